@@ -27,14 +27,22 @@ LOCAL_SRC_FILES:= \
     src/buffer.cc \
     src/command.cc \
     src/command_data.cc \
+    src/command_graph.cc \
+    src/compare_shader.cc \
+    src/compile_server.cc \
+    src/cpu/engine_cpu.cc \
+    src/cpu/invocation.cc \
+    src/cpu/program.cc \
     src/descriptor_set_and_binding_parser.cc \
     src/engine.cc \
+    src/engine_null.cc \
     src/executor.cc \
     src/float16_helper.cc \
     src/format.cc \
     src/parser.cc \
     src/pipeline.cc \
     src/pipeline_data.cc \
+    src/probe_shader.cc \
     src/recipe.cc \
     src/result.cc \
     src/sampler.cc \
@@ -44,7 +52,9 @@ LOCAL_SRC_FILES:= \
     src/tokenizer.cc \
     src/type.cc \
     src/type_parser.cc \
+    src/type_registry.cc \
     src/value.cc \
+    src/verification_queue.cc \
     src/verifier.cc \
     src/virtual_file_store.cc \
     src/vkscript/command_parser.cc \
@@ -53,11 +63,14 @@ LOCAL_SRC_FILES:= \
     src/vkscript/section_parser.cc \
     src/vulkan/buffer_descriptor.cc \
     src/vulkan/buffer_backed_descriptor.cc \
+    src/vulkan/call_stats.cc \
     src/vulkan/command_buffer.cc \
     src/vulkan/command_pool.cc \
     src/vulkan/compute_pipeline.cc \
     src/vulkan/descriptor.cc \
+    src/vulkan/descriptor_pool.cc \
     src/vulkan/device.cc \
+    src/vulkan/device_verifier.cc \
     src/vulkan/engine_vulkan.cc \
     src/vulkan/frame_buffer.cc \
     src/vulkan/graphics_pipeline.cc \
@@ -67,6 +80,7 @@ LOCAL_SRC_FILES:= \
     src/vulkan/push_constant.cc \
     src/vulkan/resource.cc \
     src/vulkan/sampler.cc \
+    src/vulkan/sampler_cache.cc \
     src/vulkan/sampler_descriptor.cc \
     src/vulkan/transfer_buffer.cc \
     src/vulkan/transfer_image.cc \
@@ -36,6 +36,10 @@ enum EngineType {
   kEngineTypeVulkan = 0,
   /// Use the Dawn backend, if available
   kEngineTypeDawn,
+  /// Use the null backend, which runs without a graphics device
+  kEngineTypeNull,
+  /// Use the CPU backend, which runs compute shaders on the host
+  kEngineTypeCpu,
 };
 
 enum class ExecutionType {
@@ -93,6 +97,10 @@ class Delegate {
   virtual bool LogGraphicsCalls() const = 0;
   /// Tells whether to log the duration of graphics API calls
   virtual bool LogGraphicsCallsTime() const = 0;
+  /// Tells whether to count the graphics API calls and their durations and
+  /// log a summary of them when the engine is destroyed, instead of a line
+  /// per call. The default implementation returns false.
+  virtual bool LogGraphicsCallStats() const;
   /// Returns the current timestamp in nanoseconds
   virtual uint64_t GetTimestampNs() const = 0;
   /// Tells whether to log each test as it's executed
@@ -130,6 +138,27 @@ struct Options {
   /// If true, disables SPIR-V validation. If false, SPIR-V shaders will be
   /// validated using the Validator component (spirv-val) from SPIRV-Tools.
   bool disable_spirv_validation;
+  /// If true, RGBA probes of framebuffers are evaluated on the device with a
+  /// compute shader when the engine and the framebuffer format allow it.
+  /// Probes which cannot run on the device are checked on the host.
+  bool device_probes;
+  /// If true, EQ and HISTOGRAM_EMD buffer comparisons are evaluated on the
+  /// device with a compute shader when both buffers are color attachments
+  /// the device still holds. Other comparisons are checked on the host. The
+  /// verdicts are the same as when comparing on the host.
+  bool device_compares;
+  /// Number of worker threads which check probes and buffer comparisons on
+  /// the host while later commands run. Checks are joined in command order,
+  /// so the reported failure is the same as without workers. Commands issued
+  /// while a failing check was still running have already executed; no
+  /// further commands are issued once the failure is known. If 0, every
+  /// check runs before the next command.
+  uint32_t verification_threads;
+  /// Path of the Unix domain socket of a compile server started with
+  /// amber-compile-server. If set, shaders are compiled by the server, and
+  /// in this process when the server cannot be reached. If empty, shaders
+  /// are always compiled in this process.
+  std::string compile_server;
 };
 
 /// Main interface to the Amber environment.
@@ -55,6 +55,10 @@ struct VulkanEngineConfig : public EngineConfig {
   /// Physical device extensions available for |physical_device|.
   std::vector<std::string> available_device_extensions;
 
+  /// Optional device extensions enabled on |device|, which amber uses when
+  /// present. Currently only VK_KHR_push_descriptor is recognized.
+  std::vector<std::string> enabled_device_extensions;
+
   /// The given queue family index to use.
   uint32_t queue_family_index;
 
@@ -63,6 +67,15 @@ struct VulkanEngineConfig : public EngineConfig {
 
   /// The VkQueue to use.
   VkQueue queue;
+
+  /// Optional queue of a family which only supports transfers, distinct from
+  /// |queue_family_index|. If provided, and the device supports timeline
+  /// semaphores, copies between staging buffers and device local buffers run
+  /// on this queue. Buffers copied there are shared between both families.
+  VkQueue transfer_queue = VK_NULL_HANDLE;
+
+  /// The queue family index of |transfer_queue|.
+  uint32_t transfer_queue_family_index = 0;
 };
 
 }  // namespace amber
@@ -23,6 +23,16 @@
 
 namespace amber {
 
+/// Where an engine places the memory of the buffers bound to descriptors.
+enum class MemoryPlacement {
+  /// Host visible and coherent memory, which the device reads and writes in
+  /// place.
+  kHostVisible = 0,
+  /// Device local memory. Data moves through host visible staging buffers,
+  /// unless the device local memory can also be mapped by the host.
+  kDeviceLocal
+};
+
 /// Internal recipe implementation.
 class RecipeImpl {
  public:
@@ -43,6 +53,9 @@ class RecipeImpl {
   /// Sets the fence timeout value to |timeout_ms|.
   virtual void SetFenceTimeout(uint32_t timeout_ms) = 0;
 
+  /// Sets the memory placement of descriptor buffers to |placement|.
+  virtual void SetMemoryPlacement(MemoryPlacement placement) = 0;
+
  protected:
   RecipeImpl();
 };
@@ -72,6 +85,9 @@ class Recipe {
   /// Sets the timeout value for fences to |timeout_ms|.
   void SetFenceTimeout(uint32_t timeout_ms);
 
+  /// Sets the memory placement of descriptor buffers to |placement|.
+  void SetMemoryPlacement(MemoryPlacement placement);
+
  private:
   RecipeImpl* impl_;
 };
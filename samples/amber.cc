@@ -66,8 +66,16 @@ struct Options {
   bool show_version_info = false;
   bool log_graphics_calls = false;
   bool log_graphics_calls_time = false;
+  bool log_graphics_call_stats = false;
   bool log_execute_calls = false;
   bool disable_spirv_validation = false;
+  bool device_probes = false;
+  bool device_compares = false;
+  uint32_t verification_threads = 0;
+  std::string compile_server;
+  bool override_memory_placement = false;
+  amber::MemoryPlacement memory_placement =
+      amber::MemoryPlacement::kHostVisible;
   std::string shader_filename;
   amber::EngineType engine = amber::kEngineTypeVulkan;
   std::string spv_env;
@@ -96,13 +104,26 @@ const char kUsage[] = R"(Usage: amber [options] SCRIPT [SCRIPTS...]
   -B [<pipeline name>:][<desc set>:]<binding> -- Identifier of buffer to write.
                                Default is [first pipeline:][0:]0.
   -w <filename>             -- Write shader assembly to |filename|
-  -e <engine>               -- Specify graphics engine: vulkan, dawn. Default is vulkan.
+  -e <engine>               -- Specify graphics engine: vulkan, dawn, null, cpu. Default is vulkan.
   -v <engine version>       -- Engine version (eg, 1.1 for Vulkan). Default 1.0.
   -V, --version             -- Output version information for Amber and libraries.
   --log-graphics-calls      -- Log graphics API calls (only for Vulkan so far).
   --log-graphics-calls-time -- Log timing of graphics API calls timing (Vulkan only).
+  --log-graphics-call-stats -- Log a summary of the count and timing of graphics API calls
+                               when the engine is destroyed, without a line per call
+                               (Vulkan only).
   --log-execute-calls       -- Log each execute call before run.
   --disable-spirv-val       -- Disable SPIR-V validation.
+  --device-probes           -- Evaluate RGBA probes on the device (Vulkan only).
+  --device-compares         -- Compare buffers on the device (Vulkan only).
+  --verification-threads <count> -- Check probes and buffer comparisons on the host with
+                               |count| worker threads while later commands run.
+  --memory-placement <placement> -- Place storage, uniform and texel buffers in
+                               host_visible or device_local memory, overriding the
+                               script (Vulkan only). Defaults to host_visible.
+  --compile-server <socket> -- Compile shaders with the amber-compile-server listening on
+                               the Unix domain socket |socket|. Shaders are compiled in
+                               this process when the server cannot be reached.
   -h                        -- This help text.
 )";
 
@@ -182,10 +203,14 @@ bool ParseArgs(const std::vector<std::string>& args, Options* opts) {
         opts->engine = amber::kEngineTypeVulkan;
       } else if (engine == "dawn") {
         opts->engine = amber::kEngineTypeDawn;
+      } else if (engine == "null") {
+        opts->engine = amber::kEngineTypeNull;
+      } else if (engine == "cpu") {
+        opts->engine = amber::kEngineTypeCpu;
       } else {
-        std::cerr
-            << "Invalid value for -e argument. Must be one of: vulkan dawn"
-            << std::endl;
+        std::cerr << "Invalid value for -e argument. Must be one of: vulkan "
+                     "dawn null cpu"
+                  << std::endl;
         return false;
       }
     } else if (arg == "-D") {
@@ -276,10 +301,55 @@ bool ParseArgs(const std::vector<std::string>& args, Options* opts) {
       opts->log_graphics_calls = true;
     } else if (arg == "--log-graphics-calls-time") {
       opts->log_graphics_calls_time = true;
+    } else if (arg == "--log-graphics-call-stats") {
+      opts->log_graphics_call_stats = true;
     } else if (arg == "--log-execute-calls") {
       opts->log_execute_calls = true;
     } else if (arg == "--disable-spirv-val") {
       opts->disable_spirv_validation = true;
+    } else if (arg == "--device-probes") {
+      opts->device_probes = true;
+    } else if (arg == "--device-compares") {
+      opts->device_compares = true;
+    } else if (arg == "--verification-threads") {
+      ++i;
+      if (i >= args.size()) {
+        std::cerr << "Missing value for --verification-threads argument."
+                  << std::endl;
+        return false;
+      }
+
+      int32_t val = 0;
+      if (!ParseOneInt(args[i].c_str(), &val) || val < 0) {
+        std::cerr << "Invalid verification thread count: " << args[i]
+                  << std::endl;
+        return false;
+      }
+      opts->verification_threads = static_cast<uint32_t>(val);
+    } else if (arg == "--memory-placement") {
+      ++i;
+      if (i >= args.size()) {
+        std::cerr << "Missing value for --memory-placement argument."
+                  << std::endl;
+        return false;
+      }
+      if (args[i] == "host_visible") {
+        opts->memory_placement = amber::MemoryPlacement::kHostVisible;
+      } else if (args[i] == "device_local") {
+        opts->memory_placement = amber::MemoryPlacement::kDeviceLocal;
+      } else {
+        std::cerr << "Invalid memory placement: " << args[i] << std::endl;
+        return false;
+      }
+      opts->override_memory_placement = true;
+    } else if (arg == "--compile-server") {
+      ++i;
+      if (i >= args.size()) {
+        std::cerr << "Missing value for --compile-server argument."
+                  << std::endl;
+        return false;
+      }
+      opts->compile_server = args[i];
     } else if (arg.size() > 0 && arg[0] == '-') {
       std::cerr << "Unrecognized option " << arg << std::endl;
       return false;
@@ -357,6 +427,13 @@ class SampleDelegate : public amber::Delegate {
     }
   }
 
+  bool LogGraphicsCallStats() const override {
+    return log_graphics_call_stats_;
+  }
+  void SetLogGraphicsCallStats(bool log_graphics_call_stats) {
+    log_graphics_call_stats_ = log_graphics_call_stats;
+  }
+
   uint64_t GetTimestampNs() const override {
     return timestamp::SampleGetTimestampNs();
   }
@@ -394,6 +471,7 @@ class SampleDelegate : public amber::Delegate {
  private:
   bool log_graphics_calls_ = false;
   bool log_graphics_calls_time_ = false;
+  bool log_graphics_call_stats_ = false;
   bool log_execute_calls_ = false;
   std::string path_ = "";
 };
@@ -513,6 +591,8 @@ int main(int argc, const char** argv) {
 
     if (options.fence_timeout > -1)
       recipe->SetFenceTimeout(static_cast<uint32_t>(options.fence_timeout));
+    if (options.override_memory_placement)
+      recipe->SetMemoryPlacement(options.memory_placement);
 
     recipe_data.emplace_back();
     recipe_data.back().file = file;
@@ -526,6 +606,8 @@ int main(int argc, const char** argv) {
     delegate.SetLogGraphicsCalls(true);
   if (options.log_graphics_calls_time)
     delegate.SetLogGraphicsCallsTime(true);
+  if (options.log_graphics_call_stats)
+    delegate.SetLogGraphicsCallStats(true);
   if (options.log_execute_calls)
     delegate.SetLogExecuteCalls(true);
 
@@ -536,6 +618,10 @@ int main(int argc, const char** argv) {
                                      ? amber::ExecutionType::kPipelineCreateOnly
                                      : amber::ExecutionType::kExecute;
   amber_options.disable_spirv_validation = options.disable_spirv_validation;
+  amber_options.device_probes = options.device_probes;
+  amber_options.device_compares = options.device_compares;
+  amber_options.verification_threads = options.verification_threads;
+  amber_options.compile_server = options.compile_server;
 
   std::set<std::string> required_features;
   std::set<std::string> required_device_extensions;
@@ -0,0 +1,46 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <string>
+
+#include "src/compile_server.h"
+
+namespace {
+
+const char kUsage[] = R"(Usage: amber-compile-server <socket>
+
+Compiles shaders for amber processes started with --compile-server <socket>.
+The server listens on the Unix domain socket |socket| until it is killed.
+A socket left behind by a killed server is replaced on the next start.
+)";
+
+}  // namespace
+
+int main(int argc, const char** argv) {
+  if (argc != 2 || std::string(argv[1]) == "-h") {
+    std::cout << kUsage;
+    return argc == 2 ? 0 : 1;
+  }
+
+  amber::CompileServer server;
+  amber::Result r = server.Listen(argv[1]);
+  if (!r.IsSuccess()) {
+    std::cerr << r.Error() << std::endl;
+    return 1;
+  }
+
+  server.Serve();
+  return 0;
+}
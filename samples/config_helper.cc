@@ -62,6 +62,10 @@ amber::Result ConfigHelper::CreateConfig(
 #else
       return amber::Result("Unable to create engine config for Dawn");
 #endif  // AMBER_ENGINE_DAWN
+    case amber::kEngineTypeNull:
+    case amber::kEngineTypeCpu:
+      // The null and CPU engines do not use a config.
+      return {};
   }
 
   if (!impl_)
@@ -54,7 +54,8 @@ class ConfigHelper {
   /// |required_features| and |required_extensions| contain lists of
   /// required features and required extensions, respectively. |engine|
   /// indicates whether the caller required VulkanEngineConfig or
-  /// DawnEngineConfig.
+  /// DawnEngineConfig. No config is created for the null and CPU
+  /// engines.
   amber::Result CreateConfig(
       amber::EngineType engine,
       uint32_t engine_major,
@@ -598,6 +598,29 @@ uint32_t ChooseQueueFamilyIndex(const VkPhysicalDevice& physical_device) {
   return std::numeric_limits<uint32_t>::max();
 }
 
+// Returns a queue family of |physical_device| which supports transfers but
+// neither graphics nor compute, usually backed by a DMA engine.
+uint32_t ChooseTransferQueueFamilyIndex(
+    const VkPhysicalDevice& physical_device) {
+  uint32_t count = 0;
+  std::vector<VkQueueFamilyProperties> properties;
+
+  vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &count, nullptr);
+  properties.resize(count);
+  vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &count,
+                                           properties.data());
+
+  for (uint32_t i = 0; i < count; ++i) {
+    if ((properties[i].queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+        !(properties[i].queueFlags &
+          (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+      return i;
+    }
+  }
+
+  return std::numeric_limits<uint32_t>::max();
+}
+
 std::string deviceTypeToName(VkPhysicalDeviceType type) {
   switch (type) {
     case VK_PHYSICAL_DEVICE_TYPE_OTHER:
@@ -647,7 +670,9 @@ ConfigHelperVulkan::ConfigHelperVulkan()
       storage_8bit_feature_(VkPhysicalDevice8BitStorageFeaturesKHR()),
       storage_16bit_feature_(VkPhysicalDevice16BitStorageFeaturesKHR()),
       subgroup_size_control_feature_(
-          VkPhysicalDeviceSubgroupSizeControlFeaturesEXT()) {}
+          VkPhysicalDeviceSubgroupSizeControlFeaturesEXT()),
+      timeline_semaphore_feature_(
+          VkPhysicalDeviceTimelineSemaphoreFeatures()) {}
 
 ConfigHelperVulkan::~ConfigHelperVulkan() {
   if (vulkan_device_)
@@ -777,7 +802,16 @@ amber::Result ConfigHelperVulkan::CheckVulkanPhysicalDeviceRequirements(
       supports_subgroup_size_control_ = true;
     else if (ext == "VK_KHR_shader_subgroup_extended_types")
       supports_shader_subgroup_extended_types_ = true;
+    else if (ext == "VK_KHR_push_descriptor")
+      supports_push_descriptor_ = true;
   }
+  const bool has_timeline_semaphore_extension =
+      std::find(available_device_extensions_.begin(),
+                available_device_extensions_.end(),
+                "VK_KHR_timeline_semaphore") !=
+      available_device_extensions_.end();
+  // Only set once the feature itself is known to be supported.
+  supports_timeline_semaphore_ = false;
 
   VkPhysicalDeviceFeatures required_vulkan_features =
       VkPhysicalDeviceFeatures();
@@ -791,6 +825,7 @@ amber::Result ConfigHelperVulkan::CheckVulkanPhysicalDeviceRequirements(
     VkPhysicalDeviceFloat16Int8FeaturesKHR float16_int8_features = {};
     VkPhysicalDevice8BitStorageFeaturesKHR storage_8bit_features = {};
     VkPhysicalDevice16BitStorageFeaturesKHR storage_16bit_features = {};
+    VkPhysicalDeviceTimelineSemaphoreFeatures timeline_semaphore_features = {};
 
     subgroup_size_control_features.sType =
         VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_SIZE_CONTROL_FEATURES_EXT;
@@ -821,9 +856,17 @@ amber::Result ConfigHelperVulkan::CheckVulkanPhysicalDeviceRequirements(
         VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_16BIT_STORAGE_FEATURES_KHR;
     storage_16bit_features.pNext = &storage_8bit_features;
 
+    // Add timeline semaphore struct into the chain only if
+    // VK_KHR_timeline_semaphore is supported.
+    timeline_semaphore_features.sType =
+        VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    timeline_semaphore_features.pNext = &storage_16bit_features;
+
     VkPhysicalDeviceFeatures2KHR features2 = VkPhysicalDeviceFeatures2KHR();
     features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
-    features2.pNext = &storage_16bit_features;
+    features2.pNext = has_timeline_semaphore_extension
+                          ? static_cast<void*>(&timeline_semaphore_features)
+                          : static_cast<void*>(&storage_16bit_features);
 
     auto vkGetPhysicalDeviceFeatures2KHR =
         reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2KHR>(
@@ -831,6 +874,9 @@ amber::Result ConfigHelperVulkan::CheckVulkanPhysicalDeviceRequirements(
                                   "vkGetPhysicalDeviceFeatures2KHR"));
     vkGetPhysicalDeviceFeatures2KHR(physical_device, &features2);
     available_features_ = features2.features;
+    supports_timeline_semaphore_ =
+        has_timeline_semaphore_extension &&
+        timeline_semaphore_features.timelineSemaphore == VK_TRUE;
 
     std::vector<std::string> required_features1;
     for (const auto& feature : required_features) {
@@ -898,6 +944,13 @@ amber::Result ConfigHelperVulkan::CheckVulkanPhysicalDeviceRequirements(
   if (vulkan_queue_family_index_ == std::numeric_limits<uint32_t>::max()) {
     return amber::Result("Device does not support required queue flags");
   }
+  // Amber orders transfer queue submissions with the main queue through
+  // timeline semaphores and ignores the transfer queue without them, so it is
+  // only created if they are enabled as well.
+  vulkan_transfer_queue_family_index_ =
+      supports_timeline_semaphore_
+          ? ChooseTransferQueueFamilyIndex(physical_device)
+          : std::numeric_limits<uint32_t>::max();
 
   return {};
 }
@@ -956,24 +1009,48 @@ amber::Result ConfigHelperVulkan::ChooseVulkanPhysicalDevice(
 amber::Result ConfigHelperVulkan::CreateVulkanDevice(
     const std::vector<std::string>& required_features,
     const std::vector<std::string>& required_extensions) {
-  VkDeviceQueueCreateInfo queue_info = VkDeviceQueueCreateInfo();
+  std::vector<VkDeviceQueueCreateInfo> queue_infos(1);
   const float priorities[] = {1.0f};
 
-  queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-  queue_info.queueFamilyIndex = vulkan_queue_family_index_;
-  queue_info.queueCount = 1;
-  queue_info.pQueuePriorities = priorities;
+  queue_infos[0] = VkDeviceQueueCreateInfo();
+  queue_infos[0].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+  queue_infos[0].queueFamilyIndex = vulkan_queue_family_index_;
+  queue_infos[0].queueCount = 1;
+  queue_infos[0].pQueuePriorities = priorities;
+
+  // Also create a queue of the dedicated transfer family, if there is one.
+  if (vulkan_transfer_queue_family_index_ !=
+      std::numeric_limits<uint32_t>::max()) {
+    queue_infos.push_back(queue_infos[0]);
+    queue_infos.back().queueFamilyIndex = vulkan_transfer_queue_family_index_;
+  }
+
+  // Push descriptors and timeline semaphores are optional, so enable them
+  // whenever they are available. Both extensions depend on
+  // VK_KHR_get_physical_device_properties2.
+  enabled_device_extensions_ = required_extensions;
+  auto enable_extension = [this](const std::string& name) {
+    if (std::find(enabled_device_extensions_.begin(),
+                  enabled_device_extensions_.end(),
+                  name) == enabled_device_extensions_.end()) {
+      enabled_device_extensions_.push_back(name);
+    }
+  };
+  if (supports_push_descriptor_ && supports_get_physical_device_properties2_)
+    enable_extension("VK_KHR_push_descriptor");
+  if (supports_timeline_semaphore_)
+    enable_extension("VK_KHR_timeline_semaphore");
 
   std::vector<const char*> required_extensions_in_char;
   std::transform(
-      required_extensions.begin(), required_extensions.end(),
+      enabled_device_extensions_.begin(), enabled_device_extensions_.end(),
       std::back_inserter(required_extensions_in_char),
       [](const std::string& ext) -> const char* { return ext.c_str(); });
 
   VkDeviceCreateInfo info = VkDeviceCreateInfo();
   info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-  info.pQueueCreateInfos = &queue_info;
-  info.queueCreateInfoCount = 1;
+  info.pQueueCreateInfos = queue_infos.data();
+  info.queueCreateInfoCount = static_cast<uint32_t>(queue_infos.size());
   info.enabledExtensionCount =
       static_cast<uint32_t>(required_extensions_in_char.size());
   info.ppEnabledExtensionNames = required_extensions_in_char.data();
@@ -1024,6 +1101,10 @@ amber::Result ConfigHelperVulkan::CreateDeviceWithFeatures2(
       VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_SUBGROUP_EXTENDED_TYPES_FEATURES;
   shader_subgroup_extended_types_feature_.pNext = nullptr;
 
+  timeline_semaphore_feature_.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+  timeline_semaphore_feature_.pNext = nullptr;
+
   void** next_ptr = &variable_pointers_feature_.pNext;
 
   if (supports_shader_float16_int8_) {
@@ -1051,6 +1132,14 @@ amber::Result ConfigHelperVulkan::CreateDeviceWithFeatures2(
     next_ptr = &shader_subgroup_extended_types_feature_.pNext;
   }
 
+  // Amber waits for its submissions with timeline semaphores when they are
+  // enabled, so the feature is not tied to a script requirement.
+  if (supports_timeline_semaphore_) {
+    timeline_semaphore_feature_.timelineSemaphore = VK_TRUE;
+    *next_ptr = &timeline_semaphore_feature_;
+    next_ptr = &timeline_semaphore_feature_.pNext;
+  }
+
   available_features2_.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
   available_features2_.pNext = &variable_pointers_feature_;
 
@@ -1255,6 +1344,11 @@ amber::Result ConfigHelperVulkan::CreateConfig(
 
   vkGetDeviceQueue(vulkan_device_, vulkan_queue_family_index_, 0,
                    &vulkan_queue_);
+  if (vulkan_transfer_queue_family_index_ !=
+      std::numeric_limits<uint32_t>::max()) {
+    vkGetDeviceQueue(vulkan_device_, vulkan_transfer_queue_family_index_, 0,
+                     &vulkan_transfer_queue_);
+  }
 
   *cfg_holder =
       std::unique_ptr<amber::EngineConfig>(new amber::VulkanEngineConfig());
@@ -1265,9 +1359,14 @@ amber::Result ConfigHelperVulkan::CreateConfig(
   config->available_features2 = available_features2_;
   config->available_instance_extensions = available_instance_extensions_;
   config->available_device_extensions = available_device_extensions_;
+  config->enabled_device_extensions = enabled_device_extensions_;
   config->instance = vulkan_instance_;
   config->queue_family_index = vulkan_queue_family_index_;
   config->queue = vulkan_queue_;
+  if (vulkan_transfer_queue_ != VK_NULL_HANDLE) {
+    config->transfer_queue = vulkan_transfer_queue_;
+    config->transfer_queue_family_index = vulkan_transfer_queue_family_index_;
+  }
   config->device = vulkan_device_;
   config->vkGetInstanceProcAddr = vkGetInstanceProcAddr;
 
@@ -104,8 +104,12 @@ class ConfigHelperVulkan : public ConfigHelperImpl {
   VkPhysicalDevice vulkan_physical_device_ = VK_NULL_HANDLE;
   std::vector<std::string> available_instance_extensions_;
   std::vector<std::string> available_device_extensions_;
+  std::vector<std::string> enabled_device_extensions_;
   uint32_t vulkan_queue_family_index_ = std::numeric_limits<uint32_t>::max();
   VkQueue vulkan_queue_ = VK_NULL_HANDLE;
+  uint32_t vulkan_transfer_queue_family_index_ =
+      std::numeric_limits<uint32_t>::max();
+  VkQueue vulkan_transfer_queue_ = VK_NULL_HANDLE;
   VkDevice vulkan_device_ = VK_NULL_HANDLE;
 
   bool supports_get_physical_device_properties2_ = false;
@@ -114,6 +118,8 @@ class ConfigHelperVulkan : public ConfigHelperImpl {
   bool supports_shader_16bit_storage_ = false;
   bool supports_subgroup_size_control_ = false;
   bool supports_shader_subgroup_extended_types_ = false;
+  bool supports_push_descriptor_ = false;
+  bool supports_timeline_semaphore_ = false;
   VkPhysicalDeviceFeatures available_features_;
   VkPhysicalDeviceFeatures2KHR available_features2_;
   VkPhysicalDeviceVariablePointerFeaturesKHR variable_pointers_feature_;
@@ -123,6 +129,7 @@ class ConfigHelperVulkan : public ConfigHelperImpl {
   VkPhysicalDeviceSubgroupSizeControlFeaturesEXT subgroup_size_control_feature_;
   VkPhysicalDeviceShaderSubgroupExtendedTypesFeatures
       shader_subgroup_extended_types_feature_;
+  VkPhysicalDeviceTimelineSemaphoreFeatures timeline_semaphore_feature_;
 };
 
 }  // namespace sample
@@ -50,7 +50,8 @@ Result GetFrameBuffer(Buffer* buffer, std::vector<Value>* values) {
     for (uint32_t x = 0; x < buffer->GetWidth(); ++x) {
       Value pixel;
 
-      const uint8_t* ptr_8 = cpu_memory + (row_stride * y) + (texel_stride * x);
+      const uint8_t* ptr_8 = cpu_memory + (static_cast<size_t>(row_stride) * y) +
+                             (texel_stride * x);
       const uint32_t* ptr_32 = reinterpret_cast<const uint32_t*>(ptr_8);
       pixel.SetIntValue(*ptr_32);
       values->push_back(pixel);
@@ -68,7 +69,10 @@ Options::Options()
     : engine(amber::EngineType::kEngineTypeVulkan),
       config(nullptr),
       execution_type(ExecutionType::kExecute),
-      disable_spirv_validation(false) {}
+      disable_spirv_validation(false),
+      device_probes(false),
+      device_compares(false),
+      verification_threads(0) {}
 
 Options::~Options() = default;
 
@@ -82,6 +86,10 @@ BufferInfo& BufferInfo::operator=(const BufferInfo&) = default;
 
 Delegate::~Delegate() = default;
 
+bool Delegate::LogGraphicsCallStats() const {
+  return false;
+}
+
 Amber::Amber(Delegate* delegate) : delegate_(delegate) {}
 
 Amber::~Amber() = default;
@@ -138,6 +146,10 @@ Result CreateEngineAndCheckRequirements(const Recipe* recipe,
   if (!r.IsSuccess())
     return r;
 
+  r = engine->CheckFormatsSupported(script->GetPipelines());
+  if (!r.IsSuccess())
+    return r;
+
   *engine_ptr = std::move(engine);
   *script_ptr = script;
 
@@ -214,12 +226,11 @@ amber::Result Amber::ExecuteWithShaderData(const amber::Recipe* recipe,
     if (!buffer)
       continue;
 
-    const uint8_t* ptr = buffer->ValuePtr()->data();
     auto& values = buffer_info.values;
-    for (size_t i = 0; i < buffer->GetSizeInBytes(); ++i) {
+    values.reserve(values.size() + buffer->ValuePtr()->size());
+    for (uint8_t byte : *buffer->ValuePtr()) {
       values.emplace_back();
-      values.back().SetIntValue(*ptr);
-      ++ptr;
+      values.back().SetIntValue(byte);
     }
   }
 
@@ -22,6 +22,7 @@
 #include <utility>
 #include <vector>
 
+#include "src/checked_math.h"
 #include "src/image.h"
 #include "src/make_unique.h"
 #include "src/sampler.h"
@@ -1480,9 +1481,7 @@ Result Parser::ParsePipelineVertexData(Pipeline* pipeline) {
       auto type = script_->ParseType(token->AsString());
       if (!type)
         return Result("invalid vertex data FORMAT");
-      auto fmt = MakeUnique<Format>(type);
-      format = fmt.get();
-      script_->RegisterFormat(std::move(fmt));
+      format = script_->GetFormat(type);
     } else {
       return Result("unexpected identifier for VERTEX_DATA command: " +
                     token->ToOriginalString());
@@ -1570,7 +1569,7 @@ Result Parser::ParsePipelineSet(Pipeline* pipeline) {
   if (!token->IsInteger() && !token->IsDouble())
     return Result("expected data value");
 
-  auto fmt = MakeUnique<Format>(type.get());
+  Format* fmt = script_->GetFormat(script_->InternType(std::move(type)));
   Value value;
   if (fmt->IsFloat32() || fmt->IsFloat64())
     value.SetDoubleValue(token->AsDouble());
@@ -1580,11 +1579,9 @@ Result Parser::ParsePipelineSet(Pipeline* pipeline) {
   Pipeline::ArgSetInfo info;
   info.name = arg_name;
   info.ordinal = arg_no;
-  info.fmt = fmt.get();
+  info.fmt = fmt;
   info.value = value;
   pipeline->SetArg(std::move(info));
-  script_->RegisterFormat(std::move(fmt));
-  script_->RegisterType(std::move(type));
 
   return ValidateEndOfStatement("SET command");
 }
@@ -2009,8 +2006,7 @@ Result Parser::ParseStruct() {
                       "' for STRUCT member");
       }
 
-      member_type = t.get();
-      script_->RegisterType(std::move(t));
+      member_type = script_->InternType(std::move(t));
     }
 
     token = tokenizer_->NextToken();
@@ -2105,9 +2101,7 @@ Result Parser::ParseBuffer() {
     if (!type)
       return Result("invalid BUFFER FORMAT");
 
-    auto fmt = MakeUnique<Format>(type);
-    buffer->SetFormat(fmt.get());
-    script_->RegisterFormat(std::move(fmt));
+    buffer->SetFormat(script_->GetFormat(type));
 
     token = tokenizer_->PeekNextToken();
     while (token->IsIdentifier()) {
@@ -2183,22 +2177,15 @@ Result Parser::ParseImage() {
         return Result("IMAGE invalid data type");
 
       auto type = script_->ParseType(token->AsString());
-      std::unique_ptr<Format> fmt;
-      if (type != nullptr) {
-        fmt = MakeUnique<Format>(type);
-        buffer->SetFormat(fmt.get());
-      } else {
+      if (type == nullptr) {
         auto new_type = ToType(token->AsString());
         if (!new_type) {
           return Result("invalid data type '" + token->AsString() +
                         "' provided");
         }
-
-        fmt = MakeUnique<Format>(new_type.get());
-        buffer->SetFormat(fmt.get());
-        script_->RegisterType(std::move(new_type));
+        type = script_->InternType(std::move(new_type));
       }
-      script_->RegisterFormat(std::move(fmt));
+      buffer->SetFormat(script_->GetFormat(type));
     } else if (token->AsString() == "FORMAT") {
       token = tokenizer_->NextToken();
       if (!token->IsIdentifier())
@@ -2208,9 +2195,7 @@ Result Parser::ParseImage() {
       if (!type)
         return Result("invalid IMAGE FORMAT");
 
-      auto fmt = MakeUnique<Format>(type);
-      buffer->SetFormat(fmt.get());
-      script_->RegisterFormat(std::move(fmt));
+      buffer->SetFormat(script_->GetFormat(type));
     } else if (token->AsString() == "MIP_LEVELS") {
       token = tokenizer_->NextToken();
 
@@ -2273,8 +2258,17 @@ Result Parser::ParseImage() {
   if (!width_set)
     return Result("expected IMAGE WIDTH");
 
-  const uint32_t size_in_items =
-      buffer->GetWidth() * buffer->GetHeight() * buffer->GetDepth();
+  uint64_t size_in_items = 0;
+  if (!CheckedMultiply(
+          static_cast<uint64_t>(buffer->GetWidth()) * buffer->GetHeight(),
+          buffer->GetDepth(), &size_in_items)) {
+    return Result("IMAGE size is too large");
+  }
+  if (buffer->GetFormat()) {
+    Result r = buffer->CheckSizeInElements(size_in_items);
+    if (!r.IsSuccess())
+      return r;
+  }
   buffer->SetElementCount(size_in_items);
 
   // Parse initializers.
@@ -2319,33 +2313,26 @@ Result Parser::ParseBufferInitializer(Buffer* buffer) {
     return Result("BUFFER invalid data type");
 
   auto type = script_->ParseType(token->AsString());
-  std::unique_ptr<Format> fmt;
-  if (type != nullptr) {
-    fmt = MakeUnique<Format>(type);
-    buffer->SetFormat(fmt.get());
-  } else {
+  if (type == nullptr) {
     auto new_type = ToType(token->AsString());
     if (!new_type)
       return Result("invalid data type '" + token->AsString() + "' provided");
 
-    fmt = MakeUnique<Format>(new_type.get());
-    buffer->SetFormat(fmt.get());
-    type = new_type.get();
-    script_->RegisterType(std::move(new_type));
+    type = script_->InternType(std::move(new_type));
   }
-  script_->RegisterFormat(std::move(fmt));
 
   token = tokenizer_->NextToken();
   if (!token->IsIdentifier())
     return Result("BUFFER missing initializer");
 
+  Format::Layout layout = Format::Layout::kStd430;
   if (token->AsString() == "STD140") {
-    buffer->GetFormat()->SetLayout(Format::Layout::kStd140);
+    layout = Format::Layout::kStd140;
     token = tokenizer_->NextToken();
   } else if (token->AsString() == "STD430") {
-    buffer->GetFormat()->SetLayout(Format::Layout::kStd430);
     token = tokenizer_->NextToken();
   }
+  buffer->SetFormat(script_->GetFormat(type, layout));
 
   if (!token->IsIdentifier())
     return Result("BUFFER missing initializer");
@@ -2374,7 +2361,10 @@ Result Parser::ParseBufferInitializer(Buffer* buffer) {
     buffer->SetHeight(height);
 
     token = tokenizer_->NextToken();
-    uint32_t size_in_items = width * height;
+    const uint64_t size_in_items = static_cast<uint64_t>(width) * height;
+    Result r = buffer->CheckSizeInElements(size_in_items);
+    if (!r.IsSuccess())
+      return r;
     buffer->SetElementCount(size_in_items);
     if (token->AsString() == "FILL")
       return ParseBufferInitializerFill(buffer, size_in_items);
@@ -2395,7 +2385,10 @@ Result Parser::ParseBufferInitializerSize(Buffer* buffer) {
   if (!token->IsInteger())
     return Result("BUFFER size invalid");
 
-  uint32_t size_in_items = token->AsUint32();
+  const uint64_t size_in_items = token->AsUint64();
+  Result r = buffer->CheckSizeInElements(size_in_items);
+  if (!r.IsSuccess())
+    return r;
   buffer->SetElementCount(size_in_items);
 
   token = tokenizer_->NextToken();
@@ -2413,7 +2406,7 @@ Result Parser::ParseBufferInitializerSize(Buffer* buffer) {
 }
 
 Result Parser::ParseBufferInitializerFill(Buffer* buffer,
-                                          uint32_t size_in_items) {
+                                          uint64_t size_in_items) {
   auto token = tokenizer_->NextToken();
   if (token->IsEOS() || token->IsEOL())
     return Result("missing BUFFER fill value");
@@ -2427,8 +2420,8 @@ Result Parser::ParseBufferInitializerFill(Buffer* buffer,
   size_in_items = size_in_items * fmt->InputNeededPerElement();
 
   std::vector<Value> values;
-  values.resize(size_in_items);
-  for (size_t i = 0; i < size_in_items; ++i) {
+  values.resize(static_cast<size_t>(size_in_items));
+  for (size_t i = 0; i < values.size(); ++i) {
     if (is_double_data)
       values[i].SetDoubleValue(token->AsDouble());
     else
@@ -2442,7 +2435,7 @@ Result Parser::ParseBufferInitializerFill(Buffer* buffer,
 }
 
 Result Parser::ParseBufferInitializerSeries(Buffer* buffer,
-                                            uint32_t size_in_items) {
+                                            uint64_t size_in_items) {
   auto token = tokenizer_->NextToken();
   if (token->IsEOS() || token->IsEOL())
     return Result("missing BUFFER series_from value");
@@ -2478,8 +2471,8 @@ Result Parser::ParseBufferInitializerSeries(Buffer* buffer,
     return Result("invalid BUFFER series_from inc_by value");
 
   std::vector<Value> values;
-  values.resize(size_in_items);
-  for (size_t i = 0; i < size_in_items; ++i) {
+  values.resize(static_cast<size_t>(size_in_items));
+  for (size_t i = 0; i < values.size(); ++i) {
     if (type::Type::IsFloat32(mode, num_bits) ||
         type::Type::IsFloat64(mode, num_bits)) {
       double value = counter.AsDouble();
@@ -2552,8 +2545,7 @@ Result Parser::ParseBufferInitializerFile(Buffer* buffer) {
     if (!r.IsSuccess())
       return r;
   } else {
-    buffer->SetElementCount(static_cast<uint32_t>(data->size()) /
-                            buffer->GetFormat()->SizeInBytes());
+    buffer->SetElementCount(data->size() / buffer->GetFormat()->SizeInBytes());
     buffer->SetWidth(info.width);
     buffer->SetHeight(info.height);
   }
@@ -2605,6 +2597,24 @@ Result Parser::ParseRun() {
   if (!token->IsIdentifier())
     return Result("invalid token in RUN command: " + token->ToOriginalString());
 
+  if (token->AsString() == "INDIRECT") {
+    if (!pipeline->IsCompute())
+      return Result("RUN INDIRECT command requires compute pipeline");
+
+    Buffer* buffer = nullptr;
+    uint32_t offset = 0;
+    Result r = ParseRunIndirect(&buffer, &offset);
+    if (!r.IsSuccess())
+      return r;
+
+    auto cmd = MakeUnique<ComputeCommand>(pipeline);
+    cmd->SetLine(line);
+    cmd->SetIndirectBuffer(buffer, offset);
+
+    command_list_.push_back(std::move(cmd));
+    return ValidateEndOfStatement("RUN command");
+  }
+
   if (token->AsString() == "DRAW_RECT") {
     if (!pipeline->IsGraphics())
       return Result("RUN command requires graphics pipeline");
@@ -2788,6 +2798,9 @@ Result Parser::ParseRun() {
     uint32_t count = 0;
     uint32_t start_instance = 0;
     uint32_t instance_count = 1;
+    bool has_draw_params = false;
+    Buffer* indirect_buffer = nullptr;
+    uint32_t indirect_offset = 0;
 
     token = tokenizer_->PeekNextToken();
 
@@ -2813,6 +2826,7 @@ Result Parser::ParseRun() {
         if (token->AsInt32() < 0)
           return Result("START_IDX value must be >= 0 for RUN command");
         start_idx = token->AsUint32();
+        has_draw_params = true;
       } else if (token->AsString() == "COUNT") {
         token = tokenizer_->NextToken();
         if (!token->IsInteger()) {
@@ -2823,6 +2837,7 @@ Result Parser::ParseRun() {
           return Result("COUNT value must be > 0 for RUN command");
 
         count = token->AsUint32();
+        has_draw_params = true;
       } else if (token->AsString() == "INSTANCE_COUNT") {
         token = tokenizer_->NextToken();
         if (!token->IsInteger()) {
@@ -2833,6 +2848,7 @@ Result Parser::ParseRun() {
           return Result("INSTANCE_COUNT value must be > 0 for RUN command");
 
         instance_count = token->AsUint32();
+        has_draw_params = true;
       } else if (token->AsString() == "START_INSTANCE") {
         token = tokenizer_->NextToken();
         if (!token->IsInteger()) {
@@ -2842,6 +2858,11 @@ Result Parser::ParseRun() {
         if (token->AsInt32() < 0)
           return Result("START_INSTANCE value must be >= 0 for RUN command");
         start_instance = token->AsUint32();
+        has_draw_params = true;
+      } else if (token->AsString() == "INDIRECT") {
+        Result r = ParseRunIndirect(&indirect_buffer, &indirect_offset);
+        if (!r.IsSuccess())
+          return r;
       } else {
         return Result("Unexpected identifier for RUN command: " +
                       token->ToOriginalString());
@@ -2850,16 +2871,24 @@ Result Parser::ParseRun() {
       token = tokenizer_->PeekNextToken();
     }
 
-    uint32_t vertex_count =
+    if (indirect_buffer && has_draw_params) {
+      return Result(
+          "RUN DRAW_ARRAY INDIRECT can not be used with START_IDX, COUNT, "
+          "START_INSTANCE or INSTANCE_COUNT");
+    }
+
+    const uint64_t vertex_count =
         indexed ? pipeline->GetIndexBuffer()->ElementCount()
                 : pipeline->GetVertexBuffers()[0].buffer->ElementCount();
 
     // If we get here then we never set count, as if count was set it must
-    // be > 0.
-    if (count == 0)
-      count = vertex_count - start_idx;
+    // be > 0. Draws are limited to 32-bit vertex counts.
+    if (count == 0 && start_idx < vertex_count) {
+      count = static_cast<uint32_t>(std::min<uint64_t>(
+          vertex_count - start_idx, std::numeric_limits<uint32_t>::max()));
+    }
 
-    if (start_idx + count > vertex_count) {
+    if (static_cast<uint64_t>(start_idx) + count > vertex_count) {
       if (indexed)
         return Result("START_IDX plus COUNT exceeds index buffer data size");
       else
@@ -2877,6 +2906,8 @@ Result Parser::ParseRun() {
 
     if (indexed)
       cmd->EnableIndexed();
+    if (indirect_buffer)
+      cmd->SetIndirectBuffer(indirect_buffer, indirect_offset);
 
     command_list_.push_back(std::move(cmd));
     return ValidateEndOfStatement("RUN command");
@@ -2885,6 +2916,37 @@ Result Parser::ParseRun() {
   return Result("invalid token in RUN command: " + token->AsString());
 }
 
+Result Parser::ParseRunIndirect(Buffer** buffer, uint32_t* offset) {
+  auto token = tokenizer_->NextToken();
+  if (!token->IsIdentifier())
+    return Result("missing buffer name for RUN INDIRECT command");
+
+  *buffer = script_->GetBuffer(token->AsString());
+  if (!*buffer) {
+    return Result("unknown buffer for RUN INDIRECT command: " +
+                  token->AsString());
+  }
+
+  *offset = 0;
+  token = tokenizer_->PeekNextToken();
+  if (!token->IsIdentifier() || token->AsString() != "OFFSET")
+    return {};
+
+  tokenizer_->NextToken();
+  token = tokenizer_->NextToken();
+  if (!token->IsInteger()) {
+    return Result("invalid OFFSET value for RUN command: " +
+                  token->ToOriginalString());
+  }
+  if (token->AsInt32() < 0)
+    return Result("OFFSET value must be >= 0 for RUN command");
+  if (token->AsUint32() % 4 != 0)
+    return Result("OFFSET value must be a multiple of 4 for RUN command");
+
+  *offset = token->AsUint32();
+  return {};
+}
+
 Result Parser::ParseClear() {
   auto token = tokenizer_->NextToken();
   if (!token->IsIdentifier())
@@ -3057,8 +3119,11 @@ Result Parser::ParseExpect() {
     return Result("missing IDX in EXPECT command");
 
   token = tokenizer_->NextToken();
-  if (!token->IsInteger() || token->AsInt32() < 0)
+  if (!token->IsInteger() || token->AsInt64() < 0)
     return Result("invalid X value in EXPECT command");
+  // Keep the exact value for byte offsets, which a float can not represent
+  // past 2^24.
+  const uint64_t x_offset = token->AsUint64();
   token->ConvertToDouble();
   float x = token->AsFloat();
 
@@ -3211,7 +3276,7 @@ Result Parser::ParseExpect() {
 
   probe->SetComparator(cmp);
   probe->SetFormat(buffer->GetFormat());
-  probe->SetOffset(static_cast<uint32_t>(x));
+  probe->SetOffset(x_offset);
 
   std::vector<Value> values;
   Result r = ParseValues("EXPECT", buffer->GetFormat(), &values);
@@ -3537,6 +3602,24 @@ Result Parser::ParseSet() {
   if (!token->IsIdentifier())
     return Result("SET invalid variable to set: " + token->ToOriginalString());
 
+  if (token->AsString() == "memory_placement") {
+    token = tokenizer_->NextToken();
+    if (token->IsEOS() || token->IsEOL())
+      return Result("SET missing value for memory_placement");
+    if (!token->IsIdentifier())
+      return Result("SET invalid value for memory_placement");
+
+    if (token->AsString() == "host_visible") {
+      script_->GetEngineData().memory_placement = MemoryPlacement::kHostVisible;
+    } else if (token->AsString() == "device_local") {
+      script_->GetEngineData().memory_placement = MemoryPlacement::kDeviceLocal;
+    } else {
+      return Result("SET invalid value for memory_placement: " +
+                    token->AsString());
+    }
+    return ValidateEndOfStatement("SET command");
+  }
+
   if (token->AsString() != "fence_timeout_ms")
     return Result("SET unknown variable provided: " + token->AsString());
 
@@ -54,8 +54,8 @@ class Parser : public amber::Parser {
   Result ParseImage();
   Result ParseBufferInitializer(Buffer*);
   Result ParseBufferInitializerSize(Buffer*);
-  Result ParseBufferInitializerFill(Buffer*, uint32_t);
-  Result ParseBufferInitializerSeries(Buffer*, uint32_t);
+  Result ParseBufferInitializerFill(Buffer*, uint64_t);
+  Result ParseBufferInitializerSeries(Buffer*, uint64_t);
   Result ParseBufferInitializerData(Buffer*);
   Result ParseBufferInitializerFile(Buffer*);
   Result ParseShaderBlock();
@@ -76,6 +76,7 @@ class Parser : public amber::Parser {
   Result ParsePipelineStencil(Pipeline* pipeline);
   Result ParsePipelineBlend(Pipeline* pipeline);
   Result ParseRun();
+  Result ParseRunIndirect(Buffer** buffer, uint32_t* offset);
   Result ParseClear();
   Result ParseClearColor();
   Result ParseClearDepth();
@@ -365,6 +365,38 @@ TEST_F(AmberScriptParserTest, BufferFill) {
   }
 }
 
+TEST_F(AmberScriptParserTest, BuffersShareFormat) {
+  std::string in = R"(
+BUFFER buf_a DATA_TYPE vec4<float> SIZE 4 FILL 0
+BUFFER buf_b DATA_TYPE vec4<float> SIZE 8 FILL 1
+BUFFER buf_c DATA_TYPE vec4<float> STD140 DATA 1 2 3 4 END)";
+
+  Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+
+  auto script = parser.GetScript();
+  const auto& buffers = script->GetBuffers();
+  ASSERT_EQ(3U, buffers.size());
+  EXPECT_EQ(buffers[0]->GetFormat(), buffers[1]->GetFormat());
+  EXPECT_NE(buffers[0]->GetFormat(), buffers[2]->GetFormat());
+  EXPECT_EQ(buffers[0]->GetFormat()->GetType(),
+            buffers[2]->GetFormat()->GetType());
+  EXPECT_EQ(Format::Layout::kStd140, buffers[2]->GetFormat()->GetLayout());
+}
+
+TEST_F(AmberScriptParserTest, BufferSizeTooLarge) {
+  std::string in =
+      "BUFFER my_buffer DATA_TYPE uint32 SIZE 4611686018427387904 FILL 5";
+
+  Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ(
+      "1: Buffer of 4611686018427387904 elements does not fit in host memory",
+      r.Error());
+}
+
 TEST_F(AmberScriptParserTest, BufferFillFloat) {
   std::string in = "BUFFER my_buffer DATA_TYPE float SIZE 5 FILL 5.2";
 
@@ -659,6 +659,24 @@ EXPECT orig_buf IDX 5 EQ 11)";
   EXPECT_EQ(11, probe->GetValues()[0].AsInt32());
 }
 
+TEST_F(AmberScriptParserTest, ExpectEQOffsetBeyond32Bits) {
+  std::string in = R"(
+BUFFER orig_buf DATA_TYPE uint8 SIZE 100 FILL 11
+EXPECT orig_buf IDX 4294967297 EQ 11)";
+
+  Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+
+  auto script = parser.GetScript();
+  const auto& commands = script->GetCommands();
+  ASSERT_EQ(1U, commands.size());
+
+  auto* cmd = commands[0].get();
+  ASSERT_TRUE(cmd->IsProbeSSBO());
+  EXPECT_EQ(4294967297ULL, cmd->AsProbeSSBO()->GetOffset());
+}
+
 TEST_F(AmberScriptParserTest, ExpectEQStruct) {
   std::string in = R"(
 STRUCT data
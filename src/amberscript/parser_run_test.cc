@@ -1842,5 +1842,234 @@ RUN my_pipeline DRAW_ARRAY AS TRIANGLE_LIST START_IDX 1 COUNT 2 START_INSTANCE 0
   EXPECT_EQ("18: INSTANCE_COUNT value must be > 0 for RUN command", r.Error());
 }
 
+TEST_F(AmberScriptParserTest, RunComputeIndirect) {
+  std::string in = R"(
+SHADER compute my_shader GLSL
+# GLSL Shader
+END
+BUFFER args_buf DATA_TYPE uint32 DATA 0 0 0 4 2 1 END
+
+PIPELINE compute my_pipeline
+  ATTACH my_shader
+END
+RUN my_pipeline INDIRECT args_buf OFFSET 12
+)";
+
+  Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+
+  auto script = parser.GetScript();
+  const auto& commands = script->GetCommands();
+  ASSERT_EQ(1U, commands.size());
+
+  auto* cmd = commands[0].get();
+  ASSERT_TRUE(cmd->IsCompute());
+  EXPECT_TRUE(cmd->AsCompute()->IsIndirect());
+  EXPECT_EQ(script->GetBuffer("args_buf"),
+            cmd->AsCompute()->GetIndirectBuffer());
+  EXPECT_EQ(12U, cmd->AsCompute()->GetIndirectOffset());
+}
+
+TEST_F(AmberScriptParserTest, RunComputeIndirectDefaultOffset) {
+  std::string in = R"(
+SHADER compute my_shader GLSL
+# GLSL Shader
+END
+BUFFER args_buf DATA_TYPE uint32 DATA 0 0 0 4 2 1 END
+
+PIPELINE compute my_pipeline
+  ATTACH my_shader
+END
+RUN my_pipeline INDIRECT args_buf
+)";
+
+  Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+
+  auto script = parser.GetScript();
+  const auto& commands = script->GetCommands();
+  ASSERT_EQ(1U, commands.size());
+
+  auto* cmd = commands[0].get();
+  ASSERT_TRUE(cmd->IsCompute());
+  EXPECT_TRUE(cmd->AsCompute()->IsIndirect());
+  EXPECT_EQ(0U, cmd->AsCompute()->GetIndirectOffset());
+}
+
+TEST_F(AmberScriptParserTest, RunComputeIndirectMissingBuffer) {
+  std::string in = R"(
+SHADER compute my_shader GLSL
+# GLSL Shader
+END
+BUFFER args_buf DATA_TYPE uint32 DATA 0 0 0 4 2 1 END
+
+PIPELINE compute my_pipeline
+  ATTACH my_shader
+END
+RUN my_pipeline INDIRECT
+)";
+
+  Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("11: missing buffer name for RUN INDIRECT command", r.Error());
+}
+
+TEST_F(AmberScriptParserTest, RunComputeIndirectUnknownBuffer) {
+  std::string in = R"(
+SHADER compute my_shader GLSL
+# GLSL Shader
+END
+BUFFER args_buf DATA_TYPE uint32 DATA 0 0 0 4 2 1 END
+
+PIPELINE compute my_pipeline
+  ATTACH my_shader
+END
+RUN my_pipeline INDIRECT unknown_buf
+)";
+
+  Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("10: unknown buffer for RUN INDIRECT command: unknown_buf",
+            r.Error());
+}
+
+TEST_F(AmberScriptParserTest, RunComputeIndirectUnalignedOffset) {
+  std::string in = R"(
+SHADER compute my_shader GLSL
+# GLSL Shader
+END
+BUFFER args_buf DATA_TYPE uint32 DATA 0 0 0 4 2 1 END
+
+PIPELINE compute my_pipeline
+  ATTACH my_shader
+END
+RUN my_pipeline INDIRECT args_buf OFFSET 2
+)";
+
+  Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("10: OFFSET value must be a multiple of 4 for RUN command",
+            r.Error());
+}
+
+TEST_F(AmberScriptParserTest, RunComputeIndirectInvalidOffset) {
+  std::string in = R"(
+SHADER compute my_shader GLSL
+# GLSL Shader
+END
+BUFFER args_buf DATA_TYPE uint32 DATA 0 0 0 4 2 1 END
+
+PIPELINE compute my_pipeline
+  ATTACH my_shader
+END
+RUN my_pipeline INDIRECT args_buf OFFSET foo
+)";
+
+  Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("10: invalid OFFSET value for RUN command: foo", r.Error());
+}
+
+TEST_F(AmberScriptParserTest, RunIndirectWithGraphicsPipeline) {
+  std::string in = R"(
+SHADER vertex my_shader PASSTHROUGH
+SHADER fragment my_fragment GLSL
+# GLSL Shader
+END
+BUFFER vtex_buf DATA_TYPE vec3<float> DATA
+1 2 3
+4 5 6
+7 8 9
+END
+BUFFER args_buf DATA_TYPE uint32 DATA 3 1 0 0 END
+
+PIPELINE graphics my_pipeline
+  ATTACH my_shader
+  ATTACH my_fragment
+  VERTEX_DATA vtex_buf LOCATION 0
+END
+RUN my_pipeline INDIRECT args_buf
+)";
+
+  Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("18: RUN INDIRECT command requires compute pipeline", r.Error());
+}
+
+TEST_F(AmberScriptParserTest, RunDrawArraysIndirect) {
+  std::string in = R"(
+SHADER vertex my_shader PASSTHROUGH
+SHADER fragment my_fragment GLSL
+# GLSL Shader
+END
+BUFFER vtex_buf DATA_TYPE vec3<float> DATA
+1 2 3
+4 5 6
+7 8 9
+END
+BUFFER args_buf DATA_TYPE uint32 DATA 3 1 0 0 END
+
+PIPELINE graphics my_pipeline
+  ATTACH my_shader
+  ATTACH my_fragment
+  VERTEX_DATA vtex_buf LOCATION 0
+END
+RUN my_pipeline DRAW_ARRAY AS TRIANGLE_LIST INDIRECT args_buf OFFSET 4
+)";
+
+  Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+
+  auto script = parser.GetScript();
+  const auto& commands = script->GetCommands();
+  ASSERT_EQ(1U, commands.size());
+  ASSERT_TRUE(commands[0]->IsDrawArrays());
+
+  auto* cmd = commands[0]->AsDrawArrays();
+  EXPECT_FALSE(cmd->IsIndexed());
+  EXPECT_TRUE(cmd->IsIndirect());
+  EXPECT_EQ(script->GetBuffer("args_buf"), cmd->GetIndirectBuffer());
+  EXPECT_EQ(4U, cmd->GetIndirectOffset());
+  EXPECT_EQ(Topology::kTriangleList, cmd->GetTopology());
+}
+
+TEST_F(AmberScriptParserTest, RunDrawArraysIndirectWithCount) {
+  std::string in = R"(
+SHADER vertex my_shader PASSTHROUGH
+SHADER fragment my_fragment GLSL
+# GLSL Shader
+END
+BUFFER vtex_buf DATA_TYPE vec3<float> DATA
+1 2 3
+4 5 6
+7 8 9
+END
+BUFFER args_buf DATA_TYPE uint32 DATA 3 1 0 0 END
+
+PIPELINE graphics my_pipeline
+  ATTACH my_shader
+  ATTACH my_fragment
+  VERTEX_DATA vtex_buf LOCATION 0
+END
+RUN my_pipeline DRAW_ARRAY AS TRIANGLE_LIST INDIRECT args_buf COUNT 2
+)";
+
+  Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ(
+      "18: RUN DRAW_ARRAY INDIRECT can not be used with START_IDX, COUNT, "
+      "START_INSTANCE or INSTANCE_COUNT",
+      r.Error());
+}
+
 }  // namespace amberscript
 }  // namespace amber
@@ -97,5 +97,45 @@ TEST_F(AmberScriptParserTest, SetFenceTimeoutExtraParams) {
   EXPECT_EQ("1: extra parameters after SET command: EXTRA", r.Error());
 }
 
+TEST_F(AmberScriptParserTest, SetMemoryPlacement) {
+  std::string in = "SET ENGINE_DATA memory_placement device_local";
+
+  Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+
+  auto script = parser.GetScript();
+  EXPECT_EQ(MemoryPlacement::kDeviceLocal,
+            script->GetEngineData().memory_placement);
+}
+
+TEST_F(AmberScriptParserTest, SetMemoryPlacementDefault) {
+  Parser parser;
+  Result r = parser.Parse("SET ENGINE_DATA fence_timeout_ms 125");
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+
+  auto script = parser.GetScript();
+  EXPECT_EQ(MemoryPlacement::kHostVisible,
+            script->GetEngineData().memory_placement);
+}
+
+TEST_F(AmberScriptParserTest, SetMemoryPlacementMissingValue) {
+  std::string in = "SET ENGINE_DATA memory_placement";
+
+  Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("1: SET missing value for memory_placement", r.Error());
+}
+
+TEST_F(AmberScriptParserTest, SetMemoryPlacementInvalidValue) {
+  std::string in = "SET ENGINE_DATA memory_placement system";
+
+  Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("1: SET invalid value for memory_placement: system", r.Error());
+}
+
 }  // namespace amberscript
 }  // namespace amber
@@ -19,6 +19,7 @@
 #include <cmath>
 #include <cstring>
 
+#include "src/checked_math.h"
 #include "src/float16_helper.h"
 
 namespace amber {
@@ -29,6 +30,25 @@ T* ValuesAs(uint8_t* values) {
   return reinterpret_cast<T*>(values);
 }
 
+// Stores the number of input values needed to write |data_size| values
+// |offset| bytes into a buffer of |format| into |value_count|. Returns false
+// if the count does not fit in 64 bits.
+bool GetValueCountWithOffset(const Format* format,
+                             uint64_t offset,
+                             uint64_t data_size,
+                             uint64_t* value_count) {
+  // Multiply by the input needed because the value count will use the needed
+  // input as the multiplier
+  uint64_t count = 0;
+  if (!CheckedMultiply(offset / format->SizeInBytes(),
+                       format->InputNeededPerElement(), &count) ||
+      !CheckedAdd(count, data_size, &count)) {
+    return false;
+  }
+  *value_count = count;
+  return true;
+}
+
 template <typename T>
 double Sub(const uint8_t* buf1, const uint8_t* buf2) {
   return static_cast<double>(*reinterpret_cast<const T*>(buf1) -
@@ -72,6 +92,22 @@ double CalculateDiff(const Format::Segment* seg,
 
 }  // namespace
 
+bool IsReadOnlyBufferType(BufferType type) {
+  switch (type) {
+    case BufferType::kIndex:
+    case BufferType::kSampledImage:
+    case BufferType::kCombinedImageSampler:
+    case BufferType::kUniform:
+    case BufferType::kUniformDynamic:
+    case BufferType::kPushConstant:
+    case BufferType::kVertex:
+    case BufferType::kUniformTexelBuffer:
+      return true;
+    default:
+      return false;
+  }
+}
+
 Buffer::Buffer() = default;
 
 Buffer::~Buffer() = default;
@@ -92,28 +128,30 @@ Result Buffer::IsEqual(Buffer* buffer) const {
   if (!result.IsSuccess())
     return result;
 
-  uint32_t num_different = 0;
-  uint32_t first_different_index = 0;
-  uint8_t first_different_left = 0;
-  uint8_t first_different_right = 0;
-  for (uint32_t i = 0; i < bytes_.size(); ++i) {
+  uint64_t num_different = 0;
+  uint64_t first_different_index = 0;
+  for (size_t i = 0; i < bytes_.size(); ++i) {
     if (bytes_[i] != buffer->bytes_[i]) {
-      if (num_different == 0) {
+      if (num_different == 0)
         first_different_index = i;
-        first_different_left = bytes_[i];
-        first_different_right = buffer->bytes_[i];
-      }
       num_different++;
     }
   }
 
+  return GetEqualityResult(buffer, num_different, first_different_index);
+}
+
+Result Buffer::GetEqualityResult(const Buffer* buffer,
+                                 uint64_t num_different,
+                                 uint64_t first_different_index) const {
   if (num_different) {
+    const size_t index = static_cast<size_t>(first_different_index);
     return Result{"Buffers have different values. " +
                   std::to_string(num_different) +
                   " values differed, first difference at byte " +
                   std::to_string(first_different_index) + " values " +
-                  std::to_string(first_different_left) +
-                  " != " + std::to_string(first_different_right)};
+                  std::to_string(bytes_[index]) + " != " +
+                  std::to_string(buffer->bytes_[index])};
   }
 
   return {};
@@ -122,6 +160,20 @@ Result Buffer::IsEqual(Buffer* buffer) const {
 std::vector<double> Buffer::CalculateDiffs(const Buffer* buffer) const {
   std::vector<double> diffs;
 
+  if (format_->AreAllSegmentsFloat16()) {
+    size_t count = GetSizeInBytes() / sizeof(uint16_t);
+    std::vector<float> values_1(count);
+    std::vector<float> values_2(count);
+    float16::HexFloatToFloatArray(GetValues<uint16_t>(), values_1.data(),
+                                  count, 16);
+    float16::HexFloatToFloatArray(buffer->GetValues<uint16_t>(),
+                                  values_2.data(), count, 16);
+    diffs.resize(count);
+    for (size_t i = 0; i < count; ++i)
+      diffs[i] = static_cast<double>(values_1[i] - values_2[i]);
+    return diffs;
+  }
+
   auto* buf_1_ptr = GetValues<uint8_t>();
   auto* buf_2_ptr = buffer->GetValues<uint8_t>();
   const auto& segments = format_->GetSegments();
@@ -205,12 +257,11 @@ std::vector<uint64_t> Buffer::GetHistogramForChannel(uint32_t channel,
   return bins;
 }
 
-Result Buffer::CompareHistogramEMD(Buffer* buffer, float tolerance) const {
+Result Buffer::CheckHistogramEMDCompability(Buffer* buffer) const {
   auto result = CheckCompability(buffer);
   if (!result.IsSuccess())
     return result;
 
-  const int num_bins = 256;
   auto num_channels = format_->InputNeededPerElement();
   for (auto segment : format_->GetSegments()) {
     if (!type::Type::IsUint8(segment.GetFormatMode(), segment.GetNumBits()) ||
@@ -219,13 +270,32 @@ Result Buffer::CompareHistogramEMD(Buffer* buffer, float tolerance) const {
           "EMD comparison only supports 8bit unorm format with four channels.");
     }
   }
+  return {};
+}
 
+Result Buffer::CompareHistogramEMD(Buffer* buffer, float tolerance) const {
+  auto result = CheckHistogramEMDCompability(buffer);
+  if (!result.IsSuccess())
+    return result;
+
+  const uint32_t num_bins = 256;
+  auto num_channels = format_->InputNeededPerElement();
   std::vector<std::vector<uint64_t>> histogram1;
   std::vector<std::vector<uint64_t>> histogram2;
   for (uint32_t c = 0; c < num_channels; ++c) {
     histogram1.push_back(GetHistogramForChannel(c, num_bins));
     histogram2.push_back(buffer->GetHistogramForChannel(c, num_bins));
   }
+  return CompareHistograms(buffer, histogram1, histogram2, tolerance);
+}
+
+Result Buffer::CompareHistograms(
+    const Buffer* buffer,
+    const std::vector<std::vector<uint64_t>>& histogram1,
+    const std::vector<std::vector<uint64_t>>& histogram2,
+    float tolerance) const {
+  const int num_bins = 256;
+  auto num_channels = format_->InputNeededPerElement();
 
   // Earth movers's distance: Calculate the minimal cost of moving "earth" to
   // transform the first histogram into the second, where each bin of the
@@ -243,10 +313,10 @@ Result Buffer::CompareHistogramEMD(Buffer* buffer, float tolerance) const {
     double diff_accum = 0;
 
     for (size_t i = 0; i < num_bins; ++i) {
-      double hist_normalized_1 =
-          static_cast<double>(histogram1[c][i]) / element_count_;
-      double hist_normalized_2 =
-          static_cast<double>(histogram2[c][i]) / buffer->element_count_;
+      double hist_normalized_1 = static_cast<double>(histogram1[c][i]) /
+                                 static_cast<double>(element_count_);
+      double hist_normalized_2 = static_cast<double>(histogram2[c][i]) /
+                                 static_cast<double>(buffer->element_count_);
       diff_accum += hist_normalized_1 - hist_normalized_2;
       diff_total += fabs(diff_accum);
     }
@@ -268,13 +338,12 @@ Result Buffer::SetData(const std::vector<Value>& data) {
 }
 
 Result Buffer::RecalculateMaxSizeInBytes(const std::vector<Value>& data,
-                                         uint32_t offset) {
-  // Multiply by the input needed because the value count will use the needed
-  // input as the multiplier
-  uint32_t value_count =
-      ((offset / format_->SizeInBytes()) * format_->InputNeededPerElement()) +
-      static_cast<uint32_t>(data.size());
-  uint32_t element_count = value_count;
+                                         uint64_t offset) {
+  uint64_t value_count = 0;
+  if (!GetValueCountWithOffset(format_, offset, data.size(), &value_count))
+    return Result("Buffer offset " + std::to_string(offset) + " is too large");
+
+  uint64_t element_count = value_count;
   if (!format_->IsPacked()) {
     // This divides by the needed input values, not the values per element.
     // The assumption being the values coming in are read from the input,
@@ -282,18 +351,20 @@ Result Buffer::RecalculateMaxSizeInBytes(const std::vector<Value>& data,
     // values per element.
     element_count = value_count / format_->InputNeededPerElement();
   }
-  if (GetMaxSizeInBytes() < element_count * format_->SizeInBytes())
-    SetMaxSizeInBytes(element_count * format_->SizeInBytes());
+  uint64_t size_in_bytes = 0;
+  if (!CheckedMultiply(element_count, format_->SizeInBytes(), &size_in_bytes))
+    return Result("Buffer offset " + std::to_string(offset) + " is too large");
+
+  if (GetMaxSizeInBytes() < size_in_bytes)
+    SetMaxSizeInBytes(size_in_bytes);
   return {};
 }
 
 Result Buffer::SetDataWithOffset(const std::vector<Value>& data,
-                                 uint32_t offset) {
-  // Multiply by the input needed because the value count will use the needed
-  // input as the multiplier
-  uint32_t value_count =
-      ((offset / format_->SizeInBytes()) * format_->InputNeededPerElement()) +
-      static_cast<uint32_t>(data.size());
+                                 uint64_t offset) {
+  uint64_t value_count = 0;
+  if (!GetValueCountWithOffset(format_, offset, data.size(), &value_count))
+    return Result("Buffer offset " + std::to_string(offset) + " is too large");
 
   // The buffer should only be resized to become bigger. This means that if a
   // command was run to set the buffer size we'll honour that size until a
@@ -301,25 +372,38 @@ Result Buffer::SetDataWithOffset(const std::vector<Value>& data,
   if (value_count > ValueCount())
     SetValueCount(value_count);
 
+  Result r = CheckSizeInElements(ElementCount());
+  if (!r.IsSuccess())
+    return r;
+
   // Even if the value count doesn't change, the buffer is still resized because
   // this maybe the first time data is set into the buffer.
-  bytes_.resize(GetSizeInBytes());
+  bytes_.resize(static_cast<size_t>(GetSizeInBytes()));
 
   // Set the new memory to zero to be on the safe side.
-  uint32_t new_space =
-      (static_cast<uint32_t>(data.size()) / format_->InputNeededPerElement()) *
-      format_->SizeInBytes();
+  const size_t new_space =
+      (data.size() / format_->InputNeededPerElement()) * format_->SizeInBytes();
   assert(new_space + offset <= GetSizeInBytes());
 
   if (new_space > 0)
-    memset(bytes_.data() + offset, 0, new_space);
+    memset(bytes_.data() + static_cast<size_t>(offset), 0, new_space);
 
   if (data.size() > (ElementCount() * format_->InputNeededPerElement()))
     return Result("Mismatched number of items in buffer");
 
-  uint8_t* ptr = bytes_.data() + offset;
+  uint8_t* ptr = bytes_.data() + static_cast<size_t>(offset);
+  if (format_->AreAllSegmentsFloat16()) {
+    std::vector<float> floats(data.size());
+    for (size_t i = 0; i < data.size(); ++i)
+      floats[i] = data[i].AsFloat();
+
+    float16::FloatToHexFloat16Array(floats.data(), ValuesAs<uint16_t>(ptr),
+                                    floats.size());
+    return {};
+  }
+
   const auto& segments = format_->GetSegments();
-  for (uint32_t i = 0; i < data.size();) {
+  for (size_t i = 0; i < data.size();) {
     for (const auto& seg : segments) {
       if (seg.IsPadding()) {
         ptr += seg.PaddingBytes();
@@ -390,35 +474,60 @@ uint32_t Buffer::WriteValueFromComponent(const Value& value,
   return 0;
 }
 
-void Buffer::SetSizeInElements(uint32_t element_count) {
+Result Buffer::CheckSizeInElements(uint64_t element_count) const {
+  uint64_t size_in_bytes = 0;
+  if (!CheckedMultiply(element_count, format_->SizeInBytes(), &size_in_bytes) ||
+      !FitsInHostMemory(size_in_bytes)) {
+    return Result("Buffer of " + std::to_string(element_count) +
+                  " elements does not fit in host memory");
+  }
+  return {};
+}
+
+Result Buffer::SetSizeInElements(uint64_t element_count) {
+  Result r = CheckSizeInElements(element_count);
+  if (!r.IsSuccess())
+    return r;
+
   element_count_ = element_count;
-  bytes_.resize(element_count * format_->SizeInBytes());
+  bytes_.resize(static_cast<size_t>(element_count * format_->SizeInBytes()));
+  return {};
 }
 
-void Buffer::SetSizeInBytes(uint32_t size_in_bytes) {
+Result Buffer::SetSizeInBytes(uint64_t size_in_bytes) {
   assert(size_in_bytes % format_->SizeInBytes() == 0);
+  if (!FitsInHostMemory(size_in_bytes)) {
+    return Result("Buffer of " + std::to_string(size_in_bytes) +
+                  " bytes does not fit in host memory");
+  }
+
   element_count_ = size_in_bytes / format_->SizeInBytes();
-  bytes_.resize(size_in_bytes);
+  bytes_.resize(static_cast<size_t>(size_in_bytes));
+  return {};
 }
 
-void Buffer::SetMaxSizeInBytes(uint32_t max_size_in_bytes) {
+void Buffer::SetMaxSizeInBytes(uint64_t max_size_in_bytes) {
   max_size_in_bytes_ = max_size_in_bytes;
 }
 
-uint32_t Buffer::GetMaxSizeInBytes() const {
+uint64_t Buffer::GetMaxSizeInBytes() const {
   if (max_size_in_bytes_ != 0)
     return max_size_in_bytes_;
   else
     return GetSizeInBytes();
 }
 
-Result Buffer::SetDataFromBuffer(const Buffer* src, uint32_t offset) {
-  if (bytes_.size() < offset + src->bytes_.size())
-    bytes_.resize(offset + src->bytes_.size());
+Result Buffer::SetDataFromBuffer(const Buffer* src, uint64_t offset) {
+  uint64_t end = 0;
+  if (!CheckedAdd(offset, src->bytes_.size(), &end) || !FitsInHostMemory(end))
+    return Result("Buffer offset " + std::to_string(offset) + " is too large");
+
+  if (bytes_.size() < end)
+    bytes_.resize(static_cast<size_t>(end));
 
-  std::memcpy(bytes_.data() + offset, src->bytes_.data(), src->bytes_.size());
-  element_count_ =
-      static_cast<uint32_t>(bytes_.size()) / format_->SizeInBytes();
+  std::memcpy(bytes_.data() + static_cast<size_t>(offset), src->bytes_.data(),
+              src->bytes_.size());
+  element_count_ = bytes_.size() / format_->SizeInBytes();
   return {};
 }
 
@@ -67,6 +67,9 @@ enum class BufferType : int8_t {
   kResolve
 };
 
+/// Returns true if a shader can only read a buffer bound as |type|.
+bool IsReadOnlyBufferType(BufferType type);
+
 enum class InputRate : int8_t {
   kVertex = 0,
   kInstance,
@@ -128,12 +131,12 @@ class Buffer {
   // inflated to 4 values per row, instead of 3.
 
   /// Sets the number of elements in the buffer.
-  void SetElementCount(uint32_t count) { element_count_ = count; }
+  void SetElementCount(uint64_t count) { element_count_ = count; }
   /// Returns the number of elements in the buffer.
-  uint32_t ElementCount() const { return element_count_; }
+  uint64_t ElementCount() const { return element_count_; }
 
   /// Sets the number of values in the buffer.
-  void SetValueCount(uint32_t count) {
+  void SetValueCount(uint64_t count) {
     if (!format_) {
       element_count_ = 0;
       return;
@@ -149,7 +152,7 @@ class Buffer {
     }
   }
   /// Returns the number of values in the buffer.
-  uint32_t ValueCount() const {
+  uint64_t ValueCount() const {
     if (!format_)
       return 0;
     // Packed formats are single values.
@@ -159,7 +162,7 @@ class Buffer {
   }
 
   /// Returns the number of bytes needed for the data in the buffer.
-  uint32_t GetSizeInBytes() const {
+  uint64_t GetSizeInBytes() const {
     if (!format_)
       return 0;
     return ElementCount() * format_->SizeInBytes();
@@ -174,36 +177,42 @@ class Buffer {
   /// Sets the data into the buffer.
   Result SetData(const std::vector<Value>& data);
 
+  /// Returns an error if |element_count| elements do not fit in host memory.
+  /// This requires the format to have been set.
+  Result CheckSizeInElements(uint64_t element_count) const;
+
   /// Resizes the buffer to hold |element_count| elements. This is separate
   /// from SetElementCount() because we may not know the format when we set the
-  /// initial count. This requires the format to have been set.
-  void SetSizeInElements(uint32_t element_count);
+  /// initial count. This requires the format to have been set. Returns an
+  /// error if the resulting size does not fit in host memory.
+  Result SetSizeInElements(uint64_t element_count);
 
   /// Resizes the buffer to hold |size_in_bytes|/format_->SizeInBytes()
   /// number of elements while resizing the buffer to |size_in_bytes| bytes.
   /// This requires the format to have been set. This is separate from
   /// SetSizeInElements() since the given argument here is |size_in_bytes|
-  /// bytes vs |element_count| elements
-  void SetSizeInBytes(uint32_t size_in_bytes);
+  /// bytes vs |element_count| elements. Returns an error if |size_in_bytes|
+  /// does not fit in host memory.
+  Result SetSizeInBytes(uint64_t size_in_bytes);
 
   /// Sets the max_size_in_bytes_ to |max_size_in_bytes| bytes
-  void SetMaxSizeInBytes(uint32_t max_size_in_bytes);
+  void SetMaxSizeInBytes(uint64_t max_size_in_bytes);
   /// Returns max_size_in_bytes_ if it is not zero. Otherwise it means this
   /// buffer is an amber buffer which has a fix size and returns
   /// GetSizeInBytes()
-  uint32_t GetMaxSizeInBytes() const;
+  uint64_t GetMaxSizeInBytes() const;
 
   /// Write |data| into the buffer |offset| bytes from the start. Write
   /// |size_in_bytes| of data.
-  Result SetDataWithOffset(const std::vector<Value>& data, uint32_t offset);
+  Result SetDataWithOffset(const std::vector<Value>& data, uint64_t offset);
 
   /// At each ubo, ssbo size and ssbo subdata size calls, recalculates
   /// max_size_in_bytes_ and updates it if underlying buffer got bigger
   Result RecalculateMaxSizeInBytes(const std::vector<Value>& data,
-                                   uint32_t offset);
+                                   uint64_t offset);
 
   /// Writes |src| data into buffer at |offset|.
-  Result SetDataFromBuffer(const Buffer* src, uint32_t offset);
+  Result SetDataFromBuffer(const Buffer* src, uint64_t offset);
 
   /// Sets the number of mip levels for a buffer used as a color buffer
   /// or a texture.
@@ -235,6 +244,12 @@ class Buffer {
   /// Succeeds only if both buffer contents are equal
   Result IsEqual(Buffer* buffer) const;
 
+  /// Returns the result of IsEqual against |buffer| given the number of
+  /// bytes which differ and the index of the first one.
+  Result GetEqualityResult(const Buffer* buffer,
+                           uint64_t num_different,
+                           uint64_t first_different_index) const;
+
   /// Returns a histogram
   std::vector<uint64_t> GetHistogramForChannel(uint32_t channel,
                                                uint32_t num_bins) const;
@@ -250,6 +265,19 @@ class Buffer {
   /// less than |tolerance|.
   Result CompareHistogramEMD(Buffer* buffer, float tolerance) const;
 
+  /// Checks if the histogram EMD of this buffer can be compared against
+  /// |buffer|.
+  Result CheckHistogramEMDCompability(Buffer* buffer) const;
+
+  /// Compares the per channel histograms |histogram1| of this buffer and
+  /// |histogram2| of |buffer|, each with 256 bins. The EMD must be less than
+  /// |tolerance|.
+  Result CompareHistograms(
+      const Buffer* buffer,
+      const std::vector<std::vector<uint64_t>>& histogram1,
+      const std::vector<std::vector<uint64_t>>& histogram2,
+      float tolerance) const;
+
  private:
   uint32_t WriteValueFromComponent(const Value& value,
                                    FormatMode mode,
@@ -263,8 +291,8 @@ class Buffer {
   std::string name_;
   /// max_size_in_bytes_ is the total size in bytes needed to hold the buffer
   /// over all ubo, ssbo size and ssbo subdata size calls.
-  uint32_t max_size_in_bytes_ = 0;
-  uint32_t element_count_ = 0;
+  uint64_t max_size_in_bytes_ = 0;
+  uint64_t element_count_ = 0;
   uint32_t width_ = 1;
   uint32_t height_ = 1;
   uint32_t depth_ = 1;
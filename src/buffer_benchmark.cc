@@ -0,0 +1,122 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "amber/value.h"
+#include "benchmark/benchmark.h"
+#include "src/buffer.h"
+#include "src/format.h"
+#include "src/type_parser.h"
+
+namespace amber {
+namespace {
+
+const char* kBufferFormats[] = {
+    "R8G8B8A8_UNORM", "R16_SFLOAT", "R32_SFLOAT", "R32G32B32A32_UINT",
+    "R64_SFLOAT",     "float/vec3",
+};
+const int kBufferFormatCount =
+    static_cast<int>(sizeof(kBufferFormats) / sizeof(kBufferFormats[0]));
+
+struct BufferFixture {
+  explicit BufferFixture(const std::string& name) {
+    TypeParser parser;
+    type = parser.Parse(name);
+    format = MakeUnique<Format>(type.get());
+  }
+
+  std::vector<Value> MakeValues(int64_t element_count) const {
+    std::vector<Value> values(static_cast<size_t>(element_count) *
+                              format->InputNeededPerElement());
+    const bool is_float =
+        type::Type::IsFloat(format->GetSegments()[0].GetFormatMode());
+    for (size_t i = 0; i < values.size(); ++i) {
+      if (is_float)
+        values[i].SetDoubleValue(static_cast<double>(i % 256) * 0.5);
+      else
+        values[i].SetIntValue(i % 256);
+    }
+    return values;
+  }
+
+  std::unique_ptr<type::Type> type;
+  std::unique_ptr<Format> format;
+};
+
+void BM_BufferSetDataWithOffset(benchmark::State& state) {
+  BufferFixture fixture(kBufferFormats[state.range(0)]);
+  state.SetLabel(kBufferFormats[state.range(0)]);
+  auto values = fixture.MakeValues(state.range(1));
+  for (auto _ : state) {
+    Buffer b;
+    b.SetFormat(fixture.format.get());
+    Result r = b.SetDataWithOffset(values, 0);
+    benchmark::DoNotOptimize(r);
+    benchmark::DoNotOptimize(b.ValuePtr()->data());
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(values.size()));
+}
+BENCHMARK(BM_BufferSetDataWithOffset)
+    ->ArgsProduct({benchmark::CreateDenseRange(0, kBufferFormatCount - 1, 1),
+                   {1 << 10, 1 << 16, 1 << 20}});
+
+// Fills two RGBA8 buffers of |element_count| texels which differ slightly.
+void FillComparePair(Buffer* b1,
+                     Buffer* b2,
+                     Format* fmt,
+                     int64_t element_count) {
+  b1->SetFormat(fmt);
+  b2->SetFormat(fmt);
+  b1->SetSizeInElements(static_cast<uint32_t>(element_count));
+  b2->SetSizeInElements(static_cast<uint32_t>(element_count));
+  auto* p1 = b1->ValuePtr();
+  auto* p2 = b2->ValuePtr();
+  for (size_t i = 0; i < p1->size(); ++i) {
+    (*p1)[i] = static_cast<uint8_t>(i * 7);
+    (*p2)[i] = static_cast<uint8_t>(i * 7 + (i % 3 == 0 ? 1 : 0));
+  }
+}
+
+void BM_BufferCompareRMSE(benchmark::State& state) {
+  BufferFixture fixture("R8G8B8A8_UNORM");
+  Buffer b1;
+  Buffer b2;
+  FillComparePair(&b1, &b2, fixture.format.get(), state.range(0));
+  for (auto _ : state) {
+    Result r = b1.CompareRMSE(&b2, 10.f);
+    benchmark::DoNotOptimize(r);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BufferCompareRMSE)->Range(1 << 10, 1 << 20);
+
+void BM_BufferCompareHistogramEMD(benchmark::State& state) {
+  BufferFixture fixture("R8G8B8A8_UNORM");
+  Buffer b1;
+  Buffer b2;
+  FillComparePair(&b1, &b2, fixture.format.get(), state.range(0));
+  for (auto _ : state) {
+    Result r = b1.CompareHistogramEMD(&b2, 1.f);
+    benchmark::DoNotOptimize(r);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BufferCompareHistogramEMD)->Range(1 << 10, 1 << 20);
+
+}  // namespace
+}  // namespace amber
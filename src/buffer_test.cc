@@ -45,6 +45,67 @@ TEST_F(BufferTest, Size) {
   EXPECT_EQ(10u * sizeof(int16_t), b.GetSizeInBytes());
 }
 
+TEST_F(BufferTest, SizeBeyond32Bits) {
+  TypeParser parser;
+  auto type = parser.Parse("R32_SFLOAT");
+  Format fmt(type.get());
+
+  Buffer b;
+  b.SetFormat(&fmt);
+  b.SetElementCount(0x100000001ULL);
+  EXPECT_EQ(0x100000001ULL, b.ElementCount());
+  EXPECT_EQ(0x100000001ULL, b.ValueCount());
+  EXPECT_EQ(0x400000004ULL, b.GetSizeInBytes());
+  EXPECT_TRUE(b.CheckSizeInElements(b.ElementCount()).IsSuccess());
+}
+
+TEST_F(BufferTest, SetDataWithOffsetTooLarge) {
+  std::vector<Value> values;
+  values.resize(1);
+
+  TypeParser parser;
+  auto type = parser.Parse("R32_SFLOAT");
+  Format fmt(type.get());
+
+  Buffer b;
+  b.SetFormat(&fmt);
+  Result r = b.SetDataWithOffset(values, 0xfffffffffffffff0ULL);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ(
+      "Buffer of 4611686018427387901 elements does not fit in host memory",
+      r.Error());
+}
+
+TEST_F(BufferTest, SetSizeInElementsOverflow) {
+  TypeParser parser;
+  auto type = parser.Parse("R32_SFLOAT");
+  Format fmt(type.get());
+
+  Buffer b;
+  b.SetFormat(&fmt);
+  Result r = b.SetSizeInElements(0x4000000000000000ULL);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ(
+      "Buffer of 4611686018427387904 elements does not fit in host memory",
+      r.Error());
+  EXPECT_EQ(0u, b.ElementCount());
+}
+
+TEST_F(BufferTest, SetSizeInBytesOverflow) {
+  TypeParser parser;
+  auto type = parser.Parse("R32_SFLOAT");
+  Format fmt(type.get());
+
+  Buffer b;
+  b.SetFormat(&fmt);
+  Result r = b.SetSizeInBytes(0xfffffffffffffff0ULL);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ(
+      "Buffer of 18446744073709551600 bytes does not fit in host memory",
+      r.Error());
+  EXPECT_EQ(0u, b.ElementCount());
+}
+
 TEST_F(BufferTest, SizeFromData) {
   std::vector<Value> values;
   values.resize(5);
@@ -295,6 +356,72 @@ TEST_F(BufferTest, CompareHistogramEMDToleranceAllWhite) {
   EXPECT_TRUE(b1.CompareHistogramEMD(&b2, 0.0f).IsSuccess());
 }
 
+TEST_F(BufferTest, IsEqualReportsFirstDifference) {
+  TypeParser parser;
+  auto type = parser.Parse("R8G8B8A8_UINT");
+  Format fmt(type.get());
+
+  std::vector<Value> values1(8);
+  for (uint32_t i = 0; i < values1.size(); ++i)
+    values1[i].SetIntValue(i);
+
+  std::vector<Value> values2 = values1;
+  values2[5].SetIntValue(50);
+  values2[7].SetIntValue(70);
+
+  Buffer b1;
+  b1.SetFormat(&fmt);
+  b1.SetData(values1);
+
+  Buffer b2;
+  b2.SetFormat(&fmt);
+  b2.SetData(values2);
+
+  Result r = b1.IsEqual(&b2);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ(
+      "Buffers have different values. 2 values differed, first difference at "
+      "byte 5 values 5 != 50",
+      r.Error());
+  EXPECT_EQ(r.Error(), b1.GetEqualityResult(&b2, 2, 5).Error());
+  EXPECT_TRUE(b1.GetEqualityResult(&b2, 0, 0).IsSuccess());
+}
+
+TEST_F(BufferTest, CompareHistogramsMatchesCompareHistogramEMD) {
+  TypeParser parser;
+  auto type = parser.Parse("R8G8B8A8_UINT");
+  Format fmt(type.get());
+
+  std::vector<Value> values1(40);
+  for (uint32_t i = 0; i < values1.size(); i += 4)
+    values1[i].SetIntValue(i / 4 * 25);
+
+  std::vector<Value> values2 = values1;
+  values2[4].SetIntValue(values2[4].AsUint8() + 50);
+
+  Buffer b1;
+  b1.SetFormat(&fmt);
+  b1.SetData(values1);
+
+  Buffer b2;
+  b2.SetFormat(&fmt);
+  b2.SetData(values2);
+
+  std::vector<std::vector<uint64_t>> histogram1;
+  std::vector<std::vector<uint64_t>> histogram2;
+  for (uint32_t c = 0; c < 4; ++c) {
+    histogram1.push_back(b1.GetHistogramForChannel(c, 256));
+    histogram2.push_back(b2.GetHistogramForChannel(c, 256));
+  }
+
+  Result expected = b1.CompareHistogramEMD(&b2, 0.001f);
+  Result r = b1.CompareHistograms(&b2, histogram1, histogram2, 0.001f);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ(expected.Error(), r.Error());
+  EXPECT_TRUE(
+      b1.CompareHistograms(&b2, histogram1, histogram2, 0.02f).IsSuccess());
+}
+
 TEST_F(BufferTest, SetFloat16) {
   std::vector<Value> values;
   values.resize(2);
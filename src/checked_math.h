@@ -0,0 +1,51 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_CHECKED_MATH_H_
+#define SRC_CHECKED_MATH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace amber {
+
+/// Stores |a| + |b| into |result|. Returns false, leaving |result|
+/// untouched, if the sum does not fit in 64 bits.
+inline bool CheckedAdd(uint64_t a, uint64_t b, uint64_t* result) {
+  if (a > std::numeric_limits<uint64_t>::max() - b)
+    return false;
+  *result = a + b;
+  return true;
+}
+
+/// Stores |a| * |b| into |result|. Returns false, leaving |result|
+/// untouched, if the product does not fit in 64 bits.
+inline bool CheckedMultiply(uint64_t a, uint64_t b, uint64_t* result) {
+  if (b != 0 && a > std::numeric_limits<uint64_t>::max() / b)
+    return false;
+  *result = a * b;
+  return true;
+}
+
+/// Returns true if |size_in_bytes| does not exceed the largest object the
+/// host can address, which is much less than 64 bits on 32-bit hosts.
+inline bool FitsInHostMemory(uint64_t size_in_bytes) {
+  return size_in_bytes <=
+         static_cast<uint64_t>(std::numeric_limits<std::ptrdiff_t>::max());
+}
+
+}  // namespace amber
+
+#endif  // SRC_CHECKED_MATH_H_
@@ -0,0 +1,57 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/checked_math.h"
+
+#include <cstddef>
+#include <limits>
+
+#include "gtest/gtest.h"
+
+namespace amber {
+
+using CheckedMathTest = testing::Test;
+
+TEST_F(CheckedMathTest, Add) {
+  uint64_t result = 0;
+  EXPECT_TRUE(CheckedAdd(0xffffffffULL, 1, &result));
+  EXPECT_EQ(0x100000000ULL, result);
+
+  const uint64_t max = std::numeric_limits<uint64_t>::max();
+  EXPECT_TRUE(CheckedAdd(max - 1, 1, &result));
+  EXPECT_EQ(max, result);
+  EXPECT_FALSE(CheckedAdd(max, 1, &result));
+  EXPECT_EQ(max, result);
+}
+
+TEST_F(CheckedMathTest, Multiply) {
+  uint64_t result = 0;
+  EXPECT_TRUE(CheckedMultiply(0x80000000ULL, 16, &result));
+  EXPECT_EQ(0x800000000ULL, result);
+  EXPECT_TRUE(CheckedMultiply(std::numeric_limits<uint64_t>::max(), 0,
+                              &result));
+  EXPECT_EQ(0U, result);
+
+  EXPECT_FALSE(CheckedMultiply(0x100000000ULL, 0x100000000ULL, &result));
+  EXPECT_EQ(0U, result);
+}
+
+TEST_F(CheckedMathTest, FitsInHostMemory) {
+  EXPECT_TRUE(FitsInHostMemory(0));
+  EXPECT_TRUE(FitsInHostMemory(
+      static_cast<uint64_t>(std::numeric_limits<std::ptrdiff_t>::max())));
+  EXPECT_FALSE(FitsInHostMemory(std::numeric_limits<uint64_t>::max()));
+}
+
+}  // namespace amber
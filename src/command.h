@@ -241,6 +241,17 @@ class DrawArraysCommand : public PipelineCommand {
   void SetInstanceCount(uint32_t count) { instance_count_ = count; }
   uint32_t GetInstanceCount() const { return instance_count_; }
 
+  /// Sets the buffer holding the draw parameters. When set, the vertex and
+  /// instance values above are ignored and the draw parameters are read
+  /// from |buffer| at |offset| bytes when the draw executes.
+  void SetIndirectBuffer(Buffer* buffer, uint32_t offset) {
+    indirect_buffer_ = buffer;
+    indirect_offset_ = offset;
+  }
+  bool IsIndirect() const { return indirect_buffer_ != nullptr; }
+  Buffer* GetIndirectBuffer() const { return indirect_buffer_; }
+  uint32_t GetIndirectOffset() const { return indirect_offset_; }
+
   std::string ToString() const override { return "DrawArraysCommand"; }
 
  private:
@@ -251,6 +262,8 @@ class DrawArraysCommand : public PipelineCommand {
   uint32_t vertex_count_ = 0;
   uint32_t first_instance_ = 0;
   uint32_t instance_count_ = 1;
+  Buffer* indirect_buffer_ = nullptr;
+  uint32_t indirect_offset_ = 0;
 };
 
 /// A command to compare two buffers.
@@ -294,12 +307,25 @@ class ComputeCommand : public PipelineCommand {
   void SetZ(uint32_t z) { z_ = z; }
   uint32_t GetZ() const { return z_; }
 
+  /// Sets the buffer holding the workgroup counts. When set, the x, y and z
+  /// values above are ignored and the counts are read from |buffer| at
+  /// |offset| bytes when the dispatch executes.
+  void SetIndirectBuffer(Buffer* buffer, uint32_t offset) {
+    indirect_buffer_ = buffer;
+    indirect_offset_ = offset;
+  }
+  bool IsIndirect() const { return indirect_buffer_ != nullptr; }
+  Buffer* GetIndirectBuffer() const { return indirect_buffer_; }
+  uint32_t GetIndirectOffset() const { return indirect_offset_; }
+
   std::string ToString() const override { return "ComputeCommand"; }
 
  private:
   uint32_t x_ = 0;
   uint32_t y_ = 0;
   uint32_t z_ = 0;
+  Buffer* indirect_buffer_ = nullptr;
+  uint32_t indirect_offset_ = 0;
 };
 
 /// Command to copy data from one buffer to another.
@@ -437,8 +463,8 @@ class ProbeSSBOCommand : public Probe {
   void SetBinding(uint32_t id) { binding_num_ = id; }
   uint32_t GetBinding() const { return binding_num_; }
 
-  void SetOffset(uint32_t offset) { offset_ = offset; }
-  uint32_t GetOffset() const { return offset_; }
+  void SetOffset(uint64_t offset) { offset_ = offset; }
+  uint64_t GetOffset() const { return offset_; }
 
   void SetFormat(Format* fmt) { format_ = fmt; }
   Format* GetFormat() const { return format_; }
@@ -452,7 +478,7 @@ class ProbeSSBOCommand : public Probe {
   Comparator comparator_ = Comparator::kEqual;
   uint32_t descriptor_set_id_ = 0;
   uint32_t binding_num_ = 0;
-  uint32_t offset_ = 0;
+  uint64_t offset_ = 0;
   Format* format_;
   std::vector<Value> values_;
 };
@@ -523,8 +549,8 @@ class BufferCommand : public BindableResourceCommand {
   void SetIsSubdata() { is_subdata_ = true; }
   bool IsSubdata() const { return is_subdata_; }
 
-  void SetOffset(uint32_t offset) { offset_ = offset; }
-  uint32_t GetOffset() const { return offset_; }
+  void SetOffset(uint64_t offset) { offset_ = offset; }
+  uint64_t GetOffset() const { return offset_; }
 
   void SetBaseMipLevel(uint32_t base_mip_level) {
     base_mip_level_ = base_mip_level;
@@ -562,7 +588,7 @@ class BufferCommand : public BindableResourceCommand {
   Sampler* sampler_ = nullptr;
   BufferType buffer_type_;
   bool is_subdata_ = false;
-  uint32_t offset_ = 0;
+  uint64_t offset_ = 0;
   uint32_t base_mip_level_ = 0;
   uint32_t dynamic_offset_ = 0;
   uint64_t descriptor_offset_ = 0;
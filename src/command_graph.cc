@@ -0,0 +1,141 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/command_graph.h"
+
+#include <algorithm>
+
+#include "src/pipeline.h"
+
+namespace amber {
+
+CommandGraph::CommandGraph() = default;
+
+CommandGraph::~CommandGraph() = default;
+
+void CommandGraph::Build(
+    const std::vector<std::unique_ptr<Command>>& commands) {
+  accesses_.assign(commands.size(), Accesses());
+  for (size_t i = 0; i < commands.size(); ++i)
+    CollectAccesses(commands[i].get(), &accesses_[i]);
+
+  dependencies_.assign(commands.size(), std::vector<size_t>());
+  std::map<const void*, LastAccess> last_access;
+  for (size_t i = 0; i < commands.size(); ++i) {
+    auto& deps = dependencies_[i];
+    for (const void* resource : accesses_[i].reads) {
+      LastAccess& last = last_access[resource];
+      if (last.has_writer)
+        deps.push_back(last.writer);
+    }
+    for (const void* resource : accesses_[i].writes) {
+      LastAccess& last = last_access[resource];
+      if (last.has_writer)
+        deps.push_back(last.writer);
+      deps.insert(deps.end(), last.readers.begin(), last.readers.end());
+    }
+
+    // A resource both read and written by the command only counts as
+    // written, which also orders it after the readers.
+    for (const void* resource : accesses_[i].reads) {
+      if (accesses_[i].writes.count(resource) == 0)
+        last_access[resource].readers.push_back(i);
+    }
+    for (const void* resource : accesses_[i].writes) {
+      LastAccess& last = last_access[resource];
+      last.has_writer = true;
+      last.writer = i;
+      last.readers.clear();
+    }
+
+    std::sort(deps.begin(), deps.end());
+    deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
+  }
+}
+
+// static
+void CommandGraph::CollectAccesses(Command* cmd, Accesses* accesses) {
+  if (cmd->IsRepeat()) {
+    for (const auto& sub_cmd : cmd->AsRepeat()->GetCommands())
+      CollectAccesses(sub_cmd.get(), accesses);
+    return;
+  }
+  if (cmd->IsProbe() || cmd->IsProbeSSBO()) {
+    accesses->reads.insert(cmd->AsProbe()->GetBuffer());
+    return;
+  }
+  if (cmd->IsCompareBuffer()) {
+    accesses->reads.insert(cmd->AsCompareBuffer()->GetBuffer1());
+    accesses->reads.insert(cmd->AsCompareBuffer()->GetBuffer2());
+    return;
+  }
+  if (cmd->IsCopy()) {
+    accesses->reads.insert(cmd->AsCopy()->GetBufferFrom());
+    accesses->writes.insert(cmd->AsCopy()->GetBufferTo());
+    return;
+  }
+
+  // Everything else is bound to a pipeline.
+  Pipeline* pipeline = static_cast<PipelineCommand*>(cmd)->GetPipeline();
+  if (pipeline)
+    accesses->writes.insert(pipeline);
+
+  if (cmd->IsBuffer()) {
+    accesses->writes.insert(cmd->AsBuffer()->GetBuffer());
+    return;
+  }
+  if (!pipeline)
+    return;
+
+  if (cmd->IsClear() || cmd->IsClearColor() || cmd->IsClearDepth() ||
+      cmd->IsClearStencil()) {
+    for (const auto& info : pipeline->GetColorAttachments())
+      accesses->writes.insert(info.buffer);
+    if (pipeline->GetDepthStencilBuffer().buffer)
+      accesses->writes.insert(pipeline->GetDepthStencilBuffer().buffer);
+    return;
+  }
+
+  if (cmd->IsCompute() && cmd->AsCompute()->IsIndirect())
+    accesses->reads.insert(cmd->AsCompute()->GetIndirectBuffer());
+  if (cmd->IsDrawArrays() && cmd->AsDrawArrays()->IsIndirect())
+    accesses->reads.insert(cmd->AsDrawArrays()->GetIndirectBuffer());
+
+  if (cmd->IsCompute() || cmd->IsDrawRect() || cmd->IsDrawGrid() ||
+      cmd->IsDrawArrays()) {
+    for (const auto& info : pipeline->GetBuffers()) {
+      if (IsReadOnlyBufferType(info.type))
+        accesses->reads.insert(info.buffer);
+      else
+        accesses->writes.insert(info.buffer);
+    }
+    if (pipeline->GetPushConstantBuffer().buffer)
+      accesses->reads.insert(pipeline->GetPushConstantBuffer().buffer);
+  }
+
+  if (cmd->IsDrawRect() || cmd->IsDrawGrid() || cmd->IsDrawArrays()) {
+    for (const auto& info : pipeline->GetColorAttachments())
+      accesses->writes.insert(info.buffer);
+    for (const auto& info : pipeline->GetResolveTargets())
+      accesses->writes.insert(info.buffer);
+    if (pipeline->GetDepthStencilBuffer().buffer)
+      accesses->writes.insert(pipeline->GetDepthStencilBuffer().buffer);
+    for (const auto& info : pipeline->GetVertexBuffers())
+      accesses->reads.insert(info.buffer);
+    if (pipeline->GetIndexBuffer())
+      accesses->reads.insert(pipeline->GetIndexBuffer());
+  }
+}
+
+}  // namespace amber
@@ -0,0 +1,82 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_COMMAND_GRAPH_H_
+#define SRC_COMMAND_GRAPH_H_
+
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "src/command.h"
+
+namespace amber {
+
+/// Read/write dependency graph over a list of commands.
+///
+/// Every command is described by the buffers it reads and writes. Commands
+/// bound to a pipeline also write the pipeline itself, as they share its
+/// state and command buffer. A command reading a resource depends on its last
+/// writer, and a command writing it on the last writer and every reader since.
+/// Only these direct edges are stored, so the graph stays linear in the number
+/// of accesses. Two commands without a path between them can run in either
+/// order or at the same time.
+class CommandGraph {
+ public:
+  CommandGraph();
+  ~CommandGraph();
+
+  /// Builds the graph for |commands|, replacing any previous graph.
+  void Build(const std::vector<std::unique_ptr<Command>>& commands);
+
+  /// Returns the number of commands in the graph.
+  size_t GetCommandCount() const { return dependencies_.size(); }
+
+  /// Returns the indices of the earlier commands which the command at |idx|
+  /// directly depends on, in increasing order.
+  const std::vector<size_t>& GetDependencies(size_t idx) const {
+    return dependencies_[idx];
+  }
+
+  /// Returns true if the command at |idx| reads or writes |resource|, a
+  /// buffer or a pipeline.
+  bool AccessesResource(size_t idx, const void* resource) const {
+    return accesses_[idx].reads.count(resource) > 0 ||
+           accesses_[idx].writes.count(resource) > 0;
+  }
+
+ private:
+  struct Accesses {
+    std::set<const void*> reads;
+    std::set<const void*> writes;
+  };
+
+  /// The commands which last accessed a resource.
+  struct LastAccess {
+    bool has_writer = false;
+    size_t writer = 0;
+    /// Readers since |writer|, or since the start without a writer.
+    std::vector<size_t> readers;
+  };
+
+  static void CollectAccesses(Command* cmd, Accesses* accesses);
+
+  std::vector<Accesses> accesses_;
+  std::vector<std::vector<size_t>> dependencies_;
+};
+
+}  // namespace amber
+
+#endif  // SRC_COMMAND_GRAPH_H_
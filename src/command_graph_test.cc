@@ -0,0 +1,190 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/command_graph.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/amberscript/parser.h"
+
+namespace amber {
+namespace {
+
+const char kPipelines[] = R"(
+SHADER compute shader GLSL
+# shader
+END
+
+BUFFER buf_a DATA_TYPE uint32 SIZE 4 FILL 0
+BUFFER buf_b DATA_TYPE uint32 SIZE 4 FILL 0
+BUFFER buf_c DATA_TYPE uint32 SIZE 4 FILL 0
+
+PIPELINE compute pipeline_a
+  ATTACH shader
+  BIND BUFFER buf_a AS storage DESCRIPTOR_SET 0 BINDING 0
+END
+
+PIPELINE compute pipeline_b
+  ATTACH shader
+  BIND BUFFER buf_b AS storage DESCRIPTOR_SET 0 BINDING 0
+  BIND BUFFER buf_c AS uniform DESCRIPTOR_SET 0 BINDING 1
+END
+
+PIPELINE compute pipeline_c
+  ATTACH shader
+  BIND BUFFER buf_c AS uniform DESCRIPTOR_SET 0 BINDING 0
+END
+)";
+
+}  // namespace
+
+using CommandGraphTest = testing::Test;
+
+TEST_F(CommandGraphTest, IndependentPipelines) {
+  std::string in = std::string(kPipelines) + R"(
+RUN pipeline_a 1 1 1
+RUN pipeline_b 1 1 1
+)";
+
+  amberscript::Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+
+  CommandGraph graph;
+  graph.Build(parser.GetScript()->GetCommands());
+  ASSERT_EQ(2U, graph.GetCommandCount());
+  EXPECT_TRUE(graph.GetDependencies(0).empty());
+  EXPECT_TRUE(graph.GetDependencies(1).empty());
+}
+
+TEST_F(CommandGraphTest, SamePipeline) {
+  std::string in = std::string(kPipelines) + R"(
+RUN pipeline_a 1 1 1
+RUN pipeline_a 2 2 2
+)";
+
+  amberscript::Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+
+  CommandGraph graph;
+  graph.Build(parser.GetScript()->GetCommands());
+  ASSERT_EQ(2U, graph.GetCommandCount());
+  EXPECT_EQ(std::vector<size_t>({0}), graph.GetDependencies(1));
+}
+
+TEST_F(CommandGraphTest, SharedReadOnlyBuffer) {
+  std::string in = std::string(kPipelines) + R"(
+RUN pipeline_b 1 1 1
+RUN pipeline_c 1 1 1
+)";
+
+  amberscript::Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+
+  CommandGraph graph;
+  graph.Build(parser.GetScript()->GetCommands());
+  ASSERT_EQ(2U, graph.GetCommandCount());
+  EXPECT_TRUE(graph.GetDependencies(1).empty());
+}
+
+TEST_F(CommandGraphTest, ProbeAndCopy) {
+  std::string in = std::string(kPipelines) + R"(
+RUN pipeline_a 1 1 1
+RUN pipeline_b 1 1 1
+EXPECT buf_a IDX 0 EQ 0
+COPY buf_b TO buf_c
+RUN pipeline_c 1 1 1
+)";
+
+  amberscript::Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+
+  CommandGraph graph;
+  graph.Build(parser.GetScript()->GetCommands());
+  ASSERT_EQ(5U, graph.GetCommandCount());
+  EXPECT_EQ(std::vector<size_t>({0}), graph.GetDependencies(2));
+  EXPECT_EQ(std::vector<size_t>({1}), graph.GetDependencies(3));
+  EXPECT_EQ(std::vector<size_t>({3}), graph.GetDependencies(4));
+}
+
+TEST_F(CommandGraphTest, OnlyDirectDependencies) {
+  std::string in = std::string(kPipelines) + R"(
+RUN pipeline_a 1 1 1
+RUN pipeline_a 1 1 1
+EXPECT buf_a IDX 0 EQ 0
+EXPECT buf_a IDX 0 EQ 0
+RUN pipeline_a 1 1 1
+)";
+
+  amberscript::Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+
+  CommandGraph graph;
+  graph.Build(parser.GetScript()->GetCommands());
+  ASSERT_EQ(5U, graph.GetCommandCount());
+  EXPECT_EQ(std::vector<size_t>({0}), graph.GetDependencies(1));
+  EXPECT_EQ(std::vector<size_t>({1}), graph.GetDependencies(2));
+  EXPECT_EQ(std::vector<size_t>({1}), graph.GetDependencies(3));
+  EXPECT_EQ(std::vector<size_t>({1, 2, 3}), graph.GetDependencies(4));
+}
+
+TEST_F(CommandGraphTest, Repeat) {
+  std::string in = std::string(kPipelines) + R"(
+REPEAT 2
+  RUN pipeline_a 1 1 1
+END
+RUN pipeline_b 1 1 1
+EXPECT buf_a IDX 0 EQ 0
+)";
+
+  amberscript::Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+
+  CommandGraph graph;
+  graph.Build(parser.GetScript()->GetCommands());
+  ASSERT_EQ(3U, graph.GetCommandCount());
+  EXPECT_TRUE(graph.GetDependencies(1).empty());
+  EXPECT_EQ(std::vector<size_t>({0}), graph.GetDependencies(2));
+}
+
+TEST_F(CommandGraphTest, AccessesResource) {
+  std::string in = std::string(kPipelines) + R"(
+RUN pipeline_b 1 1 1
+EXPECT buf_a IDX 0 EQ 0
+)";
+
+  amberscript::Parser parser;
+  Result r = parser.Parse(in);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+
+  auto script = parser.GetScript();
+  CommandGraph graph;
+  graph.Build(script->GetCommands());
+  ASSERT_EQ(2U, graph.GetCommandCount());
+  EXPECT_TRUE(graph.AccessesResource(0, script->GetBuffer("buf_b")));
+  EXPECT_TRUE(graph.AccessesResource(0, script->GetBuffer("buf_c")));
+  EXPECT_TRUE(graph.AccessesResource(0, script->GetPipeline("pipeline_b")));
+  EXPECT_FALSE(graph.AccessesResource(0, script->GetBuffer("buf_a")));
+  EXPECT_TRUE(graph.AccessesResource(1, script->GetBuffer("buf_a")));
+  EXPECT_FALSE(graph.AccessesResource(1, script->GetBuffer("buf_b")));
+}
+
+}  // namespace amber
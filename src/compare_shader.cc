@@ -0,0 +1,127 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/compare_shader.h"
+
+#include "src/probe_shader.h"
+
+namespace amber {
+namespace {
+
+// Each work group first accumulates the histograms in shared memory and then
+// adds the non zero bins to the result, which keeps the contention on the
+// global atomics low.
+const char kCompareShader[] = R"(#version 450
+
+layout(local_size_x = 64) in;
+
+layout(set = 0, binding = 0, std430) readonly buffer Buffer1 {
+  uint words1[];
+};
+
+layout(set = 0, binding = 1, std430) readonly buffer Buffer2 {
+  uint words2[];
+};
+
+layout(set = 0, binding = 2, std430) buffer CompareResult {
+  uint num_different;
+  uint first_different_index;
+  uint histograms[2048];
+};
+
+layout(push_constant) uniform Params {
+  uint byte_count;
+  uint element_count;
+  uint compute_histograms;
+};
+
+shared uint local_histograms[2048];
+
+void main() {
+  uint index = gl_GlobalInvocationID.y * gl_NumWorkGroups.x * 64u +
+               gl_GlobalInvocationID.x;
+
+  if (compute_histograms != 0u) {
+    for (uint i = gl_LocalInvocationIndex; i < 2048u; i += 64u)
+      local_histograms[i] = 0u;
+    barrier();
+  }
+
+  if (index < byte_count / 4u) {
+    uint word1 = words1[index];
+    uint word2 = words2[index];
+
+    uint difference = word1 ^ word2;
+    uint count = 0u;
+    uint first = 4u;
+    for (uint b = 0u; b < 4u; ++b) {
+      if (((difference >> (8u * b)) & 255u) != 0u) {
+        count += 1u;
+        first = min(first, b);
+      }
+    }
+    if (count != 0u) {
+      atomicAdd(num_different, count);
+      atomicMin(first_different_index, index * 4u + first);
+    }
+
+    if (compute_histograms != 0u && index < element_count) {
+      for (uint c = 0u; c < 4u; ++c) {
+        atomicAdd(local_histograms[c * 256u + ((word1 >> (8u * c)) & 255u)],
+                  1u);
+        atomicAdd(
+            local_histograms[1024u + c * 256u + ((word2 >> (8u * c)) & 255u)],
+            1u);
+      }
+    }
+  }
+
+  if (compute_histograms != 0u) {
+    barrier();
+    for (uint i = gl_LocalInvocationIndex; i < 2048u; i += 64u) {
+      if (local_histograms[i] != 0u)
+        atomicAdd(histograms[i], local_histograms[i]);
+    }
+  }
+}
+)";
+
+}  // namespace
+
+bool IsCompareShaderSupported(const Buffer& buffer1, const Buffer& buffer2) {
+  const size_t size = buffer1.ValuePtr()->size();
+  return size > 0 && size % 4 == 0 && size <= 0xffffffff &&
+         size == buffer2.ValuePtr()->size();
+}
+
+std::string GenerateCompareShader() {
+  return kCompareShader;
+}
+
+CompareShaderParams GetCompareShaderParams(const Buffer& buffer,
+                                           bool compute_histograms) {
+  CompareShaderParams params;
+  params.byte_count = static_cast<uint32_t>(buffer.ValuePtr()->size());
+  params.element_count = static_cast<uint32_t>(buffer.ElementCount());
+  params.compute_histograms = compute_histograms ? 1 : 0;
+  return params;
+}
+
+void GetCompareShaderGroupCount(const CompareShaderParams& params,
+                                uint32_t* x,
+                                uint32_t* y) {
+  GetShaderGroupCount(params.byte_count / 4, x, y);
+}
+
+}  // namespace amber
@@ -0,0 +1,78 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_COMPARE_SHADER_H_
+#define SRC_COMPARE_SHADER_H_
+
+#include <cstdint>
+#include <string>
+
+#include "src/buffer.h"
+
+namespace amber {
+
+/// Number of histogram bins for each channel computed by the compare shader.
+const uint32_t kCompareShaderHistogramBins = 256;
+/// Number of channels of the histograms computed by the compare shader.
+const uint32_t kCompareShaderHistogramChannels = 4;
+
+/// Push constant block of the compare shader. The layout matches the block
+/// declared by GenerateCompareShader.
+struct CompareShaderParams {
+  /// Number of bytes to compare. It is a multiple of 4.
+  uint32_t byte_count;
+  /// Number of 32 bit elements to add to the histograms.
+  uint32_t element_count;
+  uint32_t compute_histograms;
+};
+
+/// Storage block written by the compare shader. It must be zero initialized
+/// except for |first_different_index| which must be 0xffffffff.
+struct CompareShaderResult {
+  /// Number of bytes which differ between the two buffers.
+  uint32_t num_different;
+  /// Index of the first byte which differs.
+  uint32_t first_different_index;
+  /// Per channel histograms of the first and second buffer, filled only if
+  /// |compute_histograms| is set in the CompareShaderParams.
+  uint32_t histograms[2][kCompareShaderHistogramChannels]
+                     [kCompareShaderHistogramBins];
+};
+
+/// Returns true if the contents of |buffer1| and |buffer2| can be compared
+/// by the compare shader. Both must hold the same, non zero, number of bytes
+/// which fill whole 32 bit words.
+bool IsCompareShaderSupported(const Buffer& buffer1, const Buffer& buffer2);
+
+/// Generates the GLSL source of a compute shader which compares two buffers
+/// bound as storage buffers 0 and 1 of descriptor set 0 and writes a
+/// CompareShaderResult to binding 2. Each invocation compares one 32 bit
+/// word. The histograms assume four 8 bit channels per 32 bit element, the
+/// only layout supported by Buffer::CompareHistogramEMD.
+std::string GenerateCompareShader();
+
+/// Returns the parameters to compare |buffer| against a buffer of the same
+/// size. The histograms are computed only if |compute_histograms| is true.
+CompareShaderParams GetCompareShaderParams(const Buffer& buffer,
+                                           bool compute_histograms);
+
+/// Returns in |x| and |y| the number of work groups to dispatch so every
+/// word described by |params| gets an invocation.
+void GetCompareShaderGroupCount(const CompareShaderParams& params,
+                                uint32_t* x,
+                                uint32_t* y);
+
+}  // namespace amber
+
+#endif  // SRC_COMPARE_SHADER_H_
@@ -0,0 +1,93 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/compare_shader.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/type_parser.h"
+
+namespace amber {
+
+using CompareShaderTest = testing::Test;
+
+TEST_F(CompareShaderTest, Supported) {
+  TypeParser parser;
+  auto rgba8 = parser.Parse("R8G8B8A8_UNORM");
+  Format rgba8_fmt(rgba8.get());
+  auto r8 = parser.Parse("R8_UNORM");
+  Format r8_fmt(r8.get());
+
+  Buffer b1;
+  b1.SetFormat(&rgba8_fmt);
+  b1.SetData(std::vector<Value>(8));
+
+  Buffer b2;
+  b2.SetFormat(&rgba8_fmt);
+  b2.SetData(std::vector<Value>(8));
+  EXPECT_TRUE(IsCompareShaderSupported(b1, b2));
+
+  Buffer empty;
+  empty.SetFormat(&rgba8_fmt);
+  EXPECT_FALSE(IsCompareShaderSupported(empty, empty));
+
+  Buffer bigger;
+  bigger.SetFormat(&rgba8_fmt);
+  bigger.SetData(std::vector<Value>(12));
+  EXPECT_FALSE(IsCompareShaderSupported(b1, bigger));
+
+  // Three bytes do not fill a word.
+  Buffer odd1;
+  odd1.SetFormat(&r8_fmt);
+  odd1.SetData(std::vector<Value>(3));
+  Buffer odd2;
+  odd2.SetFormat(&r8_fmt);
+  odd2.SetData(std::vector<Value>(3));
+  EXPECT_FALSE(IsCompareShaderSupported(odd1, odd2));
+}
+
+TEST_F(CompareShaderTest, Generate) {
+  std::string src = GenerateCompareShader();
+  EXPECT_NE(std::string::npos, src.find("#version 450"));
+  EXPECT_NE(std::string::npos, src.find("atomicMin(first_different_index"));
+  EXPECT_NE(std::string::npos, src.find("shared uint local_histograms[2048]"));
+}
+
+TEST_F(CompareShaderTest, Params) {
+  TypeParser parser;
+  auto type = parser.Parse("R8G8B8A8_UNORM");
+  Format fmt(type.get());
+
+  Buffer b;
+  b.SetFormat(&fmt);
+  b.SetData(std::vector<Value>(40));
+
+  CompareShaderParams params = GetCompareShaderParams(b, true);
+  EXPECT_EQ(40U, params.byte_count);
+  EXPECT_EQ(10U, params.element_count);
+  EXPECT_EQ(1U, params.compute_histograms);
+
+  uint32_t x = 0;
+  uint32_t y = 0;
+  GetCompareShaderGroupCount(params, &x, &y);
+  EXPECT_EQ(1U, x);
+  EXPECT_EQ(1U, y);
+
+  params = GetCompareShaderParams(b, false);
+  EXPECT_EQ(0U, params.compute_histograms);
+}
+
+}  // namespace amber
@@ -0,0 +1,529 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/compile_server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#include "src/pipeline.h"
+#include "src/platform.h"
+#include "src/shader.h"
+#include "src/shader_compiler.h"
+
+#if AMBER_PLATFORM_POSIX
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif  // AMBER_PLATFORM_POSIX
+
+namespace amber {
+namespace {
+
+// Bumped whenever the layout of the messages changes, so a server and a
+// client of different versions do not misread each other.
+const uint32_t kProtocolVersion = 1;
+// Requests and replies larger than this are treated as malformed.
+const uint32_t kMaxMessageSize = 256U * 1024U * 1024U;
+// A client waits this long for the server to take its request and compile
+// it before compiling in its own process.
+const int kClientTimeoutSeconds = 60;
+// A worker waits this long for a client to send its request or take its
+// reply, so a stuck client does not hold up the pool.
+const int kServerTimeoutSeconds = 10;
+// Number of replies kept in the server cache.
+const size_t kMaxCacheEntries = 1024;
+
+void WriteUint32(uint32_t value, std::string* out) {
+  char bytes[sizeof(value)];
+  std::memcpy(bytes, &value, sizeof(value));
+  out->append(bytes, sizeof(value));
+}
+
+void WriteString(const std::string& value, std::string* out) {
+  WriteUint32(static_cast<uint32_t>(value.size()), out);
+  out->append(value);
+}
+
+// Reads the fields of a message in order. Reading past the end fails and
+// leaves the reader failed.
+class MessageReader {
+ public:
+  explicit MessageReader(const std::string& data) : data_(data) {}
+
+  bool ReadUint32(uint32_t* value) {
+    if (failed_ || data_.size() - pos_ < sizeof(*value)) {
+      failed_ = true;
+      return false;
+    }
+    std::memcpy(value, data_.data() + pos_, sizeof(*value));
+    pos_ += sizeof(*value);
+    return true;
+  }
+
+  bool ReadString(std::string* value) {
+    uint32_t size = 0;
+    if (!ReadUint32(&size) || data_.size() - pos_ < size) {
+      failed_ = true;
+      return false;
+    }
+    value->assign(data_, pos_, size);
+    pos_ += size;
+    return true;
+  }
+
+  /// Returns true if every read succeeded and the whole message was read.
+  bool IsDone() const { return !failed_ && pos_ == data_.size(); }
+
+ private:
+  const std::string& data_;
+  size_t pos_ = 0;
+  bool failed_ = false;
+};
+
+// Serializes the fields of |request| which decide the compile output.
+std::string SerializeCompileInputs(const CompileRequest& request) {
+  std::string out;
+  WriteUint32(static_cast<uint32_t>(request.type), &out);
+  WriteUint32(static_cast<uint32_t>(request.format), &out);
+  WriteString(request.spv_env, &out);
+  WriteUint32(request.disable_spirv_validation ? 1U : 0U, &out);
+  WriteUint32(static_cast<uint32_t>(request.optimizations.size()), &out);
+  for (const auto& optimization : request.optimizations)
+    WriteString(optimization, &out);
+  WriteString(request.data, &out);
+  return out;
+}
+
+std::string SerializeRequest(const CompileRequest& request) {
+  std::string out;
+  WriteUint32(kProtocolVersion, &out);
+  out += SerializeCompileInputs(request);
+  WriteString(request.file_path, &out);
+  return out;
+}
+
+// Returns the key of the reply to |request| in the server cache, which is
+// the serialized inputs themselves so different requests never share a
+// reply. The file path only matters to HLSL, whose includes are found next
+// to the file.
+std::string GetCacheKey(const CompileRequest& request) {
+  std::string inputs = SerializeCompileInputs(request);
+  if (request.format == kShaderFormatHlsl)
+    WriteString(request.file_path, &inputs);
+  return inputs;
+}
+
+bool DeserializeRequest(const std::string& data, CompileRequest* request) {
+  MessageReader reader(data);
+  uint32_t version = 0;
+  uint32_t type = 0;
+  uint32_t format = 0;
+  uint32_t disable_validation = 0;
+  uint32_t optimization_count = 0;
+  if (!reader.ReadUint32(&version) || version != kProtocolVersion ||
+      !reader.ReadUint32(&type) || !reader.ReadUint32(&format) ||
+      !reader.ReadString(&request->spv_env) ||
+      !reader.ReadUint32(&disable_validation) ||
+      !reader.ReadUint32(&optimization_count)) {
+    return false;
+  }
+  request->type = static_cast<ShaderType>(type);
+  request->format = static_cast<ShaderFormat>(format);
+  request->disable_spirv_validation = disable_validation != 0;
+
+  request->optimizations.clear();
+  for (uint32_t i = 0; i < optimization_count; ++i) {
+    std::string optimization;
+    if (!reader.ReadString(&optimization))
+      return false;
+    request->optimizations.push_back(std::move(optimization));
+  }
+  return reader.ReadString(&request->data) &&
+         reader.ReadString(&request->file_path) && reader.IsDone();
+}
+
+std::string SerializeResponse(const CompileResponse& response) {
+  std::string out;
+  WriteUint32(response.result.IsSuccess() ? 1U : 0U, &out);
+  WriteString(response.result.IsSuccess() ? "" : response.result.Error(),
+              &out);
+  WriteUint32(static_cast<uint32_t>(response.spirv.size()), &out);
+  for (uint32_t word : response.spirv)
+    WriteUint32(word, &out);
+  return out;
+}
+
+bool DeserializeResponse(const std::string& data, CompileResponse* response) {
+  MessageReader reader(data);
+  uint32_t success = 0;
+  std::string error;
+  uint32_t word_count = 0;
+  if (!reader.ReadUint32(&success) || !reader.ReadString(&error) ||
+      !reader.ReadUint32(&word_count) ||
+      word_count > data.size() / sizeof(uint32_t)) {
+    return false;
+  }
+
+  std::vector<uint32_t> spirv(word_count);
+  for (auto& word : spirv) {
+    if (!reader.ReadUint32(&word))
+      return false;
+  }
+  if (!reader.IsDone())
+    return false;
+
+  response->result = success ? Result() : Result(error);
+  response->spirv = std::move(spirv);
+  return true;
+}
+
+#if AMBER_PLATFORM_POSIX
+
+bool SendAll(int fd, const char* data, size_t size) {
+#if defined(MSG_NOSIGNAL)
+  // A peer which went away must not raise SIGPIPE in this process.
+  const int flags = MSG_NOSIGNAL;
+#else
+  const int flags = 0;
+#endif
+  while (size > 0) {
+    ssize_t sent = send(fd, data, size, flags);
+    if (sent < 0 && errno == EINTR)
+      continue;
+    if (sent <= 0)
+      return false;
+    data += sent;
+    size -= static_cast<size_t>(sent);
+  }
+  return true;
+}
+
+bool ReceiveAll(int fd, char* data, size_t size) {
+  while (size > 0) {
+    ssize_t received = recv(fd, data, size, 0);
+    if (received < 0 && errno == EINTR)
+      continue;
+    if (received <= 0)
+      return false;
+    data += received;
+    size -= static_cast<size_t>(received);
+  }
+  return true;
+}
+
+// Messages are sent as their size followed by their bytes.
+bool SendMessage(int fd, const std::string& message) {
+  std::string size;
+  WriteUint32(static_cast<uint32_t>(message.size()), &size);
+  return SendAll(fd, size.data(), size.size()) &&
+         SendAll(fd, message.data(), message.size());
+}
+
+bool ReceiveMessage(int fd, std::string* message) {
+  uint32_t size = 0;
+  if (!ReceiveAll(fd, reinterpret_cast<char*>(&size), sizeof(size)) ||
+      size > kMaxMessageSize) {
+    return false;
+  }
+  message->resize(size);
+  return size == 0 || ReceiveAll(fd, &(*message)[0], size);
+}
+
+// Fills |addr| for |socket_path|. Returns false if the path is too long.
+bool MakeAddress(const std::string& socket_path, sockaddr_un* addr) {
+  std::memset(addr, 0, sizeof(*addr));
+  addr->sun_family = AF_UNIX;
+  if (socket_path.empty() || socket_path.size() >= sizeof(addr->sun_path))
+    return false;
+  std::memcpy(addr->sun_path, socket_path.c_str(), socket_path.size());
+  return true;
+}
+
+// Makes sends and receives on |fd| fail after |seconds| without progress.
+void SetTimeout(int fd, int seconds) {
+  timeval timeout;
+  timeout.tv_sec = seconds;
+  timeout.tv_usec = 0;
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+// Returns a socket connected to |socket_path|, or -1.
+int Connect(const std::string& socket_path) {
+  sockaddr_un addr;
+  if (!MakeAddress(socket_path, &addr))
+    return -1;
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    return -1;
+#if defined(SO_NOSIGPIPE)
+  int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+#endif  // AMBER_PLATFORM_POSIX
+
+}  // namespace
+
+CompileRequest::CompileRequest() = default;
+
+CompileRequest::CompileRequest(const CompileRequest&) = default;
+
+CompileRequest::~CompileRequest() = default;
+
+CompileResponse::CompileResponse() = default;
+
+CompileResponse::~CompileResponse() = default;
+
+CompileResponse CompileInProcess(const CompileRequest& request) {
+  Shader shader(request.type);
+  shader.SetName("amber_compile_server_shader");
+  shader.SetFormat(request.format);
+  shader.SetData(request.data);
+  shader.SetFilePath(request.file_path);
+
+  Pipeline pipeline(request.type == kShaderTypeCompute
+                        ? PipelineType::kCompute
+                        : PipelineType::kGraphics);
+  Pipeline::ShaderInfo shader_info(&shader, request.type);
+  shader_info.SetShaderOptimizations(request.optimizations);
+
+  ShaderCompiler sc(request.spv_env, request.disable_spirv_validation,
+                    nullptr);
+  CompileResponse response;
+  std::tie(response.result, response.spirv) =
+      sc.Compile(&pipeline, &shader_info, ShaderMap());
+  return response;
+}
+
+#if AMBER_PLATFORM_POSIX
+
+Result SendCompileRequest(const std::string& socket_path,
+                          const CompileRequest& request,
+                          CompileResponse* response) {
+  int fd = Connect(socket_path);
+  if (fd < 0)
+    return Result("Unable to connect to compile server: " + socket_path);
+  SetTimeout(fd, kClientTimeoutSeconds);
+
+  std::string reply;
+  bool ok = SendMessage(fd, SerializeRequest(request)) &&
+            ReceiveMessage(fd, &reply);
+  close(fd);
+
+  CompileResponse received;
+  if (!ok || !DeserializeResponse(reply, &received))
+    return Result("Compile server did not reply: " + socket_path);
+
+  *response = std::move(received);
+  return {};
+}
+
+CompileServer::CompileServer() = default;
+
+CompileServer::~CompileServer() {
+  if (listen_fd_ < 0)
+    return;
+
+  close(listen_fd_);
+  unlink(socket_path_.c_str());
+}
+
+Result CompileServer::Listen(const std::string& socket_path) {
+  sockaddr_un addr;
+  if (!MakeAddress(socket_path, &addr))
+    return Result("Invalid compile server socket path: " + socket_path);
+
+  int existing = Connect(socket_path);
+  if (existing >= 0) {
+    close(existing);
+    return Result("A compile server is already listening on " + socket_path);
+  }
+  // Nothing answers on the path, so any socket there is stale. Anything else
+  // at the path is left alone.
+  struct stat st;
+  if (lstat(socket_path.c_str(), &st) == 0) {
+    if (!S_ISSOCK(st.st_mode)) {
+      return Result("Compile server socket path exists and is not a socket: " +
+                    socket_path);
+    }
+    unlink(socket_path.c_str());
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    return Result("Unable to create compile server socket");
+  if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+      listen(fd, SOMAXCONN) != 0) {
+    close(fd);
+    return Result("Unable to listen on " + socket_path + ": " +
+                  std::strerror(errno));
+  }
+
+  socket_path_ = socket_path;
+  listen_fd_ = fd;
+  return {};
+}
+
+void CompileServer::Serve() {
+  uint32_t thread_count = std::max(1U, std::thread::hardware_concurrency());
+  for (uint32_t i = 0; i < thread_count; ++i)
+    threads_.emplace_back(&CompileServer::WorkerLoop, this);
+
+  for (;;) {
+    int fd = accept(listen_fd_, nullptr, nullptr);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopping_) {
+        if (fd >= 0)
+          close(fd);
+        break;
+      }
+      if (fd < 0 && (errno == EINTR || errno == ECONNABORTED))
+        continue;
+      if (fd < 0) {
+        stopping_ = true;
+        break;
+      }
+      connections_.push_back(fd);
+    }
+    work_cv_.notify_one();
+  }
+
+  // The workers serve the connections left in the queue before they exit.
+  work_cv_.notify_all();
+  for (auto& thread : threads_)
+    thread.join();
+  threads_.clear();
+}
+
+void CompileServer::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  // Wake up the accept call in Serve.
+  int fd = Connect(socket_path_);
+  if (fd >= 0)
+    close(fd);
+}
+
+void CompileServer::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    work_cv_.wait(lock,
+                  [this]() { return stopping_ || !connections_.empty(); });
+    if (connections_.empty())
+      return;
+
+    int fd = connections_.front();
+    connections_.pop_front();
+
+    lock.unlock();
+    HandleConnection(fd);
+    lock.lock();
+  }
+}
+
+void CompileServer::HandleConnection(int fd) {
+  SetTimeout(fd, kServerTimeoutSeconds);
+
+  std::string message;
+  CompileRequest request;
+  if (ReceiveMessage(fd, &message) && DeserializeRequest(message, &request)) {
+    const std::string key = GetCacheKey(request);
+    std::string reply;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = cache_.find(key);
+      if (it != cache_.end()) {
+        reply = it->second.reply;
+        it->second.last_use = ++cache_uses_;
+        ++cache_hit_count_;
+      }
+    }
+
+    if (reply.empty()) {
+      // Compile outside of the lock, so other requests are not held up.
+      reply = SerializeResponse(CompileInProcess(request));
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (cache_.size() >= kMaxCacheEntries && cache_.count(key) == 0) {
+        auto oldest = cache_.begin();
+        for (auto it = cache_.begin(); it != cache_.end(); ++it) {
+          if (it->second.last_use < oldest->second.last_use)
+            oldest = it;
+        }
+        cache_.erase(oldest);
+      }
+      CacheEntry& entry = cache_[key];
+      entry.reply = reply;
+      entry.last_use = ++cache_uses_;
+      ++compile_count_;
+    }
+    SendMessage(fd, reply);
+  }
+  close(fd);
+}
+
+#else  // AMBER_PLATFORM_POSIX
+
+Result SendCompileRequest(const std::string&,
+                          const CompileRequest&,
+                          CompileResponse*) {
+  return Result("Compile server is not supported on this platform");
+}
+
+CompileServer::CompileServer() = default;
+
+CompileServer::~CompileServer() = default;
+
+Result CompileServer::Listen(const std::string&) {
+  return Result("Compile server is not supported on this platform");
+}
+
+void CompileServer::Serve() {}
+
+void CompileServer::Stop() {}
+
+void CompileServer::WorkerLoop() {}
+
+void CompileServer::HandleConnection(int) {}
+
+#endif  // AMBER_PLATFORM_POSIX
+
+uint64_t CompileServer::GetCompileCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return compile_count_;
+}
+
+uint64_t CompileServer::GetCacheHitCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cache_hit_count_;
+}
+
+}  // namespace amber
@@ -0,0 +1,130 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_COMPILE_SERVER_H_
+#define SRC_COMPILE_SERVER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "amber/result.h"
+#include "amber/shader_info.h"
+
+namespace amber {
+
+/// Everything needed to compile one shader outside of a script.
+struct CompileRequest {
+  CompileRequest();
+  CompileRequest(const CompileRequest&);
+  ~CompileRequest();
+
+  ShaderType type = kShaderTypeCompute;
+  ShaderFormat format = kShaderFormatDefault;
+  std::string spv_env;
+  bool disable_spirv_validation = false;
+  std::vector<std::string> optimizations;
+  std::string data;
+  std::string file_path;
+};
+
+/// The outcome of a CompileRequest.
+struct CompileResponse {
+  CompileResponse();
+  ~CompileResponse();
+
+  Result result;
+  std::vector<uint32_t> spirv;
+};
+
+/// Compiles |request| in this process with a ShaderCompiler.
+CompileResponse CompileInProcess(const CompileRequest& request);
+
+/// Sends |request| to the compile server listening on the Unix domain
+/// socket |socket_path| and stores its reply in |response|. Returns a
+/// failure, without touching |response|, if the server cannot be reached or
+/// does not reply in time, so the caller can compile in process instead. A
+/// failed compile is reported in |response|.
+Result SendCompileRequest(const std::string& socket_path,
+                          const CompileRequest& request,
+                          CompileResponse* response);
+
+/// Compiles shaders for other processes, which connect through a Unix
+/// domain socket and send one CompileRequest per connection.
+///
+/// The server lives as long as the processes using it, so the compilers are
+/// only initialized once. Connections are served by a fixed pool of worker
+/// threads, so requests from several processes compile at the same time.
+/// The most recently used replies are kept in a cache keyed by the shader
+/// source and compile options, so a shader compiled by one process is not
+/// compiled again for the next.
+///
+/// Unix domain sockets are not supported on Windows, where Listen fails.
+class CompileServer {
+ public:
+  CompileServer();
+  /// Stops the server and removes the socket.
+  ~CompileServer();
+
+  /// Starts listening on |socket_path|. A stale socket left by a server
+  /// which is gone is replaced. Fails if another server is listening or if
+  /// the path exists and is not a socket.
+  Result Listen(const std::string& socket_path);
+
+  /// Accepts and serves connections until Stop is called. Returns once all
+  /// accepted connections are served.
+  void Serve();
+
+  /// Makes Serve return. Can be called from any thread.
+  void Stop();
+
+  /// Returns the number of requests which were compiled.
+  uint64_t GetCompileCount() const;
+  /// Returns the number of requests which were answered from the cache.
+  uint64_t GetCacheHitCount() const;
+
+ private:
+  struct CacheEntry {
+    std::string reply;
+    uint64_t last_use = 0;
+  };
+
+  void WorkerLoop();
+  void HandleConnection(int fd);
+
+  std::string socket_path_;
+  int listen_fd_ = -1;
+  bool stopping_ = false;
+
+  mutable std::mutex mutex_;
+  std::condition_variable work_cv_;
+  /// Accepted connections which no worker picked up yet.
+  std::deque<int> connections_;
+  std::vector<std::thread> threads_;
+  /// Serialized replies, keyed by the serialized shader source and compile
+  /// options of the request.
+  std::map<std::string, CacheEntry> cache_;
+  uint64_t cache_uses_ = 0;
+  uint64_t compile_count_ = 0;
+  uint64_t cache_hit_count_ = 0;
+};
+
+}  // namespace amber
+
+#endif  // SRC_COMPILE_SERVER_H_
@@ -0,0 +1,162 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/compile_server.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/pipeline.h"
+#include "src/platform.h"
+#include "src/shader.h"
+#include "src/shader_compiler.h"
+
+namespace amber {
+namespace {
+
+// Validation is disabled in the tests, so the header alone is enough.
+const char kHexShader[] =
+    "0x03 0x02 0x23 0x07 0x00 0x00 0x01 0x00 0x00 0x00 0x00 0x00 "
+    "0x01 0x00 0x00 0x00 0x00 0x00 0x00 0x00";
+
+const std::vector<uint32_t> kHexShaderWords = {0x07230203, 0x00010000, 0, 1,
+                                               0};
+
+CompileRequest HexRequest() {
+  CompileRequest request;
+  request.format = kShaderFormatSpirvHex;
+  request.disable_spirv_validation = true;
+  request.data = kHexShader;
+  return request;
+}
+
+// Compiles kHexShader with a ShaderCompiler using |socket_path|.
+std::pair<Result, std::vector<uint32_t>> CompileHex(
+    const std::string& socket_path) {
+  Shader shader(kShaderTypeCompute);
+  shader.SetName("shader");
+  shader.SetFormat(kShaderFormatSpirvHex);
+  shader.SetData(kHexShader);
+
+  Pipeline pipeline(PipelineType::kCompute);
+  Pipeline::ShaderInfo shader_info(&shader, kShaderTypeCompute);
+
+  ShaderCompiler sc("", true, nullptr);
+  sc.SetCompileServer(socket_path);
+  return sc.Compile(&pipeline, &shader_info, ShaderMap());
+}
+
+}  // namespace
+
+using CompileServerTest = testing::Test;
+
+TEST_F(CompileServerTest, CompileInProcess) {
+  CompileResponse response = CompileInProcess(HexRequest());
+  ASSERT_TRUE(response.result.IsSuccess()) << response.result.Error();
+  EXPECT_EQ(kHexShaderWords, response.spirv);
+}
+
+TEST_F(CompileServerTest, CompileInProcessFailure) {
+  CompileRequest request = HexRequest();
+  request.format = kShaderFormatText;
+  CompileResponse response = CompileInProcess(request);
+  ASSERT_FALSE(response.result.IsSuccess());
+  EXPECT_EQ("Invalid shader format", response.result.Error());
+}
+
+TEST_F(CompileServerTest, FallsBackWithoutServer) {
+  Result r;
+  std::vector<uint32_t> spirv;
+  std::tie(r, spirv) =
+      CompileHex(testing::TempDir() + "amber_no_compile_server");
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+  EXPECT_EQ(kHexShaderWords, spirv);
+}
+
+#if AMBER_PLATFORM_POSIX
+TEST_F(CompileServerTest, CompilesAndCachesOnServer) {
+  const std::string socket_path =
+      testing::TempDir() + "amber_compile_server_test";
+  CompileServer server;
+  Result r = server.Listen(socket_path);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+  std::thread thread(&CompileServer::Serve, &server);
+
+  std::vector<uint32_t> spirv;
+  std::tie(r, spirv) = CompileHex(socket_path);
+  EXPECT_TRUE(r.IsSuccess()) << r.Error();
+  EXPECT_EQ(kHexShaderWords, spirv);
+
+  CompileResponse response;
+  r = SendCompileRequest(socket_path, HexRequest(), &response);
+  EXPECT_TRUE(r.IsSuccess()) << r.Error();
+  EXPECT_TRUE(response.result.IsSuccess()) << response.result.Error();
+  EXPECT_EQ(kHexShaderWords, response.spirv);
+
+  CompileRequest request = HexRequest();
+  request.format = kShaderFormatText;
+  r = SendCompileRequest(socket_path, request, &response);
+  EXPECT_TRUE(r.IsSuccess()) << r.Error();
+  ASSERT_FALSE(response.result.IsSuccess());
+  EXPECT_EQ("Invalid shader format", response.result.Error());
+
+  // The file path does not change the output, so the cached reply is used.
+  CompileRequest moved = HexRequest();
+  moved.file_path = "other.spvasm";
+  r = SendCompileRequest(socket_path, moved, &response);
+  EXPECT_TRUE(r.IsSuccess()) << r.Error();
+  EXPECT_TRUE(response.result.IsSuccess()) << response.result.Error();
+  EXPECT_EQ(kHexShaderWords, response.spirv);
+
+  CompileServer other;
+  r = other.Listen(socket_path);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("A compile server is already listening on " + socket_path,
+            r.Error());
+
+  server.Stop();
+  thread.join();
+  EXPECT_EQ(2U, server.GetCompileCount());
+  EXPECT_EQ(2U, server.GetCacheHitCount());
+}
+
+TEST_F(CompileServerTest, ListenKeepsFileWhichIsNotASocket) {
+  const std::string socket_path =
+      testing::TempDir() + "amber_compile_server_not_a_socket";
+  {
+    std::ofstream file(socket_path);
+    file << "data";
+  }
+
+  CompileServer server;
+  Result r = server.Listen(socket_path);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("Compile server socket path exists and is not a socket: " +
+                socket_path,
+            r.Error());
+
+  std::ifstream file(socket_path);
+  std::string data;
+  file >> data;
+  EXPECT_EQ("data", data);
+  std::remove(socket_path.c_str());
+}
+#endif  // AMBER_PLATFORM_POSIX
+
+}  // namespace amber
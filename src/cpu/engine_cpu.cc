@@ -0,0 +1,303 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/cpu/engine_cpu.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+#include "src/cpu/spirv.h"
+#include "src/make_unique.h"
+
+namespace amber {
+namespace cpu {
+namespace {
+
+bool IsDescriptorBuffer(BufferType type) {
+  return type == BufferType::kStorage || type == BufferType::kStorageDynamic ||
+         type == BufferType::kUniform || type == BufferType::kUniformDynamic;
+}
+
+// Copies the data of |buffer| into |block| at |offset|, growing |block| as
+// needed.
+void CopyPushConstants(Buffer* buffer,
+                       uint32_t offset,
+                       std::vector<uint8_t>* block) {
+  buffer->ValuePtr()->resize(static_cast<size_t>(buffer->GetSizeInBytes()));
+  const auto& data = *buffer->ValuePtr();
+  if (block->size() < offset + data.size())
+    block->resize(offset + data.size());
+  if (!data.empty())
+    std::memcpy(block->data() + offset, data.data(), data.size());
+}
+
+}  // namespace
+
+EngineCpu::PipelineInfo::PipelineInfo() = default;
+
+EngineCpu::PipelineInfo::~PipelineInfo() = default;
+
+EngineCpu::EngineCpu() = default;
+
+EngineCpu::~EngineCpu() = default;
+
+Result EngineCpu::Initialize(EngineConfig*,
+                             Delegate*,
+                             const std::vector<std::string>&,
+                             const std::vector<std::string>&,
+                             const std::vector<std::string>&) {
+  return {};
+}
+
+Result EngineCpu::ParseProgram(const Pipeline* pipeline,
+                               const std::string& entry_point,
+                               PipelineInfo* info) {
+  const auto& shader = pipeline->GetShaders()[0];
+  auto program = MakeUnique<Program>();
+  Result r = program->Parse(shader.GetData(), entry_point,
+                            shader.GetSpecialization());
+  if (!r.IsSuccess())
+    return r;
+
+  info->program = std::move(program);
+  return {};
+}
+
+Result EngineCpu::CreatePipeline(Pipeline* pipeline) {
+  if (!pipeline->IsCompute())
+    return Result("CPU::CreatePipeline only compute pipelines are supported");
+  if (pipeline->GetShaders().size() != 1)
+    return Result("CPU::CreatePipeline compute pipeline needs one shader");
+  if (pipeline_map_.count(pipeline) > 0)
+    return Result("CPU::CreatePipeline pipeline already created");
+
+  Result r = ParseProgram(pipeline, pipeline->GetShaders()[0].GetEntryPoint(),
+                          &pipeline_map_[pipeline]);
+  if (!r.IsSuccess())
+    pipeline_map_.erase(pipeline);
+  return r;
+}
+
+Result EngineCpu::DoClearColor(const ClearColorCommand*) {
+  return Result("CPU::DoClearColor graphics pipelines are not supported");
+}
+
+Result EngineCpu::DoClearStencil(const ClearStencilCommand*) {
+  return Result("CPU::DoClearStencil graphics pipelines are not supported");
+}
+
+Result EngineCpu::DoClearDepth(const ClearDepthCommand*) {
+  return Result("CPU::DoClearDepth graphics pipelines are not supported");
+}
+
+Result EngineCpu::DoClear(const ClearCommand*) {
+  return Result("CPU::DoClear graphics pipelines are not supported");
+}
+
+Result EngineCpu::DoDrawRect(const DrawRectCommand*) {
+  return Result("CPU::DoDrawRect graphics pipelines are not supported");
+}
+
+Result EngineCpu::DoDrawGrid(const DrawGridCommand*) {
+  return Result("CPU::DoDrawGrid graphics pipelines are not supported");
+}
+
+Result EngineCpu::DoDrawArrays(const DrawArraysCommand*) {
+  return Result("CPU::DoDrawArrays graphics pipelines are not supported");
+}
+
+Result EngineCpu::DoCompute(const ComputeCommand* cmd) {
+  Pipeline* pipeline = cmd->GetPipeline();
+  auto it = pipeline_map_.find(pipeline);
+  if (it == pipeline_map_.end())
+    return Result("CPU::DoCompute for Non-Compute Pipeline");
+  PipelineInfo& info = it->second;
+  const Program* program = info.program.get();
+
+  DispatchState state;
+  state.workgroup_count[0] = cmd->GetX();
+  state.workgroup_count[1] = cmd->GetY();
+  state.workgroup_count[2] = cmd->GetZ();
+  if (cmd->IsIndirect()) {
+    Buffer* indirect = cmd->GetIndirectBuffer();
+    indirect->ValuePtr()->resize(
+        static_cast<size_t>(indirect->GetSizeInBytes()));
+    const auto& data = *indirect->ValuePtr();
+    const uint64_t offset = cmd->GetIndirectOffset();
+    if (offset + sizeof(state.workgroup_count) > data.size())
+      return Result("CPU::DoCompute indirect buffer is too small");
+    std::memcpy(state.workgroup_count, data.data() + offset,
+                sizeof(state.workgroup_count));
+  }
+
+  std::vector<uint8_t> push_constants;
+  if (pipeline->GetPushConstantBuffer().buffer)
+    CopyPushConstants(pipeline->GetPushConstantBuffer().buffer, 0,
+                      &push_constants);
+  for (const auto& entry : info.push_constants)
+    CopyPushConstants(entry.first, entry.second, &push_constants);
+
+  state.buffers.resize(program->GetBound());
+  for (const auto& var : program->GetVariables()) {
+    BufferBinding& binding = state.buffers[var.id];
+    if (var.storage_class == spv::StorageClassPushConstant) {
+      binding.data = push_constants.data();
+      binding.size = push_constants.size();
+      continue;
+    }
+    if (var.storage_class != spv::StorageClassUniform &&
+        var.storage_class != spv::StorageClassStorageBuffer) {
+      continue;
+    }
+
+    const Pipeline::BufferInfo* bound = nullptr;
+    for (const auto& buf_info : pipeline->GetBuffers()) {
+      if (IsDescriptorBuffer(buf_info.type) &&
+          buf_info.descriptor_set == var.descriptor_set &&
+          buf_info.binding == var.binding) {
+        bound = &buf_info;
+        break;
+      }
+    }
+    if (!bound) {
+      return Result("CPU::DoCompute no buffer bound to descriptor set " +
+                    std::to_string(var.descriptor_set) + " binding " +
+                    std::to_string(var.binding));
+    }
+
+    // Like a device allocation, the memory always has the full buffer size.
+    Buffer* buffer = bound->buffer;
+    buffer->ValuePtr()->resize(static_cast<size_t>(buffer->GetSizeInBytes()));
+    const uint64_t size = buffer->ValuePtr()->size();
+    const uint64_t base = bound->descriptor_offset + bound->dynamic_offset;
+    if (base > size)
+      return Result("CPU::DoCompute descriptor offset is outside the buffer");
+
+    binding.data = buffer->ValuePtr()->data() + base;
+    binding.size = std::min(size - base, bound->descriptor_range);
+  }
+
+  return Dispatch(program, state);
+}
+
+Result EngineCpu::Dispatch(const Program* program,
+                           const DispatchState& state) {
+  const uint64_t count = uint64_t{state.workgroup_count[0]} *
+                         state.workgroup_count[1] * state.workgroup_count[2];
+  if (count == 0)
+    return {};
+
+  const uint32_t thread_count =
+      std::max(1U, std::thread::hardware_concurrency());
+  if (!workers_)
+    workers_ = MakeUnique<VerificationQueue>(thread_count);
+
+  std::mutex atomic_mutex;
+  DispatchState thread_state = state;
+  thread_state.atomic_mutex = &atomic_mutex;
+  thread_state.deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(GetEngineData().fence_timeout_ms);
+
+  std::atomic<uint64_t> next_workgroup(0);
+  std::atomic<bool> failed(false);
+
+  auto run = [&]() -> Result {
+    Invocation invocation(program);
+    const uint32_t* local_size = program->GetLocalSize();
+    for (;;) {
+      const uint64_t index = next_workgroup.fetch_add(1);
+      if (index >= count || failed.load())
+        return {};
+      if (std::chrono::steady_clock::now() >= thread_state.deadline) {
+        failed = true;
+        return Result("CPU: dispatch did not finish before the timeout");
+      }
+
+      const uint32_t workgroup_id[3] = {
+          static_cast<uint32_t>(index % state.workgroup_count[0]),
+          static_cast<uint32_t>((index / state.workgroup_count[0]) %
+                                state.workgroup_count[1]),
+          static_cast<uint32_t>(index / (uint64_t{state.workgroup_count[0]} *
+                                         state.workgroup_count[1]))};
+      uint32_t local_id[3] = {0, 0, 0};
+      for (local_id[2] = 0; local_id[2] < local_size[2]; ++local_id[2]) {
+        for (local_id[1] = 0; local_id[1] < local_size[1]; ++local_id[1]) {
+          for (local_id[0] = 0; local_id[0] < local_size[0]; ++local_id[0]) {
+            Result r = invocation.Run(thread_state, workgroup_id, local_id);
+            if (!r.IsSuccess()) {
+              failed = true;
+              return r;
+            }
+          }
+        }
+      }
+    }
+  };
+
+  // Every task runs work groups until none is left, so there is no need for
+  // more tasks than work groups. Join reports the first failure.
+  const uint64_t task_count = std::min(uint64_t{thread_count}, count);
+  for (uint64_t i = 0; i < task_count; ++i)
+    workers_->Push(static_cast<size_t>(i), run);
+  return workers_->Join();
+}
+
+Result EngineCpu::DoEntryPoint(const EntryPointCommand* cmd) {
+  auto it = pipeline_map_.find(cmd->GetPipeline());
+  if (it == pipeline_map_.end())
+    return Result("CPU::DoEntryPoint no Pipeline exists");
+  if (cmd->GetShaderType() != kShaderTypeCompute)
+    return Result("CPU::DoEntryPoint only compute shaders are supported");
+
+  return ParseProgram(cmd->GetPipeline(), cmd->GetEntryPointName(),
+                      &it->second);
+}
+
+Result EngineCpu::DoPatchParameterVertices(
+    const PatchParameterVerticesCommand*) {
+  return Result(
+      "CPU::DoPatchParameterVertices graphics pipelines are not supported");
+}
+
+Result EngineCpu::DoBuffer(const BufferCommand* cmd) {
+  Buffer* buffer = cmd->GetBuffer();
+  Result r;
+  if (cmd->GetValues().empty())
+    r = buffer->SetSizeInElements(buffer->ElementCount());
+  else
+    r = buffer->SetDataWithOffset(cmd->GetValues(), cmd->GetOffset());
+  if (!r.IsSuccess())
+    return r;
+
+  if (cmd->IsPushConstant()) {
+    if (cmd->GetOffset() > std::numeric_limits<uint32_t>::max())
+      return Result("CPU::DoBuffer push constant offset is too large");
+
+    auto it = pipeline_map_.find(cmd->GetPipeline());
+    if (it == pipeline_map_.end())
+      return Result("CPU::DoBuffer no Pipeline exists");
+    it->second.push_constants.emplace_back(
+        buffer, static_cast<uint32_t>(cmd->GetOffset()));
+  }
+  return {};
+}
+
+}  // namespace cpu
+}  // namespace amber
@@ -0,0 +1,96 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_CPU_ENGINE_CPU_H_
+#define SRC_CPU_ENGINE_CPU_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/cpu/invocation.h"
+#include "src/cpu/program.h"
+#include "src/engine.h"
+#include "src/verification_queue.h"
+
+namespace amber {
+namespace cpu {
+
+/// Engine implementation which runs compute shaders on the host CPU.
+///
+/// The SPIR-V of each compute pipeline is parsed into a Program and
+/// interpreted directly on the memory of the amber::Buffers. The work groups
+/// of a dispatch are spread over a pool of threads, one per hardware thread,
+/// which the engine keeps for all dispatches. Each thread takes the next work
+/// group not yet started, so threads finishing early keep taking work until
+/// none is left. Like a Vulkan fence wait, a dispatch fails once it runs
+/// longer than the fence timeout of the EngineData. Storage buffers, uniform
+/// buffers, push constants and specialization constants are supported. A
+/// subgroup holds a single invocation. Graphics pipelines are not
+/// supported.
+///
+/// The engine does not need an EngineConfig.
+class EngineCpu : public Engine {
+ public:
+  EngineCpu();
+  ~EngineCpu() override;
+
+  // Engine
+  Result Initialize(EngineConfig* config,
+                    Delegate* delegate,
+                    const std::vector<std::string>& features,
+                    const std::vector<std::string>& instance_extensions,
+                    const std::vector<std::string>& device_extensions) override;
+  Result CreatePipeline(Pipeline* pipeline) override;
+  Result DoClearColor(const ClearColorCommand* cmd) override;
+  Result DoClearStencil(const ClearStencilCommand* cmd) override;
+  Result DoClearDepth(const ClearDepthCommand* cmd) override;
+  Result DoClear(const ClearCommand* cmd) override;
+  Result DoDrawRect(const DrawRectCommand* cmd) override;
+  Result DoDrawGrid(const DrawGridCommand* cmd) override;
+  Result DoDrawArrays(const DrawArraysCommand* cmd) override;
+  Result DoCompute(const ComputeCommand* cmd) override;
+  Result DoEntryPoint(const EntryPointCommand* cmd) override;
+  Result DoPatchParameterVertices(
+      const PatchParameterVerticesCommand* cmd) override;
+  Result DoBuffer(const BufferCommand* cmd) override;
+
+ private:
+  struct PipelineInfo {
+    PipelineInfo();
+    ~PipelineInfo();
+
+    std::unique_ptr<Program> program;
+    /// The push constant buffers set by buffer commands, with the offset of
+    /// each in the push constant block.
+    std::vector<std::pair<Buffer*, uint32_t>> push_constants;
+  };
+
+  Result ParseProgram(const Pipeline* pipeline,
+                      const std::string& entry_point,
+                      PipelineInfo* info);
+  /// Runs every work group of |state| with |program|.
+  Result Dispatch(const Program* program, const DispatchState& state);
+
+  std::map<const Pipeline*, PipelineInfo> pipeline_map_;
+  /// Threads running the work groups, started by the first dispatch.
+  std::unique_ptr<VerificationQueue> workers_;
+};
+
+}  // namespace cpu
+}  // namespace amber
+
+#endif  // SRC_CPU_ENGINE_CPU_H_
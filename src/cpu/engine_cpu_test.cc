@@ -0,0 +1,229 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/cpu/engine_cpu.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "src/amberscript/parser.h"
+#include "src/executor.h"
+
+namespace amber {
+namespace cpu {
+namespace {
+
+// Multiplies data[gl_GlobalInvocationID.x] by the specialization constant 0
+// and adds the first push constant. The work group size is 2.
+const uint32_t kScaleShader[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x0000001c, 0x00000000, 0x00020011,
+    0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0006000f, 0x00000005,
+    0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00060010, 0x00000001,
+    0x00000011, 0x00000002, 0x00000001, 0x00000001, 0x00040047, 0x00000002,
+    0x0000000b, 0x0000001c, 0x00040047, 0x00000003, 0x00000001, 0x00000000,
+    0x00050048, 0x00000004, 0x00000000, 0x00000023, 0x00000000, 0x00030047,
+    0x00000004, 0x00000002, 0x00040047, 0x00000005, 0x00000006, 0x00000004,
+    0x00050048, 0x00000006, 0x00000000, 0x00000023, 0x00000000, 0x00030047,
+    0x00000006, 0x00000002, 0x00040047, 0x00000007, 0x00000022, 0x00000000,
+    0x00040047, 0x00000007, 0x00000021, 0x00000000, 0x00020013, 0x00000008,
+    0x00030021, 0x00000009, 0x00000008, 0x00040015, 0x0000000a, 0x00000020,
+    0x00000000, 0x0003001d, 0x00000005, 0x0000000a, 0x0003001e, 0x00000006,
+    0x00000005, 0x00040020, 0x0000000b, 0x0000000c, 0x00000006, 0x0004003b,
+    0x0000000b, 0x00000007, 0x0000000c, 0x00040020, 0x0000000c, 0x0000000c,
+    0x0000000a, 0x0004002b, 0x0000000a, 0x0000000d, 0x00000000, 0x00040017,
+    0x0000000e, 0x0000000a, 0x00000003, 0x00040020, 0x0000000f, 0x00000001,
+    0x0000000e, 0x0004003b, 0x0000000f, 0x00000002, 0x00000001, 0x0003001e,
+    0x00000004, 0x0000000a, 0x00040020, 0x00000010, 0x00000009, 0x00000004,
+    0x0004003b, 0x00000010, 0x00000011, 0x00000009, 0x00040020, 0x00000012,
+    0x00000009, 0x0000000a, 0x00040032, 0x0000000a, 0x00000003, 0x00000001,
+    0x00050036, 0x00000008, 0x00000001, 0x00000000, 0x00000009, 0x000200f8,
+    0x00000013, 0x0004003d, 0x0000000e, 0x00000014, 0x00000002, 0x00050051,
+    0x0000000a, 0x00000015, 0x00000014, 0x00000000, 0x00060041, 0x0000000c,
+    0x00000016, 0x00000007, 0x0000000d, 0x00000015, 0x0004003d, 0x0000000a,
+    0x00000017, 0x00000016, 0x00050084, 0x0000000a, 0x00000018, 0x00000017,
+    0x00000003, 0x00050041, 0x00000012, 0x00000019, 0x00000011, 0x0000000d,
+    0x0004003d, 0x0000000a, 0x0000001a, 0x00000019, 0x00050080, 0x0000000a,
+    0x0000001b, 0x00000018, 0x0000001a, 0x0003003e, 0x00000016, 0x0000001b,
+    0x000100fd, 0x00010038,
+};
+
+// Adds 0 + 1 + 2 + 3 + 4 to data[0] with an atomic add in each invocation,
+// using a loop. The work group size is 4.
+const uint32_t kLoopShader[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x00000019, 0x00000000, 0x00020011,
+    0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0005000f, 0x00000005,
+    0x00000001, 0x6e69616d, 0x00000000, 0x00060010, 0x00000001, 0x00000011,
+    0x00000004, 0x00000001, 0x00000001, 0x00040047, 0x00000002, 0x00000006,
+    0x00000004, 0x00050048, 0x00000003, 0x00000000, 0x00000023, 0x00000000,
+    0x00030047, 0x00000003, 0x00000002, 0x00040047, 0x00000004, 0x00000022,
+    0x00000000, 0x00040047, 0x00000004, 0x00000021, 0x00000000, 0x00020013,
+    0x00000005, 0x00030021, 0x00000006, 0x00000005, 0x00040015, 0x00000007,
+    0x00000020, 0x00000000, 0x0003001d, 0x00000002, 0x00000007, 0x0003001e,
+    0x00000003, 0x00000002, 0x00040020, 0x00000008, 0x0000000c, 0x00000003,
+    0x0004003b, 0x00000008, 0x00000004, 0x0000000c, 0x00040020, 0x00000009,
+    0x0000000c, 0x00000007, 0x0004002b, 0x00000007, 0x0000000a, 0x00000000,
+    0x00020014, 0x0000000b, 0x0004002b, 0x00000007, 0x0000000c, 0x00000001,
+    0x0004002b, 0x00000007, 0x0000000d, 0x00000005, 0x00050036, 0x00000005,
+    0x00000001, 0x00000000, 0x00000006, 0x000200f8, 0x0000000e, 0x000200f9,
+    0x0000000f, 0x000200f8, 0x0000000f, 0x000700f5, 0x00000007, 0x00000012,
+    0x0000000a, 0x0000000e, 0x00000010, 0x00000011, 0x000700f5, 0x00000007,
+    0x00000014, 0x0000000a, 0x0000000e, 0x00000013, 0x00000011, 0x000500b0,
+    0x0000000b, 0x00000015, 0x00000012, 0x0000000d, 0x000400f6, 0x00000016,
+    0x00000011, 0x00000000, 0x000400fa, 0x00000015, 0x00000011, 0x00000016,
+    0x000200f8, 0x00000011, 0x00050080, 0x00000007, 0x00000013, 0x00000014,
+    0x00000012, 0x00050080, 0x00000007, 0x00000010, 0x00000012, 0x0000000c,
+    0x000200f9, 0x0000000f, 0x000200f8, 0x00000016, 0x00060041, 0x00000009,
+    0x00000017, 0x00000004, 0x0000000a, 0x0000000a, 0x000700ea, 0x00000007,
+    0x00000018, 0x00000017, 0x0000000c, 0x0000000a, 0x00000014, 0x000100fd,
+    0x00010038,
+};
+
+// Loops forever. The work group size is 1.
+const uint32_t kInfiniteLoopShader[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x00000007, 0x00000000, 0x00020011,
+    0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0005000f, 0x00000005,
+    0x00000001, 0x6e69616d, 0x00000000, 0x00060010, 0x00000001, 0x00000011,
+    0x00000001, 0x00000001, 0x00000001, 0x00020013, 0x00000002, 0x00030021,
+    0x00000003, 0x00000002, 0x00050036, 0x00000002, 0x00000001, 0x00000000,
+    0x00000003, 0x000200f8, 0x00000004, 0x000200f9, 0x00000005, 0x000200f8,
+    0x00000005, 0x000400f6, 0x00000006, 0x00000005, 0x00000000, 0x000200f9,
+    0x00000005, 0x000200f8, 0x00000006, 0x000100fd, 0x00010038,
+};
+
+Result RunScript(const std::string& input,
+                 const std::vector<uint32_t>& spirv) {
+  amberscript::Parser parser;
+  Result r = parser.Parse(input);
+  if (!r.IsSuccess())
+    return r;
+
+  ShaderMap shader_map;
+  shader_map["pipeline-shader"] = spirv;
+
+  auto script = parser.GetScript();
+  auto engine = Engine::Create(kEngineTypeCpu);
+  r = engine->Initialize(nullptr, nullptr, script->GetRequiredFeatures(),
+                         script->GetRequiredInstanceExtensions(),
+                         script->GetRequiredDeviceExtensions());
+  if (!r.IsSuccess())
+    return r;
+
+  Options options;
+  Executor executor;
+  return executor.Execute(engine.get(), script.get(), shader_map, &options,
+                          nullptr);
+}
+
+}  // namespace
+
+using EngineCpuTest = testing::Test;
+
+TEST_F(EngineCpuTest, SpecializationAndPushConstants) {
+  Result r = RunScript(R"(
+SHADER compute shader GLSL
+# shader
+END
+
+BUFFER buf DATA_TYPE uint32 DATA 1 2 3 4 5 6 7 8 END
+BUFFER push DATA_TYPE uint32 DATA 10 END
+
+PIPELINE compute pipeline
+  ATTACH shader SPECIALIZE 0 AS uint32 3
+  BIND BUFFER buf AS storage DESCRIPTOR_SET 0 BINDING 0
+  BIND BUFFER push AS push_constant
+END
+
+RUN pipeline 4 1 1
+EXPECT buf IDX 0 EQ 13 16 19 22 25 28 31 34
+)",
+                       std::vector<uint32_t>(std::begin(kScaleShader),
+                                             std::end(kScaleShader)));
+  EXPECT_TRUE(r.IsSuccess()) << r.Error();
+}
+
+TEST_F(EngineCpuTest, LoopsAndAtomicsAcrossWorkGroups) {
+  Result r = RunScript(R"(
+SHADER compute shader GLSL
+# shader
+END
+
+BUFFER buf DATA_TYPE uint32 SIZE 1 FILL 0
+
+PIPELINE compute pipeline
+  ATTACH shader
+  BIND BUFFER buf AS storage DESCRIPTOR_SET 0 BINDING 0
+END
+
+RUN pipeline 64 2 1
+EXPECT buf IDX 0 EQ 5120
+)",
+                       std::vector<uint32_t>(std::begin(kLoopShader),
+                                             std::end(kLoopShader)));
+  EXPECT_TRUE(r.IsSuccess()) << r.Error();
+}
+
+TEST_F(EngineCpuTest, MissingBufferFails) {
+  Result r = RunScript(R"(
+SHADER compute shader GLSL
+# shader
+END
+
+BUFFER buf DATA_TYPE uint32 SIZE 1 FILL 0
+
+PIPELINE compute pipeline
+  ATTACH shader
+  BIND BUFFER buf AS storage DESCRIPTOR_SET 0 BINDING 1
+END
+
+RUN pipeline 1 1 1
+)",
+                       std::vector<uint32_t>(std::begin(kLoopShader),
+                                             std::end(kLoopShader)));
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("CPU::DoCompute no buffer bound to descriptor set 0 binding 0",
+            r.Error());
+}
+
+TEST_F(EngineCpuTest, RunawayInvocationTimesOut) {
+  Result r = RunScript(R"(
+SET ENGINE_DATA fence_timeout_ms 50
+
+SHADER compute shader GLSL
+# shader
+END
+
+PIPELINE compute pipeline
+  ATTACH shader
+END
+
+RUN pipeline 4 1 1
+)",
+                       std::vector<uint32_t>(std::begin(kInfiniteLoopShader),
+                                             std::end(kInfiniteLoopShader)));
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("CPU: invocation did not finish before the timeout", r.Error());
+}
+
+TEST_F(EngineCpuTest, GraphicsPipelineFails) {
+  EngineCpu engine;
+  Pipeline pipeline(PipelineType::kGraphics);
+  Result r = engine.CreatePipeline(&pipeline);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("CPU::CreatePipeline only compute pipelines are supported",
+            r.Error());
+}
+
+}  // namespace cpu
+}  // namespace amber
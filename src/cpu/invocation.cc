@@ -0,0 +1,1235 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/cpu/invocation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include "src/cpu/spirv.h"
+
+namespace amber {
+namespace cpu {
+namespace {
+
+// Number of branches between two checks of the dispatch deadline.
+const uint32_t kBranchesPerDeadlineCheck = 1024;
+
+float ToFloat(uint32_t word) {
+  float f = 0.0f;
+  std::memcpy(&f, &word, sizeof(f));
+  return f;
+}
+
+uint32_t FromFloat(float f) {
+  uint32_t word = 0;
+  std::memcpy(&word, &f, sizeof(word));
+  return word;
+}
+
+int32_t ToInt(uint32_t word) {
+  int32_t i = 0;
+  std::memcpy(&i, &word, sizeof(i));
+  return i;
+}
+
+uint32_t FromInt(int32_t i) {
+  uint32_t word = 0;
+  std::memcpy(&word, &i, sizeof(word));
+  return word;
+}
+
+uint32_t FromBool(bool b) {
+  return b ? 1U : 0U;
+}
+
+template <typename F>
+void Map1(const std::vector<uint32_t>& a, std::vector<uint32_t>* out, F f) {
+  out->resize(a.size());
+  for (size_t i = 0; i < a.size(); ++i)
+    (*out)[i] = f(a[i]);
+}
+
+template <typename F>
+bool Map2(const std::vector<uint32_t>& a,
+          const std::vector<uint32_t>& b,
+          std::vector<uint32_t>* out,
+          F f) {
+  if (a.size() != b.size())
+    return false;
+  out->resize(a.size());
+  for (size_t i = 0; i < a.size(); ++i)
+    (*out)[i] = f(a[i], b[i]);
+  return true;
+}
+
+template <typename F>
+bool Map3(const std::vector<uint32_t>& a,
+          const std::vector<uint32_t>& b,
+          const std::vector<uint32_t>& c,
+          std::vector<uint32_t>* out,
+          F f) {
+  if (a.size() != b.size() || a.size() != c.size())
+    return false;
+  out->resize(a.size());
+  for (size_t i = 0; i < a.size(); ++i)
+    (*out)[i] = f(a[i], b[i], c[i]);
+  return true;
+}
+
+uint32_t ConvertFToU(uint32_t word) {
+  const float f = ToFloat(word);
+  if (!(f > 0.0f))
+    return 0;
+  if (f >= 4294967296.0f)
+    return std::numeric_limits<uint32_t>::max();
+  return static_cast<uint32_t>(f);
+}
+
+uint32_t ConvertFToS(uint32_t word) {
+  const float f = ToFloat(word);
+  if (std::isnan(f))
+    return 0;
+  if (f <= -2147483648.0f)
+    return FromInt(std::numeric_limits<int32_t>::min());
+  if (f >= 2147483648.0f)
+    return FromInt(std::numeric_limits<int32_t>::max());
+  return FromInt(static_cast<int32_t>(f));
+}
+
+uint32_t SDiv(uint32_t x, uint32_t y) {
+  const int32_t a = ToInt(x);
+  const int32_t b = ToInt(y);
+  if (b == 0)
+    return 0;
+  if (b == -1)
+    return 0U - x;
+  return FromInt(a / b);
+}
+
+uint32_t SRem(uint32_t x, uint32_t y) {
+  const int32_t a = ToInt(x);
+  const int32_t b = ToInt(y);
+  if (b == 0 || b == -1)
+    return 0;
+  return FromInt(a % b);
+}
+
+uint32_t SMod(uint32_t x, uint32_t y) {
+  const int32_t b = ToInt(y);
+  int32_t r = ToInt(SRem(x, y));
+  if (r != 0 && ((r < 0) != (b < 0)))
+    r += b;
+  return FromInt(r);
+}
+
+uint32_t ShiftRightArithmetic(uint32_t x, uint32_t y) {
+  if (y >= 32)
+    return ToInt(x) < 0 ? ~0U : 0U;
+  if (ToInt(x) >= 0)
+    return x >> y;
+  return ~((~x) >> y);
+}
+
+uint32_t BitCount(uint32_t x) {
+  uint32_t count = 0;
+  for (; x != 0; x &= x - 1)
+    ++count;
+  return count;
+}
+
+// Returns the value which does not change the result of the subgroup
+// operation |opcode|.
+uint32_t GetIdentity(uint32_t opcode) {
+  switch (opcode) {
+    case spv::OpGroupNonUniformIMul:
+      return 1;
+    case spv::OpGroupNonUniformFMul:
+      return FromFloat(1.0f);
+    case spv::OpGroupNonUniformSMin:
+      return FromInt(std::numeric_limits<int32_t>::max());
+    case spv::OpGroupNonUniformUMin:
+    case spv::OpGroupNonUniformBitwiseAnd:
+      return std::numeric_limits<uint32_t>::max();
+    case spv::OpGroupNonUniformFMin:
+      return FromFloat(std::numeric_limits<float>::infinity());
+    case spv::OpGroupNonUniformSMax:
+      return FromInt(std::numeric_limits<int32_t>::min());
+    case spv::OpGroupNonUniformFMax:
+      return FromFloat(-std::numeric_limits<float>::infinity());
+    case spv::OpGroupNonUniformLogicalAnd:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+}  // namespace
+
+DispatchState::DispatchState() = default;
+
+DispatchState::~DispatchState() = default;
+
+Invocation::Slot::Slot() = default;
+
+Invocation::Slot::Slot(const Slot&) = default;
+
+Invocation::Slot::~Slot() = default;
+
+Invocation::Slot& Invocation::Slot::operator=(const Slot&) = default;
+
+Invocation::Invocation(const Program* program) : program_(program) {
+  slots_.resize(program->GetBound());
+  const auto& constants = program->GetConstants();
+  for (size_t i = 0; i < constants.size(); ++i)
+    slots_[i].words = constants[i];
+  locals_.resize(program->GetLocalWordCount());
+}
+
+Invocation::~Invocation() = default;
+
+const std::vector<uint32_t>& Invocation::Get(uint32_t id) const {
+  if (id >= slots_.size())
+    return slots_[0].words;
+  return slots_[id].words;
+}
+
+uint32_t Invocation::GetScalar(uint32_t id) const {
+  const auto& words = Get(id);
+  return words.empty() ? 0 : words[0];
+}
+
+const Invocation::Pointer& Invocation::GetPointer(uint32_t id) const {
+  if (id >= slots_.size())
+    return slots_[0].ptr;
+  return slots_[id].ptr;
+}
+
+void Invocation::InitializeVariables(const DispatchState& state,
+                                     const uint32_t* workgroup_id,
+                                     const uint32_t* local_id) {
+  const uint32_t* local_size = program_->GetLocalSize();
+  for (const auto& var : program_->GetVariables()) {
+    Pointer& ptr = slots_[var.id].ptr;
+    ptr.type = var.type;
+
+    if (var.storage_class == spv::StorageClassUniform ||
+        var.storage_class == spv::StorageClassStorageBuffer ||
+        var.storage_class == spv::StorageClassPushConstant) {
+      const BufferBinding& binding = state.buffers[var.id];
+      ptr.data = binding.data;
+      ptr.size = binding.size;
+      ptr.offset = 0;
+      continue;
+    }
+
+    ptr.data = nullptr;
+    ptr.size = 0;
+    ptr.offset = var.local_offset;
+    const uint32_t words = program_->GetType(var.type).words;
+    uint32_t* memory = locals_.data() + var.local_offset;
+
+    if (var.storage_class == spv::StorageClassPrivate) {
+      if (var.initializer != 0)
+        std::memcpy(memory, Get(var.initializer).data(), words * 4);
+      else
+        std::memset(memory, 0, words * 4);
+      continue;
+    }
+
+    const uint32_t local_index =
+        (local_id[2] * local_size[1] + local_id[1]) * local_size[0] +
+        local_id[0];
+    uint32_t value[3] = {0, 0, 0};
+    switch (var.builtin) {
+      case spv::BuiltInNumWorkgroups:
+        for (uint32_t i = 0; i < 3; ++i)
+          value[i] = state.workgroup_count[i];
+        break;
+      case spv::BuiltInWorkgroupId:
+        for (uint32_t i = 0; i < 3; ++i)
+          value[i] = workgroup_id[i];
+        break;
+      case spv::BuiltInLocalInvocationId:
+        for (uint32_t i = 0; i < 3; ++i)
+          value[i] = local_id[i];
+        break;
+      case spv::BuiltInGlobalInvocationId:
+        for (uint32_t i = 0; i < 3; ++i)
+          value[i] = workgroup_id[i] * local_size[i] + local_id[i];
+        break;
+      case spv::BuiltInLocalInvocationIndex:
+      case spv::BuiltInSubgroupId:
+        value[0] = local_index;
+        break;
+      case spv::BuiltInSubgroupSize:
+        value[0] = 1;
+        break;
+      case spv::BuiltInNumSubgroups:
+        value[0] = local_size[0] * local_size[1] * local_size[2];
+        break;
+      default:
+        break;
+    }
+    std::memcpy(memory, value, (words < 3 ? words : 3) * 4);
+  }
+}
+
+Result Invocation::Run(const DispatchState& state,
+                       const uint32_t* workgroup_id,
+                       const uint32_t* local_id) {
+  InitializeVariables(state, workgroup_id, local_id);
+
+  const auto& code = program_->GetCode();
+  current_label_ = code[0].result;
+  previous_label_ = 0;
+  size_t pc = 1;
+  for (;;) {
+    if (pc >= code.size())
+      return Result("CPU: invocation ran past the end of the function");
+
+    // Only loops run for long and they always branch, so checking the clock
+    // on some of the branches is enough.
+    if (code[pc].opcode == spv::OpBranch ||
+        code[pc].opcode == spv::OpBranchConditional ||
+        code[pc].opcode == spv::OpSwitch) {
+      if (++branch_count_ % kBranchesPerDeadlineCheck == 0 &&
+          std::chrono::steady_clock::now() >= state.deadline) {
+        return Result("CPU: invocation did not finish before the timeout");
+      }
+    }
+
+    const Instruction& inst = code[pc];
+    switch (inst.opcode) {
+      case spv::OpReturn:
+        return {};
+      case spv::OpBranch:
+        Branch(inst.operands[0], &pc);
+        break;
+      case spv::OpBranchConditional:
+        Branch(GetScalar(inst.operands[0]) != 0 ? inst.operands[1]
+                                                : inst.operands[2],
+               &pc);
+        break;
+      case spv::OpSwitch: {
+        const uint32_t selector = GetScalar(inst.operands[0]);
+        uint32_t target = inst.operands[1];
+        for (size_t i = 2; i + 1 < inst.operands.size(); i += 2) {
+          if (inst.operands[i] == selector) {
+            target = inst.operands[i + 1];
+            break;
+          }
+        }
+        Branch(target, &pc);
+        break;
+      }
+      case spv::OpReturnValue:
+      case spv::OpKill:
+      case spv::OpUnreachable:
+        return Result("CPU: invocation reached an unsupported terminator");
+      default: {
+        Result r = Execute(inst, state);
+        if (!r.IsSuccess())
+          return r;
+        ++pc;
+        break;
+      }
+    }
+  }
+}
+
+void Invocation::Branch(uint32_t target, size_t* pc) {
+  previous_label_ = current_label_;
+  current_label_ = target;
+
+  const auto& code = program_->GetCode();
+  size_t i = program_->GetLabelIndex(target) + 1;
+
+  // All the OpPhi of a block read their values before any of them is set.
+  phi_values_.clear();
+  for (; i < code.size() && code[i].opcode == spv::OpPhi; ++i) {
+    const auto& ops = code[i].operands;
+    for (size_t j = 0; j + 1 < ops.size(); j += 2) {
+      if (ops[j + 1] == previous_label_ && ops[j] < slots_.size()) {
+        phi_values_.emplace_back(code[i].result, slots_[ops[j]]);
+        break;
+      }
+    }
+  }
+  for (auto& value : phi_values_)
+    slots_[value.first] = value.second;
+  *pc = i;
+}
+
+void Invocation::ReadBuffer(const Pointer& ptr,
+                            uint64_t offset,
+                            uint32_t type_id,
+                            uint32_t* value) const {
+  const Type& type = program_->GetType(type_id);
+  switch (type.kind) {
+    case Type::Kind::kVector:
+      for (uint32_t i = 0; i < type.count; ++i)
+        ReadBuffer(ptr, offset + i * 4U, type.element, value + i);
+      break;
+    case Type::Kind::kArray: {
+      const uint32_t element_words = program_->GetType(type.element).words;
+      for (uint32_t i = 0; i < type.count; ++i) {
+        ReadBuffer(ptr, offset + uint64_t{i} * type.array_stride,
+                   type.element, value + i * element_words);
+      }
+      break;
+    }
+    case Type::Kind::kStruct:
+      for (size_t i = 0; i < type.members.size(); ++i) {
+        ReadBuffer(ptr, offset + type.member_offsets[i], type.members[i],
+                   value + type.member_words[i]);
+      }
+      break;
+    case Type::Kind::kRuntimeArray:
+      break;
+    default:
+      if (ptr.size >= 4 && offset <= ptr.size - 4)
+        std::memcpy(value, ptr.data + offset, 4);
+      else
+        *value = 0;
+      break;
+  }
+}
+
+void Invocation::WriteBuffer(const Pointer& ptr,
+                             uint64_t offset,
+                             uint32_t type_id,
+                             const uint32_t* value) {
+  const Type& type = program_->GetType(type_id);
+  switch (type.kind) {
+    case Type::Kind::kVector:
+      for (uint32_t i = 0; i < type.count; ++i)
+        WriteBuffer(ptr, offset + i * 4U, type.element, value + i);
+      break;
+    case Type::Kind::kArray: {
+      const uint32_t element_words = program_->GetType(type.element).words;
+      for (uint32_t i = 0; i < type.count; ++i) {
+        WriteBuffer(ptr, offset + uint64_t{i} * type.array_stride,
+                    type.element, value + i * element_words);
+      }
+      break;
+    }
+    case Type::Kind::kStruct:
+      for (size_t i = 0; i < type.members.size(); ++i) {
+        WriteBuffer(ptr, offset + type.member_offsets[i], type.members[i],
+                    value + type.member_words[i]);
+      }
+      break;
+    case Type::Kind::kRuntimeArray:
+      break;
+    default:
+      if (ptr.size >= 4 && offset <= ptr.size - 4)
+        std::memcpy(ptr.data + offset, value, 4);
+      break;
+  }
+}
+
+Result Invocation::Load(const Pointer& ptr,
+                        std::vector<uint32_t>* value) const {
+  const uint32_t words = program_->GetType(ptr.type).words;
+  value->resize(words);
+  if (ptr.data) {
+    ReadBuffer(ptr, ptr.offset, ptr.type, value->data());
+    return {};
+  }
+  if (ptr.offset + words > locals_.size())
+    return Result("CPU: out of bounds read of invocation memory");
+  std::memcpy(value->data(), locals_.data() + ptr.offset, words * 4U);
+  return {};
+}
+
+Result Invocation::Store(const Pointer& ptr,
+                         const std::vector<uint32_t>& value) {
+  const uint32_t words = program_->GetType(ptr.type).words;
+  if (value.size() != words)
+    return Result("CPU: stored value does not match the pointer type");
+  if (ptr.data) {
+    WriteBuffer(ptr, ptr.offset, ptr.type, value.data());
+    return {};
+  }
+  if (ptr.offset + words > locals_.size())
+    return Result("CPU: out of bounds write of invocation memory");
+  std::memcpy(locals_.data() + ptr.offset, value.data(), words * 4U);
+  return {};
+}
+
+Result Invocation::AccessChain(const Instruction& inst,
+                               Pointer* result) const {
+  *result = GetPointer(inst.operands[0]);
+  uint32_t type_id = result->type;
+  for (size_t i = 1; i < inst.operands.size(); ++i) {
+    const uint32_t index = GetScalar(inst.operands[i]);
+    const Type& type = program_->GetType(type_id);
+    switch (type.kind) {
+      case Type::Kind::kStruct:
+        if (index >= type.members.size())
+          return Result("CPU: invalid struct member in access chain");
+        result->offset += result->data ? type.member_offsets[index]
+                                       : type.member_words[index];
+        type_id = type.members[index];
+        break;
+      case Type::Kind::kVector:
+        result->offset += result->data ? uint64_t{index} * 4U : index;
+        type_id = type.element;
+        break;
+      case Type::Kind::kArray:
+      case Type::Kind::kRuntimeArray:
+        result->offset +=
+            result->data
+                ? uint64_t{index} * type.array_stride
+                : uint64_t{index} * program_->GetType(type.element).words;
+        type_id = type.element;
+        break;
+      default:
+        return Result("CPU: invalid access chain");
+    }
+  }
+  result->type = type_id;
+  return {};
+}
+
+Result Invocation::GetCompositeOffset(uint32_t type_id,
+                                      const std::vector<uint32_t>& indices,
+                                      size_t first,
+                                      uint32_t* offset,
+                                      uint32_t* words) const {
+  *offset = 0;
+  for (size_t i = first; i < indices.size(); ++i) {
+    const uint32_t index = indices[i];
+    const Type& type = program_->GetType(type_id);
+    if (type.kind == Type::Kind::kStruct && index < type.members.size()) {
+      *offset += type.member_words[index];
+      type_id = type.members[index];
+    } else if ((type.kind == Type::Kind::kVector ||
+                type.kind == Type::Kind::kArray) &&
+               index < type.count) {
+      *offset += index * program_->GetType(type.element).words;
+      type_id = type.element;
+    } else {
+      return Result("CPU: invalid composite index");
+    }
+  }
+  *words = program_->GetType(type_id).words;
+  return {};
+}
+
+Result Invocation::Execute(const Instruction& inst,
+                           const DispatchState& state) {
+  const auto& ops = inst.operands;
+  // Id 0 is never used, so its value is empty.
+  auto arg = [this, &ops](size_t i) -> const std::vector<uint32_t>& {
+    return Get(i < ops.size() ? ops[i] : 0);
+  };
+  std::vector<uint32_t>* out = &slots_[inst.result].words;
+  bool ok = true;
+
+  switch (inst.opcode) {
+    case spv::OpNop:
+    case spv::OpSelectionMerge:
+    case spv::OpLoopMerge:
+    case spv::OpMemoryBarrier:
+      break;
+    case spv::OpUndef:
+      out->assign(program_->GetType(inst.type).words, 0);
+      break;
+    case spv::OpExtInst:
+      return ExtInst(inst, out);
+    case spv::OpVariable: {
+      Pointer& ptr = slots_[inst.result].ptr;
+      ptr.data = nullptr;
+      ptr.size = 0;
+      ptr.offset = program_->GetLocalOffset(inst.result);
+      ptr.type = program_->GetType(inst.type).element;
+      if (ops.size() > 1)
+        return Store(ptr, arg(1));
+      break;
+    }
+    case spv::OpLoad:
+      return Load(GetPointer(ops[0]), out);
+    case spv::OpStore:
+      return Store(GetPointer(ops[0]), arg(1));
+    case spv::OpCopyMemory: {
+      std::vector<uint32_t> value;
+      Result r = Load(GetPointer(ops[1]), &value);
+      if (!r.IsSuccess())
+        return r;
+      return Store(GetPointer(ops[0]), value);
+    }
+    case spv::OpAccessChain:
+    case spv::OpInBoundsAccessChain:
+      return AccessChain(inst, &slots_[inst.result].ptr);
+    case spv::OpArrayLength: {
+      const Pointer& ptr = GetPointer(ops[0]);
+      const Type& type = program_->GetType(ptr.type);
+      if (!ptr.data || ops.size() < 2 || ops[1] >= type.members.size())
+        return Result("CPU: invalid OpArrayLength");
+      const Type& array = program_->GetType(type.members[ops[1]]);
+      const uint64_t start = ptr.offset + type.member_offsets[ops[1]];
+      uint64_t length = 0;
+      if (array.array_stride > 0 && ptr.size > start)
+        length = (ptr.size - start) / array.array_stride;
+      out->assign(1, static_cast<uint32_t>(
+                         std::min<uint64_t>(length, 0xffffffffULL)));
+      break;
+    }
+    case spv::OpVectorExtractDynamic: {
+      const auto& v = arg(0);
+      const uint32_t index = GetScalar(ops[1]);
+      out->assign(1, index < v.size() ? v[index] : 0);
+      break;
+    }
+    case spv::OpVectorInsertDynamic: {
+      const uint32_t index = GetScalar(ops[2]);
+      *out = arg(0);
+      if (index < out->size())
+        (*out)[index] = GetScalar(ops[1]);
+      break;
+    }
+    case spv::OpVectorShuffle: {
+      const auto& a = arg(0);
+      const auto& b = arg(1);
+      out->resize(ops.size() - 2);
+      for (size_t i = 2; i < ops.size(); ++i) {
+        const uint32_t c = ops[i];
+        uint32_t value = 0;
+        if (c < a.size())
+          value = a[c];
+        else if (c != 0xffffffff && c - a.size() < b.size())
+          value = b[c - a.size()];
+        (*out)[i - 2] = value;
+      }
+      break;
+    }
+    case spv::OpCompositeConstruct:
+      out->clear();
+      for (size_t i = 0; i < ops.size(); ++i)
+        out->insert(out->end(), arg(i).begin(), arg(i).end());
+      break;
+    case spv::OpCompositeExtract: {
+      const auto& composite = arg(0);
+      uint32_t offset = 0;
+      uint32_t words = 0;
+      Result r = GetCompositeOffset(program_->GetValueType(ops[0]), ops, 1,
+                                    &offset, &words);
+      if (!r.IsSuccess())
+        return r;
+      if (offset + words > composite.size())
+        return Result("CPU: invalid OpCompositeExtract");
+      out->assign(composite.begin() + offset,
+                  composite.begin() + offset + words);
+      break;
+    }
+    case spv::OpCompositeInsert: {
+      const auto& object = arg(0);
+      uint32_t offset = 0;
+      uint32_t words = 0;
+      Result r = GetCompositeOffset(program_->GetValueType(ops[1]), ops, 2,
+                                    &offset, &words);
+      if (!r.IsSuccess())
+        return r;
+      *out = arg(1);
+      if (words != object.size() || offset + words > out->size())
+        return Result("CPU: invalid OpCompositeInsert");
+      std::copy(object.begin(), object.end(), out->begin() + offset);
+      break;
+    }
+    case spv::OpCopyObject:
+      slots_[inst.result] = slots_[ops[0] < slots_.size() ? ops[0] : 0];
+      break;
+    case spv::OpConvertFToU:
+      Map1(arg(0), out, ConvertFToU);
+      break;
+    case spv::OpConvertFToS:
+      Map1(arg(0), out, ConvertFToS);
+      break;
+    case spv::OpConvertSToF:
+      Map1(arg(0), out, [](uint32_t x) {
+        return FromFloat(static_cast<float>(ToInt(x)));
+      });
+      break;
+    case spv::OpConvertUToF:
+      Map1(arg(0), out,
+           [](uint32_t x) { return FromFloat(static_cast<float>(x)); });
+      break;
+    case spv::OpBitcast:
+      *out = arg(0);
+      break;
+    case spv::OpSNegate:
+      Map1(arg(0), out, [](uint32_t x) { return 0U - x; });
+      break;
+    case spv::OpFNegate:
+      Map1(arg(0), out, [](uint32_t x) { return FromFloat(-ToFloat(x)); });
+      break;
+    case spv::OpNot:
+      Map1(arg(0), out, [](uint32_t x) { return ~x; });
+      break;
+    case spv::OpBitCount:
+      Map1(arg(0), out, BitCount);
+      break;
+    case spv::OpLogicalNot:
+      Map1(arg(0), out, [](uint32_t x) { return FromBool(x == 0); });
+      break;
+    case spv::OpIsNan:
+      Map1(arg(0), out,
+           [](uint32_t x) { return FromBool(std::isnan(ToFloat(x))); });
+      break;
+    case spv::OpIsInf:
+      Map1(arg(0), out,
+           [](uint32_t x) { return FromBool(std::isinf(ToFloat(x))); });
+      break;
+    case spv::OpIAdd:
+      ok = Map2(arg(0), arg(1), out,
+                [](uint32_t x, uint32_t y) { return x + y; });
+      break;
+    case spv::OpISub:
+      ok = Map2(arg(0), arg(1), out,
+                [](uint32_t x, uint32_t y) { return x - y; });
+      break;
+    case spv::OpIMul:
+      ok = Map2(arg(0), arg(1), out,
+                [](uint32_t x, uint32_t y) { return x * y; });
+      break;
+    case spv::OpUDiv:
+      ok = Map2(arg(0), arg(1), out,
+                [](uint32_t x, uint32_t y) { return y == 0 ? 0 : x / y; });
+      break;
+    case spv::OpUMod:
+      ok = Map2(arg(0), arg(1), out,
+                [](uint32_t x, uint32_t y) { return y == 0 ? 0 : x % y; });
+      break;
+    case spv::OpSDiv:
+      ok = Map2(arg(0), arg(1), out, SDiv);
+      break;
+    case spv::OpSRem:
+      ok = Map2(arg(0), arg(1), out, SRem);
+      break;
+    case spv::OpSMod:
+      ok = Map2(arg(0), arg(1), out, SMod);
+      break;
+    case spv::OpFAdd:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return FromFloat(ToFloat(x) + ToFloat(y));
+      });
+      break;
+    case spv::OpFSub:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return FromFloat(ToFloat(x) - ToFloat(y));
+      });
+      break;
+    case spv::OpFMul:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return FromFloat(ToFloat(x) * ToFloat(y));
+      });
+      break;
+    case spv::OpFDiv:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return FromFloat(ToFloat(x) / ToFloat(y));
+      });
+      break;
+    case spv::OpFRem:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return FromFloat(std::fmod(ToFloat(x), ToFloat(y)));
+      });
+      break;
+    case spv::OpFMod:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        const float a = ToFloat(x);
+        const float b = ToFloat(y);
+        return FromFloat(a - b * std::floor(a / b));
+      });
+      break;
+    case spv::OpVectorTimesScalar: {
+      const float scalar = ToFloat(GetScalar(ops[1]));
+      Map1(arg(0), out, [scalar](uint32_t x) {
+        return FromFloat(ToFloat(x) * scalar);
+      });
+      break;
+    }
+    case spv::OpDot: {
+      const auto& a = arg(0);
+      const auto& b = arg(1);
+      if (a.size() != b.size())
+        return Result("CPU: mismatched operands of OpDot");
+      float sum = 0.0f;
+      for (size_t i = 0; i < a.size(); ++i)
+        sum += ToFloat(a[i]) * ToFloat(b[i]);
+      out->assign(1, FromFloat(sum));
+      break;
+    }
+    case spv::OpAny:
+    case spv::OpAll: {
+      const bool is_all = inst.opcode == spv::OpAll;
+      bool value = is_all;
+      for (uint32_t component : arg(0)) {
+        if ((component != 0) != is_all) {
+          value = !is_all;
+          break;
+        }
+      }
+      out->assign(1, FromBool(value));
+      break;
+    }
+    case spv::OpLogicalEqual:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return FromBool((x != 0) == (y != 0));
+      });
+      break;
+    case spv::OpLogicalNotEqual:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return FromBool((x != 0) != (y != 0));
+      });
+      break;
+    case spv::OpLogicalOr:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return FromBool(x != 0 || y != 0);
+      });
+      break;
+    case spv::OpLogicalAnd:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return FromBool(x != 0 && y != 0);
+      });
+      break;
+    case spv::OpSelect: {
+      const auto& cond = arg(0);
+      if (cond.size() == 1) {
+        const uint32_t id = cond[0] != 0 ? ops[1] : ops[2];
+        slots_[inst.result] = slots_[id < slots_.size() ? id : 0];
+        break;
+      }
+      ok = Map3(cond, arg(1), arg(2), out,
+                [](uint32_t c, uint32_t x, uint32_t y) { return c ? x : y; });
+      break;
+    }
+    case spv::OpIEqual:
+      ok = Map2(arg(0), arg(1), out,
+                [](uint32_t x, uint32_t y) { return FromBool(x == y); });
+      break;
+    case spv::OpINotEqual:
+      ok = Map2(arg(0), arg(1), out,
+                [](uint32_t x, uint32_t y) { return FromBool(x != y); });
+      break;
+    case spv::OpUGreaterThan:
+      ok = Map2(arg(0), arg(1), out,
+                [](uint32_t x, uint32_t y) { return FromBool(x > y); });
+      break;
+    case spv::OpUGreaterThanEqual:
+      ok = Map2(arg(0), arg(1), out,
+                [](uint32_t x, uint32_t y) { return FromBool(x >= y); });
+      break;
+    case spv::OpULessThan:
+      ok = Map2(arg(0), arg(1), out,
+                [](uint32_t x, uint32_t y) { return FromBool(x < y); });
+      break;
+    case spv::OpULessThanEqual:
+      ok = Map2(arg(0), arg(1), out,
+                [](uint32_t x, uint32_t y) { return FromBool(x <= y); });
+      break;
+    case spv::OpSGreaterThan:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return FromBool(ToInt(x) > ToInt(y));
+      });
+      break;
+    case spv::OpSGreaterThanEqual:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return FromBool(ToInt(x) >= ToInt(y));
+      });
+      break;
+    case spv::OpSLessThan:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return FromBool(ToInt(x) < ToInt(y));
+      });
+      break;
+    case spv::OpSLessThanEqual:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return FromBool(ToInt(x) <= ToInt(y));
+      });
+      break;
+    case spv::OpFOrdEqual:
+    case spv::OpFUnordEqual:
+    case spv::OpFOrdNotEqual:
+    case spv::OpFUnordNotEqual:
+    case spv::OpFOrdLessThan:
+    case spv::OpFUnordLessThan:
+    case spv::OpFOrdGreaterThan:
+    case spv::OpFUnordGreaterThan:
+    case spv::OpFOrdLessThanEqual:
+    case spv::OpFUnordLessThanEqual:
+    case spv::OpFOrdGreaterThanEqual:
+    case spv::OpFUnordGreaterThanEqual: {
+      const uint32_t opcode = inst.opcode;
+      // Unordered comparisons are the odd opcodes of the range.
+      const bool unordered = (opcode - spv::OpFOrdEqual) % 2 == 1;
+      ok = Map2(arg(0), arg(1), out, [opcode, unordered](uint32_t x,
+                                                         uint32_t y) {
+        const float a = ToFloat(x);
+        const float b = ToFloat(y);
+        if (std::isnan(a) || std::isnan(b))
+          return FromBool(unordered);
+        switch (opcode) {
+          case spv::OpFOrdEqual:
+          case spv::OpFUnordEqual:
+            return FromBool(!(a < b) && !(a > b));
+          case spv::OpFOrdNotEqual:
+          case spv::OpFUnordNotEqual:
+            return FromBool(a < b || a > b);
+          case spv::OpFOrdLessThan:
+          case spv::OpFUnordLessThan:
+            return FromBool(a < b);
+          case spv::OpFOrdGreaterThan:
+          case spv::OpFUnordGreaterThan:
+            return FromBool(a > b);
+          case spv::OpFOrdLessThanEqual:
+          case spv::OpFUnordLessThanEqual:
+            return FromBool(a <= b);
+          default:
+            return FromBool(a >= b);
+        }
+      });
+      break;
+    }
+    case spv::OpShiftRightLogical:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return y >= 32 ? 0U : x >> y;
+      });
+      break;
+    case spv::OpShiftRightArithmetic:
+      ok = Map2(arg(0), arg(1), out, ShiftRightArithmetic);
+      break;
+    case spv::OpShiftLeftLogical:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return y >= 32 ? 0U : x << y;
+      });
+      break;
+    case spv::OpBitwiseOr:
+      ok = Map2(arg(0), arg(1), out,
+                [](uint32_t x, uint32_t y) { return x | y; });
+      break;
+    case spv::OpBitwiseXor:
+      ok = Map2(arg(0), arg(1), out,
+                [](uint32_t x, uint32_t y) { return x ^ y; });
+      break;
+    case spv::OpBitwiseAnd:
+      ok = Map2(arg(0), arg(1), out,
+                [](uint32_t x, uint32_t y) { return x & y; });
+      break;
+    case spv::OpAtomicLoad:
+    case spv::OpAtomicStore:
+    case spv::OpAtomicExchange:
+    case spv::OpAtomicCompareExchange:
+    case spv::OpAtomicIIncrement:
+    case spv::OpAtomicIDecrement:
+    case spv::OpAtomicIAdd:
+    case spv::OpAtomicISub:
+    case spv::OpAtomicSMin:
+    case spv::OpAtomicUMin:
+    case spv::OpAtomicSMax:
+    case spv::OpAtomicUMax:
+    case spv::OpAtomicAnd:
+    case spv::OpAtomicOr:
+    case spv::OpAtomicXor:
+      return Atomic(inst, state, out);
+    default:
+      return GroupOp(inst, out);
+  }
+
+  if (!ok) {
+    return Result("CPU: mismatched operand sizes for SPIR-V opcode " +
+                  std::to_string(inst.opcode));
+  }
+  return {};
+}
+
+Result Invocation::ExtInst(const Instruction& inst,
+                           std::vector<uint32_t>* out) const {
+  const auto& ops = inst.operands;
+  if (ops.size() < 3 || ops[0] != program_->GetGlslStd450())
+    return Result("CPU: unsupported extended instruction set");
+
+  auto arg = [this, &ops](size_t i) -> const std::vector<uint32_t>& {
+    return Get(i + 2 < ops.size() ? ops[i + 2] : 0);
+  };
+  auto unary = [&arg, out](float (*f)(float)) {
+    Map1(arg(0), out, [f](uint32_t x) { return FromFloat(f(ToFloat(x))); });
+    return true;
+  };
+
+  bool ok = true;
+  switch (ops[1]) {
+    case spv::GLSLstd450Round:
+      ok = unary([](float x) { return std::round(x); });
+      break;
+    case spv::GLSLstd450RoundEven:
+      ok = unary([](float x) { return std::nearbyint(x); });
+      break;
+    case spv::GLSLstd450Trunc:
+      ok = unary([](float x) { return std::trunc(x); });
+      break;
+    case spv::GLSLstd450FAbs:
+      ok = unary([](float x) { return std::fabs(x); });
+      break;
+    case spv::GLSLstd450FSign:
+      ok = unary([](float x) {
+        return x > 0.0f ? 1.0f : (x < 0.0f ? -1.0f : 0.0f);
+      });
+      break;
+    case spv::GLSLstd450Floor:
+      ok = unary([](float x) { return std::floor(x); });
+      break;
+    case spv::GLSLstd450Ceil:
+      ok = unary([](float x) { return std::ceil(x); });
+      break;
+    case spv::GLSLstd450Fract:
+      ok = unary([](float x) { return x - std::floor(x); });
+      break;
+    case spv::GLSLstd450Sin:
+      ok = unary([](float x) { return std::sin(x); });
+      break;
+    case spv::GLSLstd450Cos:
+      ok = unary([](float x) { return std::cos(x); });
+      break;
+    case spv::GLSLstd450Tan:
+      ok = unary([](float x) { return std::tan(x); });
+      break;
+    case spv::GLSLstd450Exp:
+      ok = unary([](float x) { return std::exp(x); });
+      break;
+    case spv::GLSLstd450Log:
+      ok = unary([](float x) { return std::log(x); });
+      break;
+    case spv::GLSLstd450Exp2:
+      ok = unary([](float x) { return std::exp2(x); });
+      break;
+    case spv::GLSLstd450Log2:
+      ok = unary([](float x) { return std::log2(x); });
+      break;
+    case spv::GLSLstd450Sqrt:
+      ok = unary([](float x) { return std::sqrt(x); });
+      break;
+    case spv::GLSLstd450InverseSqrt:
+      ok = unary([](float x) { return 1.0f / std::sqrt(x); });
+      break;
+    case spv::GLSLstd450SAbs:
+      Map1(arg(0), out, [](uint32_t x) {
+        return ToInt(x) < 0 ? 0U - x : x;
+      });
+      break;
+    case spv::GLSLstd450SSign:
+      Map1(arg(0), out, [](uint32_t x) {
+        return FromInt(ToInt(x) > 0 ? 1 : (ToInt(x) < 0 ? -1 : 0));
+      });
+      break;
+    case spv::GLSLstd450Pow:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return FromFloat(std::pow(ToFloat(x), ToFloat(y)));
+      });
+      break;
+    case spv::GLSLstd450FMin:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return FromFloat(std::fmin(ToFloat(x), ToFloat(y)));
+      });
+      break;
+    case spv::GLSLstd450FMax:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return FromFloat(std::fmax(ToFloat(x), ToFloat(y)));
+      });
+      break;
+    case spv::GLSLstd450UMin:
+      ok = Map2(arg(0), arg(1), out,
+                [](uint32_t x, uint32_t y) { return x < y ? x : y; });
+      break;
+    case spv::GLSLstd450UMax:
+      ok = Map2(arg(0), arg(1), out,
+                [](uint32_t x, uint32_t y) { return x > y ? x : y; });
+      break;
+    case spv::GLSLstd450SMin:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return ToInt(x) < ToInt(y) ? x : y;
+      });
+      break;
+    case spv::GLSLstd450SMax:
+      ok = Map2(arg(0), arg(1), out, [](uint32_t x, uint32_t y) {
+        return ToInt(x) > ToInt(y) ? x : y;
+      });
+      break;
+    case spv::GLSLstd450FClamp:
+      ok = Map3(arg(0), arg(1), arg(2), out,
+                [](uint32_t x, uint32_t lo, uint32_t hi) {
+                  return FromFloat(std::fmin(
+                      std::fmax(ToFloat(x), ToFloat(lo)), ToFloat(hi)));
+                });
+      break;
+    case spv::GLSLstd450UClamp:
+      ok = Map3(arg(0), arg(1), arg(2), out,
+                [](uint32_t x, uint32_t lo, uint32_t hi) {
+                  const uint32_t v = x > lo ? x : lo;
+                  return v < hi ? v : hi;
+                });
+      break;
+    case spv::GLSLstd450SClamp:
+      ok = Map3(arg(0), arg(1), arg(2), out,
+                [](uint32_t x, uint32_t lo, uint32_t hi) {
+                  const int32_t v = ToInt(x) > ToInt(lo) ? ToInt(x)
+                                                         : ToInt(lo);
+                  return FromInt(v < ToInt(hi) ? v : ToInt(hi));
+                });
+      break;
+    case spv::GLSLstd450FMix:
+      ok = Map3(arg(0), arg(1), arg(2), out,
+                [](uint32_t x, uint32_t y, uint32_t a) {
+                  const float t = ToFloat(a);
+                  return FromFloat(ToFloat(x) * (1.0f - t) + ToFloat(y) * t);
+                });
+      break;
+    case spv::GLSLstd450Fma:
+      ok = Map3(arg(0), arg(1), arg(2), out,
+                [](uint32_t a, uint32_t b, uint32_t c) {
+                  return FromFloat(
+                      std::fma(ToFloat(a), ToFloat(b), ToFloat(c)));
+                });
+      break;
+    default:
+      return Result("CPU: unsupported GLSL.std.450 instruction " +
+                    std::to_string(ops[1]));
+  }
+
+  if (!ok)
+    return Result("CPU: mismatched operand sizes for GLSL.std.450 "
+                  "instruction " + std::to_string(ops[1]));
+  return {};
+}
+
+Result Invocation::Atomic(const Instruction& inst,
+                          const DispatchState& state,
+                          std::vector<uint32_t>* out) {
+  const auto& ops = inst.operands;
+  const Pointer& ptr = GetPointer(ops[0]);
+  if (program_->GetType(ptr.type).words != 1)
+    return Result("CPU: atomic operations need a scalar pointer");
+
+  std::unique_lock<std::mutex> lock;
+  if (ptr.data && state.atomic_mutex)
+    lock = std::unique_lock<std::mutex>(*state.atomic_mutex);
+
+  std::vector<uint32_t> old_value;
+  Result r = Load(ptr, &old_value);
+  if (!r.IsSuccess())
+    return r;
+
+  const uint32_t old = old_value[0];
+  // The value operand follows the pointer, scope and semantics operands,
+  // and for OpAtomicCompareExchange the second semantics operand.
+  const uint32_t value =
+      GetScalar(ops[inst.opcode == spv::OpAtomicCompareExchange ? 4 : 3]);
+  uint32_t new_value = old;
+  switch (inst.opcode) {
+    case spv::OpAtomicLoad:
+      break;
+    case spv::OpAtomicStore:
+    case spv::OpAtomicExchange:
+      new_value = value;
+      break;
+    case spv::OpAtomicCompareExchange:
+      if (old == GetScalar(ops[5]))
+        new_value = value;
+      break;
+    case spv::OpAtomicIIncrement:
+      new_value = old + 1;
+      break;
+    case spv::OpAtomicIDecrement:
+      new_value = old - 1;
+      break;
+    case spv::OpAtomicIAdd:
+      new_value = old + value;
+      break;
+    case spv::OpAtomicISub:
+      new_value = old - value;
+      break;
+    case spv::OpAtomicSMin:
+      new_value = ToInt(value) < ToInt(old) ? value : old;
+      break;
+    case spv::OpAtomicUMin:
+      new_value = value < old ? value : old;
+      break;
+    case spv::OpAtomicSMax:
+      new_value = ToInt(value) > ToInt(old) ? value : old;
+      break;
+    case spv::OpAtomicUMax:
+      new_value = value > old ? value : old;
+      break;
+    case spv::OpAtomicAnd:
+      new_value = old & value;
+      break;
+    case spv::OpAtomicOr:
+      new_value = old | value;
+      break;
+    default:
+      new_value = old ^ value;
+      break;
+  }
+
+  if (new_value != old || inst.opcode == spv::OpAtomicStore) {
+    r = Store(ptr, std::vector<uint32_t>(1, new_value));
+    if (!r.IsSuccess())
+      return r;
+  }
+  if (inst.opcode != spv::OpAtomicStore)
+    out->assign(1, old);
+  return {};
+}
+
+Result Invocation::GroupOp(const Instruction& inst,
+                           std::vector<uint32_t>* out) const {
+  // Every subgroup has a single invocation, so each operation returns the
+  // value of the invocation itself.
+  const auto& ops = inst.operands;
+  switch (inst.opcode) {
+    case spv::OpGroupNonUniformElect:
+    case spv::OpGroupNonUniformAllEqual:
+      out->assign(1, 1);
+      return {};
+    case spv::OpGroupNonUniformAll:
+    case spv::OpGroupNonUniformAny:
+    case spv::OpGroupNonUniformBroadcast:
+    case spv::OpGroupNonUniformBroadcastFirst:
+      *out = Get(ops[1]);
+      return {};
+    case spv::OpGroupNonUniformBallot:
+      out->assign(4, 0);
+      (*out)[0] = FromBool(GetScalar(ops[1]) != 0);
+      return {};
+    default:
+      break;
+  }
+
+  // The remaining operations are the arithmetic ones.
+  if (ops.size() < 3)
+    return Result("CPU: unsupported SPIR-V opcode " +
+                  std::to_string(inst.opcode));
+  if (ops[1] == spv::GroupOperationExclusiveScan)
+    out->assign(Get(ops[2]).size(), GetIdentity(inst.opcode));
+  else
+    *out = Get(ops[2]);
+  return {};
+}
+
+}  // namespace cpu
+}  // namespace amber
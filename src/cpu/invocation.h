@@ -0,0 +1,138 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_CPU_INVOCATION_H_
+#define SRC_CPU_INVOCATION_H_
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "amber/result.h"
+#include "src/cpu/program.h"
+
+namespace amber {
+namespace cpu {
+
+/// Memory bound to a buffer variable.
+struct BufferBinding {
+  uint8_t* data = nullptr;
+  uint64_t size = 0;
+};
+
+/// State shared by all invocations of a dispatch.
+struct DispatchState {
+  DispatchState();
+  ~DispatchState();
+
+  /// The memory of each buffer variable of the program, indexed by the id
+  /// of the variable.
+  std::vector<BufferBinding> buffers;
+  uint32_t workgroup_count[3] = {1, 1, 1};
+  /// Serializes atomic operations on buffer memory.
+  std::mutex* atomic_mutex = nullptr;
+  /// Invocations still running at this time fail, so a shader which never
+  /// returns cannot hang the engine.
+  std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::time_point::max();
+};
+
+/// Runs invocations of a Program, one at a time. The values of the running
+/// invocation are kept in the Invocation, so each thread needs its own.
+///
+/// The program is expected to be valid SPIR-V. Reads outside of a buffer
+/// return zero and writes outside of a buffer are dropped. A subgroup holds
+/// a single invocation.
+class Invocation {
+ public:
+  explicit Invocation(const Program* program);
+  ~Invocation();
+
+  /// Runs the invocation |local_id| of the work group |workgroup_id|. Both
+  /// have three dimensions. Fails if it is still running at the deadline of
+  /// |state|.
+  Result Run(const DispatchState& state,
+             const uint32_t* workgroup_id,
+             const uint32_t* local_id);
+
+ private:
+  /// A pointer into a buffer, or into the memory of the invocation when
+  /// |data| is nullptr. |offset| is in bytes for buffers and in words for
+  /// invocation memory.
+  struct Pointer {
+    uint8_t* data = nullptr;
+    uint64_t size = 0;
+    uint64_t offset = 0;
+    /// The type pointed to.
+    uint32_t type = 0;
+  };
+
+  struct Slot {
+    Slot();
+    Slot(const Slot&);
+    ~Slot();
+
+    Slot& operator=(const Slot&);
+
+    std::vector<uint32_t> words;
+    Pointer ptr;
+  };
+
+  void InitializeVariables(const DispatchState& state,
+                           const uint32_t* workgroup_id,
+                           const uint32_t* local_id);
+  const std::vector<uint32_t>& Get(uint32_t id) const;
+  uint32_t GetScalar(uint32_t id) const;
+  const Pointer& GetPointer(uint32_t id) const;
+  Result Execute(const Instruction& inst, const DispatchState& state);
+  void Branch(uint32_t target, size_t* pc);
+
+  Result Load(const Pointer& ptr, std::vector<uint32_t>* value) const;
+  Result Store(const Pointer& ptr, const std::vector<uint32_t>& value);
+  void ReadBuffer(const Pointer& ptr,
+                  uint64_t offset,
+                  uint32_t type,
+                  uint32_t* value) const;
+  void WriteBuffer(const Pointer& ptr,
+                   uint64_t offset,
+                   uint32_t type,
+                   const uint32_t* value);
+  Result AccessChain(const Instruction& inst, Pointer* result) const;
+  Result GetCompositeOffset(uint32_t type,
+                            const std::vector<uint32_t>& indices,
+                            size_t first,
+                            uint32_t* offset,
+                            uint32_t* words) const;
+  Result ExtInst(const Instruction& inst, std::vector<uint32_t>* out) const;
+  Result Atomic(const Instruction& inst,
+                const DispatchState& state,
+                std::vector<uint32_t>* out);
+  Result GroupOp(const Instruction& inst, std::vector<uint32_t>* out) const;
+
+  const Program* program_ = nullptr;
+  std::vector<Slot> slots_;
+  std::vector<uint32_t> locals_;
+  std::vector<std::pair<uint32_t, Slot>> phi_values_;
+  uint32_t current_label_ = 0;
+  uint32_t previous_label_ = 0;
+  /// Branches taken by all runs, the deadline is checked every so often.
+  uint32_t branch_count_ = 0;
+};
+
+}  // namespace cpu
+}  // namespace amber
+
+#endif  // SRC_CPU_INVOCATION_H_
@@ -0,0 +1,731 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/cpu/program.h"
+
+#include <limits>
+
+#include "src/cpu/spirv.h"
+
+namespace amber {
+namespace cpu {
+namespace {
+
+const size_t kNoLabel = std::numeric_limits<size_t>::max();
+
+// Largest value, in words, the interpreter is willing to handle.
+const uint64_t kMaxValueWords = 1 << 24;
+
+// Returns the literal string starting at |words|, at most |count| words long.
+std::string GetString(const uint32_t* words, uint32_t count) {
+  std::string str;
+  for (uint32_t i = 0; i < count; ++i) {
+    for (uint32_t b = 0; b < 4; ++b) {
+      char c = static_cast<char>((words[i] >> (b * 8)) & 0xff);
+      if (c == '\0')
+        return str;
+      str.push_back(c);
+    }
+  }
+  return str;
+}
+
+bool IsSupportedBuiltIn(uint32_t builtin) {
+  switch (builtin) {
+    case spv::BuiltInNumWorkgroups:
+    case spv::BuiltInWorkgroupId:
+    case spv::BuiltInLocalInvocationId:
+    case spv::BuiltInGlobalInvocationId:
+    case spv::BuiltInLocalInvocationIndex:
+    case spv::BuiltInSubgroupSize:
+    case spv::BuiltInNumSubgroups:
+    case spv::BuiltInSubgroupId:
+    case spv::BuiltInSubgroupLocalInvocationId:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns true for the opcodes which have neither a result type nor a
+// result id.
+bool HasNoResult(uint32_t opcode) {
+  switch (opcode) {
+    case spv::OpNop:
+    case spv::OpStore:
+    case spv::OpCopyMemory:
+    case spv::OpSelectionMerge:
+    case spv::OpLoopMerge:
+    case spv::OpBranch:
+    case spv::OpBranchConditional:
+    case spv::OpSwitch:
+    case spv::OpReturn:
+    case spv::OpReturnValue:
+    case spv::OpKill:
+    case spv::OpUnreachable:
+    case spv::OpAtomicStore:
+    case spv::OpMemoryBarrier:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns true for the opcodes the interpreter can execute inside a
+// function.
+bool IsSupportedInFunction(uint32_t opcode) {
+  switch (opcode) {
+    case spv::OpNop:
+    case spv::OpUndef:
+    case spv::OpExtInst:
+    case spv::OpVariable:
+    case spv::OpLoad:
+    case spv::OpStore:
+    case spv::OpCopyMemory:
+    case spv::OpAccessChain:
+    case spv::OpInBoundsAccessChain:
+    case spv::OpArrayLength:
+    case spv::OpVectorExtractDynamic:
+    case spv::OpVectorInsertDynamic:
+    case spv::OpVectorShuffle:
+    case spv::OpCompositeConstruct:
+    case spv::OpCompositeExtract:
+    case spv::OpCompositeInsert:
+    case spv::OpCopyObject:
+    case spv::OpConvertFToU:
+    case spv::OpConvertFToS:
+    case spv::OpConvertSToF:
+    case spv::OpConvertUToF:
+    case spv::OpBitcast:
+    case spv::OpSNegate:
+    case spv::OpFNegate:
+    case spv::OpIAdd:
+    case spv::OpFAdd:
+    case spv::OpISub:
+    case spv::OpFSub:
+    case spv::OpIMul:
+    case spv::OpFMul:
+    case spv::OpUDiv:
+    case spv::OpSDiv:
+    case spv::OpFDiv:
+    case spv::OpUMod:
+    case spv::OpSRem:
+    case spv::OpSMod:
+    case spv::OpFRem:
+    case spv::OpFMod:
+    case spv::OpVectorTimesScalar:
+    case spv::OpDot:
+    case spv::OpAny:
+    case spv::OpAll:
+    case spv::OpIsNan:
+    case spv::OpIsInf:
+    case spv::OpLogicalEqual:
+    case spv::OpLogicalNotEqual:
+    case spv::OpLogicalOr:
+    case spv::OpLogicalAnd:
+    case spv::OpLogicalNot:
+    case spv::OpSelect:
+    case spv::OpIEqual:
+    case spv::OpINotEqual:
+    case spv::OpUGreaterThan:
+    case spv::OpSGreaterThan:
+    case spv::OpUGreaterThanEqual:
+    case spv::OpSGreaterThanEqual:
+    case spv::OpULessThan:
+    case spv::OpSLessThan:
+    case spv::OpULessThanEqual:
+    case spv::OpSLessThanEqual:
+    case spv::OpFOrdEqual:
+    case spv::OpFUnordEqual:
+    case spv::OpFOrdNotEqual:
+    case spv::OpFUnordNotEqual:
+    case spv::OpFOrdLessThan:
+    case spv::OpFUnordLessThan:
+    case spv::OpFOrdGreaterThan:
+    case spv::OpFUnordGreaterThan:
+    case spv::OpFOrdLessThanEqual:
+    case spv::OpFUnordLessThanEqual:
+    case spv::OpFOrdGreaterThanEqual:
+    case spv::OpFUnordGreaterThanEqual:
+    case spv::OpShiftRightLogical:
+    case spv::OpShiftRightArithmetic:
+    case spv::OpShiftLeftLogical:
+    case spv::OpBitwiseOr:
+    case spv::OpBitwiseXor:
+    case spv::OpBitwiseAnd:
+    case spv::OpNot:
+    case spv::OpBitCount:
+    case spv::OpMemoryBarrier:
+    case spv::OpAtomicLoad:
+    case spv::OpAtomicStore:
+    case spv::OpAtomicExchange:
+    case spv::OpAtomicCompareExchange:
+    case spv::OpAtomicIIncrement:
+    case spv::OpAtomicIDecrement:
+    case spv::OpAtomicIAdd:
+    case spv::OpAtomicISub:
+    case spv::OpAtomicSMin:
+    case spv::OpAtomicUMin:
+    case spv::OpAtomicSMax:
+    case spv::OpAtomicUMax:
+    case spv::OpAtomicAnd:
+    case spv::OpAtomicOr:
+    case spv::OpAtomicXor:
+    case spv::OpPhi:
+    case spv::OpLoopMerge:
+    case spv::OpSelectionMerge:
+    case spv::OpLabel:
+    case spv::OpBranch:
+    case spv::OpBranchConditional:
+    case spv::OpSwitch:
+    case spv::OpKill:
+    case spv::OpReturn:
+    case spv::OpReturnValue:
+    case spv::OpUnreachable:
+    case spv::OpGroupNonUniformElect:
+    case spv::OpGroupNonUniformAll:
+    case spv::OpGroupNonUniformAny:
+    case spv::OpGroupNonUniformAllEqual:
+    case spv::OpGroupNonUniformBroadcast:
+    case spv::OpGroupNonUniformBroadcastFirst:
+    case spv::OpGroupNonUniformBallot:
+    case spv::OpGroupNonUniformIAdd:
+    case spv::OpGroupNonUniformFAdd:
+    case spv::OpGroupNonUniformIMul:
+    case spv::OpGroupNonUniformFMul:
+    case spv::OpGroupNonUniformSMin:
+    case spv::OpGroupNonUniformUMin:
+    case spv::OpGroupNonUniformFMin:
+    case spv::OpGroupNonUniformSMax:
+    case spv::OpGroupNonUniformUMax:
+    case spv::OpGroupNonUniformFMax:
+    case spv::OpGroupNonUniformBitwiseAnd:
+    case spv::OpGroupNonUniformBitwiseOr:
+    case spv::OpGroupNonUniformBitwiseXor:
+    case spv::OpGroupNonUniformLogicalAnd:
+    case spv::OpGroupNonUniformLogicalOr:
+    case spv::OpGroupNonUniformLogicalXor:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+Type::Type() = default;
+
+Type::Type(const Type&) = default;
+
+Type::~Type() = default;
+
+Type& Type::operator=(const Type&) = default;
+
+Instruction::Instruction() = default;
+
+Instruction::Instruction(const Instruction&) = default;
+
+Instruction::~Instruction() = default;
+
+Instruction& Instruction::operator=(const Instruction&) = default;
+
+Program::Program() = default;
+
+Program::~Program() = default;
+
+Result Program::Parse(const std::vector<uint32_t>& binary,
+                      const std::string& entry_point,
+                      const std::map<uint32_t, uint32_t>& specialization) {
+  if (binary.size() < spv::kHeaderWordCount || binary[0] != spv::kMagicNumber)
+    return Result("CPU: shader is not a SPIR-V module");
+
+  bound_ = binary[3];
+  if (bound_ == 0 || bound_ > kMaxValueWords)
+    return Result("CPU: invalid SPIR-V id bound");
+
+  types_.assign(bound_, Type());
+  is_type_.assign(bound_, false);
+  constants_.assign(bound_, std::vector<uint32_t>());
+  is_constant_.assign(bound_, false);
+  value_types_.assign(bound_, 0);
+  decorations_.assign(bound_, Decorations());
+  label_index_.assign(bound_, kNoLabel);
+  local_offset_.assign(bound_, 0);
+
+  size_t pos = spv::kHeaderWordCount;
+  while (pos < binary.size()) {
+    const uint32_t word_count = binary[pos] >> 16;
+    const uint32_t opcode = binary[pos] & 0xffff;
+    if (word_count == 0 || pos + word_count > binary.size())
+      return Result("CPU: invalid SPIR-V instruction length");
+
+    Result r = ParseInstruction(opcode, binary.data() + pos + 1,
+                                word_count - 1, entry_point, specialization);
+    if (!r.IsSuccess())
+      return r;
+    pos += word_count;
+  }
+
+  if (!found_entry_point_) {
+    return Result("CPU: unable to find compute entry point: " +
+                  entry_point);
+  }
+  if (code_.empty() || code_[0].opcode != spv::OpLabel)
+    return Result("CPU: entry point function has no body");
+
+  // Every branch must lead to a block of the entry point function.
+  for (const auto& inst : code_) {
+    std::vector<uint32_t> targets;
+    if (inst.opcode == spv::OpBranch && !inst.operands.empty()) {
+      targets.push_back(inst.operands[0]);
+    } else if (inst.opcode == spv::OpBranchConditional &&
+               inst.operands.size() >= 3) {
+      targets.push_back(inst.operands[1]);
+      targets.push_back(inst.operands[2]);
+    } else if (inst.opcode == spv::OpSwitch && inst.operands.size() >= 2) {
+      targets.push_back(inst.operands[1]);
+      for (size_t i = 3; i < inst.operands.size(); i += 2)
+        targets.push_back(inst.operands[i]);
+    } else {
+      continue;
+    }
+    for (uint32_t target : targets) {
+      if (target >= bound_ || label_index_[target] == kNoLabel)
+        return Result("CPU: branch to an unknown block");
+    }
+  }
+  return {};
+}
+
+Result Program::CheckId(uint32_t id) const {
+  if (id == 0 || id >= bound_)
+    return Result("CPU: invalid SPIR-V id " + std::to_string(id));
+  return {};
+}
+
+uint32_t Program::AllocateLocal(uint32_t type) {
+  const uint32_t offset = local_word_count_;
+  local_word_count_ += types_[type].words;
+  return offset;
+}
+
+Result Program::ParseInstruction(
+    uint32_t opcode,
+    const uint32_t* words,
+    uint32_t count,
+    const std::string& entry_point,
+    const std::map<uint32_t, uint32_t>& specialization) {
+  // Debug instructions may appear anywhere.
+  if (opcode == spv::OpLine || opcode == spv::OpNoLine)
+    return {};
+
+  // Only the entry point function is kept.
+  if (skipping_function_ && opcode != spv::OpFunctionEnd)
+    return {};
+
+  switch (opcode) {
+    case spv::OpNop:
+    case spv::OpSourceContinued:
+    case spv::OpSource:
+    case spv::OpSourceExtension:
+    case spv::OpName:
+    case spv::OpMemberName:
+    case spv::OpString:
+    case spv::OpExtension:
+    case spv::OpMemoryModel:
+    case spv::OpCapability:
+    case spv::OpModuleProcessed:
+    case spv::OpDecorateString:
+    case spv::OpMemberDecorateString:
+      return {};
+    case spv::OpExtInstImport:
+      if (count < 1)
+        return Result("CPU: invalid OpExtInstImport");
+      if (GetString(words + 1, count - 1) == "GLSL.std.450")
+        glsl_std450_ = words[0];
+      return {};
+    case spv::OpEntryPoint:
+      if (count < 3)
+        return Result("CPU: invalid OpEntryPoint");
+      if (words[0] == spv::kExecutionModelGLCompute &&
+          GetString(words + 2, count - 2) == entry_point) {
+        entry_function_ = words[1];
+        found_entry_point_ = true;
+      }
+      return {};
+    case spv::OpExecutionMode:
+      if (count < 2)
+        return Result("CPU: invalid OpExecutionMode");
+      if (words[0] == entry_function_ &&
+          words[1] == spv::kExecutionModeLocalSize) {
+        if (count < 5)
+          return Result("CPU: invalid LocalSize execution mode");
+        for (uint32_t i = 0; i < 3; ++i)
+          local_size_[i] = words[2 + i];
+      }
+      return {};
+    case spv::OpDecorate: {
+      if (count < 2)
+        return Result("CPU: invalid OpDecorate");
+      Result r = CheckId(words[0]);
+      if (!r.IsSuccess())
+        return r;
+      Decorations& dec = decorations_[words[0]];
+      const uint32_t value = count > 2 ? words[2] : 0;
+      switch (words[1]) {
+        case spv::DecorationSpecId:
+          dec.has_spec_id = true;
+          dec.spec_id = value;
+          break;
+        case spv::DecorationArrayStride:
+          dec.array_stride = value;
+          break;
+        case spv::DecorationBuiltIn:
+          dec.has_builtin = true;
+          dec.builtin = value;
+          break;
+        case spv::DecorationBinding:
+          dec.binding = value;
+          break;
+        case spv::DecorationDescriptorSet:
+          dec.descriptor_set = value;
+          break;
+        default:
+          break;
+      }
+      return {};
+    }
+    case spv::OpMemberDecorate: {
+      if (count < 3)
+        return Result("CPU: invalid OpMemberDecorate");
+      Result r = CheckId(words[0]);
+      if (!r.IsSuccess())
+        return r;
+      if (words[2] == spv::DecorationOffset && count > 3)
+        decorations_[words[0]].member_offsets[words[1]] = words[3];
+      return {};
+    }
+    case spv::OpTypeVoid:
+    case spv::OpTypeBool:
+    case spv::OpTypeInt:
+    case spv::OpTypeFloat:
+    case spv::OpTypeVector:
+    case spv::OpTypeArray:
+    case spv::OpTypeRuntimeArray:
+    case spv::OpTypeStruct:
+    case spv::OpTypePointer:
+    case spv::OpTypeFunction:
+      return AddType(opcode, words, count);
+    case spv::OpConstantTrue:
+    case spv::OpConstantFalse:
+    case spv::OpConstant:
+    case spv::OpConstantComposite:
+    case spv::OpConstantNull:
+    case spv::OpSpecConstantTrue:
+    case spv::OpSpecConstantFalse:
+    case spv::OpSpecConstant:
+    case spv::OpSpecConstantComposite:
+      return AddConstant(opcode, words, count, specialization);
+    case spv::OpUndef:
+      if (in_entry_function_)
+        return AddCode(opcode, words, count);
+      return AddConstant(opcode, words, count, specialization);
+    case spv::OpVariable:
+      if (in_entry_function_)
+        return AddCode(opcode, words, count);
+      return AddVariable(words, count);
+    case spv::OpFunction:
+      if (count < 2)
+        return Result("CPU: invalid OpFunction");
+      in_entry_function_ = found_entry_point_ && words[1] == entry_function_;
+      skipping_function_ = !in_entry_function_;
+      return {};
+    case spv::OpFunctionEnd:
+      in_entry_function_ = false;
+      skipping_function_ = false;
+      return {};
+    default:
+      break;
+  }
+
+  if (in_entry_function_)
+    return AddCode(opcode, words, count);
+  return Result("CPU: unsupported SPIR-V opcode " + std::to_string(opcode));
+}
+
+Result Program::AddType(uint32_t opcode,
+                        const uint32_t* words,
+                        uint32_t count) {
+  if (count < 1)
+    return Result("CPU: invalid type declaration");
+  const uint32_t id = words[0];
+  Result r = CheckId(id);
+  if (!r.IsSuccess())
+    return r;
+
+  // Checks that operand |idx| is a type declared before.
+  auto operand_type = [this, words, count](uint32_t idx, uint32_t* out) {
+    if (idx >= count || words[idx] >= bound_ || !is_type_[words[idx]])
+      return false;
+    *out = words[idx];
+    return true;
+  };
+
+  Type& type = types_[id];
+  uint64_t size = 0;
+  switch (opcode) {
+    case spv::OpTypeVoid:
+      type.kind = Type::Kind::kVoid;
+      break;
+    case spv::OpTypeBool:
+      type.kind = Type::Kind::kBool;
+      size = 1;
+      break;
+    case spv::OpTypeInt:
+      if (count < 3 || words[1] != 32)
+        return Result("CPU: only 32 bit integers are supported");
+      type.kind = Type::Kind::kInt;
+      type.is_signed = words[2] != 0;
+      size = 1;
+      break;
+    case spv::OpTypeFloat:
+      if (count < 2 || words[1] != 32)
+        return Result("CPU: only 32 bit floats are supported");
+      type.kind = Type::Kind::kFloat;
+      size = 1;
+      break;
+    case spv::OpTypeVector:
+      if (!operand_type(1, &type.element) || count < 3)
+        return Result("CPU: invalid OpTypeVector");
+      type.kind = Type::Kind::kVector;
+      type.count = words[2];
+      size = static_cast<uint64_t>(type.count) * types_[type.element].words;
+      break;
+    case spv::OpTypeArray:
+      if (!operand_type(1, &type.element) || count < 3 ||
+          words[2] >= bound_ || constants_[words[2]].size() != 1) {
+        return Result("CPU: invalid OpTypeArray");
+      }
+      type.kind = Type::Kind::kArray;
+      type.count = constants_[words[2]][0];
+      type.array_stride = decorations_[id].array_stride;
+      size = static_cast<uint64_t>(type.count) * types_[type.element].words;
+      break;
+    case spv::OpTypeRuntimeArray:
+      if (!operand_type(1, &type.element))
+        return Result("CPU: invalid OpTypeRuntimeArray");
+      type.kind = Type::Kind::kRuntimeArray;
+      type.array_stride = decorations_[id].array_stride;
+      break;
+    case spv::OpTypeStruct:
+      type.kind = Type::Kind::kStruct;
+      for (uint32_t i = 1; i < count; ++i) {
+        uint32_t member = 0;
+        if (!operand_type(i, &member))
+          return Result("CPU: invalid OpTypeStruct");
+        const auto& offsets = decorations_[id].member_offsets;
+        auto it = offsets.find(i - 1);
+        type.members.push_back(member);
+        type.member_offsets.push_back(it == offsets.end() ? 0 : it->second);
+        type.member_words.push_back(static_cast<uint32_t>(size));
+        size += types_[member].words;
+      }
+      break;
+    case spv::OpTypePointer:
+      if (count < 3 || !operand_type(2, &type.element))
+        return Result("CPU: invalid OpTypePointer");
+      type.kind = Type::Kind::kPointer;
+      type.storage_class = words[1];
+      break;
+    case spv::OpTypeFunction:
+      type.kind = Type::Kind::kFunction;
+      break;
+    default:
+      return Result("CPU: unsupported SPIR-V type");
+  }
+
+  if (size > kMaxValueWords)
+    return Result("CPU: type is too large");
+  type.words = static_cast<uint32_t>(size);
+  is_type_[id] = true;
+  return {};
+}
+
+Result Program::AddConstant(
+    uint32_t opcode,
+    const uint32_t* words,
+    uint32_t count,
+    const std::map<uint32_t, uint32_t>& specialization) {
+  if (count < 2 || words[0] >= bound_ || !is_type_[words[0]])
+    return Result("CPU: invalid constant declaration");
+  const uint32_t id = words[1];
+  Result r = CheckId(id);
+  if (!r.IsSuccess())
+    return r;
+
+  const Decorations& dec = decorations_[id];
+  auto spec = specialization.end();
+  if (dec.has_spec_id)
+    spec = specialization.find(dec.spec_id);
+
+  std::vector<uint32_t>& value = constants_[id];
+  switch (opcode) {
+    case spv::OpConstantTrue:
+    case spv::OpConstantFalse:
+      value.push_back(opcode == spv::OpConstantTrue ? 1 : 0);
+      break;
+    case spv::OpSpecConstantTrue:
+    case spv::OpSpecConstantFalse:
+      if (spec != specialization.end())
+        value.push_back(spec->second != 0 ? 1 : 0);
+      else
+        value.push_back(opcode == spv::OpSpecConstantTrue ? 1 : 0);
+      break;
+    case spv::OpConstant:
+    case spv::OpSpecConstant:
+      if (count != 3)
+        return Result("CPU: only 32 bit constants are supported");
+      value.push_back(spec != specialization.end() ? spec->second : words[2]);
+      break;
+    case spv::OpConstantComposite:
+    case spv::OpSpecConstantComposite:
+      for (uint32_t i = 2; i < count; ++i) {
+        if (words[i] >= bound_ || !is_constant_[words[i]])
+          return Result("CPU: invalid constant composite");
+        value.insert(value.end(), constants_[words[i]].begin(),
+                     constants_[words[i]].end());
+      }
+      break;
+    default:
+      // OpConstantNull and OpUndef.
+      value.assign(types_[words[0]].words, 0);
+      break;
+  }
+  is_constant_[id] = true;
+  value_types_[id] = words[0];
+
+  if (dec.has_builtin && dec.builtin == spv::BuiltInWorkgroupSize) {
+    if (value.size() != 3)
+      return Result("CPU: invalid WorkgroupSize constant");
+    for (uint32_t i = 0; i < 3; ++i)
+      local_size_[i] = value[i];
+  }
+  return {};
+}
+
+Result Program::AddVariable(const uint32_t* words, uint32_t count) {
+  if (count < 3 || words[0] >= bound_ ||
+      types_[words[0]].kind != Type::Kind::kPointer) {
+    return Result("CPU: invalid OpVariable");
+  }
+  const uint32_t id = words[1];
+  Result r = CheckId(id);
+  if (!r.IsSuccess())
+    return r;
+
+  const Decorations& dec = decorations_[id];
+  Variable var;
+  var.id = id;
+  var.storage_class = words[2];
+  var.type = types_[words[0]].element;
+  var.descriptor_set = dec.descriptor_set;
+  var.binding = dec.binding;
+  if (count > 3) {
+    if (words[3] >= bound_ || !is_constant_[words[3]])
+      return Result("CPU: variable initializers must be constants");
+    var.initializer = words[3];
+  }
+
+  switch (var.storage_class) {
+    case spv::StorageClassInput:
+      if (!dec.has_builtin || !IsSupportedBuiltIn(dec.builtin)) {
+        return Result("CPU: unsupported input variable " +
+                      std::to_string(id));
+      }
+      var.builtin = dec.builtin;
+      var.local_offset = AllocateLocal(var.type);
+      break;
+    case spv::StorageClassPrivate:
+      var.local_offset = AllocateLocal(var.type);
+      break;
+    case spv::StorageClassUniform:
+    case spv::StorageClassStorageBuffer:
+    case spv::StorageClassPushConstant:
+      if (types_[var.type].kind != Type::Kind::kStruct)
+        return Result("CPU: arrays of buffers are not supported");
+      break;
+    case spv::StorageClassWorkgroup:
+      return Result("CPU: workgroup memory is not supported");
+    default:
+      return Result("CPU: unsupported storage class " +
+                    std::to_string(var.storage_class));
+  }
+  value_types_[id] = words[0];
+  variables_.push_back(var);
+  return {};
+}
+
+Result Program::AddCode(uint32_t opcode,
+                        const uint32_t* words,
+                        uint32_t count) {
+  if (opcode == spv::OpControlBarrier)
+    return Result("CPU: control barriers are not supported");
+  if (opcode == spv::OpFunctionCall)
+    return Result("CPU: function calls are not supported");
+  if (!IsSupportedInFunction(opcode))
+    return Result("CPU: unsupported SPIR-V opcode " + std::to_string(opcode));
+
+  Instruction inst;
+  inst.opcode = opcode;
+  uint32_t first_operand = 0;
+  if (opcode == spv::OpLabel) {
+    if (count < 1)
+      return Result("CPU: invalid OpLabel");
+    inst.result = words[0];
+    first_operand = 1;
+  } else if (!HasNoResult(opcode)) {
+    if (count < 2 || words[0] >= bound_ || !is_type_[words[0]])
+      return Result("CPU: invalid SPIR-V instruction");
+    inst.type = words[0];
+    inst.result = words[1];
+    first_operand = 2;
+  }
+  if (inst.result != 0) {
+    Result r = CheckId(inst.result);
+    if (!r.IsSuccess())
+      return r;
+    value_types_[inst.result] = inst.type;
+  }
+  inst.operands.assign(words + first_operand, words + count);
+
+  if (opcode == spv::OpLabel) {
+    label_index_[inst.result] = code_.size();
+  } else if (opcode == spv::OpVariable) {
+    const Type& ptr = types_[inst.type];
+    if (ptr.kind != Type::Kind::kPointer || inst.operands.empty() ||
+        inst.operands[0] != spv::StorageClassFunction) {
+      return Result("CPU: invalid function variable");
+    }
+    if (inst.operands.size() > 1 &&
+        (inst.operands[1] >= bound_ || !is_constant_[inst.operands[1]])) {
+      return Result("CPU: variable initializers must be constants");
+    }
+    local_offset_[inst.result] = AllocateLocal(ptr.element);
+  }
+  code_.push_back(std::move(inst));
+  return {};
+}
+
+}  // namespace cpu
+}  // namespace amber
@@ -0,0 +1,212 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_CPU_PROGRAM_H_
+#define SRC_CPU_PROGRAM_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "amber/result.h"
+
+namespace amber {
+namespace cpu {
+
+/// A SPIR-V type. Only 32 bit integer and float scalars are supported.
+struct Type {
+  enum class Kind : uint8_t {
+    kVoid = 0,
+    kBool,
+    kInt,
+    kFloat,
+    kVector,
+    kArray,
+    kRuntimeArray,
+    kStruct,
+    kPointer,
+    kFunction,
+  };
+
+  Type();
+  Type(const Type&);
+  ~Type();
+
+  Type& operator=(const Type&);
+
+  Kind kind = Kind::kVoid;
+  bool is_signed = false;
+  /// The component type of a vector or an array, or the pointee type of a
+  /// pointer.
+  uint32_t element = 0;
+  /// The number of components of a vector or elements of an array.
+  uint32_t count = 0;
+  /// The storage class of a pointer.
+  uint32_t storage_class = 0;
+  /// The ArrayStride decoration of an array, in bytes.
+  uint32_t array_stride = 0;
+  /// The member types of a struct.
+  std::vector<uint32_t> members;
+  /// The Offset decoration of each member of a struct, in bytes.
+  std::vector<uint32_t> member_offsets;
+  /// The position of each member of a struct in a value, in words.
+  std::vector<uint32_t> member_words;
+  /// The size of a value of this type, in 32 bit words. Values are stored
+  /// with each scalar in one word and without padding. Runtime arrays have
+  /// no size.
+  uint32_t words = 0;
+};
+
+/// An instruction of the entry point function.
+struct Instruction {
+  Instruction();
+  Instruction(const Instruction&);
+  ~Instruction();
+
+  Instruction& operator=(const Instruction&);
+
+  uint32_t opcode = 0;
+  /// The result type id, or 0.
+  uint32_t type = 0;
+  /// The result id, or 0.
+  uint32_t result = 0;
+  /// The remaining operands.
+  std::vector<uint32_t> operands;
+};
+
+/// A module scope variable.
+struct Variable {
+  uint32_t id = 0;
+  uint32_t storage_class = 0;
+  /// The type of the variable, not of the pointer to it.
+  uint32_t type = 0;
+  uint32_t descriptor_set = 0;
+  uint32_t binding = 0;
+  /// The BuiltIn decoration of an input variable.
+  uint32_t builtin = 0;
+  /// The position of Input and Private variables in invocation memory, in
+  /// words.
+  uint32_t local_offset = 0;
+  /// The id of the initializer constant, or 0.
+  uint32_t initializer = 0;
+};
+
+/// The parsed form of a SPIR-V compute shader which the CPU engine can
+/// execute.
+///
+/// Only one entry point is kept. Specialization constants are replaced by
+/// their specialized values while parsing. Parsing fails on anything the
+/// interpreter does not support, such as function calls, workgroup memory,
+/// control barriers, images or types other than 32 bit scalars.
+class Program {
+ public:
+  Program();
+  ~Program();
+
+  /// Parses |binary| for the compute entry point named |entry_point|.
+  /// |specialization| maps SpecId values to the value of the constant.
+  Result Parse(const std::vector<uint32_t>& binary,
+               const std::string& entry_point,
+               const std::map<uint32_t, uint32_t>& specialization);
+
+  /// Returns the id bound of the module. Every id is below the bound.
+  uint32_t GetBound() const { return bound_; }
+
+  /// Returns the type with |id|.
+  const Type& GetType(uint32_t id) const { return types_[id]; }
+
+  /// Returns the value of every constant, indexed by id. Non constant ids
+  /// have an empty value.
+  const std::vector<std::vector<uint32_t>>& GetConstants() const {
+    return constants_;
+  }
+
+  /// Returns the type id of the value or pointer with |id|, or 0.
+  uint32_t GetValueType(uint32_t id) const { return value_types_[id]; }
+
+  /// Returns the module scope variables.
+  const std::vector<Variable>& GetVariables() const { return variables_; }
+
+  /// Returns the instructions of the entry point function. The first
+  /// instruction is the label of the entry block.
+  const std::vector<Instruction>& GetCode() const { return code_; }
+
+  /// Returns the index in GetCode() of the label with |id|.
+  size_t GetLabelIndex(uint32_t id) const { return label_index_[id]; }
+
+  /// Returns the position in invocation memory of the function variable
+  /// with |id|, in words.
+  uint32_t GetLocalOffset(uint32_t id) const { return local_offset_[id]; }
+
+  /// Returns the number of words of memory private to an invocation.
+  uint32_t GetLocalWordCount() const { return local_word_count_; }
+
+  /// Returns the id of the GLSL.std.450 instruction set, or 0.
+  uint32_t GetGlslStd450() const { return glsl_std450_; }
+
+  /// Returns the work group size in each dimension.
+  const uint32_t* GetLocalSize() const { return local_size_; }
+
+ private:
+  struct Decorations {
+    bool has_spec_id = false;
+    uint32_t spec_id = 0;
+    uint32_t array_stride = 0;
+    bool has_builtin = false;
+    uint32_t builtin = 0;
+    uint32_t descriptor_set = 0;
+    uint32_t binding = 0;
+    std::map<uint32_t, uint32_t> member_offsets;
+  };
+
+  Result ParseInstruction(uint32_t opcode,
+                          const uint32_t* words,
+                          uint32_t count,
+                          const std::string& entry_point,
+                          const std::map<uint32_t, uint32_t>& specialization);
+  Result AddType(uint32_t opcode, const uint32_t* words, uint32_t count);
+  Result AddConstant(uint32_t opcode,
+                     const uint32_t* words,
+                     uint32_t count,
+                     const std::map<uint32_t, uint32_t>& specialization);
+  Result AddVariable(const uint32_t* words, uint32_t count);
+  Result AddCode(uint32_t opcode, const uint32_t* words, uint32_t count);
+  Result CheckId(uint32_t id) const;
+  uint32_t AllocateLocal(uint32_t type);
+
+  uint32_t bound_ = 0;
+  std::vector<Type> types_;
+  std::vector<bool> is_type_;
+  std::vector<std::vector<uint32_t>> constants_;
+  std::vector<bool> is_constant_;
+  std::vector<uint32_t> value_types_;
+  std::vector<Decorations> decorations_;
+  std::vector<Variable> variables_;
+  std::vector<Instruction> code_;
+  std::vector<size_t> label_index_;
+  std::vector<uint32_t> local_offset_;
+  uint32_t local_word_count_ = 0;
+  uint32_t glsl_std450_ = 0;
+  uint32_t local_size_[3] = {1, 1, 1};
+  uint32_t entry_function_ = 0;
+  bool found_entry_point_ = false;
+  bool in_entry_function_ = false;
+  bool skipping_function_ = false;
+};
+
+}  // namespace cpu
+}  // namespace amber
+
+#endif  // SRC_CPU_PROGRAM_H_
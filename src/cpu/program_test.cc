@@ -0,0 +1,125 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/cpu/program.h"
+
+#include <map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace amber {
+namespace cpu {
+namespace {
+
+// The module up to the entry point function:
+//
+//        OpCapability Shader
+//        OpMemoryModel Logical GLSL450
+//        OpEntryPoint GLCompute %1 "main"
+//        OpExecutionMode %1 LocalSize 8 4 2
+//   %2 = OpTypeVoid
+//   %3 = OpTypeFunction %2
+//   %4 = OpTypeInt 32 0
+//   %5 = OpTypePointer Workgroup %4
+//   %6 = OpConstant %4 2
+//   %7 = OpConstant %4 0
+const uint32_t kModuleStart[] = {
+    0x07230203, 0x00010000, 0x00000000, 0x00000010, 0x00000000, 0x00020011,
+    0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0005000f, 0x00000005,
+    0x00000001, 0x6e69616d, 0x00000000, 0x00060010, 0x00000001, 0x00000011,
+    0x00000008, 0x00000004, 0x00000002, 0x00020013, 0x00000002, 0x00030021,
+    0x00000003, 0x00000002, 0x00040015, 0x00000004, 0x00000020, 0x00000000,
+    0x00040020, 0x00000005, 0x00000004, 0x00000004, 0x0004002b, 0x00000004,
+    0x00000006, 0x00000002, 0x0004002b, 0x00000004, 0x00000007, 0x00000000,
+};
+
+//   %1 = OpFunction %2 None %3
+//   %8 = OpLabel
+const uint32_t kFunctionStart[] = {
+    0x00050036, 0x00000002, 0x00000001, 0x00000000,
+    0x00000003, 0x000200f8, 0x00000008,
+};
+
+//        OpReturn
+//        OpFunctionEnd
+const uint32_t kFunctionEnd[] = {0x000100fd, 0x00010038};
+
+std::vector<uint32_t> MakeModule(const std::vector<uint32_t>& declarations,
+                                 const std::vector<uint32_t>& body) {
+  std::vector<uint32_t> module(std::begin(kModuleStart),
+                               std::end(kModuleStart));
+  module.insert(module.end(), declarations.begin(), declarations.end());
+  module.insert(module.end(), std::begin(kFunctionStart),
+                std::end(kFunctionStart));
+  module.insert(module.end(), body.begin(), body.end());
+  module.insert(module.end(), std::begin(kFunctionEnd),
+                std::end(kFunctionEnd));
+  return module;
+}
+
+}  // namespace
+
+using ProgramTest = testing::Test;
+
+TEST_F(ProgramTest, ParseEmptyEntryPoint) {
+  Program program;
+  Result r = program.Parse(MakeModule({}, {}), "main", {});
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+
+  EXPECT_EQ(16U, program.GetBound());
+  EXPECT_EQ(8U, program.GetLocalSize()[0]);
+  EXPECT_EQ(4U, program.GetLocalSize()[1]);
+  EXPECT_EQ(2U, program.GetLocalSize()[2]);
+  ASSERT_EQ(2U, program.GetCode().size());
+  EXPECT_EQ(0U, program.GetLabelIndex(8));
+  EXPECT_EQ(std::vector<uint32_t>({2}), program.GetConstants()[6]);
+}
+
+TEST_F(ProgramTest, ParseNotSpirv) {
+  Program program;
+  Result r = program.Parse({0x12345678, 0, 0, 1, 0}, "main", {});
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("CPU: shader is not a SPIR-V module", r.Error());
+}
+
+TEST_F(ProgramTest, ParseMissingEntryPoint) {
+  Program program;
+  Result r = program.Parse(MakeModule({}, {}), "other", {});
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("CPU: unable to find compute entry point: other", r.Error());
+}
+
+TEST_F(ProgramTest, ParseWorkgroupVariable) {
+  // %9 = OpVariable %5 Workgroup
+  Program program;
+  Result r = program.Parse(
+      MakeModule({0x0004003b, 0x00000005, 0x00000009, 0x00000004}, {}),
+      "main", {});
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("CPU: workgroup memory is not supported", r.Error());
+}
+
+TEST_F(ProgramTest, ParseControlBarrier) {
+  // OpControlBarrier %6 %6 %7
+  Program program;
+  Result r = program.Parse(
+      MakeModule({}, {0x000400e0, 0x00000006, 0x00000006, 0x00000007}),
+      "main", {});
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("CPU: control barriers are not supported", r.Error());
+}
+
+}  // namespace cpu
+}  // namespace amber
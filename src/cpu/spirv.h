@@ -0,0 +1,287 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_CPU_SPIRV_H_
+#define SRC_CPU_SPIRV_H_
+
+#include <cstdint>
+
+namespace amber {
+namespace cpu {
+namespace spv {
+
+// The subset of the SPIR-V and GLSL.std.450 enumerants used by the CPU
+// engine. The SPIR-V headers are only available when SPIRV-Tools is enabled,
+// so the values are repeated here.
+
+const uint32_t kMagicNumber = 0x07230203;
+const uint32_t kHeaderWordCount = 5;
+
+enum Op : uint32_t {
+  OpNop = 0,
+  OpUndef = 1,
+  OpSourceContinued = 2,
+  OpSource = 3,
+  OpSourceExtension = 4,
+  OpName = 5,
+  OpMemberName = 6,
+  OpString = 7,
+  OpLine = 8,
+  OpExtension = 10,
+  OpExtInstImport = 11,
+  OpExtInst = 12,
+  OpMemoryModel = 14,
+  OpEntryPoint = 15,
+  OpExecutionMode = 16,
+  OpCapability = 17,
+  OpTypeVoid = 19,
+  OpTypeBool = 20,
+  OpTypeInt = 21,
+  OpTypeFloat = 22,
+  OpTypeVector = 23,
+  OpTypeArray = 28,
+  OpTypeRuntimeArray = 29,
+  OpTypeStruct = 30,
+  OpTypePointer = 32,
+  OpTypeFunction = 33,
+  OpConstantTrue = 41,
+  OpConstantFalse = 42,
+  OpConstant = 43,
+  OpConstantComposite = 44,
+  OpConstantNull = 46,
+  OpSpecConstantTrue = 48,
+  OpSpecConstantFalse = 49,
+  OpSpecConstant = 50,
+  OpSpecConstantComposite = 51,
+  OpFunction = 54,
+  OpFunctionParameter = 55,
+  OpFunctionEnd = 56,
+  OpFunctionCall = 57,
+  OpVariable = 59,
+  OpLoad = 61,
+  OpStore = 62,
+  OpCopyMemory = 63,
+  OpAccessChain = 65,
+  OpInBoundsAccessChain = 66,
+  OpArrayLength = 68,
+  OpDecorate = 71,
+  OpMemberDecorate = 72,
+  OpVectorExtractDynamic = 77,
+  OpVectorInsertDynamic = 78,
+  OpVectorShuffle = 79,
+  OpCompositeConstruct = 80,
+  OpCompositeExtract = 81,
+  OpCompositeInsert = 82,
+  OpCopyObject = 83,
+  OpConvertFToU = 109,
+  OpConvertFToS = 110,
+  OpConvertSToF = 111,
+  OpConvertUToF = 112,
+  OpBitcast = 124,
+  OpSNegate = 126,
+  OpFNegate = 127,
+  OpIAdd = 128,
+  OpFAdd = 129,
+  OpISub = 130,
+  OpFSub = 131,
+  OpIMul = 132,
+  OpFMul = 133,
+  OpUDiv = 134,
+  OpSDiv = 135,
+  OpFDiv = 136,
+  OpUMod = 137,
+  OpSRem = 138,
+  OpSMod = 139,
+  OpFRem = 140,
+  OpFMod = 141,
+  OpVectorTimesScalar = 142,
+  OpDot = 148,
+  OpAny = 154,
+  OpAll = 155,
+  OpIsNan = 156,
+  OpIsInf = 157,
+  OpLogicalEqual = 164,
+  OpLogicalNotEqual = 165,
+  OpLogicalOr = 166,
+  OpLogicalAnd = 167,
+  OpLogicalNot = 168,
+  OpSelect = 169,
+  OpIEqual = 170,
+  OpINotEqual = 171,
+  OpUGreaterThan = 172,
+  OpSGreaterThan = 173,
+  OpUGreaterThanEqual = 174,
+  OpSGreaterThanEqual = 175,
+  OpULessThan = 176,
+  OpSLessThan = 177,
+  OpULessThanEqual = 178,
+  OpSLessThanEqual = 179,
+  OpFOrdEqual = 180,
+  OpFUnordEqual = 181,
+  OpFOrdNotEqual = 182,
+  OpFUnordNotEqual = 183,
+  OpFOrdLessThan = 184,
+  OpFUnordLessThan = 185,
+  OpFOrdGreaterThan = 186,
+  OpFUnordGreaterThan = 187,
+  OpFOrdLessThanEqual = 188,
+  OpFUnordLessThanEqual = 189,
+  OpFOrdGreaterThanEqual = 190,
+  OpFUnordGreaterThanEqual = 191,
+  OpShiftRightLogical = 194,
+  OpShiftRightArithmetic = 195,
+  OpShiftLeftLogical = 196,
+  OpBitwiseOr = 197,
+  OpBitwiseXor = 198,
+  OpBitwiseAnd = 199,
+  OpNot = 200,
+  OpBitCount = 205,
+  OpControlBarrier = 224,
+  OpMemoryBarrier = 225,
+  OpAtomicLoad = 227,
+  OpAtomicStore = 228,
+  OpAtomicExchange = 229,
+  OpAtomicCompareExchange = 230,
+  OpAtomicIIncrement = 232,
+  OpAtomicIDecrement = 233,
+  OpAtomicIAdd = 234,
+  OpAtomicISub = 235,
+  OpAtomicSMin = 236,
+  OpAtomicUMin = 237,
+  OpAtomicSMax = 238,
+  OpAtomicUMax = 239,
+  OpAtomicAnd = 240,
+  OpAtomicOr = 241,
+  OpAtomicXor = 242,
+  OpPhi = 245,
+  OpLoopMerge = 246,
+  OpSelectionMerge = 247,
+  OpLabel = 248,
+  OpBranch = 249,
+  OpBranchConditional = 250,
+  OpSwitch = 251,
+  OpKill = 252,
+  OpReturn = 253,
+  OpReturnValue = 254,
+  OpUnreachable = 255,
+  OpNoLine = 317,
+  OpModuleProcessed = 330,
+  OpGroupNonUniformElect = 333,
+  OpGroupNonUniformAll = 334,
+  OpGroupNonUniformAny = 335,
+  OpGroupNonUniformAllEqual = 336,
+  OpGroupNonUniformBroadcast = 337,
+  OpGroupNonUniformBroadcastFirst = 338,
+  OpGroupNonUniformBallot = 339,
+  OpGroupNonUniformIAdd = 349,
+  OpGroupNonUniformFAdd = 350,
+  OpGroupNonUniformIMul = 351,
+  OpGroupNonUniformFMul = 352,
+  OpGroupNonUniformSMin = 353,
+  OpGroupNonUniformUMin = 354,
+  OpGroupNonUniformFMin = 355,
+  OpGroupNonUniformSMax = 356,
+  OpGroupNonUniformUMax = 357,
+  OpGroupNonUniformFMax = 358,
+  OpGroupNonUniformBitwiseAnd = 359,
+  OpGroupNonUniformBitwiseOr = 360,
+  OpGroupNonUniformBitwiseXor = 361,
+  OpGroupNonUniformLogicalAnd = 362,
+  OpGroupNonUniformLogicalOr = 363,
+  OpGroupNonUniformLogicalXor = 364,
+  OpDecorateString = 5632,
+  OpMemberDecorateString = 5633,
+};
+
+enum Decoration : uint32_t {
+  DecorationSpecId = 1,
+  DecorationArrayStride = 6,
+  DecorationBuiltIn = 11,
+  DecorationBinding = 33,
+  DecorationDescriptorSet = 34,
+  DecorationOffset = 35,
+};
+
+enum BuiltIn : uint32_t {
+  BuiltInNumWorkgroups = 24,
+  BuiltInWorkgroupSize = 25,
+  BuiltInWorkgroupId = 26,
+  BuiltInLocalInvocationId = 27,
+  BuiltInGlobalInvocationId = 28,
+  BuiltInLocalInvocationIndex = 29,
+  BuiltInSubgroupSize = 36,
+  BuiltInNumSubgroups = 38,
+  BuiltInSubgroupId = 40,
+  BuiltInSubgroupLocalInvocationId = 41,
+};
+
+enum StorageClass : uint32_t {
+  StorageClassUniformConstant = 0,
+  StorageClassInput = 1,
+  StorageClassUniform = 2,
+  StorageClassWorkgroup = 4,
+  StorageClassPrivate = 6,
+  StorageClassFunction = 7,
+  StorageClassPushConstant = 9,
+  StorageClassStorageBuffer = 12,
+};
+
+const uint32_t kExecutionModelGLCompute = 5;
+const uint32_t kExecutionModeLocalSize = 17;
+
+enum GroupOperation : uint32_t {
+  GroupOperationReduce = 0,
+  GroupOperationInclusiveScan = 1,
+  GroupOperationExclusiveScan = 2,
+};
+
+enum GLSLstd450 : uint32_t {
+  GLSLstd450Round = 1,
+  GLSLstd450RoundEven = 2,
+  GLSLstd450Trunc = 3,
+  GLSLstd450FAbs = 4,
+  GLSLstd450SAbs = 5,
+  GLSLstd450FSign = 6,
+  GLSLstd450SSign = 7,
+  GLSLstd450Floor = 8,
+  GLSLstd450Ceil = 9,
+  GLSLstd450Fract = 10,
+  GLSLstd450Sin = 13,
+  GLSLstd450Cos = 14,
+  GLSLstd450Tan = 15,
+  GLSLstd450Pow = 26,
+  GLSLstd450Exp = 27,
+  GLSLstd450Log = 28,
+  GLSLstd450Exp2 = 29,
+  GLSLstd450Log2 = 30,
+  GLSLstd450Sqrt = 31,
+  GLSLstd450InverseSqrt = 32,
+  GLSLstd450FMin = 37,
+  GLSLstd450UMin = 38,
+  GLSLstd450SMin = 39,
+  GLSLstd450FMax = 40,
+  GLSLstd450UMax = 41,
+  GLSLstd450SMax = 42,
+  GLSLstd450FClamp = 43,
+  GLSLstd450UClamp = 44,
+  GLSLstd450SClamp = 45,
+  GLSLstd450FMix = 46,
+  GLSLstd450Fma = 50,
+};
+
+}  // namespace spv
+}  // namespace cpu
+}  // namespace amber
+
+#endif  // SRC_CPU_SPIRV_H_
@@ -16,11 +16,13 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <limits>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -29,7 +31,6 @@
 #include "src/dawn/pipeline_info.h"
 #include "src/format.h"
 #include "src/make_unique.h"
-#include "src/sleep.h"
 
 namespace amber {
 namespace dawn {
@@ -103,7 +104,6 @@ struct ComboVertexInputDescriptor {
 struct DawnPipelineHelper {
   Result CreateRenderPipelineDescriptor(
       const RenderPipelineInfo& render_pipeline,
-      const ::dawn::Device& device,
       const bool ignore_vertex_and_Index_buffers,
       const PipelineData* pipeline_data);
   Result CreateRenderPassDescriptor(
@@ -239,33 +239,46 @@ uint32_t Align(uint32_t value, size_t alignment) {
 
 }  // namespace
 
-// Maps the given buffer.  Assumes the buffer has usage bit
-// ::dawn::BufferUsage::MapRead set.  Returns a MapResult structure, with
+// Maps all of |bufs| for reading and waits for the mappings to complete.
+// Assumes each buffer has usage bit ::dawn::BufferUsage::MapRead set. The
+// outcome for each buffer is stored in the matching entry of |results|, with
 // the status saved in the |result| member and the host pointer to the mapped
 // data in the |data| member. Mapping a buffer can fail if the context is
 // lost, for example. In the failure case, the |data| member will be null.
-MapResult MapBuffer(const ::dawn::Device& device, const ::dawn::Buffer& buf) {
-  MapResult map_result;
-
-  buf.MapReadAsync(
-      HandleBufferMapCallback,
-      reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(&map_result)));
-  device.Tick();
-  // Wait until the callback has been processed.  Use an exponential backoff
-  // interval, but cap it at one second intervals.  But never loop forever.
-  const int max_iters = 100;
-  const int one_second_in_us = 1000000;
-  for (int iters = 0, interval = 1;
-       !map_result.data && map_result.result.IsSuccess();
-       iters++, interval = std::min(2 * interval, one_second_in_us)) {
+// The device is ticked until every callback has run, yielding between ticks,
+// and an error is returned if that takes longer than |timeout_ms|.
+Result MapBuffers(const ::dawn::Device& device,
+                  const std::vector<::dawn::Buffer>& bufs,
+                  uint32_t timeout_ms,
+                  std::vector<MapResult>* results) {
+  results->assign(bufs.size(), MapResult());
+  for (size_t i = 0; i < bufs.size(); ++i) {
+    bufs[i].MapReadAsync(HandleBufferMapCallback,
+                         reinterpret_cast<void*>(
+                             reinterpret_cast<uintptr_t>(&(*results)[i])));
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(timeout_ms);
+  for (;;) {
     device.Tick();
-    if (iters > max_iters) {
-      map_result.result = Result("MapBuffer timed out after 100 iterations");
-      break;
+
+    bool done = true;
+    for (const auto& map_result : *results) {
+      if (!map_result.data && map_result.result.IsSuccess()) {
+        done = false;
+        break;
+      }
+    }
+    if (done)
+      return {};
+
+    if (std::chrono::steady_clock::now() > deadline) {
+      return Result("MapBuffer timed out after " + std::to_string(timeout_ms) +
+                    " ms");
     }
-    USleep(uint32_t(interval));
+    std::this_thread::yield();
   }
-  return map_result;
 }
 
 // Creates and returns a dawn BufferCopyView
@@ -308,37 +321,48 @@ Result EngineDawn::MapDeviceTextureToHostBuffer(
                              .buffer->GetElementStride();
   const auto dawn_row_pitch = Align(width * pixelSize, kMinimumImageRowPitch);
   const auto size = height * dawn_row_pitch;
-  // Create a temporary buffer to hold the color attachment content and can
-  // be mapped
-  ::dawn::BufferDescriptor descriptor;
-  descriptor.size = size;
-  descriptor.usage =
-      ::dawn::BufferUsage::CopyDst | ::dawn::BufferUsage::MapRead;
-  ::dawn::Buffer copy_buffer = device.CreateBuffer(&descriptor);
-  ::dawn::BufferCopyView copy_buffer_view =
-      CreateBufferCopyView(copy_buffer, 0, dawn_row_pitch, 0);
   ::dawn::Origin3D origin3D;
   origin3D.x = 0;
   origin3D.y = 0;
   origin3D.z = 0;
+  ::dawn::Extent3D copySize = {width, height, 1};
+
+  // Copy every color attachment into its own temporary buffer which can be
+  // mapped, so that a single submission and a single wait cover all of them.
+  const auto& color_attachments =
+      render_pipeline.pipeline->GetColorAttachments();
+  std::vector<::dawn::Buffer> copy_buffers;
+  auto encoder = device.CreateCommandEncoder();
+  for (uint32_t i = 0; i < color_attachments.size(); i++) {
+    ::dawn::BufferDescriptor descriptor;
+    descriptor.size = size;
+    descriptor.usage =
+        ::dawn::BufferUsage::CopyDst | ::dawn::BufferUsage::MapRead;
+    copy_buffers.push_back(device.CreateBuffer(&descriptor));
 
-  for (uint32_t i = 0;
-       i < render_pipeline.pipeline->GetColorAttachments().size(); i++) {
+    ::dawn::BufferCopyView copy_buffer_view =
+        CreateBufferCopyView(copy_buffers.back(), 0, dawn_row_pitch, 0);
     ::dawn::TextureCopyView device_texture_view =
         CreateTextureCopyView(textures_[i], 0, 0, origin3D);
-    ::dawn::Extent3D copySize = {width, height, 1};
-    auto encoder = device.CreateCommandEncoder();
     encoder.CopyTextureToBuffer(&device_texture_view, &copy_buffer_view,
                                 &copySize);
-    auto commands = encoder.Finish();
-    auto queue = device.CreateQueue();
-    queue.Submit(1, &commands);
-
-    MapResult mapped_device_texture = MapBuffer(device, copy_buffer);
-    if (!mapped_device_texture.result.IsSuccess())
-      return mapped_device_texture.result;
+  }
+  auto commands = encoder.Finish();
+  queue_.Submit(1, &commands);
+
+  std::vector<MapResult> mapped_device_textures;
+  Result r = MapBuffers(device, copy_buffers,
+                        GetEngineData().fence_timeout_ms,
+                        &mapped_device_textures);
+
+  for (uint32_t i = 0; r.IsSuccess() && i < color_attachments.size(); i++) {
+    const MapResult& mapped_device_texture = mapped_device_textures[i];
+    if (!mapped_device_texture.result.IsSuccess()) {
+      r = mapped_device_texture.result;
+      break;
+    }
 
-    auto& host_texture = render_pipeline.pipeline->GetColorAttachments()[i];
+    auto& host_texture = color_attachments[i];
     auto* values = host_texture.buffer->ValuePtr();
     auto row_stride = pixelSize * width;
     assert(row_stride * height == host_texture.buffer->GetSizeInBytes());
@@ -355,19 +379,26 @@ Result EngineDawn::MapDeviceTextureToHostBuffer(
                       h * dawn_row_pitch,
                   row_stride);
     }
-    // Always unmap the buffer at the end of the engine's command.
-    copy_buffer.Unmap();
   }
-  return {};
+
+  // Always unmap the buffers at the end of the engine's command.
+  for (auto& copy_buffer : copy_buffers)
+    copy_buffer.Unmap();
+  return r;
 }
 
 Result EngineDawn::MapDeviceBufferToHostBuffer(
     const ComputePipelineInfo& compute_pipeline,
     const ::dawn::Device& device) {
-  for (uint32_t i = 0; i < compute_pipeline.pipeline->GetBuffers().size();
-       i++) {
+  const auto& host_buffers = compute_pipeline.pipeline->GetBuffers();
+
+  // Copy every device buffer into a buffer which can be mapped, so that a
+  // single submission and a single wait cover all of them.
+  std::vector<::dawn::Buffer> copy_device_buffers;
+  auto encoder = device.CreateCommandEncoder();
+  for (uint32_t i = 0; i < host_buffers.size(); i++) {
     auto& device_buffer = compute_pipeline.buffers[i];
-    auto& host_buffer = compute_pipeline.pipeline->GetBuffers()[i];
+    auto& host_buffer = host_buffers[i];
 
     // Create a copy of device buffer to use it in a map read operation.
     // It's not possible to simply set this bit on the existing buffers since:
@@ -376,30 +407,40 @@ Result EngineDawn::MapDeviceBufferToHostBuffer(
     descriptor.size = host_buffer.buffer->GetSizeInBytes();
     descriptor.usage =
         ::dawn::BufferUsage::CopyDst | ::dawn::BufferUsage::MapRead;
-    const auto copy_device_buffer = device.CreateBuffer(&descriptor);
+    copy_device_buffers.push_back(device.CreateBuffer(&descriptor));
     const uint64_t source_offset = 0;
     const uint64_t destination_offset = 0;
     const uint64_t copy_size =
         static_cast<uint64_t>(host_buffer.buffer->GetSizeInBytes());
-    auto encoder = device.CreateCommandEncoder();
-    encoder.CopyBufferToBuffer(device_buffer, source_offset, copy_device_buffer,
-                               destination_offset, copy_size);
-    auto commands = encoder.Finish();
-    auto queue = device.CreateQueue();
-    queue.Submit(1, &commands);
-
-    MapResult mapped_device_buffer = MapBuffer(device, copy_device_buffer);
-    auto* values = host_buffer.buffer->ValuePtr();
-    values->resize(host_buffer.buffer->GetSizeInBytes());
+    encoder.CopyBufferToBuffer(device_buffer, source_offset,
+                               copy_device_buffers.back(), destination_offset,
+                               copy_size);
+  }
+  auto commands = encoder.Finish();
+  queue_.Submit(1, &commands);
+
+  std::vector<MapResult> mapped_device_buffers;
+  Result r = MapBuffers(device, copy_device_buffers,
+                        GetEngineData().fence_timeout_ms,
+                        &mapped_device_buffers);
+
+  for (uint32_t i = 0; r.IsSuccess() && i < host_buffers.size(); i++) {
+    const MapResult& mapped_device_buffer = mapped_device_buffers[i];
+    if (!mapped_device_buffer.result.IsSuccess()) {
+      r = mapped_device_buffer.result;
+      break;
+    }
+
+    auto* values = host_buffers[i].buffer->ValuePtr();
+    values->resize(host_buffers[i].buffer->GetSizeInBytes());
     std::memcpy(values->data(),
                 static_cast<const uint8_t*>(mapped_device_buffer.data),
-                copy_size);
+                host_buffers[i].buffer->GetSizeInBytes());
+  }
 
+  for (auto& copy_device_buffer : copy_device_buffers)
     copy_device_buffer.Unmap();
-    if (!mapped_device_buffer.result.IsSuccess())
-      return mapped_device_buffer.result;
-  }
-  return {};
+  return r;
 }
 
 // Creates a dawn buffer of |size| bytes with TransferDst and the given usage
@@ -768,6 +809,49 @@ Result GetDawnTopology(const ::amber::Topology& amber_topology,
   }
 }
 
+uint32_t FloatBits(float value) {
+  uint32_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+// Returns the fields of |pipeline_data| which a render pipeline descriptor is
+// built from, see CreateRenderPipelineDescriptor. The default state used for
+// a nullptr |pipeline_data| has no fields.
+std::vector<uint32_t> GetRenderPipelineState(
+    const PipelineData* pipeline_data) {
+  if (pipeline_data == nullptr)
+    return {};
+
+  return {
+      static_cast<uint32_t>(pipeline_data->GetFrontFace()),
+      static_cast<uint32_t>(pipeline_data->GetCullMode()),
+      static_cast<uint32_t>(pipeline_data->GetEnableDepthBias()),
+      FloatBits(pipeline_data->GetDepthBiasSlopeFactor()),
+      FloatBits(pipeline_data->GetDepthBiasClamp()),
+      static_cast<uint32_t>(pipeline_data->GetColorBlendOp()),
+      static_cast<uint32_t>(pipeline_data->GetAlphaBlendOp()),
+      static_cast<uint32_t>(pipeline_data->GetSrcColorBlendFactor()),
+      static_cast<uint32_t>(pipeline_data->GetSrcAlphaBlendFactor()),
+      static_cast<uint32_t>(pipeline_data->GetDstAlphaBlendFactor()),
+      static_cast<uint32_t>(pipeline_data->GetColorWriteMask()),
+      static_cast<uint32_t>(pipeline_data->GetFrontCompareOp()),
+      static_cast<uint32_t>(pipeline_data->GetFrontFailOp()),
+      static_cast<uint32_t>(pipeline_data->GetFrontDepthFailOp()),
+      static_cast<uint32_t>(pipeline_data->GetFrontPassOp()),
+      static_cast<uint32_t>(pipeline_data->GetBackCompareOp()),
+      static_cast<uint32_t>(pipeline_data->GetBackFailOp()),
+      static_cast<uint32_t>(pipeline_data->GetBackDepthFailOp()),
+      static_cast<uint32_t>(pipeline_data->GetBackPassOp()),
+      static_cast<uint32_t>(pipeline_data->GetEnableDepthWrite()),
+      static_cast<uint32_t>(pipeline_data->GetDepthCompareOp()),
+      pipeline_data->GetFrontCompareMask(),
+      pipeline_data->GetBackCompareMask(),
+      pipeline_data->GetFrontWriteMask(),
+      pipeline_data->GetBackWriteMask(),
+  };
+}
+
 EngineDawn::EngineDawn() : Engine() {}
 
 EngineDawn::~EngineDawn() = default;
@@ -787,6 +871,7 @@ Result EngineDawn::Initialize(EngineConfig* config,
     return Result("Dawn:Initialize device is a null pointer");
 
   device_ = dawn_config->device;
+  queue_ = device_->CreateQueue();
 
   return {};
 }
@@ -824,10 +909,12 @@ Result EngineDawn::CreatePipeline(::amber::Pipeline* pipeline) {
 
       pipeline_map_[pipeline].compute_pipeline.reset(
           new ComputePipelineInfo(pipeline, module));
-      Result result =
-          AttachBuffers(pipeline_map_[pipeline].compute_pipeline.get());
+      auto* compute_pipeline = pipeline_map_[pipeline].compute_pipeline.get();
+      Result result = AttachBuffers(compute_pipeline);
       if (!result.IsSuccess())
         return result;
+      compute_pipeline->pipeline_layout = MakeBasicPipelineLayout(
+          *device_, compute_pipeline->bind_group_layouts);
       break;
     }
 
@@ -848,10 +935,12 @@ Result EngineDawn::CreatePipeline(::amber::Pipeline* pipeline) {
 
       pipeline_map_[pipeline].render_pipeline.reset(
           new RenderPipelineInfo(pipeline, vs, fs));
-      Result result = AttachBuffersAndTextures(
-          pipeline_map_[pipeline].render_pipeline.get());
+      auto* render_pipeline = pipeline_map_[pipeline].render_pipeline.get();
+      Result result = AttachBuffersAndTextures(render_pipeline);
       if (!result.IsSuccess())
         return result;
+      render_pipeline->pipeline_layout = MakeBasicPipelineLayout(
+          *device_, render_pipeline->bind_group_layouts);
 
       break;
     }
@@ -896,10 +985,6 @@ Result EngineDawn::DoClear(const ClearCommand* command) {
     return Result("Clear invoked on invalid or missing render pipeline");
 
   DawnPipelineHelper helper;
-  result = helper.CreateRenderPipelineDescriptor(*render_pipeline, *device_,
-                                                 false, nullptr);
-  if (!result.IsSuccess())
-    return result;
   result = helper.CreateRenderPassDescriptor(
       *render_pipeline, *device_, texture_views_, ::dawn::LoadOp::Clear);
   if (!result.IsSuccess())
@@ -913,22 +998,20 @@ Result EngineDawn::DoClear(const ClearCommand* command) {
   pass.EndPass();
 
   ::dawn::CommandBuffer commands = encoder.Finish();
-  ::dawn::Queue queue = device_->CreateQueue();
-  queue.Submit(1, &commands);
+  queue_.Submit(1, &commands);
 
   result = MapDeviceTextureToHostBuffer(*render_pipeline, *device_);
 
   return result;
 }
 
-// Creates a Dawn render pipeline descriptor for the given pipeline on the given
-// device. When |ignore_vertex_and_Index_buffers| is true, ignores the vertex
-// and index buffers attached to |render_pipeline| and instead configures the
-// resulting descriptor to have a single vertex buffer with an attribute format
-// of Float4 and input stride of 4*sizeof(float)
+// Creates a Dawn render pipeline descriptor for the given pipeline, using its
+// cached pipeline layout. When |ignore_vertex_and_Index_buffers| is true,
+// ignores the vertex and index buffers attached to |render_pipeline| and
+// instead configures the resulting descriptor to have a single vertex buffer
+// with an attribute format of Float4 and input stride of 4*sizeof(float)
 Result DawnPipelineHelper::CreateRenderPipelineDescriptor(
     const RenderPipelineInfo& render_pipeline,
-    const ::dawn::Device& device,
     const bool ignore_vertex_and_Index_buffers,
     const PipelineData* pipeline_data) {
   Result result;
@@ -956,8 +1039,7 @@ Result DawnPipelineHelper::CreateRenderPipelineDescriptor(
     depth_stencil_format = ::dawn::TextureFormat::Depth24PlusStencil8;
   }
 
-  renderPipelineDescriptor.layout =
-      MakeBasicPipelineLayout(device, render_pipeline.bind_group_layouts);
+  renderPipelineDescriptor.layout = render_pipeline.pipeline_layout;
 
   renderPipelineDescriptor.primitiveTopology =
       ::dawn::PrimitiveTopology::TriangleList;
@@ -1237,6 +1319,32 @@ Result DawnPipelineHelper::CreateRenderPassDescriptor(
   return {};
 }
 
+Result EngineDawn::GetDawnRenderPipeline(
+    RenderPipelineInfo* render_pipeline,
+    ::dawn::PrimitiveTopology topology,
+    bool ignore_vertex_and_index_buffers,
+    const PipelineData* pipeline_data,
+    ::dawn::RenderPipeline* pipeline) {
+  RenderPipelineKey key(topology, ignore_vertex_and_index_buffers,
+                        GetRenderPipelineState(pipeline_data));
+  auto it = render_pipeline->render_pipelines.find(key);
+  if (it != render_pipeline->render_pipelines.end()) {
+    *pipeline = it->second;
+    return {};
+  }
+
+  DawnPipelineHelper helper;
+  Result result = helper.CreateRenderPipelineDescriptor(
+      *render_pipeline, ignore_vertex_and_index_buffers, pipeline_data);
+  if (!result.IsSuccess())
+    return result;
+  helper.renderPipelineDescriptor.primitiveTopology = topology;
+
+  *pipeline = device_->CreateRenderPipeline(&helper.renderPipelineDescriptor);
+  render_pipeline->render_pipelines[key] = *pipeline;
+  return {};
+}
+
 Result EngineDawn::DoDrawRect(const DrawRectCommand* command) {
   RenderPipelineInfo* render_pipeline = GetRenderPipeline(command);
   if (!render_pipeline)
@@ -1293,18 +1401,19 @@ Result EngineDawn::DoDrawRect(const DrawRectCommand* command) {
 
   auto vertex_buffer = CreateBufferFromData(
       *device_, vertexData, sizeof(vertexData), ::dawn::BufferUsage::Vertex);
+  ::dawn::RenderPipeline pipeline;
+  Result result = GetDawnRenderPipeline(
+      render_pipeline, ::dawn::PrimitiveTopology::TriangleList, true,
+      command->GetPipelineData(), &pipeline);
+  if (!result.IsSuccess())
+    return result;
+
   DawnPipelineHelper helper;
-  helper.CreateRenderPipelineDescriptor(*render_pipeline, *device_, true,
-                                        command->GetPipelineData());
   helper.CreateRenderPassDescriptor(*render_pipeline, *device_, texture_views_,
                                     ::dawn::LoadOp::Load);
-  ::dawn::RenderPipelineDescriptor* renderPipelineDescriptor =
-      &helper.renderPipelineDescriptor;
   ::dawn::RenderPassDescriptor* renderPassDescriptor =
       &helper.renderPassDescriptor;
 
-  const ::dawn::RenderPipeline pipeline =
-      device_->CreateRenderPipeline(renderPipelineDescriptor);
   ::dawn::CommandEncoder encoder = device_->CreateCommandEncoder();
   ::dawn::RenderPassEncoder pass =
       encoder.BeginRenderPass(renderPassDescriptor);
@@ -1320,10 +1429,9 @@ Result EngineDawn::DoDrawRect(const DrawRectCommand* command) {
   pass.EndPass();
 
   ::dawn::CommandBuffer commands = encoder.Finish();
-  ::dawn::Queue queue = device_->CreateQueue();
-  queue.Submit(1, &commands);
+  queue_.Submit(1, &commands);
 
-  Result result = MapDeviceTextureToHostBuffer(*render_pipeline, *device_);
+  result = MapDeviceTextureToHostBuffer(*render_pipeline, *device_);
 
   return result;
 }
@@ -1339,6 +1447,9 @@ Result EngineDawn::DoDrawArrays(const DrawArraysCommand* command) {
   if (!render_pipeline)
     return Result("DrawArrays invoked on invalid or missing render pipeline");
 
+  if (command->IsIndirect())
+    return Result("DrawArrays: INDIRECT is not supported in Dawn");
+
   if (command->IsIndexed()) {
     if (!render_pipeline->index_buffer)
       return Result("DrawArrays: Draw indexed is used without given indices");
@@ -1357,28 +1468,26 @@ Result EngineDawn::DoDrawArrays(const DrawArraysCommand* command) {
   if (instance_count == 0 && command->GetVertexCount() != 0)
     instance_count = 1;
 
-  DawnPipelineHelper helper;
-  result = helper.CreateRenderPipelineDescriptor(
-      *render_pipeline, *device_, false, command->GetPipelineData());
+  ::dawn::PrimitiveTopology topology;
+  result = GetDawnTopology(command->GetTopology(), &topology);
+  if (!result.IsSuccess())
+    return result;
+
+  ::dawn::RenderPipeline pipeline;
+  result = GetDawnRenderPipeline(render_pipeline, topology, false,
+                                 command->GetPipelineData(), &pipeline);
   if (!result.IsSuccess())
     return result;
+
+  DawnPipelineHelper helper;
   result = helper.CreateRenderPassDescriptor(
       *render_pipeline, *device_, texture_views_, ::dawn::LoadOp::Load);
   if (!result.IsSuccess())
     return result;
 
-  ::dawn::RenderPipelineDescriptor* renderPipelineDescriptor =
-      &helper.renderPipelineDescriptor;
   ::dawn::RenderPassDescriptor* renderPassDescriptor =
       &helper.renderPassDescriptor;
 
-  result = GetDawnTopology(command->GetTopology(),
-                           &renderPipelineDescriptor->primitiveTopology);
-  if (!result.IsSuccess())
-    return result;
-
-  const ::dawn::RenderPipeline pipeline =
-      device_->CreateRenderPipeline(renderPipelineDescriptor);
   ::dawn::CommandEncoder encoder = device_->CreateCommandEncoder();
   ::dawn::RenderPassEncoder pass =
       encoder.BeginRenderPass(renderPassDescriptor);
@@ -1405,8 +1514,7 @@ Result EngineDawn::DoDrawArrays(const DrawArraysCommand* command) {
 
   pass.EndPass();
   ::dawn::CommandBuffer commands = encoder.Finish();
-  ::dawn::Queue queue = device_->CreateQueue();
-  queue.Submit(1, &commands);
+  queue_.Submit(1, &commands);
 
   result = MapDeviceTextureToHostBuffer(*render_pipeline, *device_);
 
@@ -1420,19 +1528,23 @@ Result EngineDawn::DoCompute(const ComputeCommand* command) {
   if (!compute_pipeline)
     return Result("DoComput: invoked on invalid or missing compute pipeline");
 
-  ::dawn::ComputePipelineDescriptor computePipelineDescriptor;
-  computePipelineDescriptor.layout = MakeBasicPipelineLayout(
-      device_->Get(), compute_pipeline->bind_group_layouts);
+  if (command->IsIndirect())
+    return Result("DoCompute: INDIRECT is not supported in Dawn");
+
+  if (!compute_pipeline->compute_pipeline) {
+    ::dawn::ComputePipelineDescriptor computePipelineDescriptor;
+    computePipelineDescriptor.layout = compute_pipeline->pipeline_layout;
 
-  ::dawn::ProgrammableStageDescriptor pipelineStageDescriptor;
-  pipelineStageDescriptor.module = compute_pipeline->compute_shader;
-  pipelineStageDescriptor.entryPoint = "main";
-  computePipelineDescriptor.computeStage = pipelineStageDescriptor;
-  ::dawn::ComputePipeline pipeline =
-      device_->CreateComputePipeline(&computePipelineDescriptor);
+    ::dawn::ProgrammableStageDescriptor pipelineStageDescriptor;
+    pipelineStageDescriptor.module = compute_pipeline->compute_shader;
+    pipelineStageDescriptor.entryPoint = "main";
+    computePipelineDescriptor.computeStage = pipelineStageDescriptor;
+    compute_pipeline->compute_pipeline =
+        device_->CreateComputePipeline(&computePipelineDescriptor);
+  }
   ::dawn::CommandEncoder encoder = device_->CreateCommandEncoder();
   ::dawn::ComputePassEncoder pass = encoder.BeginComputePass();
-  pass.SetPipeline(pipeline);
+  pass.SetPipeline(compute_pipeline->compute_pipeline);
   for (uint32_t i = 0; i < compute_pipeline->bind_groups.size(); i++) {
     if (compute_pipeline->bind_groups[i]) {
       pass.SetBindGroup(i, compute_pipeline->bind_groups[i], 0, nullptr);
@@ -1443,8 +1555,7 @@ Result EngineDawn::DoCompute(const ComputeCommand* command) {
   // Finish recording the command buffer.  It only has one command.
   auto command_buffer = encoder.Finish();
   // Submit the command.
-  auto queue = device_->CreateQueue();
-  queue.Submit(1, &command_buffer);
+  queue_.Submit(1, &command_buffer);
   // Copy result back
   result = MapDeviceBufferToHostBuffer(*compute_pipeline, *device_);
 
@@ -1498,7 +1609,10 @@ Result EngineDawn::DoBuffer(const BufferCommand* command) {
 
   Buffer* amber_buffer = command->GetBuffer();
   if (amber_buffer) {
-    amber_buffer->SetDataWithOffset(command->GetValues(), command->GetOffset());
+    Result r = amber_buffer->SetDataWithOffset(command->GetValues(),
+                                               command->GetOffset());
+    if (!r.IsSuccess())
+      return r;
 
     dawn_buffer->SetSubData(0, amber_buffer->GetMaxSizeInBytes(),
                             amber_buffer->ValuePtr()->data());
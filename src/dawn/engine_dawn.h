@@ -83,6 +83,16 @@ class EngineDawn : public Engine {
   // Creates and attaches index, vertex, storage, uniform and depth-stencil
   // buffers. Used in the Compute pipeline creation.
   Result AttachBuffers(ComputePipelineInfo* compute_pipeline);
+  // Returns in |pipeline| the Dawn render pipeline for |render_pipeline| with
+  // the given topology and state. The pipeline is created on first use and
+  // cached in |render_pipeline| for later commands. When
+  // |ignore_vertex_and_index_buffers| is true the pipeline uses the vertex
+  // layout of DRAW_RECT.
+  Result GetDawnRenderPipeline(RenderPipelineInfo* render_pipeline,
+                               ::dawn::PrimitiveTopology topology,
+                               bool ignore_vertex_and_index_buffers,
+                               const PipelineData* pipeline_data,
+                               ::dawn::RenderPipeline* pipeline);
   // Creates and submits a command to copy dawn textures back to amber color
   // attachments.
   Result MapDeviceTextureToHostBuffer(const RenderPipelineInfo& render_pipeline,
@@ -94,6 +104,8 @@ class EngineDawn : public Engine {
 
   // Borrowed from the engine config
   ::dawn::Device* device_ = nullptr;
+  // Queue used for every submission, created once at initialization.
+  ::dawn::Queue queue_;
   // Dawn color attachment textures
   std::vector<::dawn::Texture> textures_;
   // Views into Dawn color attachment textures
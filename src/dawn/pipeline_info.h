@@ -16,8 +16,10 @@
 #define SRC_DAWN_PIPELINE_INFO_H_
 
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <set>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -39,6 +41,14 @@ struct hash_pair {
   }
 };
 
+/// Identifies a Dawn render pipeline built for a render pipeline info: the
+/// primitive topology, whether the default DRAW_RECT vertex layout is used
+/// instead of the attached vertex and index buffers, and the values of the
+/// pipeline state fields of the command, which are empty for the default
+/// state. Commands with equal state share the pipeline.
+using RenderPipelineKey =
+    std::tuple<::dawn::PrimitiveTopology, bool, std::vector<uint32_t>>;
+
 /// Stores information relating to a graphics pipeline in Dawn.
 struct RenderPipelineInfo {
   RenderPipelineInfo() {}
@@ -66,6 +76,11 @@ struct RenderPipelineInfo {
   // Binding info
   std::vector<::dawn::BindGroup> bind_groups;
   std::vector<::dawn::BindGroupLayout> bind_group_layouts;
+  ::dawn::PipelineLayout pipeline_layout;
+
+  // Dawn render pipelines created so far. They are built on first use and
+  // reused by every later command with the same key.
+  std::map<RenderPipelineKey, ::dawn::RenderPipeline> render_pipelines;
 
   // Mapping from the <descriptor_set, binding> to dawn buffer index in buffers
   std::unordered_map<std::pair<uint32_t, uint32_t>, uint32_t, hash_pair>
@@ -88,6 +103,10 @@ struct ComputePipelineInfo {
 
   std::vector<::dawn::BindGroup> bind_groups;
   std::vector<::dawn::BindGroupLayout> bind_group_layouts;
+  ::dawn::PipelineLayout pipeline_layout;
+
+  // Dawn compute pipeline, created on the first dispatch.
+  ::dawn::ComputePipeline compute_pipeline;
 
   // Mapping from the <descriptor_set, binding> to dawn buffer index in buffers
   std::unordered_map<std::pair<uint32_t, uint32_t>, uint32_t, hash_pair>
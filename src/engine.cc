@@ -14,6 +14,8 @@
 
 #include "src/engine.h"
 
+#include "src/cpu/engine_cpu.h"
+#include "src/engine_null.h"
 #include "src/make_unique.h"
 
 #if AMBER_ENGINE_VULKAN
@@ -43,6 +45,12 @@ std::unique_ptr<Engine> Engine::Create(EngineType type) {
       engine = MakeUnique<dawn::EngineDawn>();
 #endif  // AMBER_ENGINE_DAWN
       break;
+    case kEngineTypeNull:
+      engine = MakeUnique<EngineNull>();
+      break;
+    case kEngineTypeCpu:
+      engine = MakeUnique<cpu::EngineCpu>();
+      break;
   }
   return engine;
 }
@@ -51,4 +59,90 @@ Engine::Engine() = default;
 
 Engine::~Engine() = default;
 
+bool Engine::IsFormatSupported(const Format&, BufferType) const {
+  return true;
+}
+
+Result Engine::CheckFormatsSupported(
+    const std::vector<std::unique_ptr<Pipeline>>& pipelines) const {
+  for (const auto& pipeline : pipelines) {
+    for (const auto& info : pipeline->GetColorAttachments()) {
+      if (!IsFormatSupported(*info.buffer->GetFormat(), info.type))
+        return Result("color attachment format is not supported");
+    }
+
+    const auto& depth_stencil_info = pipeline->GetDepthStencilBuffer();
+    if (depth_stencil_info.buffer &&
+        !IsFormatSupported(*depth_stencil_info.buffer->GetFormat(),
+                           depth_stencil_info.type)) {
+      return Result("depth attachment format is not supported");
+    }
+
+    for (const auto& info : pipeline->GetVertexBuffers()) {
+      if (!IsFormatSupported(*info.buffer->GetFormat(), info.type))
+        return Result("vertex buffer format is not supported");
+    }
+  }
+  return {};
+}
+
+void Engine::SetReadbackRegions(Pipeline*,
+                                const Buffer*,
+                                const std::vector<ReadbackRegion>&,
+                                bool) {}
+
+bool Engine::SupportsDeviceProbes() const {
+  return false;
+}
+
+Result Engine::DoDeviceProbe(const ProbeCommand*,
+                             Pipeline*,
+                             const std::vector<uint32_t>&,
+                             const ProbeShaderParams&,
+                             ProbeShaderResult*) {
+  return Result("Engine does not support device probes");
+}
+
+bool Engine::SupportsDeviceCompares() const {
+  return false;
+}
+
+Result Engine::DoDeviceCompare(const CompareBufferCommand*,
+                               Pipeline*,
+                               Pipeline*,
+                               const std::vector<uint32_t>&,
+                               const CompareShaderParams&,
+                               CompareShaderResult*) {
+  return Result("Engine does not support device compares");
+}
+
+Result Engine::DoRepeatedCompute(const std::vector<const ComputeCommand*>& cmds,
+                                 uint32_t count) {
+  for (uint32_t i = 0; i < count; ++i) {
+    for (const auto* cmd : cmds) {
+      Result r = DoCompute(cmd);
+      if (!r.IsSuccess())
+        return r;
+    }
+  }
+  return {};
+}
+
+Result Engine::PrecompilePipelines(const std::vector<const Command*>&) {
+  return {};
+}
+
+Result Engine::DoConcurrentCompute(
+    const std::vector<const ComputeCommand*>& cmds,
+    size_t* failed) {
+  for (size_t i = 0; i < cmds.size(); ++i) {
+    Result r = DoCompute(cmds[i]);
+    if (!r.IsSuccess()) {
+      *failed = i;
+      return r;
+    }
+  }
+  return {};
+}
+
 }  // namespace amber
@@ -24,8 +24,10 @@
 #include "amber/result.h"
 #include "src/buffer.h"
 #include "src/command.h"
+#include "src/compare_shader.h"
 #include "src/format.h"
 #include "src/pipeline.h"
+#include "src/probe_shader.h"
 
 namespace amber {
 
@@ -35,6 +37,16 @@ class VirtualFileStore;
 struct EngineData {
   /// The timeout to use for fences, in milliseconds.
   uint32_t fence_timeout_ms = 10000;
+  /// The memory placement of the buffers bound to descriptors.
+  MemoryPlacement memory_placement = MemoryPlacement::kHostVisible;
+};
+
+/// A rectangle of texels in a color attachment.
+struct ReadbackRegion {
+  uint32_t x = 0;
+  uint32_t y = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
 };
 
 /// Abstract class which describes a backing engine for Amber.
@@ -73,9 +85,29 @@ class Engine {
       const std::vector<std::string>& instance_extensions,
       const std::vector<std::string>& device_extensions) = 0;
 
+  /// Returns true if a buffer of |type| can use |format| on this engine.
+  /// Only valid after Initialize. Engines should answer from data gathered
+  /// at initialization so the check is cheap. The default implementation
+  /// accepts every format.
+  virtual bool IsFormatSupported(const Format& format, BufferType type) const;
+
+  /// Checks the formats of the attachments and vertex buffers of
+  /// |pipelines| with IsFormatSupported. This lets a script be rejected
+  /// before any pipeline is created.
+  virtual Result CheckFormatsSupported(
+      const std::vector<std::unique_ptr<Pipeline>>& pipelines) const;
+
   /// Create graphics pipeline.
   virtual Result CreatePipeline(Pipeline* pipeline) = 0;
 
+  /// Builds ahead of time the device pipelines the draw and compute commands
+  /// in |cmds| will use. Each command is the first one of its pipeline and
+  /// nothing changes the state of that pipeline before it runs, so the
+  /// engine can build them all at once, before any command executes. This is
+  /// an optimization only, the commands must still work if it is skipped.
+  /// The default implementation does nothing.
+  virtual Result PrecompilePipelines(const std::vector<const Command*>& cmds);
+
   /// Execute the clear color command
   virtual Result DoClearColor(const ClearColorCommand* cmd) = 0;
 
@@ -100,6 +132,24 @@ class Engine {
   /// Execute the compute command
   virtual Result DoCompute(const ComputeCommand* cmd) = 0;
 
+  /// Execute the compute commands in |cmds|, in order, |count| times. All of
+  /// the commands use the same pipeline and nothing reads the buffers between
+  /// them, so an engine may record the dispatches once and submit them
+  /// together. The default implementation calls DoCompute for each command.
+  virtual Result DoRepeatedCompute(
+      const std::vector<const ComputeCommand*>& cmds,
+      uint32_t count);
+
+  /// Execute the compute commands in |cmds|. Each command uses a different
+  /// pipeline and no command touches a buffer another one writes, so an
+  /// engine may have all of them in flight at once. On failure |failed| is
+  /// set to the index of the first command which failed, every command before
+  /// it must have completed. The default implementation calls DoCompute for
+  /// each command in order.
+  virtual Result DoConcurrentCompute(
+      const std::vector<const ComputeCommand*>& cmds,
+      size_t* failed);
+
   /// Execute the entry point command
   virtual Result DoEntryPoint(const EntryPointCommand* cmd) = 0;
 
@@ -112,6 +162,53 @@ class Engine {
   /// This covers both Vulkan buffers and images.
   virtual Result DoBuffer(const BufferCommand* cmd) = 0;
 
+  /// Returns true if the engine implements DoDeviceProbe. The default
+  /// implementation returns false.
+  virtual bool SupportsDeviceProbes() const;
+
+  /// Runs the probe shader in |spirv| with |params| over the color attachment
+  /// of |pipeline| probed by |cmd| and stores what it found in |result|.
+  /// Nothing changed the attachment since the last draw of |pipeline|, so
+  /// the copy the device holds is probed. If texels do not match, the probed
+  /// region is copied into the buffer of |cmd| for the host to check. The
+  /// shader is generated with GenerateProbeShader for the buffer format. The
+  /// default implementation returns an error.
+  virtual Result DoDeviceProbe(const ProbeCommand* cmd,
+                               Pipeline* pipeline,
+                               const std::vector<uint32_t>& spirv,
+                               const ProbeShaderParams& params,
+                               ProbeShaderResult* result);
+
+  /// Returns true if the engine implements DoDeviceCompare. The default
+  /// implementation returns false.
+  virtual bool SupportsDeviceCompares() const;
+
+  /// Runs the compare shader in |spirv| with |params| over device copies of
+  /// the two buffers of |cmd| and stores what it found in |result|. The
+  /// buffers are the color attachments of |pipeline1| and |pipeline2|,
+  /// unchanged since their last draw, so the copies the device holds are
+  /// compared. The shader is generated with GenerateCompareShader. The
+  /// default implementation returns an error.
+  virtual Result DoDeviceCompare(const CompareBufferCommand* cmd,
+                                 Pipeline* pipeline1,
+                                 Pipeline* pipeline2,
+                                 const std::vector<uint32_t>& spirv,
+                                 const CompareShaderParams& params,
+                                 CompareShaderResult* result);
+
+  /// Tells the engine that after the next draw or clear of |pipeline| only
+  /// |regions| of its color attachment |buffer| are read on the host, until
+  /// |pipeline| writes the attachment again. Nothing else reads or writes
+  /// |buffer| in between, so an engine may only copy |regions| back into
+  /// |buffer| and keep its own copy of the attachment for the next draw.
+  /// |regions| may be empty. If |copy_to_host| is false only device probes
+  /// read the regions, so they need not be copied into |buffer|. The default
+  /// implementation ignores the hint.
+  virtual void SetReadbackRegions(Pipeline* pipeline,
+                                  const Buffer* buffer,
+                                  const std::vector<ReadbackRegion>& regions,
+                                  bool copy_to_host);
+
   /// Sets the engine data to use.
   void SetEngineData(const EngineData& data) { engine_data_ = data; }
 
@@ -0,0 +1,337 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/engine_null.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace amber {
+namespace {
+
+// Returns |value| converted from linear to sRGB encoding.
+double LinearToSrgb(double value) {
+  if (value <= 0.0031308)
+    return value * 12.92;
+  return 1.055 * std::pow(value, 1.0 / 2.4) - 0.055;
+}
+
+// Returns true if every component of |format| can be written from a Value.
+bool CanClear(const Format& format) {
+  if (format.IsPacked())
+    return false;
+  for (const auto& seg : format.GetSegments()) {
+    if (seg.IsPadding())
+      continue;
+    if (seg.GetFormatMode() == FormatMode::kUFloat)
+      return false;
+    uint32_t bits = seg.GetNumBits();
+    if (bits != 8 && bits != 16 && bits != 32 && bits != 64)
+      return false;
+  }
+  return true;
+}
+
+// Returns the value stored in a component of type |name| and |mode| with
+// |num_bits| bits when clearing to |color|, |depth| and |stencil|.
+Value GetClearValue(FormatComponentType name,
+                    FormatMode mode,
+                    uint32_t num_bits,
+                    const float* color,
+                    float depth,
+                    uint32_t stencil) {
+  double v = 0.0;
+  switch (name) {
+    case FormatComponentType::kR:
+      v = color[0];
+      break;
+    case FormatComponentType::kG:
+      v = color[1];
+      break;
+    case FormatComponentType::kB:
+      v = color[2];
+      break;
+    case FormatComponentType::kA:
+      v = color[3];
+      break;
+    case FormatComponentType::kX:
+      break;
+    case FormatComponentType::kD:
+      v = depth;
+      break;
+    case FormatComponentType::kS:
+      v = stencil;
+      break;
+  }
+
+  if (mode == FormatMode::kSRGB && name != FormatComponentType::kA)
+    v = LinearToSrgb(std::min(std::max(v, 0.0), 1.0));
+
+  Value value;
+  switch (mode) {
+    case FormatMode::kSRGB:
+    case FormatMode::kUNorm:
+      value.SetIntValue(static_cast<uint64_t>(
+          std::round(std::min(std::max(v, 0.0), 1.0) *
+                     static_cast<double>((1ULL << num_bits) - 1))));
+      break;
+    case FormatMode::kSNorm:
+      value.SetIntValue(static_cast<uint64_t>(static_cast<int64_t>(
+          std::round(std::min(std::max(v, -1.0), 1.0) *
+                     static_cast<double>((1ULL << (num_bits - 1)) - 1)))));
+      break;
+    case FormatMode::kUInt:
+    case FormatMode::kUScaled:
+    case FormatMode::kSInt:
+    case FormatMode::kSScaled:
+      value.SetIntValue(static_cast<uint64_t>(static_cast<int64_t>(v)));
+      break;
+    case FormatMode::kUFloat:
+    case FormatMode::kSFloat:
+      value.SetDoubleValue(v);
+      break;
+  }
+  return value;
+}
+
+}  // namespace
+
+EngineNull::EngineNull() = default;
+
+EngineNull::~EngineNull() = default;
+
+Result EngineNull::Initialize(EngineConfig*,
+                              Delegate*,
+                              const std::vector<std::string>&,
+                              const std::vector<std::string>&,
+                              const std::vector<std::string>&) {
+  return {};
+}
+
+Result EngineNull::CreatePipeline(Pipeline* pipeline) {
+  if (pipeline_map_.count(pipeline) > 0)
+    return Result("Null::CreatePipeline pipeline already created");
+
+  pipeline_map_[pipeline] = PipelineInfo();
+  UploadBuffers(pipeline);
+  return {};
+}
+
+EngineNull::PipelineInfo* EngineNull::GetPipelineInfo(
+    const PipelineCommand* cmd) {
+  auto it = pipeline_map_.find(cmd->GetPipeline());
+  if (it == pipeline_map_.end())
+    return nullptr;
+  return &it->second;
+}
+
+void EngineNull::Upload(const Buffer* buffer) {
+  if (!buffer)
+    return;
+
+  // Like a device allocation, the copy always has the full buffer size.
+  std::vector<uint8_t>& data = device_buffers_[buffer];
+  data = *buffer->ValuePtr();
+  data.resize(static_cast<size_t>(buffer->GetSizeInBytes()));
+}
+
+void EngineNull::Download(Buffer* buffer) {
+  if (!buffer)
+    return;
+
+  auto it = device_buffers_.find(buffer);
+  if (it != device_buffers_.end())
+    *buffer->ValuePtr() = it->second;
+}
+
+void EngineNull::UploadBuffers(const Pipeline* pipeline) {
+  for (const auto& info : pipeline->GetBuffers())
+    Upload(info.buffer);
+  for (const auto& info : pipeline->GetColorAttachments())
+    Upload(info.buffer);
+  for (const auto& info : pipeline->GetResolveTargets())
+    Upload(info.buffer);
+  for (const auto& info : pipeline->GetVertexBuffers())
+    Upload(info.buffer);
+  Upload(pipeline->GetDepthStencilBuffer().buffer);
+  Upload(pipeline->GetIndexBuffer());
+  Upload(pipeline->GetPushConstantBuffer().buffer);
+}
+
+void EngineNull::DownloadBuffers(const Pipeline* pipeline) {
+  // Shaders cannot write read-only bindings, so their device copies still
+  // match the host data.
+  for (const auto& info : pipeline->GetBuffers()) {
+    if (!IsReadOnlyBufferType(info.type))
+      Download(info.buffer);
+  }
+  for (const auto& info : pipeline->GetColorAttachments())
+    Download(info.buffer);
+  for (const auto& info : pipeline->GetResolveTargets())
+    Download(info.buffer);
+  Download(pipeline->GetDepthStencilBuffer().buffer);
+}
+
+Result EngineNull::ClearAttachment(const Pipeline* pipeline,
+                                   const Pipeline::BufferInfo& buffer,
+                                   const PipelineInfo& info) {
+  // Only the base mip level of the attachment is drawn into.
+  if (!buffer.buffer || buffer.base_mip_level != 0)
+    return {};
+
+  Format* format = buffer.buffer->GetFormat();
+  if (!CanClear(*format))
+    return {};
+
+  std::vector<Value> texel_values;
+  for (const auto& seg : format->GetSegments()) {
+    if (seg.IsPadding())
+      continue;
+    texel_values.push_back(GetClearValue(seg.GetName(), seg.GetFormatMode(),
+                                         seg.GetNumBits(), info.clear_color,
+                                         info.clear_depth, info.clear_stencil));
+  }
+
+  Buffer texel;
+  texel.SetFormat(format);
+  Result r = texel.SetData(texel_values);
+  if (!r.IsSuccess())
+    return r;
+
+  std::vector<uint8_t>& data = device_buffers_[buffer.buffer];
+  const std::vector<uint8_t>& texel_data = *texel.ValuePtr();
+  const size_t texel_size = texel_data.size();
+  if (texel_size == 0)
+    return {};
+
+  const size_t texel_count =
+      std::min(static_cast<size_t>(pipeline->GetFramebufferWidth()) *
+                   static_cast<size_t>(pipeline->GetFramebufferHeight()),
+               data.size() / texel_size);
+  for (size_t i = 0; i < texel_count; ++i)
+    std::memcpy(data.data() + i * texel_size, texel_data.data(), texel_size);
+  return {};
+}
+
+Result EngineNull::DoClearColor(const ClearColorCommand* cmd) {
+  PipelineInfo* info = GetPipelineInfo(cmd);
+  if (!info || !cmd->GetPipeline()->IsGraphics())
+    return Result("Null::Clear Color Command for Non-Graphics Pipeline");
+
+  info->clear_color[0] = cmd->GetR();
+  info->clear_color[1] = cmd->GetG();
+  info->clear_color[2] = cmd->GetB();
+  info->clear_color[3] = cmd->GetA();
+  return {};
+}
+
+Result EngineNull::DoClearStencil(const ClearStencilCommand* cmd) {
+  PipelineInfo* info = GetPipelineInfo(cmd);
+  if (!info || !cmd->GetPipeline()->IsGraphics())
+    return Result("Null::Clear Stencil Command for Non-Graphics Pipeline");
+
+  info->clear_stencil = cmd->GetValue();
+  return {};
+}
+
+Result EngineNull::DoClearDepth(const ClearDepthCommand* cmd) {
+  PipelineInfo* info = GetPipelineInfo(cmd);
+  if (!info || !cmd->GetPipeline()->IsGraphics())
+    return Result("Null::Clear Depth Command for Non-Graphics Pipeline");
+
+  info->clear_depth = cmd->GetValue();
+  return {};
+}
+
+Result EngineNull::DoClear(const ClearCommand* cmd) {
+  PipelineInfo* info = GetPipelineInfo(cmd);
+  const Pipeline* pipeline = cmd->GetPipeline();
+  if (!info || !pipeline->IsGraphics())
+    return Result("Null::Clear Command for Non-Graphics Pipeline");
+
+  UploadBuffers(pipeline);
+  for (const auto& attachment : pipeline->GetColorAttachments()) {
+    Result r = ClearAttachment(pipeline, attachment, *info);
+    if (!r.IsSuccess())
+      return r;
+  }
+  Result r =
+      ClearAttachment(pipeline, pipeline->GetDepthStencilBuffer(), *info);
+  if (!r.IsSuccess())
+    return r;
+
+  DownloadBuffers(pipeline);
+  return {};
+}
+
+Result EngineNull::DoDrawRect(const DrawRectCommand* cmd) {
+  if (!GetPipelineInfo(cmd) || !cmd->GetPipeline()->IsGraphics())
+    return Result("Null::DrawRect for Non-Graphics Pipeline");
+
+  UploadBuffers(cmd->GetPipeline());
+  DownloadBuffers(cmd->GetPipeline());
+  return {};
+}
+
+Result EngineNull::DoDrawGrid(const DrawGridCommand* cmd) {
+  if (!GetPipelineInfo(cmd) || !cmd->GetPipeline()->IsGraphics())
+    return Result("Null::DrawGrid for Non-Graphics Pipeline");
+
+  UploadBuffers(cmd->GetPipeline());
+  DownloadBuffers(cmd->GetPipeline());
+  return {};
+}
+
+Result EngineNull::DoDrawArrays(const DrawArraysCommand* cmd) {
+  if (!GetPipelineInfo(cmd) || !cmd->GetPipeline()->IsGraphics())
+    return Result("Null::DrawArrays for Non-Graphics Pipeline");
+
+  UploadBuffers(cmd->GetPipeline());
+  DownloadBuffers(cmd->GetPipeline());
+  return {};
+}
+
+Result EngineNull::DoCompute(const ComputeCommand* cmd) {
+  if (!GetPipelineInfo(cmd) || !cmd->GetPipeline()->IsCompute())
+    return Result("Null::Compute for Non-Compute Pipeline");
+
+  UploadBuffers(cmd->GetPipeline());
+  DownloadBuffers(cmd->GetPipeline());
+  return {};
+}
+
+Result EngineNull::DoEntryPoint(const EntryPointCommand*) {
+  return {};
+}
+
+Result EngineNull::DoPatchParameterVertices(
+    const PatchParameterVerticesCommand*) {
+  return {};
+}
+
+Result EngineNull::DoBuffer(const BufferCommand* cmd) {
+  Buffer* buffer = cmd->GetBuffer();
+  Result r;
+  if (cmd->GetValues().empty())
+    r = buffer->SetSizeInElements(buffer->ElementCount());
+  else
+    r = buffer->SetDataWithOffset(cmd->GetValues(), cmd->GetOffset());
+  if (!r.IsSuccess())
+    return r;
+  Upload(buffer);
+  return {};
+}
+
+}  // namespace amber
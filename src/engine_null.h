@@ -0,0 +1,91 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_ENGINE_NULL_H_
+#define SRC_ENGINE_NULL_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "src/engine.h"
+
+namespace amber {
+
+/// Engine implementation which runs a script without a graphics device.
+///
+/// The engine keeps a device copy of every buffer a command uses. The copy
+/// is refreshed from the host before the command and copied back after it,
+/// so the host side of the buffer traffic matches a real engine. Draws and
+/// dispatches leave the buffers unchanged. Clears fill the attachments with
+/// the clear values, so probes after a clear see the expected data. This
+/// allows measuring and testing everything except the driver.
+///
+/// The engine accepts any required feature or extension, and does not need
+/// an EngineConfig.
+class EngineNull : public Engine {
+ public:
+  EngineNull();
+  ~EngineNull() override;
+
+  // Engine
+  Result Initialize(EngineConfig* config,
+                    Delegate* delegate,
+                    const std::vector<std::string>& features,
+                    const std::vector<std::string>& instance_extensions,
+                    const std::vector<std::string>& device_extensions) override;
+  Result CreatePipeline(Pipeline* pipeline) override;
+  Result DoClearColor(const ClearColorCommand* cmd) override;
+  Result DoClearStencil(const ClearStencilCommand* cmd) override;
+  Result DoClearDepth(const ClearDepthCommand* cmd) override;
+  Result DoClear(const ClearCommand* cmd) override;
+  Result DoDrawRect(const DrawRectCommand* cmd) override;
+  Result DoDrawGrid(const DrawGridCommand* cmd) override;
+  Result DoDrawArrays(const DrawArraysCommand* cmd) override;
+  Result DoCompute(const ComputeCommand* cmd) override;
+  Result DoEntryPoint(const EntryPointCommand* cmd) override;
+  Result DoPatchParameterVertices(
+      const PatchParameterVerticesCommand* cmd) override;
+  Result DoBuffer(const BufferCommand* cmd) override;
+
+ private:
+  struct PipelineInfo {
+    float clear_color[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float clear_depth = 1.0f;
+    uint32_t clear_stencil = 0;
+  };
+
+  PipelineInfo* GetPipelineInfo(const PipelineCommand* cmd);
+
+  /// Copies the host data of every buffer used by |pipeline| to the device
+  /// copy.
+  void UploadBuffers(const Pipeline* pipeline);
+  /// Copies the device copy of every buffer |pipeline| can write back to
+  /// the host.
+  void DownloadBuffers(const Pipeline* pipeline);
+  void Upload(const Buffer* buffer);
+  void Download(Buffer* buffer);
+  /// Fills the device copy of the attachment |buffer| of |pipeline| with
+  /// the clear values of |info|.
+  Result ClearAttachment(const Pipeline* pipeline,
+                         const Pipeline::BufferInfo& buffer,
+                         const PipelineInfo& info);
+
+  std::map<const Pipeline*, PipelineInfo> pipeline_map_;
+  std::map<const Buffer*, std::vector<uint8_t>> device_buffers_;
+};
+
+}  // namespace amber
+
+#endif  // SRC_ENGINE_NULL_H_
@@ -0,0 +1,140 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/engine_null.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "src/amberscript/parser.h"
+#include "src/executor.h"
+
+namespace amber {
+namespace {
+
+const char kGraphics[] = R"(
+SHADER vertex vert_shader GLSL
+# shader
+END
+SHADER fragment frag_shader GLSL
+# shader
+END
+
+BUFFER framebuffer FORMAT B8G8R8A8_UNORM
+
+PIPELINE graphics pipeline
+  ATTACH vert_shader
+  ATTACH frag_shader
+  FRAMEBUFFER_SIZE 4 4
+  BIND BUFFER framebuffer AS color LOCATION 0
+END
+
+CLEAR_COLOR pipeline 255 0 0 255
+CLEAR pipeline
+RUN pipeline DRAW_RECT POS 0 0 SIZE 4 4
+)";
+
+Result RunScript(const std::string& input) {
+  amberscript::Parser parser;
+  Result r = parser.Parse(input);
+  if (!r.IsSuccess())
+    return r;
+
+  ShaderMap shader_map;
+  shader_map["pipeline-vert_shader"] = {0x07230203};
+  shader_map["pipeline-frag_shader"] = {0x07230203};
+  shader_map["pipeline-compute_shader"] = {0x07230203};
+
+  auto script = parser.GetScript();
+  auto engine = Engine::Create(kEngineTypeNull);
+  r = engine->Initialize(nullptr, nullptr, script->GetRequiredFeatures(),
+                         script->GetRequiredInstanceExtensions(),
+                         script->GetRequiredDeviceExtensions());
+  if (!r.IsSuccess())
+    return r;
+
+  Options options;
+  Executor executor;
+  return executor.Execute(engine.get(), script.get(), shader_map, &options,
+                          nullptr);
+}
+
+}  // namespace
+
+using EngineNullTest = testing::Test;
+
+TEST_F(EngineNullTest, ClearFillsColorAttachment) {
+  Result r = RunScript(std::string(kGraphics) + R"(
+EXPECT framebuffer IDX 0 0 SIZE 4 4 EQ_RGBA 255 0 0 255
+)");
+  EXPECT_TRUE(r.IsSuccess()) << r.Error();
+}
+
+TEST_F(EngineNullTest, ProbeOfOtherColorFails) {
+  Result r = RunScript(std::string(kGraphics) + R"(
+EXPECT framebuffer IDX 0 0 SIZE 4 4 EQ_RGBA 0 255 0 255
+)");
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ(
+      "Line 22: Probe failed at: 0, 0\n"
+      "  Expected: 0.000000, 255.000000, 0.000000, 255.000000\n"
+      "    Actual: 255.000000, 0.000000, 0.000000, 255.000000\n"
+      "Probe failed in 16 pixels",
+      r.Error());
+}
+
+TEST_F(EngineNullTest, ComputeKeepsBufferData) {
+  Result r = RunScript(R"(
+SHADER compute compute_shader GLSL
+# shader
+END
+
+BUFFER buf DATA_TYPE uint32 SIZE 4 FILL 7
+
+PIPELINE compute pipeline
+  ATTACH compute_shader
+  BIND BUFFER buf AS storage DESCRIPTOR_SET 0 BINDING 0
+END
+
+RUN pipeline 1 1 1
+EXPECT buf IDX 0 EQ 7 7 7 7
+)");
+  EXPECT_TRUE(r.IsSuccess()) << r.Error();
+}
+
+TEST_F(EngineNullTest, ComputeKeepsHostDataOfReadOnlyBinding) {
+  Result r = RunScript(R"(
+SHADER compute compute_shader GLSL
+# shader
+END
+
+BUFFER buf DATA_TYPE uint32 SIZE 4 FILL 7
+BUFFER src DATA_TYPE uint32 SIZE 4 FILL 3
+BUFFER uni DATA_TYPE uint32 SIZE 4 FILL 5
+
+PIPELINE compute pipeline
+  ATTACH compute_shader
+  BIND BUFFER buf AS storage DESCRIPTOR_SET 0 BINDING 0
+  BIND BUFFER uni AS uniform DESCRIPTOR_SET 0 BINDING 1
+END
+
+RUN pipeline 1 1 1
+COPY src TO uni
+RUN pipeline 1 1 1
+EXPECT uni IDX 0 EQ 3 3 3 3
+)");
+  EXPECT_TRUE(r.IsSuccess()) << r.Error();
+}
+
+}  // namespace amber
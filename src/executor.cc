@@ -15,16 +15,200 @@
 #include "src/executor.h"
 
 #include <cassert>
+#include <memory>
+#include <set>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#include "src/command_graph.h"
+#include "src/compare_shader.h"
 #include "src/engine.h"
 #include "src/make_unique.h"
+#include "src/probe_shader.h"
 #include "src/script.h"
 #include "src/shader_compiler.h"
 
 namespace amber {
+namespace {
+
+// Returns true if every command in |repeat| is a direct compute command on the
+// same pipeline and fills |cmds| with them in order. Such a body has no host
+// visible effects between iterations, so the engine can run it as one batch.
+// Indirect dispatches are left out, as an earlier iteration may write the
+// parameters of a later one.
+bool GetRepeatedComputeCommands(const RepeatCommand* repeat,
+                                std::vector<const ComputeCommand*>* cmds) {
+  const auto& sub_cmds = repeat->GetCommands();
+  if (sub_cmds.empty())
+    return false;
+
+  for (const auto& sub_cmd : sub_cmds) {
+    if (!sub_cmd->IsCompute() || sub_cmd->AsCompute()->IsIndirect())
+      return false;
+
+    const ComputeCommand* compute = sub_cmd->AsCompute();
+    if (compute->GetPipeline() != sub_cmds[0]->AsCompute()->GetPipeline())
+      return false;
+
+    cmds->push_back(compute);
+  }
+  return true;
+}
+
+// Returns the indices of the compute commands which can run together with
+// the compute command at |first|, including |first|. A later compute command
+// joins when every command it depends on has already run, which also keeps
+// it independent of the other commands in the batch. Commands which are
+// skipped over stay pending and run after the batch. The search stops once
+// every one of the |pipeline_count| pipelines has a pending command, as any
+// later command on them has to wait for that one.
+std::vector<size_t> GetConcurrentComputeCommands(
+    const CommandGraph& graph,
+    const std::vector<std::unique_ptr<Command>>& commands,
+    const std::vector<bool>& done,
+    size_t pipeline_count,
+    size_t first) {
+  std::vector<size_t> batch = {first};
+  std::set<const Pipeline*> blocked = {
+      commands[first]->AsCompute()->GetPipeline()};
+  for (size_t i = first + 1;
+       i < commands.size() && blocked.size() < pipeline_count; ++i) {
+    if (done[i] || !commands[i]->IsCompute())
+      continue;
+    if (!blocked.insert(commands[i]->AsCompute()->GetPipeline()).second)
+      continue;
+
+    bool ready = true;
+    for (size_t dep : graph.GetDependencies(i)) {
+      if (!done[dep]) {
+        ready = false;
+        break;
+      }
+    }
+    if (ready)
+      batch.push_back(i);
+  }
+  return batch;
+}
+
+// Maximum number of regions read back instead of a whole color attachment.
+const size_t kMaxReadbackRegions = 16;
+
+// Returns the pipeline whose color attachments |cmd| writes, or nullptr.
+Pipeline* GetColorAttachmentWriter(Command* cmd) {
+  if (cmd->IsDrawRect() || cmd->IsDrawGrid() || cmd->IsDrawArrays() ||
+      cmd->IsClear()) {
+    return static_cast<PipelineCommand*>(cmd)->GetPipeline();
+  }
+  return nullptr;
+}
+
+// Collects in |regions| the texels of the color attachment |buffer| which are
+// probed after the command at |idx| writes it, until the same pipeline writes
+// it again. The probes seen before anything else accesses |buffer| are added
+// to |probes|. Returns false if anything else accesses |buffer| in between, or
+// the regions cover too much of it, so it has to be read back completely.
+bool GetProbedRegions(const CommandGraph& graph,
+                      const std::vector<std::unique_ptr<Command>>& commands,
+                      size_t idx,
+                      const Buffer* buffer,
+                      std::vector<ReadbackRegion>* regions,
+                      std::vector<const ProbeCommand*>* probes) {
+  Pipeline* pipeline = GetColorAttachmentWriter(commands[idx].get());
+  uint64_t area = 0;
+  for (size_t i = idx + 1; i < commands.size(); ++i) {
+    Command* cmd = commands[i].get();
+    if (GetColorAttachmentWriter(cmd) == pipeline)
+      return true;
+    if (!graph.AccessesResource(i, buffer))
+      continue;
+    if (!cmd->IsProbe())
+      return false;
+
+    probes->push_back(cmd->AsProbe());
+    ReadbackRegion region;
+    Result r = GetProbeRegion(cmd->AsProbe(), buffer->GetWidth(),
+                              buffer->GetHeight(), &region.x, &region.y,
+                              &region.width, &region.height);
+    if (!r.IsSuccess())
+      return false;
+    if (region.width == 0 || region.height == 0)
+      continue;
+
+    bool seen = false;
+    for (const auto& other : *regions) {
+      seen = seen || (other.x == region.x && other.y == region.y &&
+                      other.width == region.width &&
+                      other.height == region.height);
+    }
+    if (seen)
+      continue;
+
+    area += static_cast<uint64_t>(region.width) * region.height;
+    regions->push_back(region);
+    const uint64_t buffer_area =
+        static_cast<uint64_t>(buffer->GetWidth()) * buffer->GetHeight();
+    if (regions->size() > kMaxReadbackRegions || area >= buffer_area)
+      return false;
+  }
+  return true;
+}
+
+// Adds to |compares| the buffer comparisons which read the color attachment
+// |buffer| after the command at |idx| writes it, until the same pipeline
+// writes it again or anything other than a probe or comparison accesses it.
+void GetAttachmentCompares(
+    const CommandGraph& graph,
+    const std::vector<std::unique_ptr<Command>>& commands,
+    size_t idx,
+    const Buffer* buffer,
+    std::vector<const CompareBufferCommand*>* compares) {
+  Pipeline* pipeline = GetColorAttachmentWriter(commands[idx].get());
+  for (size_t i = idx + 1; i < commands.size(); ++i) {
+    Command* cmd = commands[i].get();
+    if (GetColorAttachmentWriter(cmd) == pipeline)
+      return;
+    if (!graph.AccessesResource(i, buffer) || cmd->IsProbe())
+      continue;
+    if (!cmd->IsCompareBuffer())
+      return;
+
+    compares->push_back(cmd->AsCompareBuffer());
+  }
+}
+
+// Adds to |cmds| the first draw or compute command of every pipeline not in
+// |seen|, unless a buffer, entry point or patch command on the pipeline comes
+// before it. Such a command may change the state the pipeline is built from.
+void CollectPrecompileCommands(
+    const std::vector<std::unique_ptr<Command>>& commands,
+    std::set<const Pipeline*>* seen,
+    std::vector<const Command*>* cmds) {
+  for (const auto& cmd : commands) {
+    if (cmd->IsRepeat()) {
+      CollectPrecompileCommands(cmd->AsRepeat()->GetCommands(), seen, cmds);
+      continue;
+    }
+
+    const bool uses_pipeline = cmd->IsCompute() || cmd->IsDrawRect() ||
+                               cmd->IsDrawGrid() || cmd->IsDrawArrays();
+    if (!uses_pipeline && !cmd->IsBuffer() && !cmd->IsEntryPoint() &&
+        !cmd->IsPatchParameterVertices()) {
+      continue;
+    }
+
+    const Pipeline* pipeline =
+        static_cast<PipelineCommand*>(cmd.get())->GetPipeline();
+    if (!pipeline || !seen->insert(pipeline).second)
+      continue;
+    if (uses_pipeline)
+      cmds->push_back(cmd.get());
+  }
+}
+
+}  // namespace
 
 Executor::Executor() = default;
 
@@ -41,6 +225,7 @@ Result Executor::CompileShaders(const amber::Script* script,
 
       ShaderCompiler sc(target_env, options->disable_spirv_validation,
                         script->GetVirtualFiles());
+      sc.SetCompileServer(options->compile_server);
 
       Result r;
       std::vector<uint32_t> data;
@@ -61,6 +246,29 @@ Result Executor::Execute(Engine* engine,
                          Delegate* delegate) {
   engine->SetEngineData(script->GetEngineData());
 
+  device_probes_ = options->device_probes && engine->SupportsDeviceProbes();
+  device_compares_ =
+      options->device_compares && engine->SupportsDeviceCompares();
+  spv_env_ = script->GetSpvTargetEnv();
+  disable_spirv_validation_ = options->disable_spirv_validation;
+  virtual_files_ = script->GetVirtualFiles();
+  compile_server_ = options->compile_server;
+  verification_queue_ = nullptr;
+  limit_readbacks_ = true;
+  device_probe_pipelines_.clear();
+  device_compare_pipelines_.clear();
+  extracted_images_.clear();
+  for (const auto& info : options->extractions) {
+    if (info.is_image_buffer)
+      extracted_images_.insert(info.buffer_name);
+    else
+      limit_readbacks_ = false;
+  }
+  if (options->verification_threads > 0) {
+    verification_queue_ =
+        MakeUnique<VerificationQueue>(options->verification_threads);
+  }
+
   if (!script->GetPipelines().empty()) {
     Result r = CompileShaders(script, shader_map, options);
     if (!r.IsSuccess())
@@ -87,25 +295,331 @@ Result Executor::Execute(Engine* engine,
       if (!r.IsSuccess())
         return r;
     }
+
+    // Build every pipeline whose state is already known now, all together,
+    // instead of one at a time when the commands run.
+    std::set<const Pipeline*> seen;
+    std::vector<const Command*> precompile;
+    CollectPrecompileCommands(script->GetCommands(), &seen, &precompile);
+    r = engine->PrecompilePipelines(precompile);
+    if (!r.IsSuccess())
+      return r;
   }
 
   if (options->execution_type == ExecutionType::kPipelineCreateOnly)
     return {};
 
-  // Process Commands
-  for (const auto& cmd : script->GetCommands()) {
-    if (delegate && delegate->LogExecuteCalls()) {
-      delegate->Log(std::to_string(cmd->GetLine()) + ": " + cmd->ToString());
+  // Process Commands. Compute commands which do not depend on anything still
+  // pending are handed to the engine together so they can overlap. With a
+  // single pipeline every command depends on the previous one, so nothing is
+  // batched.
+  const auto& commands = script->GetCommands();
+  const size_t pipeline_count = script->GetPipelines().size();
+  CommandGraph graph;
+  graph.Build(commands);
+
+  std::vector<bool> done(commands.size(), false);
+  for (size_t i = 0; i < commands.size(); ++i) {
+    if (done[i])
+      continue;
+
+    std::vector<size_t> batch = {i};
+    if (commands[i]->IsCompute() && pipeline_count > 1) {
+      batch = GetConcurrentComputeCommands(graph, commands, done,
+                                           pipeline_count, i);
+    }
+
+    // Once a queued check has failed no further commands are issued. Commands
+    // issued while the check was still running have already executed.
+    if (verification_queue_ && verification_queue_->HasFailed())
+      return verification_queue_->Join();
+
+    // A command writing a buffer which a pending verification reads, or
+    // reading a buffer it checks, waits for the verifications to finish.
+    if (verification_queue_ && verification_queue_->HasPending()) {
+      bool conflict = false;
+      for (size_t idx : batch) {
+        for (size_t dep : graph.GetDependencies(idx))
+          conflict = conflict || verification_queue_->IsPending(dep);
+      }
+      if (conflict) {
+        Result r = verification_queue_->Join();
+        if (!r.IsSuccess())
+          return r;
+      }
+    }
+
+    std::vector<const ComputeCommand*> computes;
+    for (size_t idx : batch) {
+      Command* cmd = commands[idx].get();
+      if (delegate && delegate->LogExecuteCalls()) {
+        delegate->Log(std::to_string(cmd->GetLine()) + ": " + cmd->ToString());
+      }
+      if (batch.size() > 1)
+        computes.push_back(cmd->AsCompute());
+      done[idx] = true;
+    }
+
+    if (computes.empty() && CanVerifyAsync(commands[i].get())) {
+      Command* cmd = commands[i].get();
+      verification_queue_->Push(i, [this, cmd]() { return VerifyOnHost(cmd); });
+      continue;
+    }
+
+    if (limit_readbacks_ || device_probes_ || device_compares_)
+      SetReadbackRegions(engine, graph, commands, i);
+
+    size_t failed = 0;
+    Result r = computes.empty()
+                   ? ExecuteCommand(engine, commands[i].get())
+                   : engine->DoConcurrentCompute(computes, &failed);
+    if (!r.IsSuccess()) {
+      // The commands the batch skipped over before the failing command come
+      // first in the script, so one of their failures is reported instead.
+      for (size_t j = i + 1; !computes.empty() && j < batch[failed]; ++j) {
+        if (done[j])
+          continue;
+
+        Result skipped = ExecuteCommand(engine, commands[j].get());
+        if (!skipped.IsSuccess()) {
+          r = skipped;
+          break;
+        }
+      }
+      return JoinVerifications(r);
+    }
+  }
+  return JoinVerifications({});
+}
+
+void Executor::SetReadbackRegions(
+    Engine* engine,
+    const CommandGraph& graph,
+    const std::vector<std::unique_ptr<Command>>& commands,
+    size_t idx) {
+  Pipeline* pipeline = GetColorAttachmentWriter(commands[idx].get());
+  if (!pipeline)
+    return;
+
+  for (const auto& info : pipeline->GetColorAttachments()) {
+    std::vector<ReadbackRegion> regions;
+    std::vector<const ProbeCommand*> probes;
+    const bool limited = GetProbedRegions(graph, commands, idx, info.buffer,
+                                          &regions, &probes);
+
+    // Nothing changes the attachment between the draw and these probes, so
+    // they can check the copy the device already holds. When every probe
+    // does, the regions only have to reach the host if one of them fails.
+    bool device_only = device_probes_ && limited;
+    for (const auto* probe : probes) {
+      if (device_probes_ && CanProbeOnDevice(probe))
+        device_probe_pipelines_[probe] = pipeline;
+      else
+        device_only = false;
     }
 
-    Result r = ExecuteCommand(engine, cmd.get());
+    // A comparison makes the attachment be read back completely, but the
+    // device copy is still compared in place.
+    if (device_compares_) {
+      std::vector<const CompareBufferCommand*> compares;
+      GetAttachmentCompares(graph, commands, idx, info.buffer, &compares);
+      for (const auto* compare : compares)
+        device_compare_pipelines_[{compare, info.buffer}] = pipeline;
+    }
+
+    if (!limit_readbacks_ || !limited ||
+        extracted_images_.count(info.buffer->GetName()) > 0) {
+      continue;
+    }
+    engine->SetReadbackRegions(pipeline, info.buffer, regions, !device_only);
+  }
+}
+
+bool Executor::CanProbeOnDevice(const ProbeCommand* cmd) {
+  auto* buffer = cmd->GetBuffer();
+  const Format* fmt = buffer->GetFormat();
+  if (!IsProbeShaderFormatSupported(*fmt, buffer->GetElementStride()))
+    return false;
+
+  ProbeShaderParams params;
+  Result r = GetProbeShaderParams(cmd, buffer->GetRowStride(),
+                                  buffer->GetWidth(), buffer->GetHeight(),
+                                  &params);
+  return r.IsSuccess() &&
+         GetHelperShader(GenerateProbeShader(*fmt)) != nullptr;
+}
+
+bool Executor::CanVerifyAsync(const Command* cmd) const {
+  if (!verification_queue_)
+    return false;
+
+  // Device checks record commands on the engine, which only the executing
+  // thread may use.
+  if (cmd->IsProbe())
+    return !device_probes_;
+  if (cmd->IsProbeSSBO())
+    return true;
+  if (cmd->IsCompareBuffer())
+    return !device_compares_;
+  return false;
+}
+
+Result Executor::JoinVerifications(Result result) {
+  if (!verification_queue_)
+    return result;
+
+  Result r = verification_queue_->Join();
+  if (!r.IsSuccess())
+    return r;
+  return result;
+}
+
+const std::vector<uint32_t>* Executor::GetHelperShader(
+    const std::string& source) {
+  auto it = helper_shaders_.find(source);
+  if (it == helper_shaders_.end()) {
+    Shader shader(kShaderTypeCompute);
+    shader.SetName("amber_helper_shader");
+    shader.SetFormat(kShaderFormatGlsl);
+    shader.SetData(source);
+
+    Pipeline pipeline(PipelineType::kCompute);
+    Pipeline::ShaderInfo shader_info(&shader, kShaderTypeCompute);
+
+    ShaderCompiler sc(spv_env_, disable_spirv_validation_, virtual_files_);
+    sc.SetCompileServer(compile_server_);
+    Result r;
+    std::vector<uint32_t> data;
+    std::tie(r, data) = sc.Compile(&pipeline, &shader_info, ShaderMap());
     if (!r.IsSuccess())
-      return r;
+      data.clear();
+
+    it = helper_shaders_.emplace(source, std::move(data)).first;
   }
-  return {};
+  return it->second.empty() ? nullptr : &it->second;
 }
 
-Result Executor::ExecuteCommand(Engine* engine, Command* cmd) {
+Result Executor::ProbeOnDevice(Engine* engine,
+                               const ProbeCommand* cmd,
+                               bool* handled) {
+  *handled = false;
+
+  // Only probes of an attachment which is unchanged since the last draw
+  // are checked on the device, see SetReadbackRegions.
+  auto it = device_probe_pipelines_.find(cmd);
+  if (it == device_probe_pipelines_.end())
+    return {};
+
+  auto* buffer = cmd->GetBuffer();
+  const Format* fmt = buffer->GetFormat();
+  ProbeShaderParams params;
+  Result r = GetProbeShaderParams(cmd, buffer->GetRowStride(),
+                                  buffer->GetWidth(), buffer->GetHeight(),
+                                  &params);
+  if (!r.IsSuccess())
+    return {};
+
+  const std::vector<uint32_t>* spirv =
+      GetHelperShader(GenerateProbeShader(*fmt));
+  if (!spirv)
+    return {};
+
+  *handled = true;
+  ProbeShaderResult result = {};
+  r = engine->DoDeviceProbe(cmd, it->second, *spirv, params, &result);
+  if (!r.IsSuccess())
+    return r;
+  if (result.mismatch_count == 0 && result.uncertain_count == 0)
+    return {};
+
+  // Texels too close to the tolerance for the single precision shader are
+  // decided by the verifier, from the probed texels the engine copied to the
+  // host.
+  if (result.uncertain_count > 0) {
+    return verifier_.Probe(cmd, fmt, buffer->GetElementStride(),
+                           buffer->GetRowStride(), buffer->GetWidth(),
+                           buffer->GetHeight(), buffer->ValuePtr()->data());
+  }
+
+  // Otherwise the engine only copied the first failing texel, which the
+  // verifier describes the same way as without device probes.
+  const uint32_t width = params.region[2];
+  const uint32_t x = params.region[0] + result.first_mismatch % width;
+  const uint32_t y = params.region[1] + result.first_mismatch / width;
+  return verifier_.ProbeFailure(cmd, fmt, buffer->GetElementStride(),
+                                buffer->GetRowStride(), x, y,
+                                result.mismatch_count,
+                                buffer->ValuePtr()->data());
+}
+
+Result Executor::CompareOnDevice(Engine* engine,
+                                 const CompareBufferCommand* cmd,
+                                 bool* handled) {
+  *handled = false;
+
+  // The RMSE is accumulated in double precision on the host, which a device
+  // reduction can not reproduce exactly.
+  const auto comparator = cmd->GetComparator();
+  if (comparator == CompareBufferCommand::Comparator::kRmse)
+    return {};
+
+  auto* buffer_1 = cmd->GetBuffer1();
+  auto* buffer_2 = cmd->GetBuffer2();
+  const bool is_histogram =
+      comparator == CompareBufferCommand::Comparator::kHistogramEmd;
+  Result r = is_histogram ? buffer_1->CheckHistogramEMDCompability(buffer_2)
+                          : buffer_1->CheckCompability(buffer_2);
+  if (!r.IsSuccess()) {
+    *handled = true;
+    return r;
+  }
+
+  if (!IsCompareShaderSupported(*buffer_1, *buffer_2))
+    return {};
+
+  // Only attachments which the device still holds are compared there.
+  // Uploading host contents for the comparison would cost more than the
+  // host verifier.
+  auto it1 = device_compare_pipelines_.find({cmd, buffer_1});
+  auto it2 = device_compare_pipelines_.find({cmd, buffer_2});
+  if (it1 == device_compare_pipelines_.end() ||
+      it2 == device_compare_pipelines_.end()) {
+    return {};
+  }
+
+  const std::vector<uint32_t>* spirv =
+      GetHelperShader(GenerateCompareShader());
+  if (!spirv)
+    return {};
+
+  *handled = true;
+  auto result = MakeUnique<CompareShaderResult>();
+  r = engine->DoDeviceCompare(cmd, it1->second, it2->second, *spirv,
+                              GetCompareShaderParams(*buffer_1, is_histogram),
+                              result.get());
+  if (!r.IsSuccess())
+    return r;
+
+  if (!is_histogram) {
+    return buffer_1->GetEqualityResult(buffer_2, result->num_different,
+                                       result->first_different_index);
+  }
+
+  std::vector<std::vector<uint64_t>> histogram1;
+  std::vector<std::vector<uint64_t>> histogram2;
+  for (uint32_t c = 0; c < kCompareShaderHistogramChannels; ++c) {
+    histogram1.emplace_back(
+        result->histograms[0][c],
+        result->histograms[0][c] + kCompareShaderHistogramBins);
+    histogram2.emplace_back(
+        result->histograms[1][c],
+        result->histograms[1][c] + kCompareShaderHistogramBins);
+  }
+  return buffer_1->CompareHistograms(buffer_2, histogram1, histogram2,
+                                     cmd->GetTolerance());
+}
+
+Result Executor::VerifyOnHost(Command* cmd) {
   if (cmd->IsProbe()) {
     auto* buffer = cmd->AsProbe()->GetBuffer();
     assert(buffer);
@@ -124,14 +638,6 @@ Result Executor::ExecuteCommand(Engine* engine, Command* cmd) {
     return verifier_.ProbeSSBO(probe_ssbo, buffer->ElementCount(),
                                buffer->ValuePtr()->data());
   }
-  if (cmd->IsClear())
-    return engine->DoClear(cmd->AsClear());
-  if (cmd->IsClearColor())
-    return engine->DoClearColor(cmd->AsClearColor());
-  if (cmd->IsClearDepth())
-    return engine->DoClearDepth(cmd->AsClearDepth());
-  if (cmd->IsClearStencil())
-    return engine->DoClearStencil(cmd->AsClearStencil());
   if (cmd->IsCompareBuffer()) {
     auto compare = cmd->AsCompareBuffer();
     auto buffer_1 = compare->GetBuffer1();
@@ -145,6 +651,41 @@ Result Executor::ExecuteCommand(Engine* engine, Command* cmd) {
         return buffer_1->IsEqual(buffer_2);
     }
   }
+  return Result("Executor::VerifyOnHost unknown verification command");
+}
+
+Result Executor::ExecuteCommand(Engine* engine, Command* cmd) {
+  if (cmd->IsProbe()) {
+    if (device_probes_) {
+      bool handled = false;
+      Result r = ProbeOnDevice(engine, cmd->AsProbe(), &handled);
+      if (handled || !r.IsSuccess())
+        return r;
+    }
+
+    return VerifyOnHost(cmd);
+  }
+  if (cmd->IsProbeSSBO())
+    return VerifyOnHost(cmd);
+  if (cmd->IsClear())
+    return engine->DoClear(cmd->AsClear());
+  if (cmd->IsClearColor())
+    return engine->DoClearColor(cmd->AsClearColor());
+  if (cmd->IsClearDepth())
+    return engine->DoClearDepth(cmd->AsClearDepth());
+  if (cmd->IsClearStencil())
+    return engine->DoClearStencil(cmd->AsClearStencil());
+  if (cmd->IsCompareBuffer()) {
+    auto compare = cmd->AsCompareBuffer();
+    if (device_compares_) {
+      bool handled = false;
+      Result r = CompareOnDevice(engine, compare, &handled);
+      if (handled || !r.IsSuccess())
+        return r;
+    }
+
+    return VerifyOnHost(cmd);
+  }
   if (cmd->IsCopy()) {
     auto copy = cmd->AsCopy();
     auto buffer_from = copy->GetBufferFrom();
@@ -166,6 +707,10 @@ Result Executor::ExecuteCommand(Engine* engine, Command* cmd) {
   if (cmd->IsBuffer())
     return engine->DoBuffer(cmd->AsBuffer());
   if (cmd->IsRepeat()) {
+    std::vector<const ComputeCommand*> computes;
+    if (GetRepeatedComputeCommands(cmd->AsRepeat(), &computes))
+      return engine->DoRepeatedCompute(computes, cmd->AsRepeat()->GetCount());
+
     for (uint32_t i = 0; i < cmd->AsRepeat()->GetCount(); ++i) {
       for (const auto& sub_cmd : cmd->AsRepeat()->GetCommands()) {
         Result r = ExecuteCommand(engine, sub_cmd.get());
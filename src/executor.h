@@ -15,10 +15,19 @@
 #ifndef SRC_EXECUTOR_H_
 #define SRC_EXECUTOR_H_
 
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "amber/amber.h"
 #include "amber/result.h"
 #include "src/engine.h"
+#include "src/command_graph.h"
 #include "src/script.h"
+#include "src/verification_queue.h"
 #include "src/verifier.h"
 
 namespace amber {
@@ -44,8 +53,61 @@ class Executor {
                         const ShaderMap& shader_map,
                         Options* options);
   Result ExecuteCommand(Engine* engine, Command* cmd);
+  /// Returns true if |cmd| is only checked on the host, so it can be handed
+  /// to the verification queue.
+  bool CanVerifyAsync(const Command* cmd) const;
+  /// Checks the probe or buffer comparison |cmd| on the host.
+  Result VerifyOnHost(Command* cmd);
+  /// Joins the pending verifications. Their first failure takes precedence
+  /// over |result|, which comes from a later command.
+  Result JoinVerifications(Result result);
+  /// Tells |engine| which regions of the color attachments written by the
+  /// command at |idx| of |commands| are probed before they are written again.
+  /// Records the probes and comparisons of them which can use the copy on
+  /// the device.
+  void SetReadbackRegions(Engine* engine,
+                          const CommandGraph& graph,
+                          const std::vector<std::unique_ptr<Command>>& commands,
+                          size_t idx);
+  /// Returns true if the probe shader can check |cmd|.
+  bool CanProbeOnDevice(const ProbeCommand* cmd);
+  /// Evaluates |cmd| with the probe shader on the device. |handled| is set to
+  /// false if the probe has to be checked on the host instead.
+  Result ProbeOnDevice(Engine* engine, const ProbeCommand* cmd, bool* handled);
+  /// Evaluates |cmd| with the compare shader on the device. |handled| is set
+  /// to false if the buffers have to be compared on the host instead.
+  Result CompareOnDevice(Engine* engine,
+                         const CompareBufferCommand* cmd,
+                         bool* handled);
+  /// Returns the compiled binary of the GLSL compute shader |source|, or
+  /// nullptr if it can not be compiled.
+  const std::vector<uint32_t>* GetHelperShader(const std::string& source);
 
   Verifier verifier_;
+  /// Only created if verification threads were requested.
+  std::unique_ptr<VerificationQueue> verification_queue_;
+  /// False if buffers are extracted by binding, which may name a color
+  /// attachment, so every attachment is read back completely.
+  bool limit_readbacks_ = true;
+  /// Names of the image buffers extracted after the execution, which are
+  /// always read back completely.
+  std::set<std::string> extracted_images_;
+  bool device_probes_ = false;
+  /// The pipeline whose color attachment on the device holds the texels a
+  /// probe checks, for every probe which runs on the device.
+  std::map<const ProbeCommand*, Pipeline*> device_probe_pipelines_;
+  bool device_compares_ = false;
+  /// The pipeline whose color attachment on the device holds a buffer read by
+  /// a comparison, for the buffers which are compared in place.
+  std::map<std::pair<const CompareBufferCommand*, const Buffer*>, Pipeline*>
+      device_compare_pipelines_;
+  std::string spv_env_;
+  bool disable_spirv_validation_ = false;
+  VirtualFileStore* virtual_files_ = nullptr;
+  std::string compile_server_;
+  /// Compiled probe and compare shaders keyed by their GLSL source. A failed
+  /// compile is stored as an empty binary so it is not retried.
+  std::map<std::string, std::vector<uint32_t>> helper_shaders_;
 };
 
 }  // namespace amber
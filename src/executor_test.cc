@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "src/amberscript/parser.h"
 #include "src/engine.h"
 #include "src/make_unique.h"
 #include "src/vkscript/parser.h"
@@ -51,8 +52,21 @@ class EngineStub : public Engine {
   }
   uint32_t GetFenceTimeoutMs() { return GetEngineData().fence_timeout_ms; }
 
+  void SetUnsupportedFormat(FormatType type) { unsupported_format_ = type; }
+  bool IsFormatSupported(const Format& format, BufferType) const override {
+    return format.GetFormatType() != unsupported_format_;
+  }
+
   Result CreatePipeline(Pipeline*) override { return {}; }
 
+  const std::vector<const Command*>& GetPrecompiledCommands() const {
+    return precompiled_commands_;
+  }
+  Result PrecompilePipelines(const std::vector<const Command*>& cmds) override {
+    precompiled_commands_ = cmds;
+    return {};
+  }
+
   void FailClearColorCommand() { fail_clear_color_command_ = true; }
   bool DidClearColorCommand() { return did_clear_color_command_ = true; }
   ClearColorCommand* GetLastClearColorCommand() { return last_clear_color_; }
@@ -127,15 +141,36 @@ class EngineStub : public Engine {
   }
 
   void FailComputeCommand() { fail_compute_command_ = true; }
+  void FailComputeCommandOnPipeline(const Pipeline* pipeline) {
+    fail_compute_pipeline_ = pipeline;
+  }
   bool DidComputeCommand() const { return did_compute_command_; }
-  Result DoCompute(const ComputeCommand*) override {
+  uint32_t GetComputeCommandCount() const { return compute_command_count_; }
+  Result DoCompute(const ComputeCommand* cmd) override {
     did_compute_command_ = true;
+    ++compute_command_count_;
 
-    if (fail_compute_command_)
+    if (fail_compute_command_ || cmd->GetPipeline() == fail_compute_pipeline_)
       return Result("compute command failed");
     return {};
   }
 
+  uint32_t GetRepeatedComputeCount() const { return repeated_compute_count_; }
+  Result DoRepeatedCompute(const std::vector<const ComputeCommand*>& cmds,
+                           uint32_t count) override {
+    ++repeated_compute_count_;
+    return Engine::DoRepeatedCompute(cmds, count);
+  }
+
+  const std::vector<size_t>& GetConcurrentComputeSizes() const {
+    return concurrent_compute_sizes_;
+  }
+  Result DoConcurrentCompute(const std::vector<const ComputeCommand*>& cmds,
+                             size_t* failed) override {
+    concurrent_compute_sizes_.push_back(cmds.size());
+    return Engine::DoConcurrentCompute(cmds, failed);
+  }
+
   void FailEntryPointCommand() { fail_entry_point_command_ = true; }
   bool DidEntryPointCommand() const { return did_entry_point_command_; }
   Result DoEntryPoint(const EntryPointCommand*) override {
@@ -157,6 +192,16 @@ class EngineStub : public Engine {
     return {};
   }
 
+  const std::vector<std::vector<ReadbackRegion>>& GetReadbackRegions() const {
+    return readback_regions_;
+  }
+  void SetReadbackRegions(Pipeline*,
+                          const Buffer*,
+                          const std::vector<ReadbackRegion>& regions,
+                          bool) override {
+    readback_regions_.push_back(regions);
+  }
+
   void FailBufferCommand() { fail_buffer_command_ = true; }
   bool DidBufferCommand() const { return did_buffer_command_; }
   Result DoBuffer(const BufferCommand*) override {
@@ -176,6 +221,7 @@ class EngineStub : public Engine {
   bool fail_draw_grid_command_ = false;
   bool fail_draw_arrays_command_ = false;
   bool fail_compute_command_ = false;
+  const Pipeline* fail_compute_pipeline_ = nullptr;
   bool fail_entry_point_command_ = false;
   bool fail_patch_command_ = false;
   bool fail_buffer_command_ = false;
@@ -192,6 +238,13 @@ class EngineStub : public Engine {
   bool did_patch_command_ = false;
   bool did_buffer_command_ = false;
 
+  uint32_t compute_command_count_ = 0;
+  uint32_t repeated_compute_count_ = 0;
+  std::vector<size_t> concurrent_compute_sizes_;
+  std::vector<const Command*> precompiled_commands_;
+  std::vector<std::vector<ReadbackRegion>> readback_regions_;
+  FormatType unsupported_format_ = FormatType::kUnknown;
+
   std::vector<std::string> features_;
   std::vector<std::string> instance_extensions_;
   std::vector<std::string> device_extensions_;
@@ -199,10 +252,10 @@ class EngineStub : public Engine {
   ClearColorCommand* last_clear_color_ = nullptr;
 };
 
-class VkScriptExecutorTest : public testing::Test {
+class ExecutorTest : public testing::Test {
  public:
-  VkScriptExecutorTest() = default;
-  ~VkScriptExecutorTest() override = default;
+  ExecutorTest() = default;
+  ~ExecutorTest() override = default;
 
   std::unique_ptr<Engine> MakeEngine() { return MakeUnique<EngineStub>(); }
   std::unique_ptr<Engine> MakeAndInitializeEngine(
@@ -219,6 +272,9 @@ class VkScriptExecutorTest : public testing::Test {
   }
 };
 
+using VkScriptExecutorTest = ExecutorTest;
+using AmberScriptExecutorTest = ExecutorTest;
+
 }  // namespace
 
 TEST_F(VkScriptExecutorTest, ExecutesRequiredFeatures) {
@@ -874,5 +930,652 @@ probe ssbo vec3 0 2 <= 2 3 4)";
   EXPECT_EQ("probe ssbo command failed", r.Error());
 }
 
+TEST_F(AmberScriptExecutorTest, RepeatedComputeCommands) {
+  std::string input = R"(
+SHADER compute shader GLSL
+# shader
+END
+
+PIPELINE compute my_pipeline
+  ATTACH shader
+END
+
+REPEAT 4
+  RUN my_pipeline 1 2 3
+  RUN my_pipeline 4 5 6
+END
+)";
+
+  amberscript::Parser parser;
+  ASSERT_TRUE(parser.Parse(input).IsSuccess());
+
+  auto engine = MakeEngine();
+  auto script = parser.GetScript();
+
+  ShaderMap shader_map;
+  shader_map["my_pipeline-shader"] = {0x07230203};
+
+  Options options;
+  Executor ex;
+  Result r =
+      ex.Execute(engine.get(), script.get(), shader_map, &options, nullptr);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+  EXPECT_EQ(1U, ToStub(engine.get())->GetRepeatedComputeCount());
+  EXPECT_EQ(8U, ToStub(engine.get())->GetComputeCommandCount());
+}
+
+TEST_F(AmberScriptExecutorTest, RepeatedComputeCommandsFailure) {
+  std::string input = R"(
+SHADER compute shader GLSL
+# shader
+END
+
+PIPELINE compute my_pipeline
+  ATTACH shader
+END
+
+REPEAT 4
+  RUN my_pipeline 1 2 3
+END
+)";
+
+  amberscript::Parser parser;
+  ASSERT_TRUE(parser.Parse(input).IsSuccess());
+
+  auto engine = MakeEngine();
+  ToStub(engine.get())->FailComputeCommand();
+  auto script = parser.GetScript();
+
+  ShaderMap shader_map;
+  shader_map["my_pipeline-shader"] = {0x07230203};
+
+  Options options;
+  Executor ex;
+  Result r =
+      ex.Execute(engine.get(), script.get(), shader_map, &options, nullptr);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("compute command failed", r.Error());
+  EXPECT_EQ(1U, ToStub(engine.get())->GetComputeCommandCount());
+}
+
+TEST_F(AmberScriptExecutorTest, RepeatWithIndirectComputeNotBatched) {
+  std::string input = R"(
+SHADER compute shader GLSL
+# shader
+END
+
+BUFFER params DATA_TYPE uint32 DATA 1 1 1 END
+
+PIPELINE compute my_pipeline
+  ATTACH shader
+END
+
+REPEAT 3
+  RUN my_pipeline INDIRECT params
+END
+)";
+
+  amberscript::Parser parser;
+  ASSERT_TRUE(parser.Parse(input).IsSuccess());
+
+  auto engine = MakeEngine();
+  auto script = parser.GetScript();
+
+  ShaderMap shader_map;
+  shader_map["my_pipeline-shader"] = {0x07230203};
+
+  Options options;
+  Executor ex;
+  Result r =
+      ex.Execute(engine.get(), script.get(), shader_map, &options, nullptr);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+  EXPECT_EQ(0U, ToStub(engine.get())->GetRepeatedComputeCount());
+  EXPECT_EQ(3U, ToStub(engine.get())->GetComputeCommandCount());
+}
+
+TEST_F(AmberScriptExecutorTest, RepeatWithMultiplePipelinesNotBatched) {
+  std::string input = R"(
+SHADER compute shader GLSL
+# shader
+END
+
+PIPELINE compute my_pipeline
+  ATTACH shader
+END
+
+PIPELINE compute other_pipeline
+  ATTACH shader
+END
+
+REPEAT 3
+  RUN my_pipeline 1 1 1
+  RUN other_pipeline 1 1 1
+END
+)";
+
+  amberscript::Parser parser;
+  ASSERT_TRUE(parser.Parse(input).IsSuccess());
+
+  auto engine = MakeEngine();
+  auto script = parser.GetScript();
+
+  ShaderMap shader_map;
+  shader_map["my_pipeline-shader"] = {0x07230203};
+  shader_map["other_pipeline-shader"] = {0x07230203};
+
+  Options options;
+  Executor ex;
+  Result r =
+      ex.Execute(engine.get(), script.get(), shader_map, &options, nullptr);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+  EXPECT_EQ(0U, ToStub(engine.get())->GetRepeatedComputeCount());
+  EXPECT_EQ(6U, ToStub(engine.get())->GetComputeCommandCount());
+}
+
+TEST_F(AmberScriptExecutorTest, IndependentComputeCommandsRunConcurrently) {
+  std::string input = R"(
+SHADER compute shader GLSL
+# shader
+END
+
+BUFFER buf_a DATA_TYPE uint32 SIZE 4 FILL 0
+BUFFER buf_b DATA_TYPE uint32 SIZE 4 FILL 0
+
+PIPELINE compute pipeline_a
+  ATTACH shader
+  BIND BUFFER buf_a AS storage DESCRIPTOR_SET 0 BINDING 0
+END
+PIPELINE compute pipeline_b
+  ATTACH shader
+  BIND BUFFER buf_b AS storage DESCRIPTOR_SET 0 BINDING 0
+END
+
+RUN pipeline_a 1 1 1
+RUN pipeline_b 1 1 1
+)";
+
+  amberscript::Parser parser;
+  ASSERT_TRUE(parser.Parse(input).IsSuccess());
+
+  auto engine = MakeEngine();
+  auto script = parser.GetScript();
+
+  ShaderMap shader_map;
+  shader_map["pipeline_a-shader"] = {0x07230203};
+  shader_map["pipeline_b-shader"] = {0x07230203};
+
+  Options options;
+  Executor ex;
+  Result r =
+      ex.Execute(engine.get(), script.get(), shader_map, &options, nullptr);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+  ASSERT_EQ(1U, ToStub(engine.get())->GetConcurrentComputeSizes().size());
+  EXPECT_EQ(2U, ToStub(engine.get())->GetConcurrentComputeSizes()[0]);
+  EXPECT_EQ(2U, ToStub(engine.get())->GetComputeCommandCount());
+}
+
+TEST_F(AmberScriptExecutorTest, ComputeCommandsSharingBufferNotConcurrent) {
+  std::string input = R"(
+SHADER compute shader GLSL
+# shader
+END
+
+BUFFER buf_a DATA_TYPE uint32 SIZE 4 FILL 0
+BUFFER buf_b DATA_TYPE uint32 SIZE 4 FILL 0
+
+PIPELINE compute pipeline_a
+  ATTACH shader
+  BIND BUFFER buf_a AS storage DESCRIPTOR_SET 0 BINDING 0
+END
+PIPELINE compute pipeline_b
+  ATTACH shader
+  BIND BUFFER buf_a AS storage DESCRIPTOR_SET 0 BINDING 0
+END
+
+RUN pipeline_a 1 1 1
+RUN pipeline_b 1 1 1
+)";
+
+  amberscript::Parser parser;
+  ASSERT_TRUE(parser.Parse(input).IsSuccess());
+
+  auto engine = MakeEngine();
+  auto script = parser.GetScript();
+
+  ShaderMap shader_map;
+  shader_map["pipeline_a-shader"] = {0x07230203};
+  shader_map["pipeline_b-shader"] = {0x07230203};
+
+  Options options;
+  Executor ex;
+  Result r =
+      ex.Execute(engine.get(), script.get(), shader_map, &options, nullptr);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+  EXPECT_TRUE(ToStub(engine.get())->GetConcurrentComputeSizes().empty());
+  EXPECT_EQ(2U, ToStub(engine.get())->GetComputeCommandCount());
+}
+
+TEST_F(AmberScriptExecutorTest, PrecompilesFirstCommandOfEachPipeline) {
+  std::string input = R"(
+SHADER compute shader GLSL
+# shader
+END
+
+BUFFER buf_a DATA_TYPE uint32 SIZE 4 FILL 0
+BUFFER buf_b DATA_TYPE uint32 SIZE 4 FILL 0
+
+PIPELINE compute pipeline_a
+  ATTACH shader
+  BIND BUFFER buf_a AS storage DESCRIPTOR_SET 0 BINDING 0
+END
+PIPELINE compute pipeline_b
+  ATTACH shader
+  BIND BUFFER buf_b AS storage DESCRIPTOR_SET 0 BINDING 0
+END
+
+RUN pipeline_a 1 1 1
+REPEAT 2
+  RUN pipeline_b 1 1 1
+  RUN pipeline_a 1 1 1
+END
+)";
+
+  amberscript::Parser parser;
+  ASSERT_TRUE(parser.Parse(input).IsSuccess());
+
+  auto engine = MakeEngine();
+  auto script = parser.GetScript();
+
+  ShaderMap shader_map;
+  shader_map["pipeline_a-shader"] = {0x07230203};
+  shader_map["pipeline_b-shader"] = {0x07230203};
+
+  Options options;
+  options.execution_type = ExecutionType::kPipelineCreateOnly;
+  Executor ex;
+  Result r =
+      ex.Execute(engine.get(), script.get(), shader_map, &options, nullptr);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+  EXPECT_EQ(0U, ToStub(engine.get())->GetComputeCommandCount());
+
+  const auto& commands = script->GetCommands();
+  const auto& precompiled = ToStub(engine.get())->GetPrecompiledCommands();
+  ASSERT_EQ(2U, precompiled.size());
+  EXPECT_EQ(commands[0].get(), precompiled[0]);
+  EXPECT_EQ(commands[1]->AsRepeat()->GetCommands()[0].get(), precompiled[1]);
+}
+
+TEST_F(VkScriptExecutorTest, NoPrecompileAfterBufferCommand) {
+  std::string input = R"(
+[test]
+ssbo 0 24
+compute 2 3 4)";
+
+  Parser parser;
+  parser.SkipValidationForTest();
+  ASSERT_TRUE(parser.Parse(input).IsSuccess());
+
+  auto engine = MakeEngine();
+  auto script = parser.GetScript();
+
+  Options options;
+  Executor ex;
+  Result r =
+      ex.Execute(engine.get(), script.get(), ShaderMap(), &options, nullptr);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+  EXPECT_TRUE(ToStub(engine.get())->GetPrecompiledCommands().empty());
+  EXPECT_TRUE(ToStub(engine.get())->DidComputeCommand());
+}
+
+TEST_F(AmberScriptExecutorTest, IndependentComputeCommandMovedAheadOfProbe) {
+  std::string input = R"(
+SHADER compute shader GLSL
+# shader
+END
+
+BUFFER buf_a DATA_TYPE uint32 SIZE 4 FILL 0
+BUFFER buf_b DATA_TYPE uint32 SIZE 4 FILL 0
+
+PIPELINE compute pipeline_a
+  ATTACH shader
+  BIND BUFFER buf_a AS storage DESCRIPTOR_SET 0 BINDING 0
+END
+PIPELINE compute pipeline_b
+  ATTACH shader
+  BIND BUFFER buf_b AS storage DESCRIPTOR_SET 0 BINDING 0
+END
+
+RUN pipeline_a 1 1 1
+EXPECT buf_a IDX 0 EQ 0
+RUN pipeline_b 1 1 1
+RUN pipeline_a 1 1 1
+)";
+
+  amberscript::Parser parser;
+  ASSERT_TRUE(parser.Parse(input).IsSuccess());
+
+  auto engine = MakeEngine();
+  auto script = parser.GetScript();
+
+  ShaderMap shader_map;
+  shader_map["pipeline_a-shader"] = {0x07230203};
+  shader_map["pipeline_b-shader"] = {0x07230203};
+
+  Options options;
+  Executor ex;
+  Result r =
+      ex.Execute(engine.get(), script.get(), shader_map, &options, nullptr);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+  ASSERT_EQ(1U, ToStub(engine.get())->GetConcurrentComputeSizes().size());
+  EXPECT_EQ(2U, ToStub(engine.get())->GetConcurrentComputeSizes()[0]);
+  EXPECT_EQ(3U, ToStub(engine.get())->GetComputeCommandCount());
+}
+
+TEST_F(AmberScriptExecutorTest, AsyncVerificationReportsSameFailure) {
+  std::string input = R"(
+SHADER compute shader GLSL
+# shader
+END
+
+BUFFER buf_a DATA_TYPE uint32 SIZE 4 FILL 0
+BUFFER buf_b DATA_TYPE uint32 SIZE 4 FILL 0
+
+PIPELINE compute pipeline_a
+  ATTACH shader
+  BIND BUFFER buf_a AS storage DESCRIPTOR_SET 0 BINDING 0
+END
+PIPELINE compute pipeline_b
+  ATTACH shader
+  BIND BUFFER buf_b AS storage DESCRIPTOR_SET 0 BINDING 0
+  BIND BUFFER buf_a AS uniform DESCRIPTOR_SET 0 BINDING 1
+END
+
+RUN pipeline_a 1 1 1
+EXPECT buf_a IDX 0 EQ 0
+EXPECT buf_a IDX 4 EQ 1
+EXPECT buf_a IDX 8 EQ 2
+RUN pipeline_b 1 1 1
+RUN pipeline_a 1 1 1
+)";
+
+  ShaderMap shader_map;
+  shader_map["pipeline_a-shader"] = {0x07230203};
+  shader_map["pipeline_b-shader"] = {0x07230203};
+
+  std::string errors[2];
+  uint32_t compute_counts[2] = {};
+  for (uint32_t threads = 0; threads < 2; ++threads) {
+    amberscript::Parser parser;
+    ASSERT_TRUE(parser.Parse(input).IsSuccess());
+
+    auto engine = MakeEngine();
+    auto script = parser.GetScript();
+
+    Options options;
+    options.verification_threads = threads * 2;
+    Executor ex;
+    Result r =
+        ex.Execute(engine.get(), script.get(), shader_map, &options, nullptr);
+    ASSERT_FALSE(r.IsSuccess());
+    errors[threads] = r.Error();
+    compute_counts[threads] = ToStub(engine.get())->GetComputeCommandCount();
+  }
+  EXPECT_EQ(errors[0], errors[1]);
+  // Without workers the executor stops at the failing EXPECT. With workers
+  // the RUN of pipeline_b, which only reads the checked buffer, goes ahead
+  // unless the failure is already known, but the RUN of pipeline_a writing it
+  // waits for the checks and is not executed.
+  EXPECT_EQ(1U, compute_counts[0]);
+  EXPECT_GE(compute_counts[1], 1U);
+  EXPECT_LE(compute_counts[1], 2U);
+}
+
+TEST_F(AmberScriptExecutorTest, AsyncVerificationFailureBeforeCommandFailure) {
+  std::string input = R"(
+SHADER compute shader GLSL
+# shader
+END
+
+BUFFER buf_a DATA_TYPE uint32 SIZE 4 FILL 0
+BUFFER buf_b DATA_TYPE uint32 SIZE 4 FILL 0
+
+PIPELINE compute pipeline_b
+  ATTACH shader
+  BIND BUFFER buf_b AS storage DESCRIPTOR_SET 0 BINDING 0
+END
+
+EXPECT buf_a IDX 0 EQ 1
+RUN pipeline_b 1 1 1
+)";
+
+  amberscript::Parser parser;
+  ASSERT_TRUE(parser.Parse(input).IsSuccess());
+
+  auto engine = MakeEngine();
+  ToStub(engine.get())->FailComputeCommand();
+  auto script = parser.GetScript();
+
+  ShaderMap shader_map;
+  shader_map["pipeline_b-shader"] = {0x07230203};
+
+  Options options;
+  options.verification_threads = 1;
+  Executor ex;
+  Result r =
+      ex.Execute(engine.get(), script.get(), shader_map, &options, nullptr);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("Line 14: Verifier failed: 0 == 1, at index 0", r.Error());
+}
+
+TEST_F(AmberScriptExecutorTest, SkippedCommandFailureBeforeBatchFailure) {
+  std::string input = R"(
+SHADER compute shader GLSL
+# shader
+END
+
+BUFFER buf_a DATA_TYPE uint32 SIZE 4 FILL 0
+BUFFER buf_b DATA_TYPE uint32 SIZE 4 FILL 0
+
+PIPELINE compute pipeline_a
+  ATTACH shader
+  BIND BUFFER buf_a AS storage DESCRIPTOR_SET 0 BINDING 0
+END
+PIPELINE compute pipeline_b
+  ATTACH shader
+  BIND BUFFER buf_b AS storage DESCRIPTOR_SET 0 BINDING 0
+END
+
+RUN pipeline_a 1 1 1
+EXPECT buf_a IDX 0 EQ 1
+RUN pipeline_b 1 1 1
+)";
+
+  amberscript::Parser parser;
+  ASSERT_TRUE(parser.Parse(input).IsSuccess());
+
+  auto engine = MakeEngine();
+  auto script = parser.GetScript();
+  ToStub(engine.get())
+      ->FailComputeCommandOnPipeline(script->GetPipeline("pipeline_b"));
+
+  ShaderMap shader_map;
+  shader_map["pipeline_a-shader"] = {0x07230203};
+  shader_map["pipeline_b-shader"] = {0x07230203};
+
+  Options options;
+  Executor ex;
+  Result r =
+      ex.Execute(engine.get(), script.get(), shader_map, &options, nullptr);
+  ASSERT_FALSE(r.IsSuccess());
+  // pipeline_b runs together with pipeline_a ahead of the EXPECT, but the
+  // EXPECT comes first in the script so its failure is the one reported.
+  ASSERT_EQ(1U, ToStub(engine.get())->GetConcurrentComputeSizes().size());
+  EXPECT_EQ(2U, ToStub(engine.get())->GetConcurrentComputeSizes()[0]);
+  EXPECT_EQ("Line 19: Verifier failed: 0 == 1, at index 0", r.Error());
+}
+
+const char kDrawAndProbe[] = R"(
+SHADER vertex vert_shader PASSTHROUGH
+SHADER fragment frag_shader GLSL
+# shader
+END
+
+BUFFER framebuffer FORMAT B8G8R8A8_UNORM
+BUFFER other FORMAT B8G8R8A8_UNORM
+
+PIPELINE graphics pipeline
+  ATTACH vert_shader
+  ATTACH frag_shader
+  FRAMEBUFFER_SIZE 64 64
+  BIND BUFFER framebuffer AS color LOCATION 0
+END
+
+PIPELINE graphics other_pipeline
+  ATTACH vert_shader
+  ATTACH frag_shader
+  FRAMEBUFFER_SIZE 64 64
+  BIND BUFFER other AS color LOCATION 0
+END
+
+RUN pipeline DRAW_RECT POS 0 0 SIZE 64 64
+)";
+
+ShaderMap GetDrawAndProbeShaders() {
+  ShaderMap shader_map;
+  shader_map["pipeline-vert_shader"] = {0x07230203};
+  shader_map["pipeline-frag_shader"] = {0x07230203};
+  shader_map["other_pipeline-vert_shader"] = {0x07230203};
+  shader_map["other_pipeline-frag_shader"] = {0x07230203};
+  return shader_map;
+}
+
+TEST_F(AmberScriptExecutorTest, ReadbackLimitedToProbedRegions) {
+  std::string input = std::string(kDrawAndProbe) + R"(
+EXPECT framebuffer IDX 1 2 SIZE 3 4 EQ_RGBA 0 0 0 0
+EXPECT framebuffer IDX 10 10 SIZE 1 1 EQ_RGBA 0 0 0 0
+EXPECT framebuffer IDX 1 2 SIZE 3 4 EQ_RGBA 0 0 0 0
+RUN pipeline DRAW_RECT POS 0 0 SIZE 64 64
+)";
+
+  amberscript::Parser parser;
+  ASSERT_TRUE(parser.Parse(input).IsSuccess());
+
+  auto engine = MakeEngine();
+  auto script = parser.GetScript();
+
+  ShaderMap shader_map = GetDrawAndProbeShaders();
+
+  Options options;
+  Executor ex;
+  ex.Execute(engine.get(), script.get(), shader_map, &options, nullptr);
+
+  const auto& hints = ToStub(engine.get())->GetReadbackRegions();
+  ASSERT_FALSE(hints.empty());
+  ASSERT_EQ(2U, hints[0].size());
+  EXPECT_EQ(1U, hints[0][0].x);
+  EXPECT_EQ(2U, hints[0][0].y);
+  EXPECT_EQ(3U, hints[0][0].width);
+  EXPECT_EQ(4U, hints[0][0].height);
+  EXPECT_EQ(10U, hints[0][1].x);
+  EXPECT_EQ(10U, hints[0][1].y);
+  EXPECT_EQ(1U, hints[0][1].width);
+  EXPECT_EQ(1U, hints[0][1].height);
+}
+
+TEST_F(AmberScriptExecutorTest, ReadbackNotLimited) {
+  const char* kFollowUps[] = {
+      // The whole attachment is probed.
+      "EXPECT framebuffer IDX 0 0 SIZE 64 64 EQ_RGBA 0 0 0 0\n",
+      // The attachment is read by something other than a probe.
+      "EXPECT framebuffer EQ_BUFFER other\n",
+      "COPY framebuffer TO other\n",
+  };
+  for (const char* follow_up : kFollowUps) {
+    amberscript::Parser parser;
+    Result r = parser.Parse(
+        std::string(kDrawAndProbe) +
+        "EXPECT framebuffer IDX 0 0 SIZE 1 1 EQ_RGBA 0 0 0 0\n" + follow_up);
+    ASSERT_TRUE(r.IsSuccess()) << r.Error();
+
+    auto engine = MakeEngine();
+    auto script = parser.GetScript();
+
+    ShaderMap shader_map = GetDrawAndProbeShaders();
+
+    Options options;
+    Executor ex;
+    ex.Execute(engine.get(), script.get(), shader_map, &options, nullptr);
+    EXPECT_TRUE(ToStub(engine.get())->GetReadbackRegions().empty())
+        << follow_up;
+  }
+}
+
+TEST_F(AmberScriptExecutorTest, ReadbackNotLimitedForExtractedImage) {
+  amberscript::Parser parser;
+  ASSERT_TRUE(parser.Parse(kDrawAndProbe).IsSuccess());
+
+  auto engine = MakeEngine();
+  auto script = parser.GetScript();
+
+  ShaderMap shader_map = GetDrawAndProbeShaders();
+
+  Options options;
+  BufferInfo info;
+  info.is_image_buffer = true;
+  info.buffer_name = "framebuffer";
+  options.extractions.push_back(info);
+
+  Executor ex;
+  Result r =
+      ex.Execute(engine.get(), script.get(), shader_map, &options, nullptr);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+  EXPECT_TRUE(ToStub(engine.get())->GetReadbackRegions().empty());
+
+  // Without the extraction nothing reads the attachment after the draw.
+  options.extractions.clear();
+  auto engine2 = MakeEngine();
+  r = ex.Execute(engine2.get(), script.get(), shader_map, &options, nullptr);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+  ASSERT_EQ(1U, ToStub(engine2.get())->GetReadbackRegions().size());
+  EXPECT_TRUE(ToStub(engine2.get())->GetReadbackRegions()[0].empty());
+}
+
+TEST_F(AmberScriptExecutorTest, CheckFormatsSupported) {
+  std::string input = R"(
+SHADER vertex vert_shader PASSTHROUGH
+SHADER fragment frag_shader GLSL
+# shader
+END
+
+BUFFER framebuffer FORMAT B8G8R8A8_UNORM
+BUFFER depth FORMAT D32_SFLOAT_S8_UINT
+
+PIPELINE graphics pipeline
+  ATTACH vert_shader
+  ATTACH frag_shader
+  BIND BUFFER framebuffer AS color LOCATION 0
+  BIND BUFFER depth AS depth_stencil
+END
+)";
+
+  amberscript::Parser parser;
+  ASSERT_TRUE(parser.Parse(input).IsSuccess());
+  auto script = parser.GetScript();
+
+  auto engine = MakeEngine();
+  Result r = engine->CheckFormatsSupported(script->GetPipelines());
+  EXPECT_TRUE(r.IsSuccess()) << r.Error();
+
+  ToStub(engine.get())->SetUnsupportedFormat(FormatType::kB8G8R8A8_UNORM);
+  r = engine->CheckFormatsSupported(script->GetPipelines());
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("color attachment format is not supported", r.Error());
+
+  ToStub(engine.get())->SetUnsupportedFormat(FormatType::kD32_SFLOAT_S8_UINT);
+  r = engine->CheckFormatsSupported(script->GetPipelines());
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("depth attachment format is not supported", r.Error());
+}
+
 }  // namespace vkscript
 }  // namespace amber
@@ -17,6 +17,17 @@
 #include <cassert>
 #include <cstring>
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AMBER_FLOAT16_SSE2 1
+#define AMBER_FLOAT16_SIMD 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AMBER_FLOAT16_NEON 1
+#define AMBER_FLOAT16_SIMD 1
+#endif
+
 // Float10
 // | 9 8 7 6 5 | 4 3 2 1 0 |
 // | exponent  | mantissa  |
@@ -60,73 +71,187 @@ uint32_t FloatMantissa(const uint32_t hex_float) {
   return static_cast<uint32_t>(hex_float & ((1U << 23U) - 1U));
 }
 
+float BitsToFloat(uint32_t hex) {
+  float hex_float;
+  static_assert((sizeof(uint32_t) == sizeof(float)),
+                "sizeof(uint32_t) != sizeof(float)");
+  memcpy(&hex_float, &hex, sizeof(float));
+  return hex_float;
+}
+
 // Convert float |value| whose size is 16 bits to 32 bits float
 // based on IEEE-754.
-float HexFloat16ToFloat(const uint8_t* value) {
-  uint32_t sign = (static_cast<uint32_t>(value[1]) & 0x80) << 24U;
-  uint32_t exponent_bits = (static_cast<uint32_t>(value[1]) & 0x7c) >> 2U;
+float HexFloat16ToFloat(uint32_t value) {
+  uint32_t sign = (value & 0x8000U) << 16U;
+  uint32_t exponent_bits = (value & 0x7c00U) >> 10U;
   uint32_t exponent = 0U;
   uint32_t mantissa = 0U;
   // Handle zero and flush denormals to zero.
   if (exponent_bits != 0U) {
     exponent = (exponent_bits + 112U) << 23U;
-    mantissa = ((static_cast<uint32_t>(value[1]) & 0x3) << 8U |
-                static_cast<uint32_t>(value[0]))
-               << 13U;
+    mantissa = (value & 0x3ffU) << 13U;
   }
-
-  uint32_t hex = sign | exponent | mantissa;
-  float hex_float;
-  static_assert((sizeof(uint32_t) == sizeof(float)),
-                "sizeof(uint32_t) != sizeof(float)");
-  memcpy(&hex_float, &hex, sizeof(float));
-  return hex_float;
+  return BitsToFloat(sign | exponent | mantissa);
 }
 
 // Convert float |value| whose size is 11 bits to 32 bits float
 // based on IEEE-754.
-float HexFloat11ToFloat(const uint8_t* value) {
-  uint32_t exponent = (((static_cast<uint32_t>(value[1]) << 2U) |
-                        ((static_cast<uint32_t>(value[0]) & 0xc0) >> 6U)) +
-                       112U)
-                      << 23U;
-  uint32_t mantissa = (static_cast<uint32_t>(value[0]) & 0x3f) << 17U;
-
-  uint32_t hex = exponent | mantissa;
-  float hex_float;
-  static_assert((sizeof(uint32_t) == sizeof(float)),
-                "sizeof(uint32_t) != sizeof(float)");
-  memcpy(&hex_float, &hex, sizeof(float));
-  return hex_float;
+float HexFloat11ToFloat(uint32_t value) {
+  uint32_t exponent = ((value >> 6U) + 112U) << 23U;
+  uint32_t mantissa = (value & 0x3fU) << 17U;
+  return BitsToFloat(exponent | mantissa);
 }
 
 // Convert float |value| whose size is 10 bits to 32 bits float
 // based on IEEE-754.
-float HexFloat10ToFloat(const uint8_t* value) {
-  uint32_t exponent = (((static_cast<uint32_t>(value[1]) << 3U) |
-                        ((static_cast<uint32_t>(value[0]) & 0xe0) >> 5U)) +
-                       112U)
-                      << 23U;
-  uint32_t mantissa = (static_cast<uint32_t>(value[0]) & 0x1f) << 18U;
-
-  uint32_t hex = exponent | mantissa;
-  float hex_float;
-  static_assert((sizeof(uint32_t) == sizeof(float)),
-                "sizeof(uint32_t) != sizeof(float)");
-  memcpy(&hex_float, &hex, sizeof(float));
-  return hex_float;
+float HexFloat10ToFloat(uint32_t value) {
+  uint32_t exponent = ((value >> 5U) + 112U) << 23U;
+  uint32_t mantissa = (value & 0x1fU) << 18U;
+  return BitsToFloat(exponent | mantissa);
+}
+
+uint32_t ToUint16(const uint8_t* value) {
+  return static_cast<uint32_t>(value[0]) |
+         (static_cast<uint32_t>(value[1]) << 8U);
+}
+
+#if defined(AMBER_FLOAT16_SSE2)
+
+// The SSE2 and NEON paths below mirror the scalar conversions bit for bit,
+// including the flushing of denormals, four elements at a time.
+
+template <int kMantissaBits>
+__m128i SmallFloatsToFloatBits(__m128i v) {
+  const __m128i mantissa_mask = _mm_set1_epi32((1 << kMantissaBits) - 1);
+  __m128i exponent = _mm_slli_epi32(
+      _mm_add_epi32(_mm_srli_epi32(v, kMantissaBits), _mm_set1_epi32(112)),
+      23);
+  __m128i mantissa =
+      _mm_slli_epi32(_mm_and_si128(v, mantissa_mask), 23 - kMantissaBits);
+  return _mm_or_si128(exponent, mantissa);
 }
 
+__m128i Float16sToFloatBits(__m128i v) {
+  __m128i sign = _mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(0x8000)), 16);
+  __m128i exponent_bits =
+      _mm_and_si128(_mm_srli_epi32(v, 10), _mm_set1_epi32(0x1f));
+  __m128i is_zero = _mm_cmpeq_epi32(exponent_bits, _mm_setzero_si128());
+  __m128i exponent =
+      _mm_slli_epi32(_mm_add_epi32(exponent_bits, _mm_set1_epi32(112)), 23);
+  __m128i mantissa =
+      _mm_slli_epi32(_mm_and_si128(v, _mm_set1_epi32(0x3ff)), 13);
+  return _mm_or_si128(sign,
+                      _mm_andnot_si128(is_zero, _mm_or_si128(exponent, mantissa)));
+}
+
+template <typename Convert>
+size_t HexFloatToFloatVector(const uint16_t* src,
+                             float* dst,
+                             size_t count,
+                             Convert convert) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i halves = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+    __m128i v = _mm_unpacklo_epi16(halves, _mm_setzero_si128());
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), convert(v));
+  }
+  return i;
+}
+
+size_t FloatToHexFloat16Vector(const float* src, uint16_t* dst, size_t count) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i sign = _mm_and_si128(_mm_srli_epi32(v, 16), _mm_set1_epi32(0x8000));
+    __m128i exponent_bits =
+        _mm_and_si128(_mm_srli_epi32(v, 23), _mm_set1_epi32(0xff));
+    __m128i exponent =
+        _mm_and_si128(_mm_sub_epi32(exponent_bits, _mm_set1_epi32(112)),
+                      _mm_set1_epi32(0x1f));
+    exponent = _mm_andnot_si128(
+        _mm_cmpeq_epi32(exponent_bits, _mm_setzero_si128()), exponent);
+    // Flush denormals.
+    __m128i mantissa =
+        _mm_srli_epi32(_mm_and_si128(v, _mm_set1_epi32(0x7fffff)), 13);
+    mantissa = _mm_andnot_si128(_mm_cmpeq_epi32(exponent, _mm_setzero_si128()),
+                                mantissa);
+    __m128i half =
+        _mm_or_si128(_mm_or_si128(sign, _mm_slli_epi32(exponent, 10)), mantissa);
+    // Sign extend the low 16 bits so the saturating pack keeps them intact.
+    half = _mm_srai_epi32(_mm_slli_epi32(half, 16), 16);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i),
+                     _mm_packs_epi32(half, half));
+  }
+  return i;
+}
+
+#elif defined(AMBER_FLOAT16_NEON)
+
+template <int kMantissaBits>
+uint32x4_t SmallFloatsToFloatBits(uint32x4_t v) {
+  uint32x4_t exponent = vshlq_n_u32(
+      vaddq_u32(vshrq_n_u32(v, kMantissaBits), vdupq_n_u32(112)), 23);
+  uint32x4_t mantissa = vshlq_n_u32(
+      vandq_u32(v, vdupq_n_u32((1U << kMantissaBits) - 1U)),
+      23 - kMantissaBits);
+  return vorrq_u32(exponent, mantissa);
+}
+
+uint32x4_t Float16sToFloatBits(uint32x4_t v) {
+  uint32x4_t sign = vshlq_n_u32(vandq_u32(v, vdupq_n_u32(0x8000)), 16);
+  uint32x4_t exponent_bits = vandq_u32(vshrq_n_u32(v, 10), vdupq_n_u32(0x1f));
+  uint32x4_t is_zero = vceqq_u32(exponent_bits, vdupq_n_u32(0));
+  uint32x4_t exponent =
+      vshlq_n_u32(vaddq_u32(exponent_bits, vdupq_n_u32(112)), 23);
+  uint32x4_t mantissa = vshlq_n_u32(vandq_u32(v, vdupq_n_u32(0x3ff)), 13);
+  return vorrq_u32(sign, vbicq_u32(vorrq_u32(exponent, mantissa), is_zero));
+}
+
+template <typename Convert>
+size_t HexFloatToFloatVector(const uint16_t* src,
+                             float* dst,
+                             size_t count,
+                             Convert convert) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    uint32x4_t v = vmovl_u16(vld1_u16(src + i));
+    vst1q_f32(dst + i, vreinterpretq_f32_u32(convert(v)));
+  }
+  return i;
+}
+
+size_t FloatToHexFloat16Vector(const float* src, uint16_t* dst, size_t count) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    uint32x4_t v = vreinterpretq_u32_f32(vld1q_f32(src + i));
+    uint32x4_t sign = vandq_u32(vshrq_n_u32(v, 16), vdupq_n_u32(0x8000));
+    uint32x4_t exponent_bits = vandq_u32(vshrq_n_u32(v, 23), vdupq_n_u32(0xff));
+    uint32x4_t exponent = vandq_u32(vsubq_u32(exponent_bits, vdupq_n_u32(112)),
+                                    vdupq_n_u32(0x1f));
+    exponent = vbicq_u32(exponent, vceqq_u32(exponent_bits, vdupq_n_u32(0)));
+    // Flush denormals.
+    uint32x4_t mantissa =
+        vshrq_n_u32(vandq_u32(v, vdupq_n_u32(0x7fffff)), 13);
+    mantissa = vbicq_u32(mantissa, vceqq_u32(exponent, vdupq_n_u32(0)));
+    uint32x4_t half =
+        vorrq_u32(vorrq_u32(sign, vshlq_n_u32(exponent, 10)), mantissa);
+    vst1_u16(dst + i, vmovn_u32(half));
+  }
+  return i;
+}
+
+#endif  // defined(AMBER_FLOAT16_NEON)
+
 }  // namespace
 
 float HexFloatToFloat(const uint8_t* value, uint8_t bits) {
   switch (bits) {
     case 10:
-      return HexFloat10ToFloat(value);
+      return HexFloat10ToFloat(ToUint16(value));
     case 11:
-      return HexFloat11ToFloat(value);
+      return HexFloat11ToFloat(ToUint16(value));
     case 16:
-      return HexFloat16ToFloat(value);
+      return HexFloat16ToFloat(ToUint16(value));
   }
 
   assert(false && "Invalid bits");
@@ -144,5 +269,48 @@ uint16_t FloatToHexFloat16(const float value) {
                                static_cast<uint16_t>(mantissa >> 13U));
 }
 
+void HexFloatToFloatArray(const uint16_t* src,
+                          float* dst,
+                          size_t count,
+                          uint8_t bits) {
+  size_t i = 0;
+  float (*convert)(uint32_t) = nullptr;
+  switch (bits) {
+    case 10:
+#if defined(AMBER_FLOAT16_SIMD)
+      i = HexFloatToFloatVector(src, dst, count, SmallFloatsToFloatBits<5>);
+#endif
+      convert = HexFloat10ToFloat;
+      break;
+    case 11:
+#if defined(AMBER_FLOAT16_SIMD)
+      i = HexFloatToFloatVector(src, dst, count, SmallFloatsToFloatBits<6>);
+#endif
+      convert = HexFloat11ToFloat;
+      break;
+    case 16:
+#if defined(AMBER_FLOAT16_SIMD)
+      i = HexFloatToFloatVector(src, dst, count, Float16sToFloatBits);
+#endif
+      convert = HexFloat16ToFloat;
+      break;
+    default:
+      assert(false && "Invalid bits");
+      return;
+  }
+
+  for (; i < count; ++i)
+    dst[i] = convert(src[i]);
+}
+
+void FloatToHexFloat16Array(const float* src, uint16_t* dst, size_t count) {
+  size_t i = 0;
+#if defined(AMBER_FLOAT16_SIMD)
+  i = FloatToHexFloat16Vector(src, dst, count);
+#endif
+  for (; i < count; ++i)
+    dst[i] = FloatToHexFloat16(src[i]);
+}
+
 }  // namespace float16
 }  // namespace amber
@@ -15,6 +15,7 @@
 #ifndef SRC_FLOAT16_HELPER_H_
 #define SRC_FLOAT16_HELPER_H_
 
+#include <cstddef>
 #include <cstdint>
 
 namespace amber {
@@ -39,6 +40,19 @@ float HexFloatToFloat(const uint8_t* value, uint8_t bits);
 // Convert 32 bits float |value| to 16 bits float based on IEEE-754.
 uint16_t FloatToHexFloat16(const float value);
 
+// Convert |count| floats of |bits| bits stored one per 16 bit word in |src|
+// to 32 bits floats in |dst|. The results are identical to calling
+// HexFloatToFloat() on each element, but the conversion is done on several
+// elements at once where the CPU allows.
+void HexFloatToFloatArray(const uint16_t* src,
+                          float* dst,
+                          size_t count,
+                          uint8_t bits);
+
+// Convert |count| 32 bits floats in |src| to 16 bits floats in |dst|. The
+// results are identical to calling FloatToHexFloat16() on each element.
+void FloatToHexFloat16Array(const float* src, uint16_t* dst, size_t count);
+
 }  // namespace float16
 }  // namespace amber
 
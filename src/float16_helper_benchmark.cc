@@ -0,0 +1,103 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "src/float16_helper.h"
+
+namespace amber {
+namespace {
+
+void BM_Float16ToFloat(benchmark::State& state) {
+  std::vector<uint16_t> halves(static_cast<size_t>(state.range(0)));
+  for (size_t i = 0; i < halves.size(); ++i)
+    halves[i] = static_cast<uint16_t>(0x3c00 + (i % 0x400));
+
+  for (auto _ : state) {
+    float sum = 0.f;
+    for (const auto& h : halves) {
+      sum += float16::HexFloatToFloat(reinterpret_cast<const uint8_t*>(&h),
+                                      16);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Float16ToFloat)->Range(1 << 10, 1 << 20);
+
+void BM_FloatToFloat16(benchmark::State& state) {
+  std::vector<float> floats(static_cast<size_t>(state.range(0)));
+  for (size_t i = 0; i < floats.size(); ++i)
+    floats[i] = 1.0f + static_cast<float>(i % 1024) / 1024.f;
+
+  std::vector<uint16_t> halves(floats.size());
+  for (auto _ : state) {
+    for (size_t i = 0; i < floats.size(); ++i)
+      halves[i] = float16::FloatToHexFloat16(floats[i]);
+    benchmark::DoNotOptimize(halves.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FloatToFloat16)->Range(1 << 10, 1 << 20);
+
+void BM_Float16ArrayToFloat(benchmark::State& state) {
+  std::vector<uint16_t> halves(static_cast<size_t>(state.range(0)));
+  for (size_t i = 0; i < halves.size(); ++i)
+    halves[i] = static_cast<uint16_t>(0x3c00 + (i % 0x400));
+
+  std::vector<float> floats(halves.size());
+  for (auto _ : state) {
+    float16::HexFloatToFloatArray(halves.data(), floats.data(), halves.size(),
+                                  16);
+    benchmark::DoNotOptimize(floats.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Float16ArrayToFloat)->Range(1 << 10, 1 << 20);
+
+void BM_FloatToFloat16Array(benchmark::State& state) {
+  std::vector<float> floats(static_cast<size_t>(state.range(0)));
+  for (size_t i = 0; i < floats.size(); ++i)
+    floats[i] = 1.0f + static_cast<float>(i % 1024) / 1024.f;
+
+  std::vector<uint16_t> halves(floats.size());
+  for (auto _ : state) {
+    float16::FloatToHexFloat16Array(floats.data(), halves.data(),
+                                    floats.size());
+    benchmark::DoNotOptimize(halves.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FloatToFloat16Array)->Range(1 << 10, 1 << 20);
+
+void BM_Float11ToFloat(benchmark::State& state) {
+  std::vector<uint16_t> values(static_cast<size_t>(state.range(0)));
+  for (size_t i = 0; i < values.size(); ++i)
+    values[i] = static_cast<uint16_t>(0x3c0 + (i % 0x40));
+
+  for (auto _ : state) {
+    float sum = 0.f;
+    for (const auto& v : values) {
+      sum +=
+          float16::HexFloatToFloat(reinterpret_cast<const uint8_t*>(&v), 11);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Float11ToFloat)->Range(1 << 10, 1 << 20);
+
+}  // namespace
+}  // namespace amber
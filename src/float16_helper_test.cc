@@ -14,6 +14,9 @@
 
 #include "src/float16_helper.h"
 
+#include <cstring>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 namespace amber {
@@ -29,5 +32,50 @@ TEST_F(Float16HelperTest, F32ToF16AndBack) {
   EXPECT_FLOAT_EQ(a, b);
 }
 
+TEST_F(Float16HelperTest, HexFloat16ArrayMatchesScalar) {
+  // Cover every half value, including denormals, infinities and NaNs, and
+  // a count which is not a multiple of the vector width.
+  std::vector<uint16_t> halves(0x10003);
+  for (size_t i = 0; i < halves.size(); ++i)
+    halves[i] = static_cast<uint16_t>(i);
+
+  std::vector<float> floats(halves.size());
+  HexFloatToFloatArray(halves.data(), floats.data(), halves.size(), 16);
+  for (size_t i = 0; i < halves.size(); ++i) {
+    float expected =
+        HexFloatToFloat(reinterpret_cast<const uint8_t*>(&halves[i]), 16);
+    EXPECT_EQ(0, memcmp(&expected, &floats[i], sizeof(float))) << i;
+  }
+}
+
+TEST_F(Float16HelperTest, HexFloat11And10ArrayMatchesScalar) {
+  std::vector<uint16_t> values(1 << 11);
+  for (size_t i = 0; i < values.size(); ++i)
+    values[i] = static_cast<uint16_t>(i);
+
+  for (uint8_t bits : {10, 11}) {
+    size_t count = static_cast<size_t>(1 << bits) - 1;
+    std::vector<float> floats(count);
+    HexFloatToFloatArray(values.data(), floats.data(), count, bits);
+    for (size_t i = 0; i < count; ++i) {
+      float expected =
+          HexFloatToFloat(reinterpret_cast<const uint8_t*>(&values[i]), bits);
+      EXPECT_EQ(0, memcmp(&expected, &floats[i], sizeof(float)))
+          << static_cast<uint32_t>(bits) << " " << i;
+    }
+  }
+}
+
+TEST_F(Float16HelperTest, FloatToHexFloat16ArrayMatchesScalar) {
+  std::vector<float> floats = {0.f,      -0.f,    1.f,    -1.f,    2.5f,
+                               0.0001f,  65504.f, -3.75f, 6.2e-5f, 0.5f,
+                               1024.f,   -0.125f, 3.14f,  7.f,     -42.f,
+                               -1e-40f,  1e-40f};
+  std::vector<uint16_t> halves(floats.size());
+  FloatToHexFloat16Array(floats.data(), halves.data(), floats.size());
+  for (size_t i = 0; i < floats.size(); ++i)
+    EXPECT_EQ(FloatToHexFloat16(floats[i]), halves[i]) << floats[i];
+}
+
 }  // namespace float16
 }  // namespace amber
@@ -81,8 +81,23 @@ uint32_t Format::SizeInBytes() const {
 }
 
 bool Format::Equal(const Format* b) const {
+  if (this == b)
+    return true;
   return format_type_ == b->format_type_ && layout_ == b->layout_ &&
-         type_->Equal(b->type_);
+         (type_ == b->type_ || type_->Equal(b->type_));
+}
+
+bool Format::AreAllSegmentsFloat16() const {
+  if (segments_.empty())
+    return false;
+
+  for (const auto& seg : segments_) {
+    if (seg.IsPadding() ||
+        !type::Type::IsFloat16(seg.GetFormatMode(), seg.GetNumBits())) {
+      return false;
+    }
+  }
+  return true;
 }
 
 uint32_t Format::InputNeededPerElement() const {
@@ -198,6 +198,9 @@ class Format {
            type::Type::IsUint64(type_->AsNumber()->GetFormatMode(),
                                 type_->AsNumber()->NumBits());
   }
+  /// Returns true if every segment of this format is a 16 bit float component.
+  /// Such formats have no padding, so the data is a plain array of halfs.
+  bool AreAllSegmentsFloat16() const;
   /// Returns true if all components of this format are a 32 bit float.
   bool IsFloat32() const {
     return type_->IsNumber() &&
@@ -0,0 +1,87 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "src/format.h"
+#include "src/type_parser.h"
+
+namespace amber {
+namespace {
+
+const char* kFormatNames[] = {
+    "R8G8B8A8_UNORM",          "B8G8R8A8_UNORM",     "R32G32B32A32_SFLOAT",
+    "R16G16_SFLOAT",           "D32_SFLOAT_S8_UINT", "A2B10G10R10_UINT_PACK32",
+    "B10G11R11_UFLOAT_PACK32", "R64_SFLOAT",         "float/vec4",
+    "int/ivec3",               "half/vec2",          "double/dvec2",
+};
+const int kFormatNameCount =
+    static_cast<int>(sizeof(kFormatNames) / sizeof(kFormatNames[0]));
+
+void BM_TypeParserParse(benchmark::State& state) {
+  const std::string name = kFormatNames[state.range(0)];
+  state.SetLabel(name);
+  for (auto _ : state) {
+    TypeParser parser;
+    auto type = parser.Parse(name);
+    benchmark::DoNotOptimize(type.get());
+  }
+}
+BENCHMARK(BM_TypeParserParse)->DenseRange(0, kFormatNameCount - 1);
+
+void BM_FormatSegments(benchmark::State& state) {
+  const std::string name = kFormatNames[state.range(0)];
+  state.SetLabel(name);
+  TypeParser parser;
+  auto type = parser.Parse(name);
+  for (auto _ : state) {
+    Format fmt(type.get());
+    benchmark::DoNotOptimize(fmt.GetSegments().data());
+  }
+}
+BENCHMARK(BM_FormatSegments)->DenseRange(0, kFormatNameCount - 1);
+
+void BM_FormatSegmentsStd140(benchmark::State& state) {
+  TypeParser parser;
+  auto type = parser.Parse("R32G32B32_SFLOAT");
+  type->SetColumnCount(static_cast<uint32_t>(state.range(0)));
+  for (auto _ : state) {
+    Format fmt(type.get());
+    fmt.SetLayout(Format::Layout::kStd140);
+    benchmark::DoNotOptimize(fmt.GetSegments().data());
+  }
+}
+BENCHMARK(BM_FormatSegmentsStd140)->DenseRange(1, 4);
+
+void BM_FormatStruct(benchmark::State& state) {
+  type::Struct s;
+  std::vector<std::unique_ptr<type::Type>> members;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    members.push_back(type::Number::Float(32));
+    s.AddMember(members.back().get());
+    members.push_back(type::Number::Uint(8));
+    s.AddMember(members.back().get());
+  }
+  for (auto _ : state) {
+    Format fmt(&s);
+    benchmark::DoNotOptimize(fmt.GetSegments().data());
+  }
+}
+BENCHMARK(BM_FormatStruct)->Range(1, 256);
+
+}  // namespace
+}  // namespace amber
@@ -170,4 +170,8 @@ enum class FormatType {
   kX8_D24_UNORM_PACK32,
 };
 
+/// The number of values in FormatType.
+const uint32_t kFormatTypeCount =
+    static_cast<uint32_t>(FormatType::kX8_D24_UNORM_PACK32) + 1;
+
 #endif  // SRC_FORMAT_DATA_H_
@@ -884,7 +884,9 @@ Result Pipeline::GenerateOpenCLPodBuffers() {
 
       // Resize if necessary.
       if (buffer->ValueCount() < offset + arg_size) {
-        buffer->SetSizeInElements(offset + arg_size);
+        Result r = buffer->SetSizeInElements(offset + arg_size);
+        if (!r.IsSuccess())
+          return r;
       }
 
       // Check the data size.
@@ -1019,8 +1021,12 @@ Result Pipeline::GenerateOpenCLPushConstants() {
     assert(pc.size % sizeof(uint32_t) == 0);
     assert(pc.offset % sizeof(uint32_t) == 0);
 
-    if (buf->GetSizeInBytes() < pc.offset + pc.size)
-      buf->SetSizeInBytes(pc.offset + pc.size);
+    const uint64_t end = static_cast<uint64_t>(pc.offset) + pc.size;
+    if (buf->GetSizeInBytes() < end) {
+      r = buf->SetSizeInBytes(end);
+      if (!r.IsSuccess())
+        return r;
+    }
 
     std::vector<uint32_t> bytes(pc.size / sizeof(uint32_t));
     uint32_t base = 0;
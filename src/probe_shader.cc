@@ -0,0 +1,223 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/probe_shader.h"
+
+#include <algorithm>
+
+#include "src/verifier.h"
+
+namespace amber {
+namespace {
+
+// Guaranteed minimum of maxComputeWorkGroupCount in each dimension.
+const uint32_t kMaxGroupCount = 65535;
+
+const char kProbeShaderHeader[] = R"(#version 450
+
+layout(local_size_x = 64) in;
+
+layout(set = 0, binding = 0, std430) readonly buffer Texels {
+  uint texels[];
+};
+
+layout(set = 0, binding = 1, std430) buffer ProbeResult {
+  uint mismatch_count;
+  uint uncertain_count;
+  uint first_mismatch;
+};
+
+layout(push_constant) uniform Params {
+  vec4 expected;
+  vec4 tolerance;
+  uvec4 tolerance_is_percent;
+  uvec4 region;
+  uint row_stride;
+  uint check_alpha;
+};
+
+// Ordered so the state of a texel is the minimum of its channels.
+const uint kMismatch = 0u;
+const uint kUncertain = 1u;
+const uint kMatch = 2u;
+
+uint Compare(float expected, float actual, float tolerance, uint is_percent) {
+  if (isnan(expected) || isnan(actual))
+    return isnan(expected) && isnan(actual) ? kMatch : kMismatch;
+
+  float difference = abs(expected - actual);
+  float limit = is_percent != 0u ? tolerance / 100.0 * abs(actual)
+                                 : tolerance;
+  // The host compares in double precision. Within |margin| of the limit the
+  // rounding of single precision could give a different answer.
+  float margin = 1e-5 * (abs(expected) + abs(actual) + limit);
+  if (difference + margin <= limit)
+    return kMatch;
+  if (difference - margin > limit)
+    return kMismatch;
+  return kUncertain;
+}
+
+void main() {
+  uint index = gl_GlobalInvocationID.y * gl_NumWorkGroups.x * 64u +
+               gl_GlobalInvocationID.x;
+  if (index >= region.z * region.w)
+    return;
+
+)";
+
+const char kProbeShaderFooter[] = R"(
+  if (state == kMismatch) {
+    atomicAdd(mismatch_count, 1u);
+    atomicMin(first_mismatch, index);
+  } else if (state == kUncertain) {
+    atomicAdd(uncertain_count, 1u);
+  }
+}
+)";
+
+// Returns the swizzle selecting the channel of |name|, or an empty string
+// if the probe does not check that channel.
+std::string GetChannel(FormatComponentType name) {
+  switch (name) {
+    case FormatComponentType::kR:
+      return "r";
+    case FormatComponentType::kG:
+      return "g";
+    case FormatComponentType::kB:
+      return "b";
+    case FormatComponentType::kA:
+      return "a";
+    default:
+      return "";
+  }
+}
+
+}  // namespace
+
+bool IsProbeShaderFormatSupported(const Format& fmt, uint32_t texel_stride) {
+  if (fmt.GetSegments().empty() || texel_stride != fmt.SizeInBytes() ||
+      texel_stride % 4 != 0) {
+    return false;
+  }
+
+  for (const auto& seg : fmt.GetSegments()) {
+    if (seg.IsPadding())
+      continue;
+
+    const bool is_unorm8 =
+        seg.GetFormatMode() == FormatMode::kUNorm && seg.GetNumBits() == 8;
+    const bool is_float32 =
+        seg.GetFormatMode() == FormatMode::kSFloat && seg.GetNumBits() == 32;
+    if (!is_unorm8 && !is_float32)
+      return false;
+  }
+  return true;
+}
+
+std::string GenerateProbeShader(const Format& fmt) {
+  const uint32_t texel_words = fmt.SizeInBytes() / 4;
+
+  std::string src = kProbeShaderHeader;
+  src += "  uint base = (region.y + index / region.z) * row_stride +\n";
+  src += "              (region.x + index % region.z) * " +
+         std::to_string(texel_words) + "u;\n";
+  src += "  uint state = kMatch;\n";
+
+  uint32_t bit_offset = 0;
+  for (const auto& seg : fmt.GetSegments()) {
+    const uint32_t word = bit_offset / 32;
+    const uint32_t shift = bit_offset % 32;
+    bit_offset += seg.GetNumBits();
+
+    const std::string channel = GetChannel(seg.GetName());
+    if (seg.IsPadding() || channel.empty())
+      continue;
+
+    const std::string texel_word =
+        "texels[base + " + std::to_string(word) + "u]";
+    std::string actual;
+    if (seg.GetFormatMode() == FormatMode::kSFloat) {
+      actual = "uintBitsToFloat(" + texel_word + ")";
+    } else {
+      actual = "float((" + texel_word + " >> " + std::to_string(shift) +
+               "u) & 255u) / 255.0";
+    }
+
+    std::string check = "Compare(expected." + channel + ", " + actual +
+                        ",\n                 tolerance." + channel +
+                        ", tolerance_is_percent." + channel + ")";
+    if (channel == "a")
+      check = "(check_alpha == 0u ? kMatch :\n       " + check + ")";
+
+    src += "  state = min(state, " + check + ");\n";
+  }
+
+  src += kProbeShaderFooter;
+  return src;
+}
+
+Result GetProbeShaderParams(const ProbeCommand* command,
+                            uint32_t row_stride,
+                            uint32_t frame_width,
+                            uint32_t frame_height,
+                            ProbeShaderParams* params) {
+  uint32_t x = 0;
+  uint32_t y = 0;
+  uint32_t width = 1;
+  uint32_t height = 1;
+  Result r = GetProbeRegion(command, frame_width, frame_height, &x, &y, &width,
+                            &height);
+  if (!r.IsSuccess())
+    return r;
+
+  double tolerance[4] = {0, 0, 0, 0};
+  bool is_tolerance_percent[4] = {0, 0, 0, 0};
+  SetupToleranceForTexels(command, tolerance, is_tolerance_percent);
+
+  params->expected[0] = command->GetR();
+  params->expected[1] = command->GetG();
+  params->expected[2] = command->GetB();
+  params->expected[3] = command->GetA();
+  for (size_t i = 0; i < 4; ++i) {
+    params->tolerance[i] = static_cast<float>(tolerance[i]);
+    params->tolerance_is_percent[i] = is_tolerance_percent[i] ? 1 : 0;
+  }
+  params->region[0] = x;
+  params->region[1] = y;
+  params->region[2] = width;
+  params->region[3] = height;
+  params->row_stride = row_stride / 4;
+  params->check_alpha = command->IsRGBA() ? 1 : 0;
+  return {};
+}
+
+void GetShaderGroupCount(uint64_t invocation_count, uint32_t* x, uint32_t* y) {
+  const uint64_t groups =
+      (invocation_count + kProbeShaderLocalSize - 1) / kProbeShaderLocalSize;
+
+  *x = static_cast<uint32_t>(
+      std::max<uint64_t>(1, std::min<uint64_t>(groups, kMaxGroupCount)));
+  *y = static_cast<uint32_t>(std::max<uint64_t>(1, (groups + *x - 1) / *x));
+}
+
+void GetProbeShaderGroupCount(const ProbeShaderParams& params,
+                              uint32_t* x,
+                              uint32_t* y) {
+  const uint64_t texels =
+      static_cast<uint64_t>(params.region[2]) * params.region[3];
+  GetShaderGroupCount(texels, x, y);
+}
+
+}  // namespace amber
@@ -0,0 +1,94 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_PROBE_SHADER_H_
+#define SRC_PROBE_SHADER_H_
+
+#include <cstdint>
+#include <string>
+
+#include "amber/result.h"
+#include "src/command.h"
+#include "src/format.h"
+
+namespace amber {
+
+/// Number of invocations in a work group of the probe shader.
+const uint32_t kProbeShaderLocalSize = 64;
+
+/// Push constant block of the probe shader. The layout matches the block
+/// declared by GenerateProbeShader.
+struct ProbeShaderParams {
+  float expected[4];
+  float tolerance[4];
+  uint32_t tolerance_is_percent[4];
+  /// The probed region as x, y, width and height in texels.
+  uint32_t region[4];
+  /// Distance between two rows of texels, in 32 bit words.
+  uint32_t row_stride;
+  uint32_t check_alpha;
+};
+
+/// Storage block written by the probe shader. It must be initialized with
+/// counts of 0 and a |first_mismatch| of 0xffffffff.
+struct ProbeShaderResult {
+  /// Number of texels which do not match the expected color.
+  uint32_t mismatch_count;
+  /// Number of texels too close to the tolerance to be decided in single
+  /// precision. The host verifier, which compares in double precision, must
+  /// check the probe if there are any.
+  uint32_t uncertain_count;
+  /// Row major index inside the probed region of the first texel which does
+  /// not match.
+  uint32_t first_mismatch;
+};
+
+/// Returns true if texels of |fmt| laid out |texel_stride| bytes apart can
+/// be checked by the probe shader. Only formats made of 8 bit UNORM or 32 bit
+/// SFLOAT components which fill whole 32 bit words are supported.
+bool IsProbeShaderFormatSupported(const Format& fmt, uint32_t texel_stride);
+
+/// Generates the GLSL source of a compute shader which checks RGBA probes of
+/// texels in |fmt|. Binding 0 of descriptor set 0 is a storage buffer with
+/// the texels of the whole frame and binding 1 holds a ProbeShaderResult.
+/// Each invocation checks one texel of the probed region and records a
+/// mismatch, or a texel it can not decide, with atomic operations. |fmt| must
+/// be supported according to IsProbeShaderFormatSupported.
+std::string GenerateProbeShader(const Format& fmt);
+
+/// Fills |params| for evaluating |command| on a |frame_width| by
+/// |frame_height| frame with rows |row_stride| bytes apart. Returns an error
+/// if the probed region is outside the frame.
+Result GetProbeShaderParams(const ProbeCommand* command,
+                            uint32_t row_stride,
+                            uint32_t frame_width,
+                            uint32_t frame_height,
+                            ProbeShaderParams* params);
+
+/// Returns in |x| and |y| the number of work groups of
+/// kProbeShaderLocalSize invocations to dispatch so there are at least
+/// |invocation_count| invocations while keeping within the minimum work group
+/// count limits of Vulkan. The shader derives its index from
+/// gl_GlobalInvocationID and gl_NumWorkGroups.x.
+void GetShaderGroupCount(uint64_t invocation_count, uint32_t* x, uint32_t* y);
+
+/// Returns in |x| and |y| the number of work groups to dispatch so every
+/// texel of the region in |params| gets an invocation.
+void GetProbeShaderGroupCount(const ProbeShaderParams& params,
+                              uint32_t* x,
+                              uint32_t* y);
+
+}  // namespace amber
+
+#endif  // SRC_PROBE_SHADER_H_
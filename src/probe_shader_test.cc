@@ -0,0 +1,163 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/probe_shader.h"
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "src/pipeline.h"
+#include "src/type_parser.h"
+
+namespace amber {
+namespace {
+
+std::unique_ptr<type::Type> ParseType(const std::string& name) {
+  TypeParser parser;
+  return parser.Parse(name);
+}
+
+}  // namespace
+
+using ProbeShaderTest = testing::Test;
+
+TEST_F(ProbeShaderTest, SupportedFormats) {
+  auto unorm8 = ParseType("B8G8R8A8_UNORM");
+  Format unorm8_fmt(unorm8.get());
+  EXPECT_TRUE(IsProbeShaderFormatSupported(unorm8_fmt, 4));
+  EXPECT_FALSE(IsProbeShaderFormatSupported(unorm8_fmt, 8));
+
+  auto float32 = ParseType("R32G32B32A32_SFLOAT");
+  Format float32_fmt(float32.get());
+  EXPECT_TRUE(IsProbeShaderFormatSupported(float32_fmt, 16));
+
+  auto uint8 = ParseType("R8G8B8A8_UINT");
+  Format uint8_fmt(uint8.get());
+  EXPECT_FALSE(IsProbeShaderFormatSupported(uint8_fmt, 4));
+
+  auto unorm16 = ParseType("R16G16B16A16_UNORM");
+  Format unorm16_fmt(unorm16.get());
+  EXPECT_FALSE(IsProbeShaderFormatSupported(unorm16_fmt, 8));
+
+  auto rgb8 = ParseType("R8G8B8_UNORM");
+  Format rgb8_fmt(rgb8.get());
+  EXPECT_FALSE(IsProbeShaderFormatSupported(rgb8_fmt, 3));
+}
+
+TEST_F(ProbeShaderTest, GenerateUNorm8) {
+  auto type = ParseType("B8G8R8A8_UNORM");
+  Format fmt(type.get());
+
+  std::string src = GenerateProbeShader(fmt);
+  EXPECT_NE(std::string::npos, src.find("#version 450"));
+  EXPECT_NE(std::string::npos, src.find("* 1u;"));
+  EXPECT_NE(std::string::npos,
+            src.find("Compare(expected.b, float((texels[base + 0u] >> 0u) "
+                     "& 255u) / 255.0"));
+  EXPECT_NE(std::string::npos,
+            src.find("Compare(expected.r, float((texels[base + 0u] >> 16u) "
+                     "& 255u) / 255.0"));
+  EXPECT_NE(std::string::npos, src.find("(check_alpha == 0u ? kMatch :"));
+  EXPECT_NE(std::string::npos, src.find("atomicAdd(uncertain_count, 1u);"));
+}
+
+TEST_F(ProbeShaderTest, GenerateFloat32) {
+  auto type = ParseType("R32G32B32A32_SFLOAT");
+  Format fmt(type.get());
+
+  std::string src = GenerateProbeShader(fmt);
+  EXPECT_NE(std::string::npos, src.find("* 4u;"));
+  EXPECT_NE(std::string::npos,
+            src.find("Compare(expected.r, uintBitsToFloat(texels[base + 0u])"));
+  EXPECT_NE(std::string::npos,
+            src.find("Compare(expected.a, uintBitsToFloat(texels[base + 3u])"));
+}
+
+TEST_F(ProbeShaderTest, Params) {
+  Pipeline pipeline(PipelineType::kGraphics);
+  auto color_buf = pipeline.GenerateDefaultColorAttachmentBuffer();
+
+  ProbeCommand probe(color_buf.get());
+  probe.SetProbeRect();
+  probe.SetX(2);
+  probe.SetY(3);
+  probe.SetWidth(4);
+  probe.SetHeight(5);
+  probe.SetR(0.25f);
+  probe.SetG(0.5f);
+  probe.SetB(0.75f);
+  probe.SetTolerances({Probe::Tolerance(true, 10.0)});
+
+  ProbeShaderParams params;
+  Result r = GetProbeShaderParams(&probe, 40, 10, 10, &params);
+  ASSERT_TRUE(r.IsSuccess()) << r.Error();
+  EXPECT_FLOAT_EQ(0.25f, params.expected[0]);
+  EXPECT_FLOAT_EQ(0.5f, params.expected[1]);
+  EXPECT_FLOAT_EQ(0.75f, params.expected[2]);
+  EXPECT_FLOAT_EQ(10.0f, params.tolerance[0]);
+  EXPECT_EQ(1U, params.tolerance_is_percent[3]);
+  EXPECT_EQ(2U, params.region[0]);
+  EXPECT_EQ(3U, params.region[1]);
+  EXPECT_EQ(4U, params.region[2]);
+  EXPECT_EQ(5U, params.region[3]);
+  EXPECT_EQ(10U, params.row_stride);
+  EXPECT_EQ(0U, params.check_alpha);
+}
+
+TEST_F(ProbeShaderTest, ParamsOutOfFrame) {
+  Pipeline pipeline(PipelineType::kGraphics);
+  auto color_buf = pipeline.GenerateDefaultColorAttachmentBuffer();
+
+  ProbeCommand probe(color_buf.get());
+  probe.SetProbeRect();
+  probe.SetX(8);
+  probe.SetY(8);
+  probe.SetWidth(4);
+  probe.SetHeight(4);
+
+  ProbeShaderParams params;
+  Result r = GetProbeShaderParams(&probe, 40, 10, 10, &params);
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ(
+      "Line 1: Verifier::Probe Position(11, 11) is out of framebuffer scope "
+      "(10,10)",
+      r.Error());
+}
+
+TEST_F(ProbeShaderTest, GroupCount) {
+  ProbeShaderParams params = {};
+  params.region[2] = 1;
+  params.region[3] = 1;
+
+  uint32_t x = 0;
+  uint32_t y = 0;
+  GetProbeShaderGroupCount(params, &x, &y);
+  EXPECT_EQ(1U, x);
+  EXPECT_EQ(1U, y);
+
+  params.region[2] = 250;
+  params.region[3] = 250;
+  GetProbeShaderGroupCount(params, &x, &y);
+  EXPECT_EQ(977U, x);
+  EXPECT_EQ(1U, y);
+
+  params.region[2] = 8192;
+  params.region[3] = 8192;
+  GetProbeShaderGroupCount(params, &x, &y);
+  EXPECT_EQ(65535U, x);
+  EXPECT_EQ(17U, y);
+}
+
+}  // namespace amber
@@ -50,4 +50,9 @@ void Recipe::SetFenceTimeout(uint32_t timeout_ms) {
     impl_->SetFenceTimeout(timeout_ms);
 }
 
+void Recipe::SetMemoryPlacement(MemoryPlacement placement) {
+  if (impl_)
+    impl_->SetMemoryPlacement(placement);
+}
+
 }  // namespace amber
@@ -140,11 +140,9 @@ type::Type* Script::ParseType(const std::string& str) {
 
   TypeParser parser;
   auto new_type = parser.Parse(str);
-  if (new_type != nullptr) {
-    type = new_type.get();
-    RegisterType(std::move(new_type));
-  }
-  return type;
+  if (new_type == nullptr)
+    return nullptr;
+  return InternType(std::move(new_type));
 }
 
 }  // namespace amber
@@ -32,6 +32,7 @@
 #include "src/pipeline.h"
 #include "src/sampler.h"
 #include "src/shader.h"
+#include "src/type_registry.h"
 #include "src/virtual_file_store.h"
 
 namespace amber {
@@ -67,6 +68,11 @@ class Script : public RecipeImpl {
     engine_data_.fence_timeout_ms = timeout_ms;
   }
 
+  /// Sets the memory placement of descriptor buffers to |placement|.
+  void SetMemoryPlacement(MemoryPlacement placement) override {
+    engine_data_.memory_placement = placement;
+  }
+
   /// Adds |pipeline| to the list of known pipelines. The |pipeline| must have
   /// a unique name over all pipelines in the script.
   Result AddPipeline(std::unique_ptr<Pipeline> pipeline) {
@@ -215,6 +221,19 @@ class Script : public RecipeImpl {
     return types_.back().get();
   }
 
+  /// Returns the script wide type equal to |type|, taking ownership of
+  /// |type|. The returned type is shared and must not be modified.
+  type::Type* InternType(std::unique_ptr<type::Type> type) {
+    return type_registry_.Intern(std::move(type));
+  }
+
+  /// Returns the script wide format for |type| with |layout|. The returned
+  /// format is shared and must not be modified.
+  Format* GetFormat(type::Type* type,
+                    Format::Layout layout = Format::Layout::kStd430) {
+    return type_registry_.GetFormat(type, layout);
+  }
+
   /// Adds |type| to the list of known types. The |type| must have
   /// a unique name over all types in the script.
   Result AddType(const std::string& name, std::unique_ptr<type::Type> type) {
@@ -270,6 +289,7 @@ class Script : public RecipeImpl {
   std::vector<std::unique_ptr<Pipeline>> pipelines_;
   std::vector<std::unique_ptr<type::Type>> types_;
   std::vector<std::unique_ptr<Format>> formats_;
+  TypeRegistry type_registry_;
   std::unique_ptr<VirtualFileStore> virtual_files_;
 };
 
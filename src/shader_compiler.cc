@@ -20,6 +20,8 @@
 #include <string>
 #include <utility>
 
+#include "src/compile_server.h"
+
 #if AMBER_ENABLE_SPIRV_TOOLS
 #include "spirv-tools/libspirv.hpp"
 #include "spirv-tools/linker.hpp"
@@ -81,6 +83,23 @@ std::pair<Result, std::vector<uint32_t>> ShaderCompiler::Compile(
     return {{}, it->second};
   }
 
+  if (!compile_server_.empty() && CanUseCompileServer(shader)) {
+    CompileRequest request;
+    request.type = shader->GetType();
+    request.format = shader->GetFormat();
+    request.spv_env = spv_env_;
+    request.disable_spirv_validation = disable_spirv_validation_;
+    request.optimizations = shader_info->GetShaderOptimizations();
+    request.data = shader->GetData();
+    request.file_path = shader->GetFilePath();
+
+    CompileResponse response;
+    Result r = SendCompileRequest(compile_server_, request, &response);
+    if (r.IsSuccess())
+      return {response.result, std::move(response.spirv)};
+    // The server is not available, so compile in this process.
+  }
+
 #if AMBER_ENABLE_SPIRV_TOOLS
   std::string spv_errors;
 
@@ -185,6 +204,21 @@ std::pair<Result, std::vector<uint32_t>> ShaderCompiler::Compile(
   return {{}, results};
 }
 
+bool ShaderCompiler::CanUseCompileServer(const Shader* shader) const {
+  switch (shader->GetFormat()) {
+    case kShaderFormatGlsl:
+    case kShaderFormatSpirvAsm:
+    case kShaderFormatSpirvHex:
+      return true;
+    case kShaderFormatHlsl:
+      // The server cannot see the virtual files included by the shader.
+      return !virtual_files_ || virtual_files_->IsEmpty();
+    default:
+      // OPENCL-C compiles update the pipeline with the sampler bindings.
+      return false;
+  }
+}
+
 Result ShaderCompiler::ParseHex(const std::string& data,
                                 std::vector<uint32_t>* result) const {
   size_t used = 0;
@@ -39,6 +39,14 @@ class ShaderCompiler {
                  VirtualFileStore* virtual_files);
   ~ShaderCompiler();
 
+  /// Sends compiles to the compile server listening on the Unix domain
+  /// socket |socket_path|. When the server cannot be reached, shaders are
+  /// compiled in this process instead. An empty path compiles in this
+  /// process.
+  void SetCompileServer(const std::string& socket_path) {
+    compile_server_ = socket_path;
+  }
+
   /// Returns a result code and a compilation of the given shader.
   /// If the shader in |shader_info| has a corresponding entry in the
   /// |shader_map|, then the compilation result is copied from that entry.
@@ -58,6 +66,8 @@ class ShaderCompiler {
       const ShaderMap& shader_map) const;
 
  private:
+  /// Returns true if |shader| can be compiled by a compile server.
+  bool CanUseCompileServer(const Shader* shader) const;
   Result ParseHex(const std::string& data, std::vector<uint32_t>* result) const;
   Result CompileGlsl(const Shader* shader, std::vector<uint32_t>* result) const;
   Result CompileHlsl(const Shader* shader, std::vector<uint32_t>* result) const;
@@ -71,6 +81,7 @@ class ShaderCompiler {
   std::string spv_env_;
   bool disable_spirv_validation_ = false;
   VirtualFileStore* virtual_files_ = nullptr;
+  std::string compile_server_;
 };
 
 // Parses the SPIR-V environment string, and returns the corresponding
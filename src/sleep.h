@@ -1,27 +0,0 @@
-// Copyright 2018 The Amber Authors.
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-//     http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-
-#ifndef SRC_SLEEP_H_
-#define SRC_SLEEP_H_
-
-#include <cstdint>
-
-namespace amber {
-
-/// Pause execution for the given number of microseconds, or longer.
-void USleep(uint32_t microseconds);
-
-}  // namespace amber
-
-#endif  // SRC_SLEEP_H_
@@ -0,0 +1,71 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "src/tokenizer.h"
+
+namespace amber {
+namespace {
+
+// Builds the body of a DATA block holding |count| values of the given style.
+std::string BuildData(int64_t count, bool doubles) {
+  std::string data;
+  data.reserve(static_cast<size_t>(count) * 8);
+  for (int64_t i = 0; i < count; ++i) {
+    if (doubles)
+      data += std::to_string(static_cast<double>(i) * 0.25);
+    else
+      data += std::to_string(i);
+    data += (i % 16 == 15) ? "\n" : " ";
+  }
+  return data;
+}
+
+void TokenizeAll(benchmark::State& state, const std::string& data) {
+  for (auto _ : state) {
+    Tokenizer t(data);
+    int64_t tokens = 0;
+    for (auto token = t.NextToken(); !token->IsEOS(); token = t.NextToken())
+      ++tokens;
+    benchmark::DoNotOptimize(tokens);
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(data.size()));
+}
+
+void BM_TokenizerIntegers(benchmark::State& state) {
+  TokenizeAll(state, BuildData(state.range(0), false));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TokenizerIntegers)->Range(1 << 10, 1 << 20);
+
+void BM_TokenizerDoubles(benchmark::State& state) {
+  TokenizeAll(state, BuildData(state.range(0), true));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TokenizerDoubles)->Range(1 << 10, 1 << 20);
+
+void BM_TokenizerHex(benchmark::State& state) {
+  std::string data;
+  for (int64_t i = 0; i < state.range(0); ++i)
+    data += "0xdeadbeef ";
+  TokenizeAll(state, data);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TokenizerHex)->Range(1 << 10, 1 << 20);
+
+}  // namespace
+}  // namespace amber
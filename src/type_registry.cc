@@ -0,0 +1,74 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/type_registry.h"
+
+#include "src/make_unique.h"
+
+namespace amber {
+
+TypeRegistry::TypeRegistry() = default;
+
+TypeRegistry::~TypeRegistry() = default;
+
+// static
+std::string TypeRegistry::KeyFor(const type::Type* type) {
+  // Type::Equal ignores the shape of the type, so the key lists it as well.
+  std::string key = std::to_string(type->RowCount()) + "x" +
+                    std::to_string(type->ColumnCount());
+  if (type->IsArray())
+    key += "[" + std::to_string(type->ArraySize()) + "]";
+
+  if (type->IsNumber()) {
+    key += " n" +
+           std::to_string(static_cast<int>(type->AsNumber()->GetFormatMode())) +
+           ":" + std::to_string(type->AsNumber()->NumBits());
+    return key;
+  }
+
+  key += " l" + std::to_string(type->AsList()->PackSizeInBits());
+  for (const auto& member : type->AsList()->Members()) {
+    key += " " + std::to_string(static_cast<int>(member.name)) + ":" +
+           std::to_string(static_cast<int>(member.mode)) + ":" +
+           std::to_string(member.num_bits);
+  }
+  return key;
+}
+
+type::Type* TypeRegistry::Intern(std::unique_ptr<type::Type> type) {
+  if (type->IsStruct()) {
+    types_.push_back(std::move(type));
+    return types_.back().get();
+  }
+
+  const std::string key = KeyFor(type.get());
+  auto it = key_to_type_.find(key);
+  if (it != key_to_type_.end())
+    return it->second;
+
+  types_.push_back(std::move(type));
+  key_to_type_[key] = types_.back().get();
+  return types_.back().get();
+}
+
+Format* TypeRegistry::GetFormat(type::Type* type, Format::Layout layout) {
+  auto& fmt = formats_[std::make_pair(type, layout)];
+  if (!fmt) {
+    fmt = MakeUnique<Format>(type);
+    fmt->SetLayout(layout);
+  }
+  return fmt.get();
+}
+
+}  // namespace amber
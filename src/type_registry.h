@@ -0,0 +1,66 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_TYPE_REGISTRY_H_
+#define SRC_TYPE_REGISTRY_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "src/format.h"
+#include "src/type.h"
+
+namespace amber {
+
+/// Owns the types and formats of a script and shares identical ones.
+///
+/// Number and list types are hash-consed: interning a type that matches an
+/// earlier one returns the earlier object and drops the new one. Struct types
+/// are built member by member, so they are owned but keep their identity.
+/// Formats are created once per type and layout. The returned objects are
+/// shared and must not be modified.
+class TypeRegistry {
+ public:
+  TypeRegistry();
+  ~TypeRegistry();
+
+  /// Returns the canonical type equal to |type|, taking ownership of it.
+  type::Type* Intern(std::unique_ptr<type::Type> type);
+
+  /// Returns the format of |type| with |layout|. |type| must outlive the
+  /// registry.
+  Format* GetFormat(type::Type* type, Format::Layout layout);
+
+  /// Returns the number of distinct types owned by the registry.
+  size_t GetTypeCount() const { return types_.size(); }
+  /// Returns the number of distinct formats owned by the registry.
+  size_t GetFormatCount() const { return formats_.size(); }
+
+ private:
+  static std::string KeyFor(const type::Type* type);
+
+  std::vector<std::unique_ptr<type::Type>> types_;
+  std::unordered_map<std::string, type::Type*> key_to_type_;
+  std::map<std::pair<const type::Type*, Format::Layout>,
+           std::unique_ptr<Format>>
+      formats_;
+};
+
+}  // namespace amber
+
+#endif  // SRC_TYPE_REGISTRY_H_
@@ -0,0 +1,83 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/type_registry.h"
+
+#include "gtest/gtest.h"
+#include "src/make_unique.h"
+#include "src/type_parser.h"
+
+namespace amber {
+
+using TypeRegistryTest = testing::Test;
+
+TEST_F(TypeRegistryTest, InternSharesEqualTypes) {
+  TypeRegistry registry;
+  TypeParser parser;
+
+  auto* a = registry.Intern(parser.Parse("R32G32B32A32_SFLOAT"));
+  auto* b = registry.Intern(parser.Parse("R32G32B32A32_SFLOAT"));
+  auto* c = registry.Intern(parser.Parse("R32G32B32A32_UINT"));
+
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, c);
+  EXPECT_EQ(2U, registry.GetTypeCount());
+}
+
+TEST_F(TypeRegistryTest, InternKeepsShapeApart) {
+  TypeRegistry registry;
+
+  auto* scalar = registry.Intern(type::Number::Float(32));
+
+  auto vec = type::Number::Float(32);
+  vec->SetRowCount(4);
+  auto* vec4 = registry.Intern(std::move(vec));
+
+  auto arr = type::Number::Float(32);
+  arr->SetIsSizedArray(4);
+  auto* array = registry.Intern(std::move(arr));
+
+  EXPECT_NE(scalar, vec4);
+  EXPECT_NE(scalar, array);
+  EXPECT_NE(vec4, array);
+  EXPECT_EQ(scalar, registry.Intern(type::Number::Float(32)));
+}
+
+TEST_F(TypeRegistryTest, InternKeepsStructsApart) {
+  TypeRegistry registry;
+
+  auto* a = registry.Intern(MakeUnique<type::Struct>());
+  auto* b = registry.Intern(MakeUnique<type::Struct>());
+
+  EXPECT_NE(a, b);
+  EXPECT_EQ(2U, registry.GetTypeCount());
+}
+
+TEST_F(TypeRegistryTest, GetFormat) {
+  TypeRegistry registry;
+  auto* type = registry.Intern(type::Number::Uint(32));
+
+  auto* fmt = registry.GetFormat(type, Format::Layout::kStd430);
+  EXPECT_EQ(type, fmt->GetType());
+  EXPECT_EQ(Format::Layout::kStd430, fmt->GetLayout());
+  EXPECT_EQ(fmt, registry.GetFormat(type, Format::Layout::kStd430));
+
+  auto* std140 = registry.GetFormat(type, Format::Layout::kStd140);
+  EXPECT_NE(fmt, std140);
+  EXPECT_EQ(Format::Layout::kStd140, std140->GetLayout());
+  EXPECT_FALSE(fmt->Equal(std140));
+  EXPECT_EQ(2U, registry.GetFormatCount());
+}
+
+}  // namespace amber
@@ -0,0 +1,121 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/verification_queue.h"
+
+#include <utility>
+
+#include "src/make_unique.h"
+
+namespace amber {
+
+VerificationQueue::VerificationQueue(uint32_t thread_count) {
+  if (thread_count == 0)
+    thread_count = 1;
+
+  for (uint32_t i = 0; i < thread_count; ++i)
+    threads_.emplace_back(&VerificationQueue::WorkerLoop, this);
+}
+
+VerificationQueue::~VerificationQueue() {
+  Join();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& thread : threads_)
+    thread.join();
+}
+
+void VerificationQueue::Push(size_t command_index,
+                             std::function<Result()> task) {
+  auto entry = MakeUnique<Task>();
+  entry->command_index = command_index;
+  entry->run = std::move(task);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(entry));
+  }
+  work_cv_.notify_one();
+}
+
+bool VerificationQueue::IsPending(size_t command_index) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& task : tasks_) {
+    if (task->command_index == command_index)
+      return true;
+  }
+  return false;
+}
+
+bool VerificationQueue::HasPending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !tasks_.empty();
+}
+
+bool VerificationQueue::HasFailed() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return failed_;
+}
+
+Result VerificationQueue::Join() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [this]() {
+    for (const auto& task : tasks_) {
+      if (!task->done)
+        return false;
+    }
+    return true;
+  });
+
+  Result result;
+  for (const auto& task : tasks_) {
+    if (!task->result.IsSuccess()) {
+      result = task->result;
+      break;
+    }
+  }
+  tasks_.clear();
+  next_task_ = 0;
+  failed_ = false;
+  return result;
+}
+
+void VerificationQueue::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    work_cv_.wait(lock,
+                  [this]() { return stop_ || next_task_ < tasks_.size(); });
+    if (next_task_ >= tasks_.size())
+      return;
+
+    // Tasks are only removed by Join, which waits for this one first, so the
+    // pointer stays valid while the lock is released.
+    Task* task = tasks_[next_task_].get();
+    ++next_task_;
+
+    lock.unlock();
+    Result result = task->run();
+    lock.lock();
+
+    task->result = result;
+    task->done = true;
+    failed_ = failed_ || !result.IsSuccess();
+    done_cv_.notify_all();
+  }
+}
+
+}  // namespace amber
@@ -0,0 +1,86 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_VERIFICATION_QUEUE_H_
+#define SRC_VERIFICATION_QUEUE_H_
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "amber/result.h"
+
+namespace amber {
+
+/// Runs verification tasks on a pool of worker threads while the caller
+/// continues with other work.
+///
+/// Each task is tagged with the index of the command it verifies. Tasks may
+/// finish in any order, but `Join` reports their results in the order they
+/// were pushed, so the first failure is the same as when running them one
+/// after the other.
+class VerificationQueue {
+ public:
+  /// Creates a queue with |thread_count| worker threads, at least one.
+  explicit VerificationQueue(uint32_t thread_count);
+  /// Waits for the pushed tasks and stops the worker threads.
+  ~VerificationQueue();
+
+  /// Queues |task| which verifies the command at |command_index|. Anything
+  /// read by |task| must not change until the task is joined.
+  void Push(size_t command_index, std::function<Result()> task);
+
+  /// Returns true if a task verifying the command at |command_index| was
+  /// pushed and not joined yet.
+  bool IsPending(size_t command_index) const;
+
+  /// Returns true if any task was pushed and not joined yet.
+  bool HasPending() const;
+
+  /// Returns true if a task which was not joined yet has already failed.
+  /// Callers use this to stop issuing work once a check is known to fail.
+  bool HasFailed() const;
+
+  /// Waits for every pushed task. Returns the result of the first task, in
+  /// push order, which failed, or success if none did.
+  Result Join();
+
+ private:
+  struct Task {
+    size_t command_index = 0;
+    std::function<Result()> run;
+    Result result;
+    bool done = false;
+  };
+
+  void WorkerLoop();
+
+  mutable std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  /// Tasks which were not joined yet, in push order.
+  std::vector<std::unique_ptr<Task>> tasks_;
+  /// Index in |tasks_| of the next task to run.
+  size_t next_task_ = 0;
+  bool failed_ = false;
+  bool stop_ = false;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace amber
+
+#endif  // SRC_VERIFICATION_QUEUE_H_
@@ -0,0 +1,104 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/verification_queue.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace amber {
+
+using VerificationQueueTest = testing::Test;
+
+TEST_F(VerificationQueueTest, JoinEmpty) {
+  VerificationQueue queue(2);
+  EXPECT_FALSE(queue.HasPending());
+  EXPECT_TRUE(queue.Join().IsSuccess());
+}
+
+TEST_F(VerificationQueueTest, RunsAllTasks) {
+  std::atomic<uint32_t> count(0);
+  VerificationQueue queue(4);
+  for (size_t i = 0; i < 100; ++i) {
+    queue.Push(i, [&count]() {
+      ++count;
+      return Result();
+    });
+  }
+  EXPECT_TRUE(queue.HasPending());
+  EXPECT_TRUE(queue.IsPending(42));
+  EXPECT_FALSE(queue.IsPending(100));
+
+  Result r = queue.Join();
+  EXPECT_TRUE(r.IsSuccess()) << r.Error();
+  EXPECT_EQ(100U, count.load());
+  EXPECT_FALSE(queue.HasPending());
+  EXPECT_FALSE(queue.IsPending(42));
+}
+
+TEST_F(VerificationQueueTest, ReportsFirstFailureInPushOrder) {
+  VerificationQueue queue(4);
+  for (size_t i = 0; i < 50; ++i) {
+    queue.Push(i, [i]() {
+      if (i % 10 == 7)
+        return Result("failure " + std::to_string(i));
+      return Result();
+    });
+  }
+
+  Result r = queue.Join();
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("failure 7", r.Error());
+}
+
+TEST_F(VerificationQueueTest, HasFailed) {
+  VerificationQueue queue(1);
+  EXPECT_FALSE(queue.HasFailed());
+
+  queue.Push(0, []() { return Result(); });
+  queue.Push(1, []() { return Result("failure"); });
+  while (!queue.HasFailed())
+    std::this_thread::yield();
+
+  EXPECT_TRUE(queue.HasPending());
+  Result r = queue.Join();
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ("failure", r.Error());
+  EXPECT_FALSE(queue.HasFailed());
+}
+
+TEST_F(VerificationQueueTest, ReusableAfterJoin) {
+  VerificationQueue queue(1);
+  queue.Push(0, []() { return Result("failure"); });
+  EXPECT_FALSE(queue.Join().IsSuccess());
+
+  queue.Push(1, []() { return Result(); });
+  EXPECT_TRUE(queue.Join().IsSuccess());
+}
+
+TEST_F(VerificationQueueTest, ZeroThreadsStillRuns) {
+  bool ran = false;
+  VerificationQueue queue(0);
+  queue.Push(0, [&ran]() {
+    ran = true;
+    return Result();
+  });
+  EXPECT_TRUE(queue.Join().IsSuccess());
+  EXPECT_TRUE(ran);
+}
+
+}  // namespace amber
@@ -16,10 +16,12 @@
 
 #include <cassert>
 #include <cmath>
+#include <cstddef>
 #include <cstring>
 #include <string>
 #include <vector>
 
+#include "src/checked_math.h"
 #include "src/command.h"
 #include "src/float16_helper.h"
 
@@ -170,42 +172,6 @@ Result CheckValue(const ProbeSSBOCommand* command,
   return CheckActualValue<T>(command, *ptr, value);
 }
 
-void SetupToleranceForTexels(const ProbeCommand* command,
-                             double* tolerance,
-                             bool* is_tolerance_percent) {
-  if (command->HasTolerances()) {
-    const auto& tol = command->GetTolerances();
-    if (tol.size() == 4) {
-      tolerance[0] = tol[0].value;
-      tolerance[1] = tol[1].value;
-      tolerance[2] = tol[2].value;
-      tolerance[3] = tol[3].value;
-      is_tolerance_percent[0] = tol[0].is_percent;
-      is_tolerance_percent[1] = tol[1].is_percent;
-      is_tolerance_percent[2] = tol[2].is_percent;
-      is_tolerance_percent[3] = tol[3].is_percent;
-    } else {
-      tolerance[0] = tol[0].value;
-      tolerance[1] = tol[0].value;
-      tolerance[2] = tol[0].value;
-      tolerance[3] = tol[0].value;
-      is_tolerance_percent[0] = tol[0].is_percent;
-      is_tolerance_percent[1] = tol[0].is_percent;
-      is_tolerance_percent[2] = tol[0].is_percent;
-      is_tolerance_percent[3] = tol[0].is_percent;
-    }
-  } else {
-    tolerance[0] = kDefaultTexelTolerance;
-    tolerance[1] = kDefaultTexelTolerance;
-    tolerance[2] = kDefaultTexelTolerance;
-    tolerance[3] = kDefaultTexelTolerance;
-    is_tolerance_percent[0] = false;
-    is_tolerance_percent[1] = false;
-    is_tolerance_percent[2] = false;
-    is_tolerance_percent[3] = false;
-  }
-}
-
 // Convert data of |texel| into double values based on the
 // information given in |fmt|.
 std::vector<double> GetActualValuesFromTexel(const uint8_t* texel,
@@ -390,8 +356,121 @@ std::vector<double> GetTexelInRGBA(const std::vector<double>& texel,
   return texel_in_rgba;
 }
 
+// Returns the error of |command| failing in |count| texels, the first of
+// which is at |x|, |y| and has the RGBA |values|.
+Result ProbeFailureResult(const ProbeCommand* command,
+                          const Format* fmt,
+                          uint32_t x,
+                          uint32_t y,
+                          const std::vector<double>& values,
+                          uint32_t count) {
+  float scale = fmt->IsNormalized() ? 255.f : 1.f;
+  std::string reason =
+      "Line " + std::to_string(command->GetLine()) +
+      ": Probe failed at: " + std::to_string(x) + ", " + std::to_string(y) +
+      "\n  Expected: " + std::to_string(command->GetR() * scale) + ", " +
+      std::to_string(command->GetG() * scale) + ", " +
+      std::to_string(command->GetB() * scale);
+
+  if (command->IsRGBA()) {
+    reason += ", " + std::to_string(command->GetA() * scale);
+  }
+
+  reason += "\n    Actual: " +
+            std::to_string(static_cast<float>(values[0]) * scale) + ", " +
+            std::to_string(static_cast<float>(values[1]) * scale) + ", " +
+            std::to_string(static_cast<float>(values[2]) * scale);
+
+  if (command->IsRGBA()) {
+    reason += ", " + std::to_string(static_cast<float>(values[3]) * scale);
+  }
+
+  reason += "\nProbe failed in " + std::to_string(count) + " pixels";
+
+  return Result(reason);
+}
+
 }  // namespace
 
+void SetupToleranceForTexels(const ProbeCommand* command,
+                             double* tolerance,
+                             bool* is_tolerance_percent) {
+  if (command->HasTolerances()) {
+    const auto& tol = command->GetTolerances();
+    if (tol.size() == 4) {
+      tolerance[0] = tol[0].value;
+      tolerance[1] = tol[1].value;
+      tolerance[2] = tol[2].value;
+      tolerance[3] = tol[3].value;
+      is_tolerance_percent[0] = tol[0].is_percent;
+      is_tolerance_percent[1] = tol[1].is_percent;
+      is_tolerance_percent[2] = tol[2].is_percent;
+      is_tolerance_percent[3] = tol[3].is_percent;
+    } else {
+      tolerance[0] = tol[0].value;
+      tolerance[1] = tol[0].value;
+      tolerance[2] = tol[0].value;
+      tolerance[3] = tol[0].value;
+      is_tolerance_percent[0] = tol[0].is_percent;
+      is_tolerance_percent[1] = tol[0].is_percent;
+      is_tolerance_percent[2] = tol[0].is_percent;
+      is_tolerance_percent[3] = tol[0].is_percent;
+    }
+  } else {
+    tolerance[0] = kDefaultTexelTolerance;
+    tolerance[1] = kDefaultTexelTolerance;
+    tolerance[2] = kDefaultTexelTolerance;
+    tolerance[3] = kDefaultTexelTolerance;
+    is_tolerance_percent[0] = false;
+    is_tolerance_percent[1] = false;
+    is_tolerance_percent[2] = false;
+    is_tolerance_percent[3] = false;
+  }
+}
+
+Result GetProbeRegion(const ProbeCommand* command,
+                      uint32_t frame_width,
+                      uint32_t frame_height,
+                      uint32_t* x,
+                      uint32_t* y,
+                      uint32_t* width,
+                      uint32_t* height) {
+  *x = 0;
+  *y = 0;
+  *width = 1;
+  *height = 1;
+
+  if (command->IsWholeWindow()) {
+    *width = frame_width;
+    *height = frame_height;
+  } else if (command->IsRelative()) {
+    *x = static_cast<uint32_t>(static_cast<float>(frame_width) *
+                               command->GetX());
+    *y = static_cast<uint32_t>(static_cast<float>(frame_height) *
+                               command->GetY());
+    if (command->IsProbeRect()) {
+      *width = static_cast<uint32_t>(static_cast<float>(frame_width) *
+                                     command->GetWidth());
+      *height = static_cast<uint32_t>(static_cast<float>(frame_height) *
+                                      command->GetHeight());
+    }
+  } else {
+    *x = static_cast<uint32_t>(command->GetX());
+    *y = static_cast<uint32_t>(command->GetY());
+    *width = static_cast<uint32_t>(command->GetWidth());
+    *height = static_cast<uint32_t>(command->GetHeight());
+  }
+
+  if (*x + *width > frame_width || *y + *height > frame_height) {
+    return Result(
+        "Line " + std::to_string(command->GetLine()) +
+        ": Verifier::Probe Position(" + std::to_string(*x + *width - 1) +
+        ", " + std::to_string(*y + *height - 1) +
+        ") is out of framebuffer scope (" + std::to_string(frame_width) +
+        "," + std::to_string(frame_height) + ")");
+  }
+  return {};
+}
 Verifier::Verifier() = default;
 
 Verifier::~Verifier() = default;
@@ -414,35 +493,10 @@ Result Verifier::Probe(const ProbeCommand* command,
   uint32_t y = 0;
   uint32_t width = 1;
   uint32_t height = 1;
-
-  if (command->IsWholeWindow()) {
-    width = frame_width;
-    height = frame_height;
-  } else if (command->IsRelative()) {
-    x = static_cast<uint32_t>(static_cast<float>(frame_width) *
-                              command->GetX());
-    y = static_cast<uint32_t>(static_cast<float>(frame_height) *
-                              command->GetY());
-    if (command->IsProbeRect()) {
-      width = static_cast<uint32_t>(static_cast<float>(frame_width) *
-                                    command->GetWidth());
-      height = static_cast<uint32_t>(static_cast<float>(frame_height) *
-                                     command->GetHeight());
-    }
-  } else {
-    x = static_cast<uint32_t>(command->GetX());
-    y = static_cast<uint32_t>(command->GetY());
-    width = static_cast<uint32_t>(command->GetWidth());
-    height = static_cast<uint32_t>(command->GetHeight());
-  }
-
-  if (x + width > frame_width || y + height > frame_height) {
-    return Result(
-        "Line " + std::to_string(command->GetLine()) +
-        ": Verifier::Probe Position(" + std::to_string(x + width - 1) + ", " +
-        std::to_string(y + height - 1) + ") is out of framebuffer scope (" +
-        std::to_string(frame_width) + "," + std::to_string(frame_height) + ")");
-  }
+  Result r = GetProbeRegion(command, frame_width, frame_height, &x, &y, &width,
+                            &height);
+  if (!r.IsSuccess())
+    return r;
 
   if (row_stride < frame_width * texel_stride) {
     return Result("Line " + std::to_string(command->GetLine()) +
@@ -456,6 +510,13 @@ Result Verifier::Probe(const ProbeCommand* command,
   bool is_tolerance_percent[4] = {0, 0, 0, 0};
   SetupToleranceForTexels(command, tolerance, is_tolerance_percent);
 
+  // Rows of half float texels are converted in one go rather than texel by
+  // texel.
+  const bool convert_rows =
+      fmt->AreAllSegmentsFloat16() && texel_stride == fmt->SizeInBytes();
+  const size_t values_per_texel = fmt->GetSegments().size();
+  std::vector<float> row_values;
+
   const uint8_t* ptr = static_cast<const uint8_t*>(buf);
   uint32_t count_of_invalid_pixels = 0;
   uint32_t first_invalid_i = 0;
@@ -463,9 +524,24 @@ Result Verifier::Probe(const ProbeCommand* command,
   std::vector<double> failure_values;
   for (uint32_t j = 0; j < height; ++j) {
     const uint8_t* p = ptr + row_stride * (j + y) + texel_stride * x;
+    if (convert_rows) {
+      row_values.resize(width * values_per_texel);
+      float16::HexFloatToFloatArray(reinterpret_cast<const uint16_t*>(p),
+                                    row_values.data(), row_values.size(), 16);
+    }
+
     for (uint32_t i = 0; i < width; ++i) {
-      auto actual_texel_values =
-          GetActualValuesFromTexel(p + texel_stride * i, fmt);
+      std::vector<double> actual_texel_values;
+      if (convert_rows) {
+        auto texel_begin = row_values.begin() +
+                           static_cast<std::ptrdiff_t>(i * values_per_texel);
+        actual_texel_values.assign(
+            texel_begin,
+            texel_begin + static_cast<std::ptrdiff_t>(values_per_texel));
+      } else {
+        actual_texel_values =
+            GetActualValuesFromTexel(p + texel_stride * i, fmt);
+      }
       ScaleTexelValuesIfNeeded(&actual_texel_values, fmt);
       if (!IsTexelEqualToExpected(actual_texel_values, fmt, command, tolerance,
                                   is_tolerance_percent)) {
@@ -480,41 +556,40 @@ Result Verifier::Probe(const ProbeCommand* command,
   }
 
   if (count_of_invalid_pixels) {
-    float scale = fmt->IsNormalized() ? 255.f : 1.f;
-    std::string reason =
-        "Line " + std::to_string(command->GetLine()) +
-        ": Probe failed at: " + std::to_string(x + first_invalid_i) + ", " +
-        std::to_string(first_invalid_j + y) + "\n" +
-        "  Expected: " + std::to_string(command->GetR() * scale) + ", " +
-        std::to_string(command->GetG() * scale) + ", " +
-        std::to_string(command->GetB() * scale);
-
-    if (command->IsRGBA()) {
-      reason += ", " + std::to_string(command->GetA() * scale);
-    }
-
-    reason +=
-        "\n    Actual: " +
-        std::to_string(static_cast<float>(failure_values[0]) * scale) + ", " +
-        std::to_string(static_cast<float>(failure_values[1]) * scale) + ", " +
-        std::to_string(static_cast<float>(failure_values[2]) * scale);
-
-    if (command->IsRGBA()) {
-      reason +=
-          ", " + std::to_string(static_cast<float>(failure_values[3]) * scale);
-    }
-
-    reason += "\nProbe failed in " + std::to_string(count_of_invalid_pixels) +
-              " pixels";
-
-    return Result(reason);
+    return ProbeFailureResult(command, fmt, x + first_invalid_i,
+                              y + first_invalid_j, failure_values,
+                              count_of_invalid_pixels);
   }
 
   return {};
 }
 
+Result Verifier::ProbeFailure(const ProbeCommand* command,
+                              const Format* fmt,
+                              uint32_t texel_stride,
+                              uint32_t row_stride,
+                              uint32_t x,
+                              uint32_t y,
+                              uint32_t failed_count,
+                              const void* buf) {
+  if (!command)
+    return Result("Verifier::ProbeFailure given ProbeCommand is nullptr");
+  if (!fmt)
+    return Result("Verifier::ProbeFailure given texel's Format is nullptr");
+  if (!buf)
+    return Result("Verifier::ProbeFailure given buffer is nullptr");
+
+  const uint8_t* texel = static_cast<const uint8_t*>(buf) +
+                         static_cast<size_t>(row_stride) * y +
+                         static_cast<size_t>(texel_stride) * x;
+  std::vector<double> values = GetActualValuesFromTexel(texel, fmt);
+  ScaleTexelValuesIfNeeded(&values, fmt);
+  return ProbeFailureResult(command, fmt, x, y, GetTexelInRGBA(values, fmt),
+                            failed_count);
+}
+
 Result Verifier::ProbeSSBO(const ProbeSSBOCommand* command,
-                           uint32_t buffer_element_count,
+                           uint64_t buffer_element_count,
                            const void* buffer) {
   const auto& values = command->GetValues();
   if (!buffer) {
@@ -527,13 +602,27 @@ Result Verifier::ProbeSSBO(const ProbeSSBOCommand* command,
 
   auto* fmt = command->GetFormat();
   size_t elem_count = values.size() / fmt->InputNeededPerElement();
-  size_t offset = static_cast<size_t>(command->GetOffset());
-  size_t size_in_bytes = buffer_element_count * fmt->SizeInBytes();
-  if ((elem_count * fmt->SizeInBytes()) + offset > size_in_bytes) {
+  const uint64_t offset = command->GetOffset();
+  uint64_t size_in_bytes = 0;
+  if (!CheckedMultiply(buffer_element_count, fmt->SizeInBytes(),
+                       &size_in_bytes)) {
+    return Result("Line " + std::to_string(command->GetLine()) +
+                  ": Verifier::ProbeSSBO buffer of " +
+                  std::to_string(buffer_element_count) +
+                  " elements is too large");
+  }
+  uint64_t probe_size = 0;
+  uint64_t end = 0;
+  if (!CheckedMultiply(elem_count, fmt->SizeInBytes(), &probe_size) ||
+      !CheckedAdd(probe_size, offset, &end)) {
+    return Result("Line " + std::to_string(command->GetLine()) +
+                  ": Verifier::ProbeSSBO given offset (" +
+                  std::to_string(offset) + ") is too large");
+  }
+  if (end > size_in_bytes) {
     return Result("Line " + std::to_string(command->GetLine()) +
                   ": Verifier::ProbeSSBO request to access to byte " +
-                  std::to_string((elem_count * fmt->SizeInBytes()) + offset) +
-                  " would read outside buffer of size " +
+                  std::to_string(end) + " would read outside buffer of size " +
                   std::to_string(size_in_bytes) + " bytes");
   }
 
@@ -547,7 +636,23 @@ Result Verifier::ProbeSSBO(const ProbeSSBOCommand* command,
 
   auto& segments = fmt->GetSegments();
 
-  const uint8_t* ptr = static_cast<const uint8_t*>(buffer) + offset;
+  const uint8_t* ptr =
+      static_cast<const uint8_t*>(buffer) + static_cast<size_t>(offset);
+  if (fmt->AreAllSegmentsFloat16()) {
+    std::vector<float> actual(values.size());
+    float16::HexFloatToFloatArray(reinterpret_cast<const uint16_t*>(ptr),
+                                  actual.data(), actual.size(), 16);
+    for (size_t i = 0; i < values.size(); ++i) {
+      Result r = CheckActualValue<float>(command, actual[i], values[i]);
+      if (!r.IsSuccess()) {
+        return Result("Line " + std::to_string(command->GetLine()) +
+                      ": Verifier failed: " + r.Error() + ", at index " +
+                      std::to_string(i));
+      }
+    }
+    return {};
+  }
+
   for (size_t i = 0, k = 0; i < values.size(); ++i, ++k) {
     if (k >= segments.size())
       k = 0;
@@ -23,6 +23,23 @@
 
 namespace amber {
 
+/// Computes the texel region of a |frame_width| by |frame_height| frame
+/// checked by |command|. Returns an error if the region is not inside the
+/// frame.
+Result GetProbeRegion(const ProbeCommand* command,
+                      uint32_t frame_width,
+                      uint32_t frame_height,
+                      uint32_t* x,
+                      uint32_t* y,
+                      uint32_t* width,
+                      uint32_t* height);
+
+/// Fills the R, G, B and A entries of |tolerance| and |is_tolerance_percent|
+/// with the tolerances used to check the texels probed by |command|.
+void SetupToleranceForTexels(const ProbeCommand* command,
+                             double* tolerance,
+                             bool* is_tolerance_percent);
+
 /// The verifier is used to validate if a probe command is successful or not.
 class Verifier {
  public:
@@ -40,10 +57,22 @@ class Verifier {
                uint32_t frame_height,
                const void* buf);
 
+  /// Returns the error Probe reports for |command| when |failed_count|
+  /// texels do not match and the first of them is at |x|, |y| of |buf|.
+  /// This lets a probe evaluated elsewhere fail with the same message.
+  Result ProbeFailure(const ProbeCommand* command,
+                      const Format* texel_format,
+                      uint32_t texel_stride,
+                      uint32_t row_stride,
+                      uint32_t x,
+                      uint32_t y,
+                      uint32_t failed_count,
+                      const void* buf);
+
   /// Check |command| against |cpu_memory|. The result will be success if the
   /// probe passes correctly.
   Result ProbeSSBO(const ProbeSSBOCommand* command,
-                   uint32_t buffer_element_count,
+                   uint64_t buffer_element_count,
                    const void* buffer);
 };
 
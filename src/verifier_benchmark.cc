@@ -0,0 +1,124 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "amber/value.h"
+#include "benchmark/benchmark.h"
+#include "src/buffer.h"
+#include "src/command.h"
+#include "src/format.h"
+#include "src/pipeline.h"
+#include "src/type_parser.h"
+#include "src/verifier.h"
+
+namespace amber {
+namespace {
+
+const char* kProbeFormats[] = {
+    "B8G8R8A8_UNORM",
+    "R8G8B8A8_SRGB",
+    "R16G16B16A16_SFLOAT",
+    "R32G32B32A32_SFLOAT",
+};
+const int kProbeFormatCount =
+    static_cast<int>(sizeof(kProbeFormats) / sizeof(kProbeFormats[0]));
+
+void BM_VerifierProbe(benchmark::State& state) {
+  const char* name = kProbeFormats[state.range(0)];
+  const uint32_t dim = static_cast<uint32_t>(state.range(1));
+  state.SetLabel(name);
+
+  TypeParser parser;
+  auto type = parser.Parse(name);
+  Format fmt(type.get());
+  const uint32_t texel_stride = fmt.SizeInBytes();
+  const uint32_t row_stride = texel_stride * dim;
+
+  // A zero filled frame matches an all zero probe for every format.
+  std::vector<uint8_t> frame(static_cast<size_t>(row_stride) * dim, 0);
+
+  Pipeline pipeline(PipelineType::kGraphics);
+  auto color_buf = pipeline.GenerateDefaultColorAttachmentBuffer();
+  ProbeCommand probe(color_buf.get());
+  probe.SetWholeWindow();
+  probe.SetProbeRect();
+  probe.SetIsRGBA();
+
+  Verifier verifier;
+  for (auto _ : state) {
+    Result r = verifier.Probe(&probe, &fmt, texel_stride, row_stride, dim, dim,
+                              frame.data());
+    benchmark::DoNotOptimize(r);
+  }
+  state.SetItemsProcessed(state.iterations() * dim * dim);
+}
+BENCHMARK(BM_VerifierProbe)
+    ->ArgsProduct({benchmark::CreateDenseRange(0, kProbeFormatCount - 1, 1),
+                   {64, 256, 1024}});
+
+const char* kSSBOFormats[] = {
+    "R8_UINT", "R16_SFLOAT", "R32_SINT", "R32_SFLOAT", "R64_SFLOAT",
+};
+const int kSSBOFormatCount =
+    static_cast<int>(sizeof(kSSBOFormats) / sizeof(kSSBOFormats[0]));
+
+void BM_VerifierProbeSSBO(benchmark::State& state) {
+  const char* name = kSSBOFormats[state.range(0)];
+  const size_t count = static_cast<size_t>(state.range(1));
+  const auto comparator =
+      static_cast<ProbeSSBOCommand::Comparator>(state.range(2));
+  state.SetLabel(name);
+
+  TypeParser parser;
+  auto type = parser.Parse(name);
+  Format fmt(type.get());
+
+  Buffer buf;
+  ProbeSSBOCommand probe(&buf);
+  probe.SetFormat(&fmt);
+  probe.SetComparator(comparator);
+  if (comparator == ProbeSSBOCommand::Comparator::kFuzzyEqual)
+    probe.SetTolerances({Probe::Tolerance(false, 0.1)});
+
+  // Expect zero everywhere; the SSBO contents are zero for every format.
+  std::vector<Value> values(count);
+  for (auto& v : values)
+    v.SetIntValue(0);
+  probe.SetValues(std::move(values));
+
+  std::vector<uint8_t> ssbo(count * fmt.SizeInBytes(), 0);
+
+  Verifier verifier;
+  for (auto _ : state) {
+    Result r = verifier.ProbeSSBO(&probe, static_cast<uint32_t>(count),
+                                  ssbo.data());
+    benchmark::DoNotOptimize(r);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_VerifierProbeSSBO)
+    ->ArgsProduct(
+        {benchmark::CreateDenseRange(0, kSSBOFormatCount - 1, 1),
+         {1 << 10, 1 << 16, 1 << 20},
+         {static_cast<int64_t>(ProbeSSBOCommand::Comparator::kEqual),
+          static_cast<int64_t>(ProbeSSBOCommand::Comparator::kFuzzyEqual),
+          static_cast<int64_t>(
+              ProbeSSBOCommand::Comparator::kLessOrEqual)}});
+
+}  // namespace
+}  // namespace amber
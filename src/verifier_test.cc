@@ -153,6 +153,51 @@ TEST_F(VerifierTest, ProbeFrameBufferRelativeSmallExpectFail) {
       r.Error());
 }
 
+TEST_F(VerifierTest, ProbeFailureMatchesProbe) {
+  Pipeline pipeline(PipelineType::kGraphics);
+  auto color_buf = pipeline.GenerateDefaultColorAttachmentBuffer();
+
+  ProbeCommand probe(color_buf.get());
+  probe.SetProbeRect();
+  probe.SetIsRGBA();
+  probe.SetX(1.0f);
+  probe.SetY(2.0f);
+  probe.SetWidth(4.0f);
+  probe.SetHeight(3.0f);
+  probe.SetR(0.5f);
+  probe.SetG(0.25f);
+  probe.SetB(0.0f);
+  probe.SetA(1.0f);
+
+  uint8_t frame_buffer[10][10][4] = {};
+  for (uint32_t y = 2; y < 5; ++y) {
+    for (uint32_t x = 1; x < 5; ++x) {
+      frame_buffer[y][x][0] = 0;
+      frame_buffer[y][x][1] = 64;
+      frame_buffer[y][x][2] = 128;
+      frame_buffer[y][x][3] = 255;
+    }
+  }
+  frame_buffer[3][2][2] = 10;
+  frame_buffer[4][4][1] = 200;
+
+  Verifier verifier;
+  Result r = verifier.Probe(&probe, GetColorFormat(), 4, 40, 10, 10,
+                            static_cast<const void*>(frame_buffer));
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ(
+      "Line 1: Probe failed at: 2, 3\n  Expected: 127.500000, 63.750000, "
+      "0.000000, 255.000000\n    Actual: 10.000000, 64.000000, 0.000000, "
+      "255.000000\nProbe failed in 2 pixels",
+      r.Error());
+
+  Result failure = verifier.ProbeFailure(
+      &probe, GetColorFormat(), 4, 40, 2, 3, 2,
+      static_cast<const void*>(frame_buffer));
+  ASSERT_FALSE(failure.IsSuccess());
+  EXPECT_EQ(r.Error(), failure.Error());
+}
+
 TEST_F(VerifierTest, ProbeFrameBuffer) {
   Pipeline pipeline(PipelineType::kGraphics);
   auto color_buf = pipeline.GenerateDefaultColorAttachmentBuffer();
@@ -428,6 +473,46 @@ TEST_F(VerifierTest, ProbeFrameBufferFloat32) {
   EXPECT_TRUE(r.IsSuccess());
 }
 
+TEST_F(VerifierTest, ProbeFrameBufferFloat16) {
+  Pipeline pipeline(PipelineType::kGraphics);
+  auto color_buf = pipeline.GenerateDefaultColorAttachmentBuffer();
+
+  ProbeCommand probe(color_buf.get());
+  probe.SetIsRGBA();
+  probe.SetProbeRect();
+  probe.SetX(0.0f);
+  probe.SetY(0.0f);
+  probe.SetWidth(3.0f);
+  probe.SetHeight(1.0f);
+  probe.SetR(-6.0f);
+  probe.SetG(14.0f);
+  probe.SetB(0.1171875f);
+  probe.SetA(0.5f);
+
+  uint16_t frame_buffer[3][4];
+  for (auto& texel : frame_buffer) {
+    texel[0] = float16::FloatToHexFloat16(-6.0f);
+    texel[1] = float16::FloatToHexFloat16(14.0f);
+    texel[2] = float16::FloatToHexFloat16(0.1171875f);
+    texel[3] = float16::FloatToHexFloat16(0.5f);
+  }
+  frame_buffer[2][1] = float16::FloatToHexFloat16(15.0f);
+
+  TypeParser parser;
+  auto type = parser.Parse("R16G16B16A16_SFLOAT");
+  Format fmt(type.get());
+
+  Verifier verifier;
+  Result r = verifier.Probe(&probe, &fmt, 4 * sizeof(uint16_t),
+                            12 * sizeof(uint16_t), 3, 1,
+                            static_cast<const void*>(&frame_buffer));
+  EXPECT_EQ(
+      "Line 1: Probe failed at: 2, 0\n  Expected: -6.000000, 14.000000, "
+      "0.117188, 0.500000\n    Actual: -6.000000, 15.000000, 0.117188, "
+      "0.500000\nProbe failed in 1 pixels",
+      r.Error());
+}
+
 TEST_F(VerifierTest, ProbeFrameBufferFloat64) {
   Pipeline pipeline(PipelineType::kGraphics);
   auto color_buf = pipeline.GenerateDefaultColorAttachmentBuffer();
@@ -688,6 +773,67 @@ TEST_F(VerifierTest, ProbeSSBOUint8Single) {
   EXPECT_TRUE(r.IsSuccess()) << r.Error();
 }
 
+TEST_F(VerifierTest, ProbeSSBOOffsetBeyond32Bits) {
+  Pipeline pipeline(PipelineType::kGraphics);
+  auto color_buf = pipeline.GenerateDefaultColorAttachmentBuffer();
+
+  ProbeSSBOCommand probe_ssbo(color_buf.get());
+
+  TypeParser parser;
+  auto type = parser.Parse("R8_UINT");
+  Format fmt(type.get());
+
+  probe_ssbo.SetFormat(&fmt);
+  probe_ssbo.SetComparator(ProbeSSBOCommand::Comparator::kEqual);
+  probe_ssbo.SetOffset(0x100000000ULL);
+
+  std::vector<Value> values;
+  values.emplace_back();
+  values.back().SetIntValue(13);
+  probe_ssbo.SetValues(std::move(values));
+
+  uint8_t ssbo = 13U;
+
+  Verifier verifier;
+  Result r =
+      verifier.ProbeSSBO(&probe_ssbo, 1, static_cast<const void*>(&ssbo));
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ(
+      "Line 1: Verifier::ProbeSSBO request to access to byte 4294967297 would "
+      "read outside buffer of size 1 bytes",
+      r.Error());
+}
+
+TEST_F(VerifierTest, ProbeSSBOBufferSizeOverflow) {
+  Pipeline pipeline(PipelineType::kGraphics);
+  auto color_buf = pipeline.GenerateDefaultColorAttachmentBuffer();
+
+  ProbeSSBOCommand probe_ssbo(color_buf.get());
+
+  TypeParser parser;
+  auto type = parser.Parse("R32_UINT");
+  Format fmt(type.get());
+
+  probe_ssbo.SetFormat(&fmt);
+  probe_ssbo.SetComparator(ProbeSSBOCommand::Comparator::kEqual);
+
+  std::vector<Value> values;
+  values.emplace_back();
+  values.back().SetIntValue(13);
+  probe_ssbo.SetValues(std::move(values));
+
+  uint32_t ssbo = 13U;
+
+  Verifier verifier;
+  Result r = verifier.ProbeSSBO(&probe_ssbo, 0x4000000000000000ULL,
+                                static_cast<const void*>(&ssbo));
+  ASSERT_FALSE(r.IsSuccess());
+  EXPECT_EQ(
+      "Line 1: Verifier::ProbeSSBO buffer of 4611686018427387904 elements is "
+      "too large",
+      r.Error());
+}
+
 TEST_F(VerifierTest, ProbeSSBOUint8Multiple) {
   Pipeline pipeline(PipelineType::kGraphics);
   auto color_buf = pipeline.GenerateDefaultColorAttachmentBuffer();
@@ -857,6 +1003,35 @@ TEST_F(VerifierTest, ProbeSSBOFloatSingle) {
   EXPECT_TRUE(r.IsSuccess()) << r.Error();
 }
 
+TEST_F(VerifierTest, ProbeSSBOFloat16Many) {
+  Pipeline pipeline(PipelineType::kGraphics);
+  auto color_buf = pipeline.GenerateDefaultColorAttachmentBuffer();
+
+  ProbeSSBOCommand probe_ssbo(color_buf.get());
+
+  TypeParser parser;
+  auto type = parser.Parse("R16G16_SFLOAT");
+  Format fmt(type.get());
+
+  probe_ssbo.SetFormat(&fmt);
+  probe_ssbo.SetComparator(ProbeSSBOCommand::Comparator::kEqual);
+
+  std::vector<Value> values(10);
+  uint16_t ssbo[10];
+  for (size_t i = 0; i < 10; ++i) {
+    values[i].SetDoubleValue(static_cast<double>(i) * 0.5);
+    ssbo[i] = float16::FloatToHexFloat16(static_cast<float>(i) * 0.5f);
+  }
+  ssbo[7] = float16::FloatToHexFloat16(2.0f);
+  probe_ssbo.SetValues(std::move(values));
+
+  Verifier verifier;
+  Result r =
+      verifier.ProbeSSBO(&probe_ssbo, 5, static_cast<const void*>(ssbo));
+  EXPECT_EQ("Line 1: Verifier failed: 2.000000 == 3.500000, at index 7",
+            r.Error());
+}
+
 TEST_F(VerifierTest, ProbeSSBOFloatMultiple) {
   Pipeline pipeline(PipelineType::kGraphics);
   auto color_buf = pipeline.GenerateDefaultColorAttachmentBuffer();
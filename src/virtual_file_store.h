@@ -66,6 +66,9 @@ class VirtualFileStore {
     return {};
   }
 
+  /// Returns true if no virtual file was added.
+  bool IsEmpty() const { return files_by_path_.empty(); }
+
  private:
   std::unordered_map<std::string, std::string> files_by_path_;
 };
@@ -24,7 +24,6 @@
 #include "src/command_data.h"
 #include "src/make_unique.h"
 #include "src/tokenizer.h"
-#include "src/type_parser.h"
 #include "src/vkscript/datum_type_parser.h"
 
 namespace amber {
@@ -594,13 +593,11 @@ Result CommandParser::ProcessSSBO() {
     if (!type)
       return Result("Invalid type provided: " + token->AsString());
 
-    auto fmt = MakeUnique<Format>(type.get());
+    auto* fmt = script_->GetFormat(script_->InternType(std::move(type)));
     auto* buf = cmd->GetBuffer();
     if (buf->FormatIsDefault() || !buf->GetFormat()) {
-      buf->SetFormat(fmt.get());
-      script_->RegisterFormat(std::move(fmt));
-      script_->RegisterType(std::move(type));
-    } else if (!buf->GetFormat()->Equal(fmt.get())) {
+      buf->SetFormat(fmt);
+    } else if (!buf->GetFormat()->Equal(fmt)) {
       return Result("probe ssbo format does not match buffer format");
     }
 
@@ -609,24 +606,26 @@ Result CommandParser::ProcessSSBO() {
       return Result("Invalid offset for ssbo command: " +
                     token->ToOriginalString());
     }
-    if (token->AsInt32() < 0) {
+    if (token->AsInt64() < 0) {
       return Result("offset for SSBO must be positive, got: " +
-                    std::to_string(token->AsInt32()));
+                    std::to_string(token->AsInt64()));
     }
-    if ((token->AsUint32() % buf->GetFormat()->SizeInBytes()) != 0) {
+    if ((token->AsUint64() % buf->GetFormat()->SizeInBytes()) != 0) {
       return Result(
           "offset for SSBO must be a multiple of the data size expected " +
           std::to_string(buf->GetFormat()->SizeInBytes()));
     }
 
-    cmd->SetOffset(token->AsUint32());
+    cmd->SetOffset(token->AsUint64());
 
     std::vector<Value> values;
     Result r = ParseValues("ssbo", buf->GetFormat(), &values);
     if (!r.IsSuccess())
       return r;
 
-    buf->RecalculateMaxSizeInBytes(values, cmd->GetOffset());
+    r = buf->RecalculateMaxSizeInBytes(values, cmd->GetOffset());
+    if (!r.IsSuccess())
+      return r;
 
     cmd->SetValues(std::move(values));
 
@@ -640,22 +639,21 @@ Result CommandParser::ProcessSSBO() {
 
     // Resize the buffer so we'll correctly create the descriptor sets.
     auto* buf = cmd->GetBuffer();
-    buf->SetElementCount(token->AsUint32());
+    buf->SetElementCount(token->AsUint64());
 
     // Set a default format into the buffer if needed.
     if (!buf->GetFormat()) {
-      TypeParser parser;
-      auto type = parser.Parse("R8_SINT");
-      auto fmt = MakeUnique<Format>(type.get());
-      buf->SetFormat(fmt.get());
-      script_->RegisterFormat(std::move(fmt));
-      script_->RegisterType(std::move(type));
+      buf->SetFormat(script_->GetFormat(script_->ParseType("R8_SINT")));
 
       // This has to come after the SetFormat() call because SetFormat() resets
       // the value back to false.
       buf->SetFormatIsDefault(true);
     }
 
+    Result r = buf->CheckSizeInElements(buf->ElementCount());
+    if (!r.IsSuccess())
+      return r;
+
     token = tokenizer_->NextToken();
     if (!token->IsEOS() && !token->IsEOL())
       return Result("Extra parameter for ssbo command: " +
@@ -752,18 +750,15 @@ Result CommandParser::ProcessUniform() {
   if (!type)
     return Result("Invalid type provided: " + token->AsString());
 
-  auto fmt = MakeUnique<Format>(type.get());
-
   // uniform is always std140.
-  if (is_ubo)
-    fmt->SetLayout(Format::Layout::kStd140);
+  auto* fmt = script_->GetFormat(
+      script_->InternType(std::move(type)),
+      is_ubo ? Format::Layout::kStd140 : Format::Layout::kStd430);
 
   auto* buf = cmd->GetBuffer();
   if (buf->FormatIsDefault() || !buf->GetFormat()) {
-    buf->SetFormat(fmt.get());
-    script_->RegisterFormat(std::move(fmt));
-    script_->RegisterType(std::move(type));
-  } else if (!buf->GetFormat()->Equal(fmt.get())) {
+    buf->SetFormat(fmt);
+  } else if (!buf->GetFormat()->Equal(fmt)) {
     return Result("probe ssbo format does not match buffer format");
   }
 
@@ -772,23 +767,24 @@ Result CommandParser::ProcessUniform() {
     return Result("Invalid offset value for uniform command: " +
                   token->ToOriginalString());
   }
-  if (token->AsInt32() < 0) {
+  if (token->AsInt64() < 0) {
     return Result("offset for uniform must be positive, got: " +
-                  std::to_string(token->AsInt32()));
+                  std::to_string(token->AsInt64()));
   }
 
-  auto buf_size = static_cast<int32_t>(buf->GetFormat()->SizeInBytes());
-  if (token->AsInt32() % buf_size != 0)
+  if (token->AsUint64() % buf->GetFormat()->SizeInBytes() != 0)
     return Result("offset for uniform must be multiple of data size");
 
-  cmd->SetOffset(token->AsUint32());
+  cmd->SetOffset(token->AsUint64());
 
   std::vector<Value> values;
   Result r = ParseValues("uniform", buf->GetFormat(), &values);
   if (!r.IsSuccess())
     return r;
 
-  buf->RecalculateMaxSizeInBytes(values, cmd->GetOffset());
+  r = buf->RecalculateMaxSizeInBytes(values, cmd->GetOffset());
+  if (!r.IsSuccess())
+    return r;
 
   if (cmd->IsPushConstant())
     buf->SetData(values);
@@ -2072,28 +2068,25 @@ Result CommandParser::ProcessProbeSSBO() {
                   std::to_string(binding));
   }
 
-  auto fmt = MakeUnique<Format>(type.get());
+  auto* fmt = script_->GetFormat(script_->InternType(std::move(type)));
   if (buffer->FormatIsDefault() || !buffer->GetFormat()) {
-    buffer->SetFormat(fmt.get());
-  } else if (buffer->GetFormat() && !buffer->GetFormat()->Equal(fmt.get())) {
+    buffer->SetFormat(fmt);
+  } else if (buffer->GetFormat() && !buffer->GetFormat()->Equal(fmt)) {
     return Result("probe format does not match buffer format");
   }
 
   auto cmd = MakeUnique<ProbeSSBOCommand>(buffer);
   cmd->SetLine(cur_line);
   cmd->SetTolerances(current_tolerances_);
-  cmd->SetFormat(fmt.get());
+  cmd->SetFormat(fmt);
   cmd->SetDescriptorSet(set);
   cmd->SetBinding(binding);
 
-  script_->RegisterFormat(std::move(fmt));
-  script_->RegisterType(std::move(type));
-
   if (!token->IsInteger())
     return Result("Invalid offset for probe ssbo command: " +
                   token->ToOriginalString());
 
-  cmd->SetOffset(token->AsUint32());
+  cmd->SetOffset(token->AsUint64());
 
   token = tokenizer_->NextToken();
   if (!token->IsIdentifier())
@@ -178,12 +178,10 @@ Result Parser::ProcessRequireBlock(const SectionParser::Section& section) {
                                       token->ToOriginalString()));
       }
 
-      auto fmt = MakeUnique<Format>(type.get());
       script_->GetPipeline(kDefaultPipelineName)
           ->GetColorAttachments()[0]
-          .buffer->SetFormat(fmt.get());
-      script_->RegisterFormat(std::move(fmt));
-      script_->RegisterType(std::move(type));
+          .buffer->SetFormat(
+              script_->GetFormat(script_->InternType(std::move(type))));
 
     } else if (str == "depthstencil") {
       token = tokenizer.NextToken();
@@ -202,12 +200,10 @@ Result Parser::ProcessRequireBlock(const SectionParser::Section& section) {
       if (pipeline->GetDepthStencilBuffer().buffer != nullptr)
         return Result("Only one depthstencil command allowed");
 
-      auto fmt = MakeUnique<Format>(type.get());
       // Generate and add a depth buffer
       auto depth_buf = pipeline->GenerateDefaultDepthStencilAttachmentBuffer();
-      depth_buf->SetFormat(fmt.get());
-      script_->RegisterFormat(std::move(fmt));
-      script_->RegisterType(std::move(type));
+      depth_buf->SetFormat(
+          script_->GetFormat(script_->InternType(std::move(type))));
 
       Result r = pipeline->SetDepthStencilBuffer(depth_buf.get());
       if (!r.IsSuccess())
@@ -296,16 +292,11 @@ Result Parser::ProcessIndicesBlock(const SectionParser::Section& section) {
   }
 
   if (!indices.empty()) {
-    TypeParser parser;
-    auto type = parser.Parse("R32_UINT");
-    auto fmt = MakeUnique<Format>(type.get());
     auto b = MakeUnique<Buffer>();
     auto* buf = b.get();
     b->SetName("indices");
-    b->SetFormat(fmt.get());
+    b->SetFormat(script_->GetFormat(script_->ParseType("R32_UINT")));
     b->SetData(std::move(indices));
-    script_->RegisterFormat(std::move(fmt));
-    script_->RegisterType(std::move(type));
 
     Result r = script_->AddBuffer(std::move(b));
     if (!r.IsSuccess())
@@ -367,10 +358,8 @@ Result Parser::ProcessVertexDataBlock(const SectionParser::Section& section) {
                                     fmt_name.substr(1, fmt_name.length())));
     }
 
-    auto fmt = MakeUnique<Format>(type.get());
-    headers.push_back({loc, fmt.get()});
-    script_->RegisterFormat(std::move(fmt));
-    script_->RegisterType(std::move(type));
+    headers.push_back(
+        {loc, script_->GetFormat(script_->InternType(std::move(type)))});
 
     token = tokenizer.NextToken();
   }
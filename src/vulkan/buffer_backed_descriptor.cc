@@ -80,7 +80,8 @@ Result BufferBackedDescriptor::MoveTransferResourceToBufferOutput(
         "output buffer is not empty");
   }
 
-  auto size_in_bytes = transfer_resource->GetSizeInBytes();
+  const auto size_in_bytes =
+      static_cast<size_t>(transfer_resource->GetSizeInBytes());
   buffer->SetElementCount(size_in_bytes / buffer->GetFormat()->SizeInBytes());
   buffer->ValuePtr()->resize(size_in_bytes);
   std::memcpy(buffer->ValuePtr()->data(), resource_memory_ptr, size_in_bytes);
@@ -60,11 +60,11 @@ Result BufferDescriptor::CreateResourceIfNeeded() {
   for (const auto& amber_buffer : GetAmberBuffers()) {
     // Create (but don't initialize) the transfer buffer if not already created.
     if (transfer_resources.count(amber_buffer) == 0) {
-      auto size_in_bytes =
-          static_cast<uint32_t>(amber_buffer->ValuePtr()->size());
+      const uint64_t size_in_bytes = amber_buffer->ValuePtr()->size();
       auto transfer_buffer = MakeUnique<TransferBuffer>(
           device_, size_in_bytes, amber_buffer->GetFormat());
       transfer_buffer->SetReadOnly(IsReadOnly());
+      transfer_buffer->SetMemoryPlacement(pipeline_->GetMemoryPlacement());
       transfer_resources[amber_buffer] = std::move(transfer_buffer);
     } else {
       // Unset transfer buffer's read only property if needed.
@@ -88,13 +88,14 @@ Result BufferDescriptor::CreateResourceIfNeeded() {
   return {};
 }
 
-void BufferDescriptor::UpdateDescriptorSetIfNeeded(
-    VkDescriptorSet descriptor_set) {
+void BufferDescriptor::AddDescriptorSetWriteIfNeeded(
+    VkDescriptorSet descriptor_set,
+    std::vector<VkWriteDescriptorSet>* writes) {
   if (!is_descriptor_set_update_needed_)
     return;
 
-  std::vector<VkDescriptorBufferInfo> buffer_infos;
-  std::vector<VkBufferView> buffer_views;
+  buffer_infos_.clear();
+  buffer_views_.clear();
 
   // Create VkDescriptorBufferInfo for every descriptor buffer.
   for (uint32_t i = 0; i < GetAmberBuffers().size(); i++) {
@@ -123,11 +124,11 @@ void BufferDescriptor::UpdateDescriptorSetIfNeeded(
       buffer_info.offset = descriptor_offsets_[i];
       buffer_info.range = range;
 
-      buffer_infos.push_back(buffer_info);
+      buffer_infos_.push_back(buffer_info);
     }
 
     if (IsUniformTexelBuffer() || IsStorageTexelBuffer()) {
-      buffer_views.push_back(*buffer->GetVkBufferView());
+      buffer_views_.push_back(*buffer->GetVkBufferView());
     }
   }
 
@@ -138,11 +139,9 @@ void BufferDescriptor::UpdateDescriptorSetIfNeeded(
   write.dstArrayElement = 0;
   write.descriptorCount = static_cast<uint32_t>(GetAmberBuffers().size());
   write.descriptorType = GetVkDescriptorType();
-  write.pBufferInfo = buffer_infos.data();
-  write.pTexelBufferView = buffer_views.data();
-
-  device_->GetPtrs()->vkUpdateDescriptorSets(device_->GetVkDevice(), 1, &write,
-                                             0, nullptr);
+  write.pBufferInfo = buffer_infos_.data();
+  write.pTexelBufferView = buffer_views_.data();
+  writes->push_back(write);
   is_descriptor_set_update_needed_ = false;
 }
 
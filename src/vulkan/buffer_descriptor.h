@@ -47,7 +47,9 @@ class BufferDescriptor : public BufferBackedDescriptor {
                    vulkan::Pipeline* pipeline);
   ~BufferDescriptor() override;
 
-  void UpdateDescriptorSetIfNeeded(VkDescriptorSet descriptor_set) override;
+  void AddDescriptorSetWriteIfNeeded(
+      VkDescriptorSet descriptor_set,
+      std::vector<VkWriteDescriptorSet>* writes) override;
   Result CreateResourceIfNeeded() override;
   std::vector<uint32_t> GetDynamicOffsets() override {
     return dynamic_offsets_;
@@ -72,6 +74,8 @@ class BufferDescriptor : public BufferBackedDescriptor {
   std::vector<uint32_t> dynamic_offsets_;
   std::vector<VkDeviceSize> descriptor_offsets_;
   std::vector<VkDeviceSize> descriptor_ranges_;
+  std::vector<VkDescriptorBufferInfo> buffer_infos_;
+  std::vector<VkBufferView> buffer_views_;
 };
 
 }  // namespace vulkan
@@ -0,0 +1,100 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/vulkan/call_stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#include "src/make_unique.h"
+
+namespace amber {
+namespace vulkan {
+
+CallStats::Entry::Entry(const std::string& entry_name)
+    : name(entry_name),
+      count(0),
+      total_ns(0),
+      min_ns(std::numeric_limits<uint64_t>::max()),
+      max_ns(0) {}
+
+CallStats::CallStats() = default;
+
+CallStats::~CallStats() = default;
+
+CallStats::Entry* CallStats::AddEntry(const std::string& name) {
+  entries_.push_back(MakeUnique<Entry>(name));
+  return entries_.back().get();
+}
+
+// static
+uint64_t CallStats::NowNs() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+// static
+void CallStats::Record(Entry* entry, uint64_t duration_ns) {
+  entry->count.fetch_add(1, std::memory_order_relaxed);
+  entry->total_ns.fetch_add(duration_ns, std::memory_order_relaxed);
+
+  uint64_t min_ns = entry->min_ns.load(std::memory_order_relaxed);
+  while (duration_ns < min_ns &&
+         !entry->min_ns.compare_exchange_weak(min_ns, duration_ns,
+                                              std::memory_order_relaxed)) {
+  }
+  uint64_t max_ns = entry->max_ns.load(std::memory_order_relaxed);
+  while (duration_ns > max_ns &&
+         !entry->max_ns.compare_exchange_weak(max_ns, duration_ns,
+                                              std::memory_order_relaxed)) {
+  }
+}
+
+std::vector<std::string> CallStats::GetSummary() const {
+  std::vector<const Entry*> called;
+  for (const auto& entry : entries_) {
+    if (entry->count.load() > 0)
+      called.push_back(entry.get());
+  }
+  std::stable_sort(called.begin(), called.end(),
+                   [](const Entry* a, const Entry* b) {
+                     return a->total_ns.load() > b->total_ns.load();
+                   });
+
+  std::vector<std::string> lines;
+  std::ostringstream header;
+  // Same column widths as the per call timing lines.
+  header << std::left << std::setw(40) << "call" << std::right << std::setw(12)
+         << "count" << std::setw(16) << "total ns" << std::setw(12)
+         << "min ns" << std::setw(12) << "max ns";
+  lines.push_back(header.str());
+
+  for (const auto* entry : called) {
+    std::ostringstream out;
+    out << std::left << std::setw(40) << entry->name << std::right
+        << std::setw(12) << entry->count.load() << std::setw(16)
+        << entry->total_ns.load() << std::setw(12) << entry->min_ns.load()
+        << std::setw(12) << entry->max_ns.load();
+    lines.push_back(out.str());
+  }
+  return lines;
+}
+
+}  // namespace vulkan
+}  // namespace amber
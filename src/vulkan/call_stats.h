@@ -0,0 +1,68 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_VULKAN_CALL_STATS_H_
+#define SRC_VULKAN_CALL_STATS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace amber {
+namespace vulkan {
+
+/// Aggregated timing of the Vulkan calls made through the wrappers of a
+/// device. Every entry point has its own counters, which are updated without
+/// locks so calls made on different threads do not wait for each other.
+class CallStats {
+ public:
+  /// Counters of a single entry point.
+  struct Entry {
+    explicit Entry(const std::string& entry_name);
+
+    std::string name;
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> total_ns;
+    std::atomic<uint64_t> min_ns;
+    std::atomic<uint64_t> max_ns;
+  };
+
+  CallStats();
+  ~CallStats();
+
+  /// Adds the counters of the entry point |name| and returns them. Entries
+  /// must be added before any call is recorded.
+  Entry* AddEntry(const std::string& name);
+
+  /// Returns the current time of a monotonic clock in nanoseconds. Unlike the
+  /// delegate timestamps, this is safe to call from any thread.
+  static uint64_t NowNs();
+
+  /// Records a call which took |duration_ns| nanoseconds in |entry|.
+  static void Record(Entry* entry, uint64_t duration_ns);
+
+  /// Returns a table of the entry points which were called, one line each,
+  /// sorted by the total time spent in them, longest first.
+  std::vector<std::string> GetSummary() const;
+
+ private:
+  std::vector<std::unique_ptr<Entry>> entries_;
+};
+
+}  // namespace vulkan
+}  // namespace amber
+
+#endif  // SRC_VULKAN_CALL_STATS_H_
@@ -0,0 +1,58 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/vulkan/call_stats.h"
+
+#include "gtest/gtest.h"
+
+namespace amber {
+namespace vulkan {
+
+using CallStatsTest = testing::Test;
+
+TEST_F(CallStatsTest, Record) {
+  CallStats stats;
+  auto* entry = stats.AddEntry("vkQueueSubmit");
+  CallStats::Record(entry, 30);
+  CallStats::Record(entry, 10);
+  CallStats::Record(entry, 20);
+
+  EXPECT_EQ(3U, entry->count.load());
+  EXPECT_EQ(60U, entry->total_ns.load());
+  EXPECT_EQ(10U, entry->min_ns.load());
+  EXPECT_EQ(30U, entry->max_ns.load());
+}
+
+TEST_F(CallStatsTest, NowNsIsMonotonic) {
+  uint64_t first = CallStats::NowNs();
+  uint64_t second = CallStats::NowNs();
+  EXPECT_LE(first, second);
+}
+
+TEST_F(CallStatsTest, SummarySortedByTotalTime) {
+  CallStats stats;
+  auto* submit = stats.AddEntry("vkQueueSubmit");
+  auto* dispatch = stats.AddEntry("vkCmdDispatch");
+  stats.AddEntry("vkCmdDraw");
+  CallStats::Record(submit, 5);
+  CallStats::Record(dispatch, 7);
+
+  auto lines = stats.GetSummary();
+  ASSERT_EQ(3U, lines.size());
+  EXPECT_EQ(0U, lines[1].find("vkCmdDispatch "));
+  EXPECT_EQ(0U, lines[2].find("vkQueueSubmit "));
+}
+
+}  // namespace vulkan
+}  // namespace amber
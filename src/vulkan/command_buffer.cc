@@ -15,6 +15,7 @@
 #include "src/vulkan/command_buffer.h"
 
 #include <cassert>
+#include <string>
 
 #include "src/vulkan/command_pool.h"
 #include "src/vulkan/device.h"
@@ -22,22 +23,69 @@
 namespace amber {
 namespace vulkan {
 
-CommandBuffer::CommandBuffer(Device* device, CommandPool* pool)
-    : device_(device), pool_(pool) {}
+namespace {
+
+// Number of command buffers a single `CommandBuffer` may have in flight.
+const size_t kMaxSlots = 3;
+
+uint64_t ToNanoseconds(uint32_t timeout_ms) {
+  return static_cast<uint64_t>(timeout_ms) * 1000ULL * 1000ULL;
+}
+
+}  // namespace
+
+CommandBuffer::CommandBuffer(Device* device,
+                             CommandPool* pool,
+                             uint32_t fence_timeout_ms)
+    : device_(device), pool_(pool), fence_timeout_ms_(fence_timeout_ms) {}
 
 CommandBuffer::~CommandBuffer() {
   Reset();
 
-  if (fence_ != VK_NULL_HANDLE)
-    device_->GetPtrs()->vkDestroyFence(device_->GetVkDevice(), fence_, nullptr);
+  // Command buffers must not be freed while the device still uses them.
+  WaitAndReset(fence_timeout_ms_);
 
-  if (command_ != VK_NULL_HANDLE) {
-    device_->GetPtrs()->vkFreeCommandBuffers(
-        device_->GetVkDevice(), pool_->GetVkCommandPool(), 1, &command_);
+  for (auto& slot : slots_) {
+    if (slot.fence != VK_NULL_HANDLE) {
+      device_->GetPtrs()->vkDestroyFence(device_->GetVkDevice(), slot.fence,
+                                         nullptr);
+    }
+    if (slot.command != VK_NULL_HANDLE) {
+      device_->GetPtrs()->vkFreeCommandBuffers(
+          device_->GetVkDevice(), pool_->GetVkCommandPool(), 1, &slot.command);
+    }
+  }
+
+  if (timeline_ != VK_NULL_HANDLE) {
+    device_->GetPtrs()->vkDestroySemaphore(device_->GetVkDevice(), timeline_,
+                                           nullptr);
   }
 }
 
 Result CommandBuffer::Initialize() {
+  if (device_->SupportsTimelineSemaphores()) {
+    VkSemaphoreTypeCreateInfo type_info = VkSemaphoreTypeCreateInfo();
+    type_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    type_info.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    type_info.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphore_info = VkSemaphoreCreateInfo();
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphore_info.pNext = &type_info;
+    if (device_->GetPtrs()->vkCreateSemaphore(device_->GetVkDevice(),
+                                              &semaphore_info, nullptr,
+                                              &timeline_) != VK_SUCCESS) {
+      return Result("Vulkan::Calling vkCreateSemaphore Fail");
+    }
+  }
+
+  return AddSlot();
+}
+
+Result CommandBuffer::AddSlot() {
+  slots_.emplace_back();
+  Slot& slot = slots_.back();
+
   VkCommandBufferAllocateInfo command_info = VkCommandBufferAllocateInfo();
   command_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
   command_info.commandPool = pool_->GetVkCommandPool();
@@ -45,26 +93,105 @@ Result CommandBuffer::Initialize() {
   command_info.commandBufferCount = 1;
 
   if (device_->GetPtrs()->vkAllocateCommandBuffers(
-          device_->GetVkDevice(), &command_info, &command_) != VK_SUCCESS) {
+          device_->GetVkDevice(), &command_info, &slot.command) != VK_SUCCESS) {
     return Result("Vulkan::Calling vkAllocateCommandBuffers Fail");
   }
 
+  if (timeline_ != VK_NULL_HANDLE)
+    return {};
+
   VkFenceCreateInfo fence_info = VkFenceCreateInfo();
   fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
   if (device_->GetPtrs()->vkCreateFence(device_->GetVkDevice(), &fence_info,
-                                        nullptr, &fence_) != VK_SUCCESS) {
+                                        nullptr, &slot.fence) != VK_SUCCESS) {
     return Result("Vulkan::Calling vkCreateFence Fail");
   }
 
   return {};
 }
 
+VkResult CommandBuffer::WaitForSlot(const Slot& slot, uint64_t timeout_ns) {
+  if (timeline_ != VK_NULL_HANDLE)
+    return device_->WaitTimelineSemaphore(timeline_, slot.value, timeout_ns);
+
+  return device_->GetPtrs()->vkWaitForFences(device_->GetVkDevice(), 1,
+                                             &slot.fence, VK_TRUE, timeout_ns);
+}
+
+Result CommandBuffer::WaitResultToError(VkResult r) const {
+  const std::string name =
+      timeline_ != VK_NULL_HANDLE ? "vkWaitSemaphores" : "vkWaitForFences";
+  if (r == VK_TIMEOUT)
+    return Result("Vulkan::Calling " + name + " Timeout");
+  return Result("Vulkan::Calling " + name + " Fail");
+}
+
+Result CommandBuffer::ResetSlot(Slot* slot) {
+  slot->pending = false;
+  if (device_->GetPtrs()->vkResetCommandBuffer(slot->command, 0) !=
+      VK_SUCCESS) {
+    return Result("Vulkan::Calling vkResetCommandBuffer Fail");
+  }
+  return {};
+}
+
+Result CommandBuffer::AcquireSlot() {
+  // Recycle the command buffers the device is already done with.
+  for (auto& slot : slots_) {
+    if (!slot.pending)
+      continue;
+
+    VkResult r = WaitForSlot(slot, 0);
+    if (r == VK_TIMEOUT)
+      continue;
+    if (r != VK_SUCCESS)
+      return WaitResultToError(r);
+
+    Result res = ResetSlot(&slot);
+    if (!res.IsSuccess())
+      return res;
+  }
+
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    if (!slots_[i].pending) {
+      current_ = i;
+      return {};
+    }
+  }
+
+  if (slots_.size() < kMaxSlots) {
+    Result r = AddSlot();
+    if (!r.IsSuccess())
+      return r;
+
+    current_ = slots_.size() - 1;
+    return {};
+  }
+
+  // Every command buffer is in flight, wait for the oldest one.
+  size_t oldest = 0;
+  for (size_t i = 1; i < slots_.size(); ++i) {
+    if (slots_[i].value < slots_[oldest].value)
+      oldest = i;
+  }
+  VkResult r = WaitForSlot(slots_[oldest], ToNanoseconds(fence_timeout_ms_));
+  if (r != VK_SUCCESS)
+    return WaitResultToError(r);
+
+  current_ = oldest;
+  return ResetSlot(&slots_[oldest]);
+}
+
 Result CommandBuffer::BeginRecording() {
+  Result r = AcquireSlot();
+  if (!r.IsSuccess())
+    return r;
+
   VkCommandBufferBeginInfo command_begin_info = VkCommandBufferBeginInfo();
   command_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
   command_begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-  if (device_->GetPtrs()->vkBeginCommandBuffer(command_, &command_begin_info) !=
-      VK_SUCCESS) {
+  if (device_->GetPtrs()->vkBeginCommandBuffer(
+          GetVkCommandBuffer(), &command_begin_info) != VK_SUCCESS) {
     return Result("Vulkan::Calling vkBeginCommandBuffer Fail");
   }
   guarded_ = true;
@@ -72,43 +199,106 @@ Result CommandBuffer::BeginRecording() {
   return {};
 }
 
-Result CommandBuffer::SubmitAndReset(uint32_t timeout_ms) {
-  if (device_->GetPtrs()->vkEndCommandBuffer(command_) != VK_SUCCESS)
+Result CommandBuffer::Submit() {
+  Slot& slot = slots_[current_];
+  if (device_->GetPtrs()->vkEndCommandBuffer(slot.command) != VK_SUCCESS)
     return Result("Vulkan::Calling vkEndCommandBuffer Fail");
 
-  if (device_->GetPtrs()->vkResetFences(device_->GetVkDevice(), 1, &fence_) !=
-      VK_SUCCESS) {
-    return Result("Vulkan::Calling vkResetFences Fail");
-  }
+  const uint64_t signal_value = last_value_ + 1;
 
   VkSubmitInfo submit_info = VkSubmitInfo();
   submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
   submit_info.commandBufferCount = 1;
-  submit_info.pCommandBuffers = &command_;
-  if (device_->GetPtrs()->vkQueueSubmit(device_->GetVkQueue(), 1, &submit_info,
-                                        fence_) != VK_SUCCESS) {
+  submit_info.pCommandBuffers = &slot.command;
+
+  // Each submission waits for the previous value before signaling its own,
+  // so reaching a value implies all earlier submissions are done. Waits
+  // requested with `WaitForOnDevice` are added to it.
+  std::vector<VkSemaphore> wait_semaphores;
+  std::vector<uint64_t> wait_values;
+  if (last_value_ > 0) {
+    wait_semaphores.push_back(timeline_);
+    wait_values.push_back(last_value_);
+  }
+  for (const auto& wait : device_waits_) {
+    wait_semaphores.push_back(wait.first);
+    wait_values.push_back(wait.second);
+  }
+  const std::vector<VkPipelineStageFlags> wait_stages(
+      wait_semaphores.size(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+
+  VkTimelineSemaphoreSubmitInfo timeline_info = VkTimelineSemaphoreSubmitInfo();
+  if (timeline_ != VK_NULL_HANDLE) {
+    timeline_info.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timeline_info.signalSemaphoreValueCount = 1;
+    timeline_info.pSignalSemaphoreValues = &signal_value;
+    submit_info.pNext = &timeline_info;
+    submit_info.signalSemaphoreCount = 1;
+    submit_info.pSignalSemaphores = &timeline_;
+
+    if (!wait_semaphores.empty()) {
+      timeline_info.waitSemaphoreValueCount =
+          static_cast<uint32_t>(wait_values.size());
+      timeline_info.pWaitSemaphoreValues = wait_values.data();
+      submit_info.waitSemaphoreCount =
+          static_cast<uint32_t>(wait_semaphores.size());
+      submit_info.pWaitSemaphores = wait_semaphores.data();
+      submit_info.pWaitDstStageMask = wait_stages.data();
+    }
+  } else if (device_->GetPtrs()->vkResetFences(device_->GetVkDevice(), 1,
+                                               &slot.fence) != VK_SUCCESS) {
+    return Result("Vulkan::Calling vkResetFences Fail");
+  }
+
+  if (device_->GetPtrs()->vkQueueSubmit(pool_->GetVkQueue(), 1, &submit_info,
+                                        slot.fence) != VK_SUCCESS) {
     return Result("Vulkan::Calling vkQueueSubmit Fail");
   }
+  device_waits_.clear();
 
+  last_value_ = signal_value;
+  slot.value = signal_value;
+  slot.pending = true;
   guarded_ = false;
+  return {};
+}
 
-  VkResult r = device_->GetPtrs()->vkWaitForFences(
-      device_->GetVkDevice(), 1, &fence_, VK_TRUE,
-      static_cast<uint64_t>(timeout_ms) * 1000ULL * 1000ULL /* nanosecond */);
-  if (r == VK_TIMEOUT)
-    return Result("Vulkan::Calling vkWaitForFences Timeout");
-  if (r != VK_SUCCESS)
-    return Result("Vulkan::Calling vkWaitForFences Fail");
+void CommandBuffer::WaitForOnDevice(const CommandBuffer& other) {
+  if (timeline_ == VK_NULL_HANDLE || other.timeline_ == VK_NULL_HANDLE ||
+      other.last_value_ == 0) {
+    return;
+  }
+  device_waits_.emplace_back(other.timeline_, other.last_value_);
+}
 
-  if (device_->GetPtrs()->vkResetCommandBuffer(command_, 0) != VK_SUCCESS)
-    return Result("Vulkan::Calling vkResetCommandBuffer Fail");
+Result CommandBuffer::SubmitAndReset(uint32_t timeout_ms) {
+  Result r = Submit();
+  if (!r.IsSuccess())
+    return r;
+  return WaitAndReset(timeout_ms);
+}
+
+Result CommandBuffer::WaitAndReset(uint32_t timeout_ms) {
+  const uint64_t timeout_ns = ToNanoseconds(timeout_ms);
+  for (auto& slot : slots_) {
+    if (!slot.pending)
+      continue;
+
+    VkResult r = WaitForSlot(slot, timeout_ns);
+    if (r != VK_SUCCESS)
+      return WaitResultToError(r);
+
+    Result res = ResetSlot(&slot);
+    if (!res.IsSuccess())
+      return res;
+  }
 
   return {};
 }
 
 void CommandBuffer::Reset() {
   if (guarded_) {
-    device_->GetPtrs()->vkResetCommandBuffer(command_, 0);
+    device_->GetPtrs()->vkResetCommandBuffer(GetVkCommandBuffer(), 0);
     guarded_ = false;
   }
 }
@@ -129,5 +319,10 @@ Result CommandBufferGuard::Submit(uint32_t timeout_ms) {
   return buffer_->SubmitAndReset(timeout_ms);
 }
 
+Result CommandBufferGuard::SubmitNoWait() {
+  assert(buffer_->guarded_);
+  return buffer_->Submit();
+}
+
 }  // namespace vulkan
 }  // namespace amber
@@ -15,6 +15,9 @@
 #ifndef SRC_VULKAN_COMMAND_BUFFER_H_
 #define SRC_VULKAN_COMMAND_BUFFER_H_
 
+#include <utility>
+#include <vector>
+
 #include "amber/result.h"
 #include "amber/vulkan_header.h"
 
@@ -34,20 +37,63 @@ class CommandBufferGuard;
 class CommandPool;
 class Device;
 
-/// Wrapper around a Vulkan command buffer. This is designed to not be used
-/// directly, but should always be used through the `CommandBufferGuard` class.
+/// Wrapper around a small ring of Vulkan command buffers. This is designed to
+/// not be used directly, but should always be used through the
+/// `CommandBufferGuard` class.
+///
+/// Each recording takes a command buffer from the ring which is not in flight,
+/// so the host can record the next submission while the device still runs
+/// earlier ones. The host only blocks when the ring is exhausted or when the
+/// results are needed, see `WaitAndReset`. Completion is tracked with a
+/// timeline semaphore if the device enabled them, otherwise with one fence
+/// per command buffer.
 class CommandBuffer {
  public:
-  CommandBuffer(Device* device, CommandPool* pool);
+  /// |fence_timeout_ms| bounds the wait for a free command buffer when every
+  /// command buffer of the ring is in flight.
+  CommandBuffer(Device* device, CommandPool* pool, uint32_t fence_timeout_ms);
   ~CommandBuffer();
 
   Result Initialize();
-  VkCommandBuffer GetVkCommandBuffer() const { return command_; }
+  /// Returns the command buffer which is currently recorded.
+  VkCommandBuffer GetVkCommandBuffer() const {
+    return slots_.empty() ? VK_NULL_HANDLE : slots_[current_].command;
+  }
+
+  /// Waits for every submission made with `CommandBufferGuard::SubmitNoWait`
+  /// to finish and resets their command buffers.
+  Result WaitAndReset(uint32_t timeout_ms);
+
+  /// Makes the next submission wait on the device for everything submitted
+  /// through |other| so far, which may use a different queue. Only has an
+  /// effect if both use timeline semaphores.
+  void WaitForOnDevice(const CommandBuffer& other);
 
  private:
   friend CommandBufferGuard;
 
+  struct Slot {
+    VkCommandBuffer command = VK_NULL_HANDLE;
+    /// Only created if timeline semaphores are not supported.
+    VkFence fence = VK_NULL_HANDLE;
+    /// Sequence number of the last submission, also the timeline value it
+    /// signals.
+    uint64_t value = 0;
+    bool pending = false;
+  };
+
+  Result AddSlot();
+  /// Waits up to |timeout_ns| for the last submission of |slot| to finish.
+  VkResult WaitForSlot(const Slot& slot, uint64_t timeout_ns);
+  /// Returns the error for a failed `WaitForSlot` result |r|.
+  Result WaitResultToError(VkResult r) const;
+  /// Marks |slot| as not in flight and resets its command buffer.
+  Result ResetSlot(Slot* slot);
+  /// Finds a command buffer which is not in flight and makes it current.
+  Result AcquireSlot();
+
   Result BeginRecording();
+  Result Submit();
   Result SubmitAndReset(uint32_t timeout_ms);
   void Reset();
 
@@ -55,8 +101,13 @@ class CommandBuffer {
 
   Device* device_ = nullptr;
   CommandPool* pool_ = nullptr;
-  VkCommandBuffer command_ = VK_NULL_HANDLE;
-  VkFence fence_ = VK_NULL_HANDLE;
+  uint32_t fence_timeout_ms_ = 0;
+  std::vector<Slot> slots_;
+  size_t current_ = 0;
+  VkSemaphore timeline_ = VK_NULL_HANDLE;
+  uint64_t last_value_ = 0;
+  /// Timeline values of other command buffers the next submission waits for.
+  std::vector<std::pair<VkSemaphore, uint64_t>> device_waits_;
 };
 
 /// Wrapper around a `CommandBuffer`.
@@ -84,6 +135,10 @@ class CommandBufferGuard {
 
   /// Submits and resets the internal command buffer.
   Result Submit(uint32_t timeout_ms);
+  /// Submits the internal command buffer without waiting for it. The caller
+  /// must call `CommandBuffer::WaitAndReset` before reading the results on
+  /// the host.
+  Result SubmitNoWait();
 
  private:
   Result result_;
@@ -19,7 +19,15 @@
 namespace amber {
 namespace vulkan {
 
-CommandPool::CommandPool(Device* device) : device_(device) {}
+CommandPool::CommandPool(Device* device)
+    : CommandPool(device,
+                  device->GetQueueFamilyIndex(),
+                  device->GetVkQueue()) {}
+
+CommandPool::CommandPool(Device* device,
+                         uint32_t queue_family_index,
+                         VkQueue queue)
+    : device_(device), queue_family_index_(queue_family_index), queue_(queue) {}
 
 CommandPool::~CommandPool() {
   if (pool_ == VK_NULL_HANDLE)
@@ -33,7 +41,7 @@ Result CommandPool::Initialize() {
   VkCommandPoolCreateInfo pool_info = VkCommandPoolCreateInfo();
   pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
   pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-  pool_info.queueFamilyIndex = device_->GetQueueFamilyIndex();
+  pool_info.queueFamilyIndex = queue_family_index_;
 
   if (device_->GetPtrs()->vkCreateCommandPool(
           device_->GetVkDevice(), &pool_info, nullptr, &pool_) != VK_SUCCESS) {
@@ -24,17 +24,22 @@ namespace vulkan {
 class Device;
 
 /// Wrapper around a Vulkan command pool. The `Initialize` method must be called
-/// before using the command pool.
+/// before using the command pool. Command buffers of the pool are submitted to
+/// the queue given at construction, the main queue of the device by default.
 class CommandPool {
  public:
   explicit CommandPool(Device* device);
+  CommandPool(Device* device, uint32_t queue_family_index, VkQueue queue);
   ~CommandPool();
 
   Result Initialize();
   VkCommandPool GetVkCommandPool() const { return pool_; }
+  VkQueue GetVkQueue() const { return queue_; }
 
  private:
   Device* device_ = nullptr;
+  uint32_t queue_family_index_ = 0;
+  VkQueue queue_ = VK_NULL_HANDLE;
   VkCommandPool pool_ = VK_NULL_HANDLE;
 };
 
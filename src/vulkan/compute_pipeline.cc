@@ -14,6 +14,9 @@
 
 #include "src/vulkan/compute_pipeline.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "src/vulkan/command_pool.h"
 #include "src/vulkan/device.h"
 
@@ -29,10 +32,19 @@ ComputePipeline::ComputePipeline(
                fence_timeout_ms,
                shader_stage_info) {}
 
-ComputePipeline::~ComputePipeline() = default;
+ComputePipeline::~ComputePipeline() {
+  // The pipeline is destroyed before the command buffers, so submissions
+  // which were not waited for must be done first.
+  if (command_)
+    command_->WaitAndReset(GetFenceTimeout());
+
+  DestroyVkComputePipeline();
+}
 
-Result ComputePipeline::Initialize(CommandPool* pool) {
-  return Pipeline::Initialize(pool);
+Result ComputePipeline::Initialize(CommandPool* pool,
+                                   DescriptorPool* descriptor_pool,
+                                   SamplerCache* sampler_cache) {
+  return Pipeline::Initialize(pool, descriptor_pool, sampler_cache);
 }
 
 Result ComputePipeline::CreateVkComputePipeline(
@@ -56,66 +68,165 @@ Result ComputePipeline::CreateVkComputePipeline(
   pipeline_info.layout = pipeline_layout;
 
   if (device_->GetPtrs()->vkCreateComputePipelines(
-          device_->GetVkDevice(), VK_NULL_HANDLE, 1, &pipeline_info, nullptr,
-          pipeline) != VK_SUCCESS) {
+          device_->GetVkDevice(), device_->GetVkPipelineCache(), 1,
+          &pipeline_info, nullptr, pipeline) != VK_SUCCESS) {
     return Result("Vulkan::Calling vkCreateComputePipelines Fail");
   }
 
   return {};
 }
 
-Result ComputePipeline::Compute(uint32_t x, uint32_t y, uint32_t z) {
+void ComputePipeline::RecordDispatchBarrier() {
+  VkMemoryBarrier barrier = VkMemoryBarrier();
+  barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+  barrier.dstAccessMask =
+      VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+  device_->GetPtrs()->vkCmdPipelineBarrier(
+      command_->GetVkCommandBuffer(), VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0,
+      nullptr);
+}
+
+Result ComputePipeline::Compute(const std::vector<Dispatch>& dispatches,
+                                uint32_t count) {
+  if (dispatches.empty() || count == 0)
+    return {};
+
+  Result r = PrepareCompute();
+  if (!r.IsSuccess())
+    return r;
+
+  r = SubmitCompute(dispatches, count);
+  if (!r.IsSuccess())
+    return r;
+
+  return FinishCompute();
+}
+
+Result ComputePipeline::PrepareCompute() {
   Result r = SendDescriptorDataToDeviceIfNeeded();
   if (!r.IsSuccess())
     return r;
 
-  VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
-  r = CreateVkPipelineLayout(&pipeline_layout);
+  r = CreateVkDescriptorRelatedObjectsIfNeeded();
   if (!r.IsSuccess())
     return r;
 
-  VkPipeline pipeline = VK_NULL_HANDLE;
-  r = CreateVkComputePipeline(pipeline_layout, &pipeline);
+  r = CreateVkComputePipelineIfNeeded();
   if (!r.IsSuccess())
     return r;
 
   // Note that a command updating a descriptor set and a command using
   // it must be submitted separately, because using a descriptor set
   // while updating it is not safe.
-  UpdateDescriptorSetsIfNeeded();
+  return UpdateDescriptorSetsIfNeeded();
+}
 
-  {
-    CommandBufferGuard guard(GetCommandBuffer());
-    if (!guard.IsRecording())
-      return guard.GetResult();
+Result ComputePipeline::SubmitCompute(const std::vector<Dispatch>& dispatches,
+                                      uint32_t count) {
+  // The fence timeout is per dispatch, so the wait for the whole batch grows
+  // with its size.
+  const uint64_t timeout_ms = static_cast<uint64_t>(GetFenceTimeout()) *
+                              dispatches.size() * std::max(count, 1U);
+  submitted_timeout_ms_ = static_cast<uint32_t>(std::min<uint64_t>(
+      timeout_ms, std::numeric_limits<uint32_t>::max()));
 
-    BindVkDescriptorSets(pipeline_layout);
+  CommandBufferGuard guard(GetCommandBuffer());
+  if (!guard.IsRecording())
+    return guard.GetResult();
 
-    r = RecordPushConstant(pipeline_layout);
-    if (!r.IsSuccess())
-      return r;
+  BindVkDescriptorSets(pipeline_layout_);
 
-    device_->GetPtrs()->vkCmdBindPipeline(command_->GetVkCommandBuffer(),
-                                          VK_PIPELINE_BIND_POINT_COMPUTE,
-                                          pipeline);
-    device_->GetPtrs()->vkCmdDispatch(command_->GetVkCommandBuffer(), x, y, z);
+  Result r = RecordPushConstant(pipeline_layout_);
+  if (!r.IsSuccess())
+    return r;
 
-    r = guard.Submit(GetFenceTimeout());
+  device_->GetPtrs()->vkCmdBindPipeline(command_->GetVkCommandBuffer(),
+                                        VK_PIPELINE_BIND_POINT_COMPUTE,
+                                        pipeline_);
+  std::vector<VkBuffer> indirect_buffers(dispatches.size(), VK_NULL_HANDLE);
+  for (size_t k = 0; k < dispatches.size(); ++k) {
+    if (!dispatches[k].indirect_buffer)
+      continue;
+
+    r = RecordIndirectBufferUpload(
+        dispatches[k].indirect_buffer, dispatches[k].indirect_offset,
+        static_cast<uint32_t>(sizeof(VkDispatchIndirectCommand)),
+        &indirect_buffers[k]);
     if (!r.IsSuccess())
       return r;
   }
 
-  r = ReadbackDescriptorsToHostDataQueue();
+  for (uint32_t i = 0; i < count; ++i) {
+    for (size_t k = 0; k < dispatches.size(); ++k) {
+      if (i > 0 || k > 0)
+        RecordDispatchBarrier();
+
+      if (indirect_buffers[k] != VK_NULL_HANDLE) {
+        device_->GetPtrs()->vkCmdDispatchIndirect(
+            command_->GetVkCommandBuffer(), indirect_buffers[k],
+            dispatches[k].indirect_offset);
+      } else {
+        device_->GetPtrs()->vkCmdDispatch(command_->GetVkCommandBuffer(),
+                                          dispatches[k].x, dispatches[k].y,
+                                          dispatches[k].z);
+      }
+    }
+  }
+
+  return guard.SubmitNoWait();
+}
+
+Result ComputePipeline::FinishCompute() {
+  Result r = GetCommandBuffer()->WaitAndReset(
+      std::max(GetFenceTimeout(), submitted_timeout_ms_));
+  if (!r.IsSuccess())
+    return r;
+
+  return ReadbackDescriptorsToHostDataQueue();
+}
+
+Result ComputePipeline::CreateVkComputePipelineIfNeeded() {
+  const std::string entry_point =
+      GetEntryPointName(VK_SHADER_STAGE_COMPUTE_BIT);
+  const VkPushConstantRange range = GetVkPushConstantRange();
+  if (pipeline_ != VK_NULL_HANDLE && entry_point == pipeline_entry_point_ &&
+      range.offset == pipeline_push_constant_range_.offset &&
+      range.size == pipeline_push_constant_range_.size) {
+    return {};
+  }
+
+  // Only called between dispatches, which were waited for.
+  DestroyVkComputePipeline();
+
+  // The layout does not need the descriptor sets, so it can be created
+  // before them.
+  Result r = CreateTransientVkPipelineLayout(&pipeline_set_layouts_,
+                                             &pipeline_layout_);
   if (!r.IsSuccess())
     return r;
 
-  device_->GetPtrs()->vkDestroyPipeline(device_->GetVkDevice(), pipeline,
-                                        nullptr);
-  device_->GetPtrs()->vkDestroyPipelineLayout(device_->GetVkDevice(),
-                                              pipeline_layout, nullptr);
+  r = CreateVkComputePipeline(pipeline_layout_, &pipeline_);
+  if (!r.IsSuccess())
+    return r;
 
+  pipeline_entry_point_ = entry_point;
+  pipeline_push_constant_range_ = range;
   return {};
 }
 
+void ComputePipeline::DestroyVkComputePipeline() {
+  if (pipeline_ != VK_NULL_HANDLE) {
+    device_->GetPtrs()->vkDestroyPipeline(device_->GetVkDevice(), pipeline_,
+                                          nullptr);
+    pipeline_ = VK_NULL_HANDLE;
+  }
+  DestroyTransientVkPipelineLayout(pipeline_set_layouts_, pipeline_layout_);
+  pipeline_set_layouts_.clear();
+  pipeline_layout_ = VK_NULL_HANDLE;
+}
+
 }  // namespace vulkan
 }  // namespace amber
@@ -15,6 +15,7 @@
 #ifndef SRC_VULKAN_COMPUTE_PIPELINE_H_
 #define SRC_VULKAN_COMPUTE_PIPELINE_H_
 
+#include <string>
 #include <vector>
 
 #include "amber/result.h"
@@ -27,19 +28,66 @@ namespace vulkan {
 /// Pipepline to handle compute commands.
 class ComputePipeline : public Pipeline {
  public:
+  /// Workgroup counts for a single dispatch. If |indirect_buffer| is set the
+  /// counts are read from it at |indirect_offset| instead of x, y and z.
+  struct Dispatch {
+    uint32_t x;
+    uint32_t y;
+    uint32_t z;
+    Buffer* indirect_buffer;
+    uint32_t indirect_offset;
+  };
+
   ComputePipeline(
       Device* device,
       uint32_t fence_timeout_ms,
       const std::vector<VkPipelineShaderStageCreateInfo>& shader_stage_info);
   ~ComputePipeline() override;
 
-  Result Initialize(CommandPool* pool);
+  Result Initialize(CommandPool* pool,
+                    DescriptorPool* descriptor_pool,
+                    SamplerCache* sampler_cache);
+
+  /// Records |dispatches| |count| times into a single command buffer, with a
+  /// memory barrier between consecutive dispatches, and submits it once.
+  /// Descriptor data is uploaded before the first dispatch and read back
+  /// after the last one. The wait for the submission allows the fence
+  /// timeout for each of the recorded dispatches.
+  Result Compute(const std::vector<Dispatch>& dispatches, uint32_t count);
 
-  Result Compute(uint32_t x, uint32_t y, uint32_t z);
+  /// The three steps of `Compute`, for running several pipelines at once.
+  /// `PrepareCompute` uploads descriptor data and creates the VkPipeline if
+  /// needed, `SubmitCompute` records and submits the dispatches without
+  /// waiting and `FinishCompute` waits for them and reads the descriptors
+  /// back.
+  Result PrepareCompute();
+  Result SubmitCompute(const std::vector<Dispatch>& dispatches,
+                       uint32_t count);
+  Result FinishCompute();
+
+  /// Creates the VkPipeline and its layout unless they were already created
+  /// for the current entry point and push constants. They are kept for the
+  /// following dispatches. Only changes this pipeline, so different
+  /// pipelines can be built on different threads at the same time.
+  Result CreateVkComputePipelineIfNeeded();
 
  private:
   Result CreateVkComputePipeline(const VkPipelineLayout& pipeline_layout,
                                  VkPipeline* pipeline);
+  void DestroyVkComputePipeline();
+  void RecordDispatchBarrier();
+
+  /// The layout owns its descriptor set layouts, which are defined like the
+  /// ones of the descriptor sets, so the sets can be bound with it.
+  VkPipelineLayout pipeline_layout_ = VK_NULL_HANDLE;
+  std::vector<VkDescriptorSetLayout> pipeline_set_layouts_;
+  VkPipeline pipeline_ = VK_NULL_HANDLE;
+  /// The entry point and push constant range |pipeline_| was created for.
+  std::string pipeline_entry_point_;
+  VkPushConstantRange pipeline_push_constant_range_ = VkPushConstantRange();
+  /// Time `FinishCompute` waits for the last `SubmitCompute`, the fence
+  /// timeout scaled by the number of dispatches submitted.
+  uint32_t submitted_timeout_ms_ = 0;
 };
 
 }  // namespace vulkan
@@ -56,8 +56,18 @@ class Descriptor {
              uint32_t binding);
   virtual ~Descriptor();
 
-  virtual void UpdateDescriptorSetIfNeeded(VkDescriptorSet descriptor_set) = 0;
+  /// Appends to |writes| the write which updates |descriptor_set| with the
+  /// current resources, if the set is out of date. The write points at info
+  /// owned by the descriptor, which stays valid until the next call.
+  virtual void AddDescriptorSetWriteIfNeeded(
+      VkDescriptorSet descriptor_set,
+      std::vector<VkWriteDescriptorSet>* writes) = 0;
   virtual Result CreateResourceIfNeeded() = 0;
+  /// Makes the next AddDescriptorSetWriteIfNeeded call add a write, even if
+  /// the resources did not change.
+  void SetDescriptorSetUpdateNeeded() {
+    is_descriptor_set_update_needed_ = true;
+  }
   virtual uint32_t GetDescriptorCount() { return 1; }
   virtual std::vector<uint32_t> GetDynamicOffsets() { return {}; }
   virtual std::vector<VkDeviceSize> GetDescriptorOffsets() { return {}; }
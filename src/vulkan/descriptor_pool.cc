@@ -0,0 +1,128 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/vulkan/descriptor_pool.h"
+
+#include <algorithm>
+
+#include "src/vulkan/device.h"
+
+namespace amber {
+namespace vulkan {
+namespace {
+
+// Capacity of the first pool. Each following pool doubles it.
+const uint32_t kInitialSetCount = 16;
+const uint32_t kInitialDescriptorCount = 64;
+
+}  // namespace
+
+DescriptorPool::DescriptorPool(Device* device) : device_(device) {}
+
+DescriptorPool::~DescriptorPool() {
+  for (auto pool : pools_) {
+    device_->GetPtrs()->vkDestroyDescriptorPool(device_->GetVkDevice(), pool,
+                                                nullptr);
+  }
+}
+
+bool DescriptorPool::Fits(
+    uint32_t set_count,
+    const std::vector<VkDescriptorPoolSize>& sizes) const {
+  if (pools_.empty() || set_count > remaining_sets_)
+    return false;
+
+  for (const auto& size : sizes) {
+    auto it = remaining_descriptors_.find(size.type);
+    if (it == remaining_descriptors_.end() ||
+        size.descriptorCount > it->second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Result DescriptorPool::CreatePool(
+    uint32_t set_count,
+    const std::vector<VkDescriptorPoolSize>& sizes) {
+  max_sets_ = std::max(std::max(kInitialSetCount, max_sets_ * 2), set_count);
+
+  // Keep room for every type seen so far, not only the requested ones.
+  for (auto& entry : max_descriptors_)
+    entry.second *= 2;
+  for (const auto& size : sizes) {
+    uint32_t& count = max_descriptors_[size.type];
+    count = std::max(std::max(count, kInitialDescriptorCount),
+                     size.descriptorCount);
+  }
+
+  std::vector<VkDescriptorPoolSize> pool_sizes;
+  for (const auto& entry : max_descriptors_) {
+    pool_sizes.emplace_back();
+    pool_sizes.back().type = entry.first;
+    pool_sizes.back().descriptorCount = entry.second;
+  }
+
+  VkDescriptorPoolCreateInfo pool_info = VkDescriptorPoolCreateInfo();
+  pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  pool_info.maxSets = max_sets_;
+  pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+  pool_info.pPoolSizes = pool_sizes.data();
+
+  VkDescriptorPool pool = VK_NULL_HANDLE;
+  if (device_->GetPtrs()->vkCreateDescriptorPool(
+          device_->GetVkDevice(), &pool_info, nullptr, &pool) != VK_SUCCESS) {
+    return Result("Vulkan::Calling vkCreateDescriptorPool Fail");
+  }
+  pools_.push_back(pool);
+
+  remaining_sets_ = max_sets_;
+  remaining_descriptors_ = max_descriptors_;
+  return {};
+}
+
+Result DescriptorPool::AllocateDescriptorSets(
+    const std::vector<VkDescriptorSetLayout>& layouts,
+    const std::vector<VkDescriptorPoolSize>& sizes,
+    std::vector<VkDescriptorSet>* sets) {
+  sets->assign(layouts.size(), VK_NULL_HANDLE);
+  if (layouts.empty())
+    return {};
+
+  const auto set_count = static_cast<uint32_t>(layouts.size());
+  if (!Fits(set_count, sizes)) {
+    Result r = CreatePool(set_count, sizes);
+    if (!r.IsSuccess())
+      return r;
+  }
+
+  VkDescriptorSetAllocateInfo desc_set_info = VkDescriptorSetAllocateInfo();
+  desc_set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  desc_set_info.descriptorPool = pools_.back();
+  desc_set_info.descriptorSetCount = set_count;
+  desc_set_info.pSetLayouts = layouts.data();
+
+  if (device_->GetPtrs()->vkAllocateDescriptorSets(
+          device_->GetVkDevice(), &desc_set_info, sets->data()) != VK_SUCCESS) {
+    return Result("Vulkan::Calling vkAllocateDescriptorSets Fail");
+  }
+
+  remaining_sets_ -= set_count;
+  for (const auto& size : sizes)
+    remaining_descriptors_[size.type] -= size.descriptorCount;
+  return {};
+}
+
+}  // namespace vulkan
+}  // namespace amber
@@ -0,0 +1,63 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_VULKAN_DESCRIPTOR_POOL_H_
+#define SRC_VULKAN_DESCRIPTOR_POOL_H_
+
+#include <map>
+#include <vector>
+
+#include "amber/result.h"
+#include "amber/vulkan_header.h"
+
+namespace amber {
+namespace vulkan {
+
+class Device;
+
+/// Engine wide allocator for descriptor sets. Sets are allocated from the
+/// most recent Vulkan descriptor pool. When a request does not fit, a new
+/// pool with twice the capacity is created. Sets are never freed
+/// individually. They are released together when the pools are destroyed.
+class DescriptorPool {
+ public:
+  explicit DescriptorPool(Device* device);
+  ~DescriptorPool();
+
+  /// Allocates one descriptor set for each entry in |layouts| into |sets|.
+  /// |sizes| is the total number of descriptors of each type used by the
+  /// layouts.
+  Result AllocateDescriptorSets(
+      const std::vector<VkDescriptorSetLayout>& layouts,
+      const std::vector<VkDescriptorPoolSize>& sizes,
+      std::vector<VkDescriptorSet>* sets);
+
+ private:
+  bool Fits(uint32_t set_count,
+            const std::vector<VkDescriptorPoolSize>& sizes) const;
+  Result CreatePool(uint32_t set_count,
+                    const std::vector<VkDescriptorPoolSize>& sizes);
+
+  Device* device_ = nullptr;
+  std::vector<VkDescriptorPool> pools_;
+  uint32_t max_sets_ = 0;
+  uint32_t remaining_sets_ = 0;
+  std::map<VkDescriptorType, uint32_t> max_descriptors_;
+  std::map<VkDescriptorType, uint32_t> remaining_descriptors_;
+};
+
+}  // namespace vulkan
+}  // namespace amber
+
+#endif  // SRC_VULKAN_DESCRIPTOR_POOL_H_
@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "src/make_unique.h"
+#include "src/vulkan/call_stats.h"
 
 namespace amber {
 namespace vulkan {
@@ -408,7 +409,16 @@ Device::Device(VkInstance instance,
       queue_(queue),
       queue_family_index_(queue_family_index) {}
 
-Device::~Device() = default;
+Device::~Device() {
+  if (pipeline_cache_ != VK_NULL_HANDLE)
+    ptrs_.vkDestroyPipelineCache(device_, pipeline_cache_, nullptr);
+
+  if (call_stats_) {
+    stats_delegate_->Log("Vulkan call statistics");
+    for (const auto& line : call_stats_->GetSummary())
+      stats_delegate_->Log(line);
+  }
+}
 
 Result Device::LoadVulkanPointers(PFN_vkGetInstanceProcAddr getInstanceProcAddr,
                                   Delegate* delegate) {
@@ -418,6 +428,11 @@ Result Device::LoadVulkanPointers(PFN_vkGetInstanceProcAddr getInstanceProcAddr,
   if (delegate && delegate->LogGraphicsCalls())
     delegate->Log("Loading Vulkan Pointers");
 
+  if (delegate && delegate->LogGraphicsCallStats()) {
+    call_stats_ = MakeUnique<CallStats>();
+    stats_delegate_ = delegate;
+  }
+
 #include "vk-wrappers-1-0.inc"
 
   ptrs_.vkGetPhysicalDeviceProperties(physical_device_,
@@ -425,11 +440,25 @@ Result Device::LoadVulkanPointers(PFN_vkGetInstanceProcAddr getInstanceProcAddr,
 
   if (SupportsApiVersion(1, 1, 0)) {
 #include "vk-wrappers-1-1.inc"
+    supports_descriptor_update_templates_ = true;
   }
 
+#include "vk-wrappers-optional.inc"
+
   return {};
 }
 
+VkResult Device::WaitTimelineSemaphore(VkSemaphore semaphore,
+                                       uint64_t value,
+                                       uint64_t timeout_ns) const {
+  VkSemaphoreWaitInfo wait_info = VkSemaphoreWaitInfo();
+  wait_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+  wait_info.semaphoreCount = 1;
+  wait_info.pSemaphores = &semaphore;
+  wait_info.pValues = &value;
+  return ptrs_.vkWaitSemaphores(device_, &wait_info, timeout_ns);
+}
+
 bool Device::SupportsApiVersion(uint32_t major,
                                 uint32_t minor,
                                 uint32_t patch) {
@@ -452,6 +481,15 @@ Result Device::Initialize(
   if (!r.IsSuccess())
     return r;
 
+  // Pipelines built ahead of time leave their compiled shaders in the cache,
+  // which makes building them again when a command runs cheap.
+  VkPipelineCacheCreateInfo cache_info = VkPipelineCacheCreateInfo();
+  cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  if (ptrs_.vkCreatePipelineCache(device_, &cache_info, nullptr,
+                                  &pipeline_cache_) != VK_SUCCESS) {
+    return Result("Vulkan::Calling vkCreatePipelineCache Fail");
+  }
+
   // Check for the core features. We don't know if available_features or
   // available_features2 is provided, so check both.
   if (!AreAllRequiredFeaturesSupported(available_features, required_features) &&
@@ -475,6 +513,7 @@ Result Device::Initialize(
       subgroup_size_control_features = nullptr;
   VkPhysicalDeviceShaderSubgroupExtendedTypesFeatures*
       shader_subgroup_extended_types_ptrs = nullptr;
+  VkPhysicalDeviceTimelineSemaphoreFeatures* timeline_semaphore_ptrs = nullptr;
   void* ptr = available_features2.pNext;
   while (ptr != nullptr) {
     BaseOutStructure* s = static_cast<BaseOutStructure*>(ptr);
@@ -505,6 +544,10 @@ Result Device::Initialize(
             static_cast<VkPhysicalDeviceShaderSubgroupExtendedTypesFeatures*>(
                 ptr);
         break;
+      case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES:
+        timeline_semaphore_ptrs =
+            static_cast<VkPhysicalDeviceTimelineSemaphoreFeatures*>(ptr);
+        break;
       case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES:
         vulkan11_ptrs = static_cast<VkPhysicalDeviceVulkan11Features*>(ptr);
         break;
@@ -713,6 +756,16 @@ Result Device::Initialize(
 
   ptrs_.vkGetPhysicalDeviceMemoryProperties(physical_device_,
                                             &physical_memory_properties_);
+  CacheFormatProperties();
+
+  // Timeline semaphores are optional. They are only used when the embedder
+  // enabled the feature and the wait entry point could be loaded.
+  const bool timeline_semaphore_enabled =
+      (timeline_semaphore_ptrs &&
+       timeline_semaphore_ptrs->timelineSemaphore == VK_TRUE) ||
+      (vulkan12_ptrs && vulkan12_ptrs->timelineSemaphore == VK_TRUE);
+  supports_timeline_semaphores_ =
+      timeline_semaphore_enabled && ptrs_.vkWaitSemaphores != nullptr;
 
   subgroup_size_control_properties_ = {};
   const bool needs_subgroup_size_control =
@@ -871,12 +924,24 @@ Result Device::Initialize(
   return {};
 }
 
+void Device::CacheFormatProperties() {
+  format_properties_.assign(kFormatTypeCount, VkFormatProperties());
+
+  // FormatType::kUnknown maps to VK_FORMAT_UNDEFINED and keeps empty
+  // properties.
+  for (uint32_t i = 1; i < kFormatTypeCount; ++i) {
+    VkFormat vk_format = GetVkFormat(static_cast<FormatType>(i));
+    ptrs_.vkGetPhysicalDeviceFormatProperties(physical_device_, vk_format,
+                                              &format_properties_[i]);
+  }
+}
+
 bool Device::IsFormatSupportedByPhysicalDevice(const Format& format,
-                                               BufferType type) {
-  VkFormat vk_format = GetVkFormat(format);
-  VkFormatProperties properties = VkFormatProperties();
-  GetPtrs()->vkGetPhysicalDeviceFormatProperties(physical_device_, vk_format,
-                                                 &properties);
+                                               BufferType type) const {
+  const auto idx = static_cast<size_t>(format.GetFormatType());
+  if (idx >= format_properties_.size())
+    return false;
+  const VkFormatProperties& properties = format_properties_[idx];
 
   VkFormatFeatureFlagBits flag = VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT;
   bool is_buffer_type_image = false;
@@ -916,6 +981,45 @@ bool Device::HasMemoryFlags(uint32_t memory_type_index,
           flags) == flags;
 }
 
+void Device::SetTransferQueue(VkQueue queue, uint32_t queue_family_index) {
+  if (queue_family_index == queue_family_index_)
+    return;
+
+  transfer_queue_ = queue;
+  transfer_queue_family_index_ = queue_family_index;
+}
+
+void Device::SetEnabledExtensions(const std::vector<std::string>& extensions) {
+  max_push_descriptors_ = 0;
+
+  // The properties of the extension are queried through
+  // vkGetPhysicalDeviceProperties2, which is only loaded for Vulkan 1.1.
+  if (!supports_descriptor_update_templates_ ||
+      ptrs_.vkCmdPushDescriptorSetKHR == nullptr ||
+      std::find(extensions.begin(), extensions.end(),
+                "VK_KHR_push_descriptor") == extensions.end()) {
+    return;
+  }
+
+  VkPhysicalDevicePushDescriptorPropertiesKHR push_properties = {};
+  push_properties.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PUSH_DESCRIPTOR_PROPERTIES_KHR;
+  VkPhysicalDeviceProperties2 properties2 = {};
+  properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+  properties2.pNext = &push_properties;
+  ptrs_.vkGetPhysicalDeviceProperties2(physical_device_, &properties2);
+
+  max_push_descriptors_ = push_properties.maxPushDescriptors;
+}
+
+bool Device::HasMemoryTypeWithFlags(const VkMemoryPropertyFlags flags) const {
+  for (uint32_t i = 0; i < physical_memory_properties_.memoryTypeCount; ++i) {
+    if (HasMemoryFlags(i, flags))
+      return true;
+  }
+  return false;
+}
+
 bool Device::IsMemoryHostAccessible(uint32_t memory_type_index) const {
   return HasMemoryFlags(memory_type_index, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
 }
@@ -930,14 +1034,17 @@ uint32_t Device::GetMaxPushConstants() const {
 }
 
 bool Device::IsDescriptorSetInBounds(uint32_t descriptor_set) const {
-  VkPhysicalDeviceProperties properties = VkPhysicalDeviceProperties();
-  GetPtrs()->vkGetPhysicalDeviceProperties(physical_device_, &properties);
-  return properties.limits.maxBoundDescriptorSets > descriptor_set;
+  return physical_device_properties_.limits.maxBoundDescriptorSets >
+         descriptor_set;
 }
 
 VkFormat Device::GetVkFormat(const Format& format) const {
+  return GetVkFormat(format.GetFormatType());
+}
+
+VkFormat Device::GetVkFormat(FormatType format_type) const {
   VkFormat ret = VK_FORMAT_UNDEFINED;
-  switch (format.GetFormatType()) {
+  switch (format_type) {
     case FormatType::kUnknown:
       ret = VK_FORMAT_UNDEFINED;
       break;
@@ -29,9 +29,12 @@
 namespace amber {
 namespace vulkan {
 
+class CallStats;
+
 struct VulkanPtrs {
 #include "vk-wrappers-1-0.h"  // NOLINT(build/include_subdir)
 #include "vk-wrappers-1-1.h"  // NOLINT(build/include_subdir)
+#include "vk-wrappers-optional.h"  // NOLINT(build/include_subdir)
 };
 
 /// Wrapper around a Vulkan Device object.
@@ -53,16 +56,48 @@ class Device {
                     const std::vector<std::string>& available_extensions);
 
   /// Returns true if |format| and the |buffer|s buffer type combination is
-  /// supported by the physical device.
-  bool IsFormatSupportedByPhysicalDevice(const Format& format, BufferType type);
+  /// supported by the physical device. The format properties are queried
+  /// once in Initialize, so this does not call into Vulkan.
+  bool IsFormatSupportedByPhysicalDevice(const Format& format,
+                                         BufferType type) const;
 
   VkDevice GetVkDevice() const { return device_; }
   VkQueue GetVkQueue() const { return queue_; }
+  /// Returns the cache shared by every pipeline created on the device.
+  VkPipelineCache GetVkPipelineCache() const { return pipeline_cache_; }
   VkFormat GetVkFormat(const Format& format) const;
+  VkFormat GetVkFormat(FormatType format_type) const;
 
   uint32_t GetQueueFamilyIndex() const { return queue_family_index_; }
+
+  /// Sets the optional |queue| of |queue_family_index| used for transfers
+  /// only. It is ignored if it belongs to the family of the main queue.
+  void SetTransferQueue(VkQueue queue, uint32_t queue_family_index);
+  /// Returns true if a transfer queue was set and timeline semaphores, which
+  /// order its submissions with the main queue, were enabled.
+  bool HasTransferQueue() const {
+    return transfer_queue_ != VK_NULL_HANDLE && SupportsTimelineSemaphores();
+  }
+  VkQueue GetTransferQueue() const { return transfer_queue_; }
+  uint32_t GetTransferQueueFamilyIndex() const {
+    return transfer_queue_family_index_;
+  }
   uint32_t GetMaxPushConstants() const;
 
+  /// Tells the device which optional |extensions| the embedder enabled.
+  /// Extensions amber can use, but does not require, are only used if they
+  /// are listed here.
+  void SetEnabledExtensions(const std::vector<std::string>& extensions);
+  /// Returns true if descriptor sets can be written with update templates.
+  bool SupportsDescriptorUpdateTemplates() const {
+    return supports_descriptor_update_templates_;
+  }
+  /// Returns true if VK_KHR_push_descriptor was enabled on the device.
+  bool SupportsPushDescriptors() const { return max_push_descriptors_ > 0; }
+  /// Returns the number of descriptors a push descriptor set can hold, or 0
+  /// if push descriptors are not supported.
+  uint32_t GetMaxPushDescriptors() const { return max_push_descriptors_; }
+
   /// Returns true if the given |descriptor_set| is within the bounds of
   /// this device.
   bool IsDescriptorSetInBounds(uint32_t descriptor_set) const;
@@ -70,11 +105,23 @@ class Device {
   /// Returns true if the memory at |memory_type_index| has |flags| set.
   virtual bool HasMemoryFlags(uint32_t memory_type_index,
                               const VkMemoryPropertyFlags flags) const;
+  /// Returns true if any memory type of the device has |flags| set.
+  bool HasMemoryTypeWithFlags(const VkMemoryPropertyFlags flags) const;
   /// Returns true if the memory at |memory_type_index| is host accessible.
   bool IsMemoryHostAccessible(uint32_t memory_type_index) const;
   /// Returns true if the memory at |memory_type_index| is host coherent.
   bool IsMemoryHostCoherent(uint32_t memory_type_index) const;
 
+  /// Returns true if timeline semaphores were enabled on the device.
+  bool SupportsTimelineSemaphores() const {
+    return supports_timeline_semaphores_;
+  }
+  /// Waits until the counter of the timeline |semaphore| reaches |value|.
+  /// Must only be called if `SupportsTimelineSemaphores` returns true.
+  VkResult WaitTimelineSemaphore(VkSemaphore semaphore,
+                                 uint64_t value,
+                                 uint64_t timeout_ns) const;
+
   /// Returns the pointers to the Vulkan API methods.
   virtual const VulkanPtrs* GetPtrs() const { return &ptrs_; }
 
@@ -92,18 +139,31 @@ class Device {
  private:
   Result LoadVulkanPointers(PFN_vkGetInstanceProcAddr, Delegate* delegate);
   bool SupportsApiVersion(uint32_t major, uint32_t minor, uint32_t patch);
+  void CacheFormatProperties();
 
   VkInstance instance_ = VK_NULL_HANDLE;
   VkPhysicalDevice physical_device_ = VK_NULL_HANDLE;
   VkPhysicalDeviceProperties physical_device_properties_;
   VkPhysicalDeviceMemoryProperties physical_memory_properties_;
+  /// Properties of every FormatType, indexed by its value.
+  std::vector<VkFormatProperties> format_properties_;
   VkPhysicalDeviceSubgroupSizeControlPropertiesEXT
       subgroup_size_control_properties_;
   VkDevice device_ = VK_NULL_HANDLE;
   VkQueue queue_ = VK_NULL_HANDLE;
   uint32_t queue_family_index_ = 0;
+  VkPipelineCache pipeline_cache_ = VK_NULL_HANDLE;
+  VkQueue transfer_queue_ = VK_NULL_HANDLE;
+  uint32_t transfer_queue_family_index_ = 0;
+  bool supports_descriptor_update_templates_ = false;
+  bool supports_timeline_semaphores_ = false;
+  uint32_t max_push_descriptors_ = 0;
 
   VulkanPtrs ptrs_;
+  /// Counters of the Vulkan calls, only created if the delegate asks for
+  /// call statistics. |stats_delegate_| receives their summary.
+  std::unique_ptr<CallStats> call_stats_;
+  Delegate* stats_delegate_ = nullptr;
 };
 
 }  // namespace vulkan
@@ -0,0 +1,329 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/vulkan/device_verifier.h"
+
+#include <cstring>
+
+#include "src/make_unique.h"
+#include "src/vulkan/command_buffer.h"
+#include "src/vulkan/command_pool.h"
+#include "src/vulkan/descriptor_pool.h"
+#include "src/vulkan/device.h"
+#include "src/vulkan/transfer_buffer.h"
+
+namespace amber {
+namespace vulkan {
+
+DeviceVerifier::DeviceVerifier(Device* device, uint32_t fence_timeout_ms)
+    : device_(device), fence_timeout_ms_(fence_timeout_ms) {}
+
+DeviceVerifier::~DeviceVerifier() {
+  DestroyKernel(&probe_kernel_);
+  DestroyKernel(&compare_kernel_);
+}
+
+void DeviceVerifier::DestroyKernel(Kernel* kernel) {
+  auto vk_device = device_->GetVkDevice();
+  for (const auto& entry : kernel->pipelines) {
+    device_->GetPtrs()->vkDestroyPipeline(vk_device, entry.second.pipeline,
+                                          nullptr);
+    device_->GetPtrs()->vkDestroyShaderModule(vk_device, entry.second.shader,
+                                              nullptr);
+  }
+  if (kernel->pipeline_layout != VK_NULL_HANDLE) {
+    device_->GetPtrs()->vkDestroyPipelineLayout(
+        vk_device, kernel->pipeline_layout, nullptr);
+  }
+  if (kernel->descriptor_set_layout != VK_NULL_HANDLE) {
+    device_->GetPtrs()->vkDestroyDescriptorSetLayout(
+        vk_device, kernel->descriptor_set_layout, nullptr);
+  }
+}
+
+Result DeviceVerifier::Initialize(CommandPool* pool,
+                                  DescriptorPool* descriptor_pool) {
+  command_ = MakeUnique<CommandBuffer>(device_, pool, fence_timeout_ms_);
+  Result r = command_->Initialize();
+  if (!r.IsSuccess())
+    return r;
+
+  r = InitializeKernel(descriptor_pool, 1,
+                       static_cast<uint32_t>(sizeof(ProbeShaderParams)),
+                       static_cast<uint32_t>(sizeof(ProbeShaderResult)),
+                       &probe_kernel_);
+  if (!r.IsSuccess())
+    return r;
+
+  return InitializeKernel(descriptor_pool, 2,
+                          static_cast<uint32_t>(sizeof(CompareShaderParams)),
+                          static_cast<uint32_t>(sizeof(CompareShaderResult)),
+                          &compare_kernel_);
+}
+
+Result DeviceVerifier::InitializeKernel(DescriptorPool* descriptor_pool,
+                                        uint32_t buffer_count,
+                                        uint32_t push_constant_size,
+                                        uint32_t result_size,
+                                        Kernel* kernel) {
+  kernel->buffer_count = buffer_count;
+  kernel->push_constant_size = push_constant_size;
+
+  kernel->result_buffer =
+      MakeUnique<TransferBuffer>(device_, result_size, nullptr);
+  Result r =
+      kernel->result_buffer->AddUsageFlags(VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+  if (!r.IsSuccess())
+    return r;
+  r = kernel->result_buffer->Initialize();
+  if (!r.IsSuccess())
+    return r;
+
+  const uint32_t binding_count = buffer_count + 1;
+  std::vector<VkDescriptorSetLayoutBinding> bindings(binding_count);
+  for (uint32_t i = 0; i < binding_count; ++i) {
+    bindings[i] = VkDescriptorSetLayoutBinding();
+    bindings[i].binding = i;
+    bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    bindings[i].descriptorCount = 1;
+    bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+  }
+
+  VkDescriptorSetLayoutCreateInfo layout_info =
+      VkDescriptorSetLayoutCreateInfo();
+  layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  layout_info.bindingCount = binding_count;
+  layout_info.pBindings = bindings.data();
+
+  if (device_->GetPtrs()->vkCreateDescriptorSetLayout(
+          device_->GetVkDevice(), &layout_info, nullptr,
+          &kernel->descriptor_set_layout) != VK_SUCCESS) {
+    return Result("Vulkan::Calling vkCreateDescriptorSetLayout Fail");
+  }
+
+  VkPushConstantRange push_constant_range = VkPushConstantRange();
+  push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+  push_constant_range.offset = 0;
+  push_constant_range.size = push_constant_size;
+
+  VkPipelineLayoutCreateInfo pipeline_layout_info =
+      VkPipelineLayoutCreateInfo();
+  pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+  pipeline_layout_info.setLayoutCount = 1;
+  pipeline_layout_info.pSetLayouts = &kernel->descriptor_set_layout;
+  pipeline_layout_info.pushConstantRangeCount = 1;
+  pipeline_layout_info.pPushConstantRanges = &push_constant_range;
+
+  if (device_->GetPtrs()->vkCreatePipelineLayout(
+          device_->GetVkDevice(), &pipeline_layout_info, nullptr,
+          &kernel->pipeline_layout) != VK_SUCCESS) {
+    return Result("Vulkan::Calling vkCreatePipelineLayout Fail");
+  }
+
+  VkDescriptorPoolSize size = VkDescriptorPoolSize();
+  size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+  size.descriptorCount = binding_count;
+
+  std::vector<VkDescriptorSet> sets;
+  r = descriptor_pool->AllocateDescriptorSets({kernel->descriptor_set_layout},
+                                              {size}, &sets);
+  if (!r.IsSuccess())
+    return r;
+
+  kernel->descriptor_set = sets[0];
+  return {};
+}
+
+Result DeviceVerifier::GetVkPipeline(const std::vector<uint32_t>& spirv,
+                                     Kernel* kernel,
+                                     VkPipeline* pipeline) {
+  auto it = kernel->pipelines.find(spirv);
+  if (it != kernel->pipelines.end()) {
+    *pipeline = it->second.pipeline;
+    return {};
+  }
+
+  ShaderPipeline entry;
+
+  VkShaderModuleCreateInfo shader_info = VkShaderModuleCreateInfo();
+  shader_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+  shader_info.codeSize = spirv.size() * sizeof(uint32_t);
+  shader_info.pCode = spirv.data();
+
+  if (device_->GetPtrs()->vkCreateShaderModule(device_->GetVkDevice(),
+                                               &shader_info, nullptr,
+                                               &entry.shader) != VK_SUCCESS) {
+    return Result("Vulkan::Calling vkCreateShaderModule Fail");
+  }
+
+  VkComputePipelineCreateInfo pipeline_info = VkComputePipelineCreateInfo();
+  pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+  pipeline_info.stage.sType =
+      VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+  pipeline_info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+  pipeline_info.stage.module = entry.shader;
+  pipeline_info.stage.pName = "main";
+  pipeline_info.layout = kernel->pipeline_layout;
+
+  if (device_->GetPtrs()->vkCreateComputePipelines(
+          device_->GetVkDevice(), VK_NULL_HANDLE, 1, &pipeline_info, nullptr,
+          &entry.pipeline) != VK_SUCCESS) {
+    device_->GetPtrs()->vkDestroyShaderModule(device_->GetVkDevice(),
+                                              entry.shader, nullptr);
+    return Result("Vulkan::Calling vkCreateComputePipelines Fail");
+  }
+
+  kernel->pipelines[spirv] = entry;
+  *pipeline = entry.pipeline;
+  return {};
+}
+
+Result DeviceVerifier::Run(const std::vector<uint32_t>& spirv,
+                           Kernel* kernel,
+                           const void* push_constants,
+                           const std::vector<VkDescriptorBufferInfo>& buffers,
+                           uint32_t group_count_x,
+                           uint32_t group_count_y,
+                           const void* initial_result,
+                           void* result) {
+  VkPipeline pipeline = VK_NULL_HANDLE;
+  Result r = GetVkPipeline(spirv, kernel, &pipeline);
+  if (!r.IsSuccess())
+    return r;
+
+  // No submission using the descriptor set is in flight here, as every run
+  // waits for its own submission.
+  std::vector<VkDescriptorBufferInfo> buffer_infos = buffers;
+  buffer_infos.emplace_back();
+  buffer_infos.back().buffer = kernel->result_buffer->GetVkBuffer();
+  buffer_infos.back().offset = 0;
+  buffer_infos.back().range = VK_WHOLE_SIZE;
+
+  std::vector<VkWriteDescriptorSet> writes(buffer_infos.size());
+  for (size_t i = 0; i < writes.size(); ++i) {
+    writes[i] = VkWriteDescriptorSet();
+    writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writes[i].dstSet = kernel->descriptor_set;
+    writes[i].dstBinding = static_cast<uint32_t>(i);
+    writes[i].descriptorCount = 1;
+    writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    writes[i].pBufferInfo = &buffer_infos[i];
+  }
+  device_->GetPtrs()->vkUpdateDescriptorSets(
+      device_->GetVkDevice(), static_cast<uint32_t>(writes.size()),
+      writes.data(), 0, nullptr);
+
+  const size_t result_size =
+      static_cast<size_t>(kernel->result_buffer->GetSizeInBytes());
+  std::memcpy(kernel->result_buffer->HostAccessibleMemoryPtr(),
+              initial_result, result_size);
+
+  {
+    CommandBufferGuard guard(command_.get());
+    if (!guard.IsRecording())
+      return guard.GetResult();
+
+    VkCommandBuffer cmd = command_->GetVkCommandBuffer();
+
+    // Make the host writes to the inputs and the result, and the readback
+    // copies of attachments probed in place, visible.
+    VkMemoryBarrier host_barrier = VkMemoryBarrier();
+    host_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    host_barrier.srcAccessMask =
+        VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    host_barrier.dstAccessMask =
+        VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    device_->GetPtrs()->vkCmdPipelineBarrier(
+        cmd, VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &host_barrier, 0, nullptr,
+        0, nullptr);
+
+    device_->GetPtrs()->vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+                                          pipeline);
+    device_->GetPtrs()->vkCmdBindDescriptorSets(
+        cmd, VK_PIPELINE_BIND_POINT_COMPUTE, kernel->pipeline_layout, 0, 1,
+        &kernel->descriptor_set, 0, nullptr);
+    device_->GetPtrs()->vkCmdPushConstants(
+        cmd, kernel->pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+        kernel->push_constant_size, push_constants);
+    device_->GetPtrs()->vkCmdDispatch(cmd, group_count_x, group_count_y, 1);
+
+    VkMemoryBarrier result_barrier = VkMemoryBarrier();
+    result_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    result_barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    result_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    device_->GetPtrs()->vkCmdPipelineBarrier(
+        cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+        0, 1, &result_barrier, 0, nullptr, 0, nullptr);
+
+    r = guard.Submit(fence_timeout_ms_);
+    if (!r.IsSuccess())
+      return r;
+  }
+
+  std::memcpy(result, kernel->result_buffer->HostAccessibleMemoryPtr(),
+              result_size);
+  return {};
+}
+
+Result DeviceVerifier::Probe(const std::vector<uint32_t>& spirv,
+                             const ProbeShaderParams& params,
+                             VkBuffer texels,
+                             uint64_t size_in_bytes,
+                             ProbeShaderResult* result) {
+  std::vector<VkDescriptorBufferInfo> buffers(1);
+  buffers[0].buffer = texels;
+  buffers[0].offset = 0;
+  buffers[0].range = size_in_bytes;
+
+  ProbeShaderResult initial = ProbeShaderResult();
+  initial.mismatch_count = 0;
+  initial.uncertain_count = 0;
+  initial.first_mismatch = 0xffffffff;
+
+  uint32_t group_count_x = 1;
+  uint32_t group_count_y = 1;
+  GetProbeShaderGroupCount(params, &group_count_x, &group_count_y);
+
+  return Run(spirv, &probe_kernel_, &params, buffers, group_count_x,
+             group_count_y, &initial, result);
+}
+
+Result DeviceVerifier::Compare(const std::vector<uint32_t>& spirv,
+                               const CompareShaderParams& params,
+                               VkBuffer buffer1,
+                               VkBuffer buffer2,
+                               CompareShaderResult* result) {
+  std::vector<VkDescriptorBufferInfo> buffers(2);
+  buffers[0].buffer = buffer1;
+  buffers[1].buffer = buffer2;
+  for (auto& info : buffers) {
+    info.offset = 0;
+    info.range = params.byte_count;
+  }
+
+  auto initial = MakeUnique<CompareShaderResult>();
+  std::memset(initial.get(), 0, sizeof(CompareShaderResult));
+  initial->first_different_index = 0xffffffff;
+
+  uint32_t group_count_x = 1;
+  uint32_t group_count_y = 1;
+  GetCompareShaderGroupCount(params, &group_count_x, &group_count_y);
+
+  return Run(spirv, &compare_kernel_, &params, buffers, group_count_x,
+             group_count_y, initial.get(), result);
+}
+
+}  // namespace vulkan
+}  // namespace amber
@@ -0,0 +1,114 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_VULKAN_DEVICE_VERIFIER_H_
+#define SRC_VULKAN_DEVICE_VERIFIER_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "amber/result.h"
+#include "amber/vulkan_header.h"
+#include "src/compare_shader.h"
+#include "src/probe_shader.h"
+
+namespace amber {
+namespace vulkan {
+
+class CommandBuffer;
+class CommandPool;
+class DescriptorPool;
+class Device;
+class TransferBuffer;
+
+/// Runs the probe shaders generated by GenerateProbeShader and the compare
+/// shader generated by GenerateCompareShader. Each kind of shader has its
+/// own descriptor set layout, pipeline layout, descriptor set and result
+/// buffer, shared by all runs. The compute pipelines are cached per shader
+/// binary.
+class DeviceVerifier {
+ public:
+  DeviceVerifier(Device* device, uint32_t fence_timeout_ms);
+  ~DeviceVerifier();
+
+  Result Initialize(CommandPool* pool, DescriptorPool* descriptor_pool);
+
+  /// Runs |spirv| with |params| over the first |size_in_bytes| bytes of
+  /// |texels| and waits for the result to be written to |result|.
+  Result Probe(const std::vector<uint32_t>& spirv,
+               const ProbeShaderParams& params,
+               VkBuffer texels,
+               uint64_t size_in_bytes,
+               ProbeShaderResult* result);
+
+  /// Runs |spirv| with |params| over |buffer1| and |buffer2|, which hold at
+  /// least |params.byte_count| bytes, and waits for the result to be written
+  /// to |result|.
+  Result Compare(const std::vector<uint32_t>& spirv,
+                 const CompareShaderParams& params,
+                 VkBuffer buffer1,
+                 VkBuffer buffer2,
+                 CompareShaderResult* result);
+
+ private:
+  struct ShaderPipeline {
+    VkShaderModule shader = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+  };
+
+  /// Objects shared by all runs of one kind of shader. The last storage
+  /// buffer binding of the descriptor set holds the result.
+  struct Kernel {
+    uint32_t buffer_count = 0;
+    uint32_t push_constant_size = 0;
+    VkDescriptorSetLayout descriptor_set_layout = VK_NULL_HANDLE;
+    VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
+    VkDescriptorSet descriptor_set = VK_NULL_HANDLE;
+    std::unique_ptr<TransferBuffer> result_buffer;
+    std::map<std::vector<uint32_t>, ShaderPipeline> pipelines;
+  };
+
+  Result InitializeKernel(DescriptorPool* descriptor_pool,
+                          uint32_t buffer_count,
+                          uint32_t push_constant_size,
+                          uint32_t result_size,
+                          Kernel* kernel);
+  void DestroyKernel(Kernel* kernel);
+  Result GetVkPipeline(const std::vector<uint32_t>& spirv,
+                       Kernel* kernel,
+                       VkPipeline* pipeline);
+  /// Binds |buffers| followed by the result buffer of |kernel|, copies
+  /// |initial_result| to the result buffer, dispatches |spirv| and copies
+  /// the result back to |result| once the device is done.
+  Result Run(const std::vector<uint32_t>& spirv,
+             Kernel* kernel,
+             const void* push_constants,
+             const std::vector<VkDescriptorBufferInfo>& buffers,
+             uint32_t group_count_x,
+             uint32_t group_count_y,
+             const void* initial_result,
+             void* result);
+
+  Device* device_ = nullptr;
+  uint32_t fence_timeout_ms_ = 0;
+  std::unique_ptr<CommandBuffer> command_;
+  Kernel probe_kernel_;
+  Kernel compare_kernel_;
+};
+
+}  // namespace vulkan
+}  // namespace amber
+
+#endif  // SRC_VULKAN_DEVICE_VERIFIER_H_
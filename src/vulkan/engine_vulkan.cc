@@ -15,14 +15,21 @@
 #include "src/vulkan/engine_vulkan.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <limits>
 #include <set>
+#include <thread>
 #include <utility>
 
 #include "amber/amber_vulkan.h"
 #include "src/make_unique.h"
 #include "src/type_parser.h"
 #include "src/vulkan/compute_pipeline.h"
+#include "src/vulkan/frame_buffer.h"
 #include "src/vulkan/graphics_pipeline.h"
+#include "src/vulkan/transfer_image.h"
 
 namespace amber {
 namespace vulkan {
@@ -30,6 +37,8 @@ namespace {
 
 const uint32_t kTrianglesPerCell = 2;
 const uint32_t kVerticesPerTriangle = 3;
+// Number of DRAW_RECT and DRAW_GRID vertex buffers kept for reuse.
+const size_t kMaxRectGeometries = 8;
 
 Result ToVkShaderStage(ShaderType type, VkShaderStageFlagBits* ret) {
   switch (type) {
@@ -113,6 +122,7 @@ Result EngineVulkan::Initialize(
     return Result("Vulkan::Initialize not all instance extensions supported");
   }
 
+  delegate_ = delegate;
   device_ = MakeUnique<Device>(vk_config->instance, vk_config->physical_device,
                                vk_config->queue_family_index, vk_config->device,
                                vk_config->queue);
@@ -124,6 +134,12 @@ Result EngineVulkan::Initialize(
   if (!r.IsSuccess())
     return r;
 
+  if (vk_config->transfer_queue != VK_NULL_HANDLE) {
+    device_->SetTransferQueue(vk_config->transfer_queue,
+                              vk_config->transfer_queue_family_index);
+  }
+  device_->SetEnabledExtensions(vk_config->enabled_device_extensions);
+
   if (!pool_) {
     pool_ = MakeUnique<CommandPool>(device_.get());
     r = pool_->Initialize();
@@ -131,6 +147,33 @@ Result EngineVulkan::Initialize(
       return r;
   }
 
+  if (!transfer_pool_ && device_->HasTransferQueue()) {
+    transfer_pool_ = MakeUnique<CommandPool>(
+        device_.get(), device_->GetTransferQueueFamilyIndex(),
+        device_->GetTransferQueue());
+    r = transfer_pool_->Initialize();
+    if (!r.IsSuccess())
+      return r;
+  }
+
+  if (!descriptor_pool_)
+    descriptor_pool_ = MakeUnique<DescriptorPool>(device_.get());
+  if (!sampler_cache_)
+    sampler_cache_ = MakeUnique<SamplerCache>(device_.get());
+
+  return {};
+}
+
+bool EngineVulkan::IsFormatSupported(const Format& format,
+                                     BufferType type) const {
+  return device_->IsFormatSupportedByPhysicalDevice(format, type);
+}
+
+Result EngineVulkan::CheckFormatsSupported(
+    const std::vector<std::unique_ptr<amber::Pipeline>>& pipelines) const {
+  Result r = Engine::CheckFormatsSupported(pipelines);
+  if (!r.IsSuccess())
+    return Result("Vulkan " + r.Error());
   return {};
 }
 
@@ -171,7 +214,8 @@ Result EngineVulkan::CreatePipeline(amber::Pipeline* pipeline) {
   if (pipeline->GetType() == PipelineType::kCompute) {
     vk_pipeline = MakeUnique<ComputePipeline>(
         device_.get(), engine_data.fence_timeout_ms, stage_create_info);
-    r = vk_pipeline->AsCompute()->Initialize(pool_.get());
+    r = vk_pipeline->AsCompute()->Initialize(
+        pool_.get(), descriptor_pool_.get(), sampler_cache_.get());
     if (!r.IsSuccess())
       return r;
   } else {
@@ -185,11 +229,24 @@ Result EngineVulkan::CreatePipeline(amber::Pipeline* pipeline) {
 
     r = vk_pipeline->AsGraphics()->Initialize(pipeline->GetFramebufferWidth(),
                                               pipeline->GetFramebufferHeight(),
-                                              pool_.get());
+                                              pool_.get(),
+                                              descriptor_pool_.get(),
+                                              sampler_cache_.get());
     if (!r.IsSuccess())
       return r;
   }
 
+  vk_pipeline->SetMemoryPlacement(engine_data.memory_placement);
+  LogMemoryPlacementOnce(engine_data.memory_placement);
+
+  // Only device local descriptor buffers are copied through staging buffers,
+  // which is what the transfer queue is used for.
+  if (transfer_pool_ &&
+      engine_data.memory_placement == MemoryPlacement::kDeviceLocal) {
+    r = vk_pipeline->InitializeTransferCommandBuffer(transfer_pool_.get());
+    if (!r.IsSuccess())
+      return r;
+  }
   info.vk_pipeline = std::move(vk_pipeline);
 
   // Set the entry point names for the pipeline.
@@ -263,10 +320,13 @@ Result EngineVulkan::CreatePipeline(amber::Pipeline* pipeline) {
     cmd->SetSampler(buf_info.sampler);
 
     if (cmd->GetValues().empty()) {
-      cmd->GetBuffer()->SetSizeInElements(cmd->GetBuffer()->ElementCount());
+      r = cmd->GetBuffer()->SetSizeInElements(cmd->GetBuffer()->ElementCount());
     } else {
-      cmd->GetBuffer()->SetDataWithOffset(cmd->GetValues(), cmd->GetOffset());
+      r = cmd->GetBuffer()->SetDataWithOffset(cmd->GetValues(),
+                                              cmd->GetOffset());
     }
+    if (!r.IsSuccess())
+      return r;
 
     r = info.vk_pipeline->AddBufferDescriptor(cmd.get());
     if (!r.IsSuccess())
@@ -287,6 +347,97 @@ Result EngineVulkan::CreatePipeline(amber::Pipeline* pipeline) {
   return {};
 }
 
+Result EngineVulkan::PrecompilePipelines(
+    const std::vector<const Command*>& cmds) {
+  // The builds are gathered here and each only changes its own pipeline, so
+  // they can run on any thread. Compute pipelines keep what they build for
+  // their first dispatch. Graphics pipelines depend on the draw, so they
+  // only leave the compiled shaders in the pipeline cache.
+  std::vector<std::function<Result()>> warm_ups;
+  for (const auto* cmd : cmds) {
+    auto it = pipeline_map_.find(
+        static_cast<const PipelineCommand*>(cmd)->GetPipeline());
+    if (it == pipeline_map_.end() || !it->second.vk_pipeline)
+      continue;
+
+    auto* vk_pipeline = it->second.vk_pipeline.get();
+    if (cmd->IsCompute()) {
+      if (vk_pipeline->IsGraphics())
+        continue;
+
+      auto* compute = vk_pipeline->AsCompute();
+      warm_ups.push_back(
+          [compute]() { return compute->CreateVkComputePipelineIfNeeded(); });
+      continue;
+    }
+    if (!vk_pipeline->IsGraphics())
+      continue;
+
+    const PipelineData* data = nullptr;
+    Topology topology = Topology::kUnknown;
+    const VertexBuffer* vertex_buffer = nullptr;
+    if (cmd->IsDrawArrays()) {
+      const auto* draw = static_cast<const DrawArraysCommand*>(cmd);
+      data = draw->GetPipelineData();
+      topology = draw->GetTopology();
+      vertex_buffer = it->second.vertex_buffer.get();
+    } else if (cmd->IsDrawRect() || cmd->IsDrawGrid()) {
+      if (!rect_vertex_input_) {
+        Format* format = GetRectVertexFormat();
+        rect_vertex_input_ = MakeUnique<VertexBuffer>(device_.get());
+        rect_vertex_input_->SetData(0, nullptr, InputRate::kVertex, format, 0,
+                                    format->SizeInBytes());
+      }
+      vertex_buffer = rect_vertex_input_.get();
+      if (cmd->IsDrawRect()) {
+        const auto* draw = static_cast<const DrawRectCommand*>(cmd);
+        data = draw->GetPipelineData();
+        topology =
+            draw->IsPatch() ? Topology::kPatchList : Topology::kTriangleStrip;
+      } else {
+        data = static_cast<const DrawGridCommand*>(cmd)->GetPipelineData();
+        topology = Topology::kTriangleList;
+      }
+    } else {
+      continue;
+    }
+
+    auto* graphics = vk_pipeline->AsGraphics();
+    warm_ups.push_back([graphics, data, topology, vertex_buffer]() {
+      return graphics->WarmPipelineCache(data, topology, vertex_buffer);
+    });
+  }
+  if (warm_ups.empty())
+    return {};
+
+  // Logged Vulkan calls go through the delegate, which is not thread safe.
+  size_t thread_count = std::max(1U, std::thread::hardware_concurrency());
+  if (delegate_ && delegate_->LogGraphicsCalls())
+    thread_count = 1;
+  thread_count = std::min(thread_count, warm_ups.size());
+
+  std::vector<Result> results(warm_ups.size());
+  std::atomic<size_t> next(0);
+  auto run = [&warm_ups, &results, &next]() {
+    for (size_t i = next++; i < warm_ups.size(); i = next++)
+      results[i] = warm_ups[i]();
+  };
+
+  // The calling thread warms up pipelines as well.
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; ++i)
+    threads.emplace_back(run);
+  run();
+  for (auto& thread : threads)
+    thread.join();
+
+  for (const auto& r : results) {
+    if (!r.IsSuccess())
+      return r;
+  }
+  return {};
+}
+
 Result EngineVulkan::SetShader(amber::Pipeline* pipeline,
                                const amber::Pipeline::ShaderInfo& shader) {
   const auto type = shader.GetShaderType();
@@ -482,35 +633,19 @@ Result EngineVulkan::DoDrawRect(const DrawRectCommand* command) {
     height = (height / frame_height) * 2.0f;
   }
 
-  std::vector<Value> values(8);
-  // Bottom left
-  values[0].SetDoubleValue(static_cast<double>(x));
-  values[1].SetDoubleValue(static_cast<double>(y + height));
-  // Top left
-  values[2].SetDoubleValue(static_cast<double>(x));
-  values[3].SetDoubleValue(static_cast<double>(y));
-  // Bottom right
-  values[4].SetDoubleValue(static_cast<double>(x + width));
-  values[5].SetDoubleValue(static_cast<double>(y + height));
-  // Top right
-  values[6].SetDoubleValue(static_cast<double>(x + width));
-  values[7].SetDoubleValue(static_cast<double>(y));
-
-  // |format| is not Format for frame buffer but for vertex buffer.
-  // Since draw rect command contains its vertex information and it
-  // does not include a format of vertex buffer, we can choose any
-  // one that is suitable. We use VK_FORMAT_R32G32_SFLOAT for it.
-  TypeParser parser;
-  auto type = parser.Parse("R32G32_SFLOAT");
-  Format fmt(type.get());
-
-  auto buf = MakeUnique<Buffer>();
-  buf->SetFormat(&fmt);
-  buf->SetData(std::move(values));
-
-  auto vertex_buffer = MakeUnique<VertexBuffer>(device_.get());
-  vertex_buffer->SetData(0, buf.get(), InputRate::kVertex, buf->GetFormat(), 0,
-                         buf->GetFormat()->SizeInBytes());
+  RectGeometryKey key(x, y, width, height, 0, 0);
+  VertexBuffer* vertex_buffer = FindRectGeometry(key);
+  if (!vertex_buffer) {
+    const std::vector<float> coords = {
+        x,         y + height,  // Bottom left
+        x,         y,           // Top left
+        x + width, y + height,  // Bottom right
+        x + width, y,           // Top right
+    };
+    Result r = AddRectGeometry(key, coords, &vertex_buffer);
+    if (!r.IsSuccess())
+      return r;
+  }
 
   DrawArraysCommand draw(command->GetPipeline(), *command->GetPipelineData());
   draw.SetTopology(command->IsPatch() ? Topology::kPatchList
@@ -519,7 +654,7 @@ Result EngineVulkan::DoDrawRect(const DrawRectCommand* command) {
   draw.SetVertexCount(4);
   draw.SetInstanceCount(1);
 
-  Result r = graphics->Draw(&draw, vertex_buffer.get());
+  Result r = graphics->Draw(&draw, vertex_buffer);
   if (!r.IsSuccess())
     return r;
 
@@ -550,69 +685,117 @@ Result EngineVulkan::DoDrawGrid(const DrawGridCommand* command) {
   width = (width / frame_width) * 2.0f;
   height = (height / frame_height) * 2.0f;
 
-  std::vector<Value> values(vertices * 2);
-
-  const float cell_width = width / static_cast<float>(columns);
-  const float cell_height = height / static_cast<float>(rows);
-
-  for (uint32_t i = 0, c = 0; i < rows; i++) {
-    for (uint32_t j = 0; j < columns; j++, c += 12) {
-      // Calculate corners
-      float x0 = x + cell_width * static_cast<float>(j);
-      float y0 = y + cell_height * static_cast<float>(i);
-      float x1 = x + cell_width * static_cast<float>(j + 1);
-      float y1 = y + cell_height * static_cast<float>(i + 1);
-
-      // Bottom right
-      values[c + 0].SetDoubleValue(static_cast<double>(x1));
-      values[c + 1].SetDoubleValue(static_cast<double>(y1));
-      // Bottom left
-      values[c + 2].SetDoubleValue(static_cast<double>(x0));
-      values[c + 3].SetDoubleValue(static_cast<double>(y1));
-      // Top left
-      values[c + 4].SetDoubleValue(static_cast<double>(x0));
-      values[c + 5].SetDoubleValue(static_cast<double>(y0));
-      // Bottom right
-      values[c + 6].SetDoubleValue(static_cast<double>(x1));
-      values[c + 7].SetDoubleValue(static_cast<double>(y1));
-      // Top left
-      values[c + 8].SetDoubleValue(static_cast<double>(x0));
-      values[c + 9].SetDoubleValue(static_cast<double>(y0));
-      // Top right
-      values[c + 10].SetDoubleValue(static_cast<double>(x1));
-      values[c + 11].SetDoubleValue(static_cast<double>(y0));
+  RectGeometryKey key(x, y, width, height, columns, rows);
+  VertexBuffer* vertex_buffer = FindRectGeometry(key);
+  if (!vertex_buffer) {
+    std::vector<float> coords(vertices * 2);
+
+    const float cell_width = width / static_cast<float>(columns);
+    const float cell_height = height / static_cast<float>(rows);
+
+    for (uint32_t i = 0, c = 0; i < rows; i++) {
+      for (uint32_t j = 0; j < columns; j++, c += 12) {
+        // Calculate corners
+        float x0 = x + cell_width * static_cast<float>(j);
+        float y0 = y + cell_height * static_cast<float>(i);
+        float x1 = x + cell_width * static_cast<float>(j + 1);
+        float y1 = y + cell_height * static_cast<float>(i + 1);
+
+        // Bottom right
+        coords[c + 0] = x1;
+        coords[c + 1] = y1;
+        // Bottom left
+        coords[c + 2] = x0;
+        coords[c + 3] = y1;
+        // Top left
+        coords[c + 4] = x0;
+        coords[c + 5] = y0;
+        // Bottom right
+        coords[c + 6] = x1;
+        coords[c + 7] = y1;
+        // Top left
+        coords[c + 8] = x0;
+        coords[c + 9] = y0;
+        // Top right
+        coords[c + 10] = x1;
+        coords[c + 11] = y0;
+      }
     }
+    Result r = AddRectGeometry(key, coords, &vertex_buffer);
+    if (!r.IsSuccess())
+      return r;
   }
 
-  // |format| is not Format for frame buffer but for vertex buffer.
-  // Since draw rect command contains its vertex information and it
-  // does not include a format of vertex buffer, we can choose any
-  // one that is suitable. We use VK_FORMAT_R32G32_SFLOAT for it.
-  TypeParser parser;
-  auto type = parser.Parse("R32G32_SFLOAT");
-  Format fmt(type.get());
-
-  auto buf = MakeUnique<Buffer>();
-  buf->SetFormat(&fmt);
-  buf->SetData(std::move(values));
-
-  auto vertex_buffer = MakeUnique<VertexBuffer>(device_.get());
-  vertex_buffer->SetData(0, buf.get(), InputRate::kVertex, buf->GetFormat(), 0,
-                         buf->GetFormat()->SizeInBytes());
-
   DrawArraysCommand draw(command->GetPipeline(), *command->GetPipelineData());
   draw.SetTopology(Topology::kTriangleList);
   draw.SetFirstVertexIndex(0);
   draw.SetVertexCount(vertices);
   draw.SetInstanceCount(1);
 
-  Result r = graphics->Draw(&draw, vertex_buffer.get());
+  Result r = graphics->Draw(&draw, vertex_buffer);
+  if (!r.IsSuccess())
+    return r;
+
+  return {};
+}
+
+VertexBuffer* EngineVulkan::FindRectGeometry(const RectGeometryKey& key) {
+  auto it = rect_geometry_.find(key);
+  if (it == rect_geometry_.end())
+    return nullptr;
+
+  it->second.last_use = ++rect_geometry_uses_;
+  return it->second.vertex_buffer.get();
+}
+
+Result EngineVulkan::AddRectGeometry(const RectGeometryKey& key,
+                                     const std::vector<float>& coords,
+                                     VertexBuffer** vertex_buffer) {
+  Format* format = GetRectVertexFormat();
+
+  // Every draw waits for its submission, so the least recently used geometry
+  // is no longer referenced by the device.
+  if (rect_geometry_.size() >= kMaxRectGeometries) {
+    auto oldest = rect_geometry_.begin();
+    for (auto it = rect_geometry_.begin(); it != rect_geometry_.end(); ++it) {
+      if (it->second.last_use < oldest->second.last_use)
+        oldest = it;
+    }
+    rect_geometry_.erase(oldest);
+  }
+
+  auto buffer = MakeUnique<Buffer>();
+  buffer->SetFormat(format);
+  Result r = buffer->SetSizeInElements(coords.size() / 2);
   if (!r.IsSuccess())
     return r;
 
+  auto& geometry = rect_geometry_[key];
+  geometry.last_use = ++rect_geometry_uses_;
+  geometry.buffer = std::move(buffer);
+  std::memcpy(geometry.buffer->ValuePtr()->data(), coords.data(),
+              coords.size() * sizeof(float));
+
+  geometry.vertex_buffer = MakeUnique<VertexBuffer>(device_.get());
+  geometry.vertex_buffer->SetData(0, geometry.buffer.get(), InputRate::kVertex,
+                                  format, 0, format->SizeInBytes());
+  *vertex_buffer = geometry.vertex_buffer.get();
   return {};
 }
 
+Format* EngineVulkan::GetRectVertexFormat() {
+  // |format| is not Format for frame buffer but for vertex buffer.
+  // Since draw rect command contains its vertex information and it
+  // does not include a format of vertex buffer, we can choose any
+  // one that is suitable. We use VK_FORMAT_R32G32_SFLOAT for it.
+  if (!rect_vertex_format_) {
+    TypeParser parser;
+    rect_vertex_type_ = parser.Parse("R32G32_SFLOAT");
+    rect_vertex_format_ = MakeUnique<Format>(rect_vertex_type_.get());
+  }
+  return rect_vertex_format_.get();
+}
+
 Result EngineVulkan::DoDrawArrays(const DrawArraysCommand* command) {
   auto& info = pipeline_map_[command->GetPipeline()];
   if (!info.vk_pipeline)
@@ -623,12 +806,80 @@ Result EngineVulkan::DoDrawArrays(const DrawArraysCommand* command) {
 }
 
 Result EngineVulkan::DoCompute(const ComputeCommand* command) {
-  auto& info = pipeline_map_[command->GetPipeline()];
+  return DoRepeatedCompute({command}, 1);
+}
+
+Result EngineVulkan::DoRepeatedCompute(
+    const std::vector<const ComputeCommand*>& cmds,
+    uint32_t count) {
+  if (cmds.empty())
+    return {};
+
+  auto& info = pipeline_map_[cmds[0]->GetPipeline()];
   if (info.vk_pipeline->IsGraphics())
     return Result("Vulkan: Compute called for graphics pipeline.");
 
-  return info.vk_pipeline->AsCompute()->Compute(
-      command->GetX(), command->GetY(), command->GetZ());
+  std::vector<ComputePipeline::Dispatch> dispatches;
+  for (const auto* cmd : cmds)
+    dispatches.push_back({cmd->GetX(), cmd->GetY(), cmd->GetZ(),
+                          cmd->GetIndirectBuffer(), cmd->GetIndirectOffset()});
+
+  return info.vk_pipeline->AsCompute()->Compute(dispatches, count);
+}
+
+Result EngineVulkan::DoConcurrentCompute(
+    const std::vector<const ComputeCommand*>& cmds,
+    size_t* failed) {
+  // Commands are prepared and submitted up to the first one which fails, so
+  // the commands before it still run and the failure is reported for it.
+  Result prepare_result;
+  std::vector<ComputePipeline*> pipelines;
+  for (const auto* cmd : cmds) {
+    auto& info = pipeline_map_[cmd->GetPipeline()];
+    if (info.vk_pipeline->IsGraphics()) {
+      prepare_result = Result("Vulkan: Compute called for graphics pipeline.");
+      break;
+    }
+    prepare_result = info.vk_pipeline->AsCompute()->PrepareCompute();
+    if (!prepare_result.IsSuccess())
+      break;
+
+    pipelines.push_back(info.vk_pipeline->AsCompute());
+  }
+
+  // All of the submissions go to the queue before waiting on any of them so
+  // the dispatches of independent pipelines can overlap on the device.
+  Result submit_result;
+  size_t submitted = 0;
+  for (; submitted < pipelines.size(); ++submitted) {
+    const auto* cmd = cmds[submitted];
+    submit_result = pipelines[submitted]->SubmitCompute(
+        {{cmd->GetX(), cmd->GetY(), cmd->GetZ(), cmd->GetIndirectBuffer(),
+          cmd->GetIndirectOffset()}},
+        1);
+    if (!submit_result.IsSuccess())
+      break;
+  }
+
+  // Wait for everything that made it to the queue, even after a failure, so
+  // no command buffer is left in flight.
+  Result r;
+  for (size_t i = 0; i < submitted; ++i) {
+    Result finish = pipelines[i]->FinishCompute();
+    if (r.IsSuccess() && !finish.IsSuccess()) {
+      r = finish;
+      *failed = i;
+    }
+  }
+  if (r.IsSuccess() && !submit_result.IsSuccess()) {
+    r = submit_result;
+    *failed = submitted;
+  }
+  if (r.IsSuccess() && !prepare_result.IsSuccess()) {
+    r = prepare_result;
+    *failed = pipelines.size();
+  }
+  return r;
 }
 
 Result EngineVulkan::DoEntryPoint(const EntryPointCommand* command) {
@@ -663,17 +914,180 @@ Result EngineVulkan::DoBuffer(const BufferCommand* cmd) {
         "device");
   }
   if (cmd->GetValues().empty()) {
-    cmd->GetBuffer()->SetSizeInElements(cmd->GetBuffer()->ElementCount());
+    Result r =
+        cmd->GetBuffer()->SetSizeInElements(cmd->GetBuffer()->ElementCount());
+    if (!r.IsSuccess())
+      return r;
   } else {
-    cmd->GetBuffer()->SetDataWithOffset(cmd->GetValues(), cmd->GetOffset());
+    Result r =
+        cmd->GetBuffer()->SetDataWithOffset(cmd->GetValues(), cmd->GetOffset());
+    if (!r.IsSuccess())
+      return r;
   }
   if (cmd->IsPushConstant()) {
+    if (cmd->GetOffset() > std::numeric_limits<uint32_t>::max())
+      return Result("Vulkan::DoBuffer push constant offset is too large");
+
     auto& info = pipeline_map_[cmd->GetPipeline()];
-    return info.vk_pipeline->AddPushConstantBuffer(cmd->GetBuffer(),
-                                                   cmd->GetOffset());
+    return info.vk_pipeline->AddPushConstantBuffer(
+        cmd->GetBuffer(), static_cast<uint32_t>(cmd->GetOffset()));
+  }
+  return {};
+}
+
+Result EngineVulkan::GetDeviceVerifier(DeviceVerifier** verifier) {
+  if (!device_verifier_) {
+    device_verifier_ = MakeUnique<DeviceVerifier>(
+        device_.get(), GetEngineData().fence_timeout_ms);
+    Result r =
+        device_verifier_->Initialize(pool_.get(), descriptor_pool_.get());
+    if (!r.IsSuccess()) {
+      device_verifier_ = nullptr;
+      return r;
+    }
   }
+  *verifier = device_verifier_.get();
   return {};
 }
 
+void EngineVulkan::LogMemoryPlacementOnce(MemoryPlacement placement) {
+  if (memory_placement_logged_ || !delegate_)
+    return;
+  memory_placement_logged_ = true;
+
+  if (placement == MemoryPlacement::kHostVisible) {
+    if (delegate_->LogExecuteCalls())
+      delegate_->Log("Vulkan: descriptor buffers use host visible memory");
+    return;
+  }
+
+  if (device_->HasMemoryTypeWithFlags(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+                                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                      VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)) {
+    delegate_->Log(
+        "Vulkan: descriptor buffers use device local memory, mapped by the "
+        "host when it fits and staged otherwise");
+  } else {
+    delegate_->Log(
+        "Vulkan: descriptor buffers use device local memory with staging "
+        "copies");
+  }
+}
+
+Result EngineVulkan::GetVerificationBuffer(amber::Pipeline* pipeline,
+                                           const Buffer* buffer,
+                                           VkBuffer* vk_buffer) {
+  auto it = pipeline_map_.find(pipeline);
+  if (it == pipeline_map_.end() || !it->second.vk_pipeline->IsGraphics())
+    return Result("Vulkan: device compare without a graphics pipeline");
+
+  // The last draw copied the whole attachment to the host accessible buffer
+  // of the image.
+  FrameBuffer* frame = it->second.vk_pipeline->AsGraphics()->GetFrameBuffer();
+  size_t idx = 0;
+  if (!frame->FindColorAttachment(buffer, &idx))
+    return Result("Vulkan: device compare of a buffer which is not attached");
+
+  *vk_buffer = frame->GetColorImage(idx)->GetHostAccessibleBuffer();
+  return {};
+}
+
+void EngineVulkan::SetReadbackRegions(
+    amber::Pipeline* pipeline,
+    const Buffer* buffer,
+    const std::vector<ReadbackRegion>& regions,
+    bool copy_to_host) {
+  auto it = pipeline_map_.find(pipeline);
+  if (it == pipeline_map_.end() || !it->second.vk_pipeline->IsGraphics())
+    return;
+
+  FrameBuffer* frame = it->second.vk_pipeline->AsGraphics()->GetFrameBuffer();
+  size_t idx = 0;
+  if (!frame->FindColorAttachment(buffer, &idx))
+    return;
+
+  std::vector<VkRect2D> rects;
+  for (const auto& region : regions) {
+    VkRect2D rect = VkRect2D();
+    rect.offset = {static_cast<int32_t>(region.x),
+                   static_cast<int32_t>(region.y)};
+    rect.extent = {region.width, region.height};
+    rects.push_back(rect);
+  }
+  frame->SetColorReadbackRegions(idx, std::move(rects), copy_to_host);
+}
+
+Result EngineVulkan::DoDeviceProbe(const ProbeCommand* cmd,
+                                   amber::Pipeline* pipeline,
+                                   const std::vector<uint32_t>& spirv,
+                                   const ProbeShaderParams& params,
+                                   ProbeShaderResult* result) {
+  auto it = pipeline_map_.find(pipeline);
+  if (it == pipeline_map_.end() || !it->second.vk_pipeline->IsGraphics())
+    return Result("Vulkan: device probe without a graphics pipeline");
+
+  FrameBuffer* frame = it->second.vk_pipeline->AsGraphics()->GetFrameBuffer();
+  size_t idx = 0;
+  if (!frame->FindColorAttachment(cmd->GetBuffer(), &idx))
+    return Result("Vulkan: device probe of a buffer which is not attached");
+
+  DeviceVerifier* verifier = nullptr;
+  Result r = GetDeviceVerifier(&verifier);
+  if (!r.IsSuccess())
+    return r;
+
+  // Every draw copies the attachment, or its probed regions, to the host
+  // accessible buffer of the image, which is probed in place.
+  TransferImage* image = frame->GetColorImage(idx);
+  r = verifier->Probe(spirv, params, image->GetHostAccessibleBuffer(),
+                      cmd->GetBuffer()->GetSizeInBytes(), result);
+  if (!r.IsSuccess())
+    return r;
+
+  // The host verifier needs the whole region to decide uncertain texels. A
+  // failure the device is sure about is described with its first texel.
+  VkRect2D region = VkRect2D();
+  if (result->uncertain_count > 0) {
+    region.offset = {static_cast<int32_t>(params.region[0]),
+                     static_cast<int32_t>(params.region[1])};
+    region.extent = {params.region[2], params.region[3]};
+  } else if (result->mismatch_count > 0) {
+    region.offset = {
+        static_cast<int32_t>(params.region[0] +
+                             result->first_mismatch % params.region[2]),
+        static_cast<int32_t>(params.region[1] +
+                             result->first_mismatch / params.region[2])};
+    region.extent = {1, 1};
+  } else {
+    return {};
+  }
+  frame->CopyColorRegionToBuffer(idx, region);
+  return {};
+}
+
+Result EngineVulkan::DoDeviceCompare(const CompareBufferCommand* cmd,
+                                     amber::Pipeline* pipeline1,
+                                     amber::Pipeline* pipeline2,
+                                     const std::vector<uint32_t>& spirv,
+                                     const CompareShaderParams& params,
+                                     CompareShaderResult* result) {
+  DeviceVerifier* verifier = nullptr;
+  Result r = GetDeviceVerifier(&verifier);
+  if (!r.IsSuccess())
+    return r;
+
+  VkBuffer buffer1 = VK_NULL_HANDLE;
+  r = GetVerificationBuffer(pipeline1, cmd->GetBuffer1(), &buffer1);
+  if (!r.IsSuccess())
+    return r;
+
+  VkBuffer buffer2 = VK_NULL_HANDLE;
+  r = GetVerificationBuffer(pipeline2, cmd->GetBuffer2(), &buffer2);
+  if (!r.IsSuccess())
+    return r;
+
+  return verifier->Compare(spirv, params, buffer1, buffer2, result);
+}
+
 }  // namespace vulkan
 }  // namespace amber
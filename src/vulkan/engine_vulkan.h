@@ -18,6 +18,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -25,10 +26,14 @@
 #include "amber/vulkan_header.h"
 #include "src/cast_hash.h"
 #include "src/engine.h"
+#include "src/format.h"
 #include "src/pipeline.h"
 #include "src/vulkan/buffer_descriptor.h"
 #include "src/vulkan/command_pool.h"
+#include "src/vulkan/descriptor_pool.h"
+#include "src/vulkan/sampler_cache.h"
 #include "src/vulkan/device.h"
+#include "src/vulkan/device_verifier.h"
 #include "src/vulkan/pipeline.h"
 #include "src/vulkan/vertex_buffer.h"
 
@@ -47,7 +52,12 @@ class EngineVulkan : public Engine {
                     const std::vector<std::string>& features,
                     const std::vector<std::string>& instance_extensions,
                     const std::vector<std::string>& device_extensions) override;
+  bool IsFormatSupported(const Format& format, BufferType type) const override;
+  Result CheckFormatsSupported(
+      const std::vector<std::unique_ptr<amber::Pipeline>>& pipelines)
+      const override;
   Result CreatePipeline(amber::Pipeline* type) override;
+  Result PrecompilePipelines(const std::vector<const Command*>& cmds) override;
 
   Result DoClearColor(const ClearColorCommand* cmd) override;
   Result DoClearStencil(const ClearStencilCommand* cmd) override;
@@ -57,10 +67,31 @@ class EngineVulkan : public Engine {
   Result DoDrawGrid(const DrawGridCommand* cmd) override;
   Result DoDrawArrays(const DrawArraysCommand* cmd) override;
   Result DoCompute(const ComputeCommand* cmd) override;
+  Result DoRepeatedCompute(const std::vector<const ComputeCommand*>& cmds,
+                           uint32_t count) override;
+  Result DoConcurrentCompute(const std::vector<const ComputeCommand*>& cmds,
+                             size_t* failed) override;
   Result DoEntryPoint(const EntryPointCommand* cmd) override;
   Result DoPatchParameterVertices(
       const PatchParameterVerticesCommand* cmd) override;
   Result DoBuffer(const BufferCommand* cmd) override;
+  void SetReadbackRegions(amber::Pipeline* pipeline,
+                          const Buffer* buffer,
+                          const std::vector<ReadbackRegion>& regions,
+                          bool copy_to_host) override;
+  bool SupportsDeviceProbes() const override { return true; }
+  Result DoDeviceProbe(const ProbeCommand* cmd,
+                       amber::Pipeline* pipeline,
+                       const std::vector<uint32_t>& spirv,
+                       const ProbeShaderParams& params,
+                       ProbeShaderResult* result) override;
+  bool SupportsDeviceCompares() const override { return true; }
+  Result DoDeviceCompare(const CompareBufferCommand* cmd,
+                         amber::Pipeline* pipeline1,
+                         amber::Pipeline* pipeline2,
+                         const std::vector<uint32_t>& spirv,
+                         const CompareShaderParams& params,
+                         CompareShaderResult* result) override;
 
  private:
   struct PipelineInfo {
@@ -86,12 +117,63 @@ class EngineVulkan : public Engine {
   Result SetShader(amber::Pipeline* pipeline,
                    const amber::Pipeline::ShaderInfo& shader);
 
+  /// Vertex data generated for a DRAW_RECT or DRAW_GRID command. The key is
+  /// the rectangle in normalized device coordinates followed by the number
+  /// of columns and rows, which are both 0 for DRAW_RECT.
+  using RectGeometryKey =
+      std::tuple<float, float, float, float, uint32_t, uint32_t>;
+  struct RectGeometry {
+    std::unique_ptr<Buffer> buffer;
+    std::unique_ptr<VertexBuffer> vertex_buffer;
+    uint64_t last_use = 0;
+  };
+
+  /// Returns the cached vertex buffer for |key|, or nullptr if there is none
+  /// yet.
+  VertexBuffer* FindRectGeometry(const RectGeometryKey& key);
+  /// Caches a vertex buffer holding |coords|, a list of (x, y) pairs, for
+  /// |key| and returns it in |vertex_buffer|. Its data is uploaded on the
+  /// first draw only. Only the most recently used vertex buffers are kept.
+  Result AddRectGeometry(const RectGeometryKey& key,
+                         const std::vector<float>& coords,
+                         VertexBuffer** vertex_buffer);
+  /// Returns the format of the vertices of DRAW_RECT and DRAW_GRID.
+  Format* GetRectVertexFormat();
+
+  /// Returns the device verifier, creating it on first use.
+  Result GetDeviceVerifier(DeviceVerifier** verifier);
+  /// Returns in |vk_buffer| the storage buffer holding the color attachment
+  /// |buffer| of |pipeline|, for comparing it on the device in place.
+  Result GetVerificationBuffer(amber::Pipeline* pipeline,
+                               const Buffer* buffer,
+                               VkBuffer* vk_buffer);
+
+  /// Logs the memory placement of descriptor buffers the first time a
+  /// pipeline is created. The default placement is only logged when execute
+  /// calls are logged.
+  void LogMemoryPlacementOnce(MemoryPlacement placement);
+
+  Delegate* delegate_ = nullptr;
+  bool memory_placement_logged_ = false;
   std::unique_ptr<Device> device_;
   std::unique_ptr<CommandPool> pool_;
+  /// Pool of the transfer queue, only created if the device has one.
+  std::unique_ptr<CommandPool> transfer_pool_;
+  std::unique_ptr<DescriptorPool> descriptor_pool_;
+  std::unique_ptr<SamplerCache> sampler_cache_;
+  std::unique_ptr<DeviceVerifier> device_verifier_;
 
   std::map<amber::Pipeline*, PipelineInfo> pipeline_map_;
 
   std::map<std::string, VkShaderModule> shaders_;
+
+  std::unique_ptr<type::Type> rect_vertex_type_;
+  std::unique_ptr<Format> rect_vertex_format_;
+  std::map<RectGeometryKey, RectGeometry> rect_geometry_;
+  uint64_t rect_geometry_uses_ = 0;
+  /// Vertex input of DRAW_RECT and DRAW_GRID without any data, used to warm
+  /// up their pipelines.
+  std::unique_ptr<VertexBuffer> rect_vertex_input_;
 };
 
 }  // namespace vulkan
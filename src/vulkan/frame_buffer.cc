@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cstring>
 #include <limits>
+#include <utility>
 #include <vector>
 
 #include "src/make_unique.h"
@@ -38,7 +39,9 @@ FrameBuffer::FrameBuffer(
       resolve_targets_(resolve_targets),
       depth_stencil_attachment_(depth_stencil_attachment),
       width_(width),
-      height_(height) {}
+      height_(height) {
+  color_readbacks_.resize(color_attachments.size());
+}
 
 FrameBuffer::~FrameBuffer() {
   if (frame_ != VK_NULL_HANDLE) {
@@ -183,8 +186,12 @@ void FrameBuffer::ChangeFrameToWriteLayout(CommandBuffer* command) {
 }
 
 void FrameBuffer::TransferImagesToHost(CommandBuffer* command) {
-  for (auto& img : color_images_)
-    img->CopyToHost(command);
+  for (size_t i = 0; i < color_images_.size(); ++i) {
+    if (color_readbacks_[i].limited)
+      color_images_[i]->CopyRegionsToHost(command, color_readbacks_[i].regions);
+    else
+      color_images_[i]->CopyToHost(command);
+  }
 
   for (auto& img : resolve_images_)
     img->CopyToHost(command);
@@ -193,14 +200,41 @@ void FrameBuffer::TransferImagesToHost(CommandBuffer* command) {
     depth_stencil_image_->CopyToHost(command);
 }
 
+bool FrameBuffer::FindColorAttachment(const amber::Buffer* buffer,
+                                      size_t* idx) const {
+  for (size_t i = 0; i < color_attachments_.size(); ++i) {
+    if (color_attachments_[i]->buffer == buffer) {
+      *idx = i;
+      return true;
+    }
+  }
+  return false;
+}
+
 void FrameBuffer::CopyImagesToBuffers() {
   for (size_t i = 0; i < color_images_.size(); ++i) {
     auto& img = color_images_[i];
     auto* info = color_attachments_[i];
     auto* values = info->buffer->ValuePtr();
+    auto& readback = color_readbacks_[i];
     values->resize(info->buffer->GetSizeInBytes());
-    std::memcpy(values->data(), img->HostAccessibleMemoryPtr(),
-                info->buffer->GetSizeInBytes());
+    if (!readback.limited) {
+      std::memcpy(values->data(), img->HostAccessibleMemoryPtr(),
+                  info->buffer->GetSizeInBytes());
+      readback.buffer_partial = false;
+      readback.regions_on_host = true;
+      continue;
+    }
+
+    if (readback.copy_to_host) {
+      for (const auto& region : readback.regions)
+        CopyColorRegion(i, region);
+    }
+    readback.limited = false;
+    readback.regions.clear();
+    readback.buffer_partial = true;
+    readback.regions_on_host = readback.copy_to_host;
+    readback.copy_to_host = true;
   }
 
   for (size_t i = 0; i < resolve_images_.size(); ++i) {
@@ -220,9 +254,74 @@ void FrameBuffer::CopyImagesToBuffers() {
   }
 }
 
+bool FrameBuffer::CanCopyColorRegions(size_t idx) const {
+  const auto* info = color_attachments_[idx];
+  // Regions are only copied from the first mip level of single sampled
+  // images, with texel offsets vkCmdCopyImageToBuffer accepts.
+  return info->base_mip_level == 0 && info->buffer->GetMipLevels() == 1 &&
+         info->buffer->GetSamples() == 1 &&
+         info->buffer->GetFormat()->SizeInBytes() % 4 == 0 &&
+         info->buffer->GetWidth() == width_ &&
+         info->buffer->GetHeight() == height_;
+}
+
+void FrameBuffer::CopyColorRegion(size_t idx, const VkRect2D& region) {
+  const auto* info = color_attachments_[idx];
+  auto* values = info->buffer->ValuePtr();
+  const auto* src = static_cast<const uint8_t*>(
+      color_images_[idx]->HostAccessibleMemoryPtr());
+  const size_t texel_size = info->buffer->GetFormat()->SizeInBytes();
+  const size_t row_size = region.extent.width * texel_size;
+  for (uint32_t y = 0; y < region.extent.height; ++y) {
+    const size_t offset =
+        (static_cast<size_t>(static_cast<uint32_t>(region.offset.y) + y) *
+             width_ +
+         static_cast<uint32_t>(region.offset.x)) *
+        texel_size;
+    std::memcpy(values->data() + offset, src + offset, row_size);
+  }
+}
+
+void FrameBuffer::CopyColorRegionToBuffer(size_t idx, const VkRect2D& region) {
+  // Every other readback already copied what it read to the buffer.
+  if (color_readbacks_[idx].regions_on_host)
+    return;
+  if (region.offset.x < 0 || region.offset.y < 0 ||
+      static_cast<uint64_t>(region.offset.x) + region.extent.width > width_ ||
+      static_cast<uint64_t>(region.offset.y) + region.extent.height >
+          height_) {
+    return;
+  }
+  CopyColorRegion(idx, region);
+}
+
+void FrameBuffer::SetColorReadbackRegions(size_t idx,
+                                          std::vector<VkRect2D> regions,
+                                          bool copy_to_host) {
+  if (!CanCopyColorRegions(idx))
+    return;
+  for (const auto& region : regions) {
+    if (region.offset.x < 0 || region.offset.y < 0 ||
+        static_cast<uint64_t>(region.offset.x) + region.extent.width >
+            width_ ||
+        static_cast<uint64_t>(region.offset.y) + region.extent.height >
+            height_) {
+      return;
+    }
+  }
+
+  color_readbacks_[idx].limited = true;
+  color_readbacks_[idx].regions = std::move(regions);
+  color_readbacks_[idx].copy_to_host = copy_to_host;
+}
+
 void FrameBuffer::TransferImagesToDevice(CommandBuffer* command) {
-  for (auto& img : color_images_)
-    img->CopyToDevice(command);
+  // The image of a partially read back attachment holds the only complete
+  // copy of its contents.
+  for (size_t i = 0; i < color_images_.size(); ++i) {
+    if (!color_readbacks_[i].buffer_partial)
+      color_images_[i]->CopyToDevice(command);
+  }
 
   if (depth_stencil_image_)
     depth_stencil_image_->CopyToDevice(command);
@@ -233,8 +332,8 @@ void FrameBuffer::CopyBuffersToImages() {
     auto& img = color_images_[i];
     auto* info = color_attachments_[i];
     auto* values = info->buffer->ValuePtr();
-    // Nothing to do if our local buffer is empty
-    if (values->empty())
+    // Nothing to do if our local buffer is empty or only partially valid.
+    if (values->empty() || color_readbacks_[i].buffer_partial)
       continue;
 
     std::memcpy(img->HostAccessibleMemoryPtr(), values->data(),
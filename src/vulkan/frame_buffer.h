@@ -49,6 +49,12 @@ class FrameBuffer {
   const void* GetColorBufferPtr(size_t idx) const {
     return color_images_[idx]->HostAccessibleMemoryPtr();
   }
+  /// Returns the index of the color attachment backed by |buffer| in
+  /// |idx|, or false if |buffer| is not a color attachment.
+  bool FindColorAttachment(const amber::Buffer* buffer, size_t* idx) const;
+  TransferImage* GetColorImage(size_t idx) const {
+    return color_images_[idx].get();
+  }
 
   // Only record the command for copying the image that backs this
   // framebuffer to the host accessible buffer. The actual submission
@@ -59,10 +65,41 @@ class FrameBuffer {
   void CopyImagesToBuffers();
   void CopyBuffersToImages();
 
+  /// Limits the next TransferImagesToHost() and CopyImagesToBuffers() of the
+  /// color attachment |idx| to |regions|, which may be empty. The rest of its
+  /// buffer is left stale, so until the next full readback the image is not
+  /// overwritten from the buffer before drawing. If |copy_to_host| is false
+  /// the regions only reach the host accessible buffer of the image, and
+  /// CopyColorRegionToBuffer() has to be called for any of them read on the
+  /// host. The hint is ignored if the attachment can not be copied by
+  /// regions.
+  void SetColorReadbackRegions(size_t idx,
+                               std::vector<VkRect2D> regions,
+                               bool copy_to_host);
+  /// Copies |region| of the color attachment |idx| from the host accessible
+  /// buffer of its image into its buffer, if the last readback left it out.
+  void CopyColorRegionToBuffer(size_t idx, const VkRect2D& region);
+
   uint32_t GetWidth() const { return width_; }
   uint32_t GetHeight() const { return height_; }
 
  private:
+  struct ColorReadback {
+    /// True if the next readback is limited to |regions|.
+    bool limited = false;
+    std::vector<VkRect2D> regions;
+    /// False if the next readback leaves the regions in the image buffer.
+    bool copy_to_host = true;
+    /// False if the last readback left the regions in the image buffer.
+    bool regions_on_host = true;
+    /// True if the buffer only holds the regions of the last readback.
+    bool buffer_partial = false;
+  };
+
+  /// Returns true if the color attachment |idx| can be copied by regions.
+  bool CanCopyColorRegions(size_t idx) const;
+  void CopyColorRegion(size_t idx, const VkRect2D& region);
+
   void ChangeFrameLayout(CommandBuffer* command,
                          VkImageLayout color_layout,
                          VkPipelineStageFlags color_stage,
@@ -75,6 +112,7 @@ class FrameBuffer {
   amber::Pipeline::BufferInfo depth_stencil_attachment_;
   VkFramebuffer frame_ = VK_NULL_HANDLE;
   std::vector<std::unique_ptr<TransferImage>> color_images_;
+  std::vector<ColorReadback> color_readbacks_;
   std::vector<std::unique_ptr<TransferImage>> resolve_images_;
   std::unique_ptr<TransferImage> depth_stencil_image_;
   uint32_t width_ = 0;
@@ -405,6 +405,11 @@ GraphicsPipeline::GraphicsPipeline(
 }
 
 GraphicsPipeline::~GraphicsPipeline() {
+  // The index buffer and frame buffer are destroyed before the command
+  // buffers, so submissions which were not waited for must be done first.
+  if (command_)
+    command_->WaitAndReset(GetFenceTimeout());
+
   if (render_pass_) {
     device_->GetPtrs()->vkDestroyRenderPass(device_->GetVkDevice(),
                                             render_pass_, nullptr);
@@ -722,8 +727,8 @@ Result GraphicsPipeline::CreateVkGraphicsPipeline(
   pipeline_info.subpass = 0;
 
   if (device_->GetPtrs()->vkCreateGraphicsPipelines(
-          device_->GetVkDevice(), VK_NULL_HANDLE, 1, &pipeline_info, nullptr,
-          pipeline) != VK_SUCCESS) {
+          device_->GetVkDevice(), device_->GetVkPipelineCache(), 1,
+          &pipeline_info, nullptr, pipeline) != VK_SUCCESS) {
     return Result("Vulkan::Calling vkCreateGraphicsPipelines Fail");
   }
 
@@ -732,8 +737,10 @@ Result GraphicsPipeline::CreateVkGraphicsPipeline(
 
 Result GraphicsPipeline::Initialize(uint32_t width,
                                     uint32_t height,
-                                    CommandPool* pool) {
-  Result r = Pipeline::Initialize(pool);
+                                    CommandPool* pool,
+                                    DescriptorPool* descriptor_pool,
+                                    SamplerCache* sampler_cache) {
+  Result r = Pipeline::Initialize(pool, descriptor_pool, sampler_cache);
   if (!r.IsSuccess())
     return r;
 
@@ -778,7 +785,9 @@ Result GraphicsPipeline::SetIndexBuffer(Buffer* buffer) {
   if (!r.IsSuccess())
     return r;
 
-  return guard.Submit(GetFenceTimeout());
+  // The index buffer keeps its staging memory, so the upload is only waited
+  // for with the first draw using it.
+  return guard.SubmitNoWait();
 }
 
 Result GraphicsPipeline::SetClearColor(float r, float g, float b, float a) {
@@ -877,6 +886,26 @@ Result GraphicsPipeline::Clear() {
   return {};
 }
 
+Result GraphicsPipeline::WarmPipelineCache(const PipelineData* pipeline_data,
+                                           Topology topology,
+                                           const VertexBuffer* vertex_buffer) {
+  std::vector<VkDescriptorSetLayout> set_layouts;
+  VkPipelineLayout pipeline_layout = VK_NULL_HANDLE;
+  Result r = CreateTransientVkPipelineLayout(&set_layouts, &pipeline_layout);
+  if (r.IsSuccess()) {
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    r = CreateVkGraphicsPipeline(pipeline_data, ToVkTopology(topology),
+                                 vertex_buffer, pipeline_layout, &pipeline);
+    if (r.IsSuccess()) {
+      device_->GetPtrs()->vkDestroyPipeline(device_->GetVkDevice(), pipeline,
+                                            nullptr);
+    }
+  }
+
+  DestroyTransientVkPipelineLayout(set_layouts, pipeline_layout);
+  return r;
+}
+
 Result GraphicsPipeline::Draw(const DrawArraysCommand* command,
                               VertexBuffer* vertex_buffer) {
   Result r = SendDescriptorDataToDeviceIfNeeded();
@@ -898,7 +927,9 @@ Result GraphicsPipeline::Draw(const DrawArraysCommand* command,
   // Note that a command updating a descriptor set and a command using
   // it must be submitted separately, because using a descriptor set
   // while updating it is not safe.
-  UpdateDescriptorSetsIfNeeded();
+  r = UpdateDescriptorSetsIfNeeded();
+  if (!r.IsSuccess())
+    return r;
 
   {
     CommandBufferGuard cmd_buf_guard(GetCommandBuffer());
@@ -909,6 +940,19 @@ Result GraphicsPipeline::Draw(const DrawArraysCommand* command,
     if (!r.IsSuccess())
       return r;
 
+    VkBuffer indirect_buffer = VK_NULL_HANDLE;
+    if (command->IsIndirect()) {
+      uint32_t params_size =
+          command->IsIndexed()
+              ? static_cast<uint32_t>(sizeof(VkDrawIndexedIndirectCommand))
+              : static_cast<uint32_t>(sizeof(VkDrawIndirectCommand));
+      r = RecordIndirectBufferUpload(command->GetIndirectBuffer(),
+                                     command->GetIndirectOffset(), params_size,
+                                     &indirect_buffer);
+      if (!r.IsSuccess())
+        return r;
+    }
+
     frame_->ChangeFrameToWriteLayout(GetCommandBuffer());
     frame_->CopyBuffersToImages();
     frame_->TransferImagesToDevice(GetCommandBuffer());
@@ -936,7 +980,21 @@ Result GraphicsPipeline::Draw(const DrawArraysCommand* command,
         r = index_buffer_->BindToCommandBuffer(command_.get());
         if (!r.IsSuccess())
           return r;
+      }
 
+      if (command->IsIndirect()) {
+        if (command->IsIndexed()) {
+          device_->GetPtrs()->vkCmdDrawIndexedIndirect(
+              command_->GetVkCommandBuffer(), indirect_buffer,
+              command->GetIndirectOffset(), 1,
+              static_cast<uint32_t>(sizeof(VkDrawIndexedIndirectCommand)));
+        } else {
+          device_->GetPtrs()->vkCmdDrawIndirect(
+              command_->GetVkCommandBuffer(), indirect_buffer,
+              command->GetIndirectOffset(), 1,
+              static_cast<uint32_t>(sizeof(VkDrawIndirectCommand)));
+        }
+      } else if (command->IsIndexed()) {
         // VkRunner spec says
         //   "vertexCount will be used as the index count, firstVertex
         //    becomes the vertex offset and firstIndex will always be zero."
@@ -958,7 +1016,9 @@ Result GraphicsPipeline::Draw(const DrawArraysCommand* command,
 
     frame_->TransferImagesToHost(command_.get());
 
-    r = cmd_buf_guard.Submit(GetFenceTimeout());
+    // The readback below waits for the draw before the host reads the
+    // results or the pipeline is destroyed.
+    r = cmd_buf_guard.SubmitNoWait();
     if (!r.IsSuccess())
       return r;
   }
@@ -21,6 +21,7 @@
 #include "amber/result.h"
 #include "amber/value.h"
 #include "amber/vulkan_header.h"
+#include "src/command_data.h"
 #include "src/format.h"
 #include "src/pipeline.h"
 #include "src/vulkan/frame_buffer.h"
@@ -48,7 +49,11 @@ class GraphicsPipeline : public Pipeline {
       const std::vector<VkPipelineShaderStageCreateInfo>&);
   ~GraphicsPipeline() override;
 
-  Result Initialize(uint32_t width, uint32_t height, CommandPool* pool);
+  Result Initialize(uint32_t width,
+                    uint32_t height,
+                    CommandPool* pool,
+                    DescriptorPool* descriptor_pool,
+                    SamplerCache* sampler_cache);
 
   Result SetIndexBuffer(Buffer* buffer);
 
@@ -60,6 +65,15 @@ class GraphicsPipeline : public Pipeline {
 
   Result Draw(const DrawArraysCommand* command, VertexBuffer* vertex_buffer);
 
+  /// Creates the VkPipeline a draw with |pipeline_data|, |topology| and the
+  /// vertex input of |vertex_buffer| would use, and destroys it again, so
+  /// the compiled shaders are left in the pipeline cache of the device. Only
+  /// reads the pipeline state, so different pipelines can be warmed up on
+  /// different threads at the same time.
+  Result WarmPipelineCache(const PipelineData* pipeline_data,
+                           Topology topology,
+                           const VertexBuffer* vertex_buffer);
+
   VkRenderPass GetVkRenderPass() const { return render_pass_; }
   FrameBuffer* GetFrameBuffer() const { return frame_.get(); }
 
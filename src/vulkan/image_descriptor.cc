@@ -27,13 +27,14 @@ namespace vulkan {
 ImageDescriptor::ImageDescriptor(Buffer* buffer,
                                  DescriptorType type,
                                  Device* device,
+                                 SamplerCache* sampler_cache,
                                  uint32_t base_mip_level,
                                  uint32_t desc_set,
                                  uint32_t binding,
                                  Pipeline* pipeline)
     : BufferBackedDescriptor(buffer, type, device, desc_set, binding, pipeline),
       base_mip_level_(base_mip_level),
-      vulkan_sampler_(device) {}
+      vulkan_sampler_(sampler_cache) {}
 
 ImageDescriptor::~ImageDescriptor() = default;
 
@@ -107,15 +108,16 @@ Result ImageDescriptor::CreateResourceIfNeeded() {
   return {};
 }
 
-void ImageDescriptor::UpdateDescriptorSetIfNeeded(
-    VkDescriptorSet descriptor_set) {
+void ImageDescriptor::AddDescriptorSetWriteIfNeeded(
+    VkDescriptorSet descriptor_set,
+    std::vector<VkWriteDescriptorSet>* writes) {
   if (!is_descriptor_set_update_needed_)
     return;
 
   // Always use general layout.
   VkImageLayout layout = VK_IMAGE_LAYOUT_GENERAL;
 
-  std::vector<VkDescriptorImageInfo> image_infos;
+  image_infos_.clear();
 
   // Create VkDescriptorImageInfo for every descriptor image.
   for (const auto& amber_buffer : GetAmberBuffers()) {
@@ -124,7 +126,7 @@ void ImageDescriptor::UpdateDescriptorSetIfNeeded(
             ->AsTransferImage();
     VkDescriptorImageInfo image_info = {vulkan_sampler_.GetVkSampler(),
                                         image->GetVkImageView(), layout};
-    image_infos.push_back(image_info);
+    image_infos_.push_back(image_info);
   }
 
   VkWriteDescriptorSet write = VkWriteDescriptorSet();
@@ -132,12 +134,10 @@ void ImageDescriptor::UpdateDescriptorSetIfNeeded(
   write.dstSet = descriptor_set;
   write.dstBinding = binding_;
   write.dstArrayElement = 0;
-  write.descriptorCount = static_cast<uint32_t>(image_infos.size());
+  write.descriptorCount = static_cast<uint32_t>(image_infos_.size());
   write.descriptorType = GetVkDescriptorType();
-  write.pImageInfo = image_infos.data();
-
-  device_->GetPtrs()->vkUpdateDescriptorSets(device_->GetVkDevice(), 1, &write,
-                                             0, nullptr);
+  write.pImageInfo = image_infos_.data();
+  writes->push_back(write);
 
   is_descriptor_set_update_needed_ = false;
 }
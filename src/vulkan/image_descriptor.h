@@ -33,13 +33,16 @@ class ImageDescriptor : public BufferBackedDescriptor {
   ImageDescriptor(Buffer* buffer,
                   DescriptorType type,
                   Device* device,
+                  SamplerCache* sampler_cache,
                   uint32_t base_mip_level,
                   uint32_t desc_set,
                   uint32_t binding,
                   Pipeline* pipeline);
   ~ImageDescriptor() override;
 
-  void UpdateDescriptorSetIfNeeded(VkDescriptorSet descriptor_set) override;
+  void AddDescriptorSetWriteIfNeeded(
+      VkDescriptorSet descriptor_set,
+      std::vector<VkWriteDescriptorSet>* writes) override;
   Result CreateResourceIfNeeded() override;
   void SetAmberSampler(amber::Sampler* sampler) { amber_sampler_ = sampler; }
 
@@ -48,6 +51,7 @@ class ImageDescriptor : public BufferBackedDescriptor {
  private:
   uint32_t base_mip_level_ = 0;
   amber::Sampler* amber_sampler_ = nullptr;
+  std::vector<VkDescriptorImageInfo> image_infos_;
   amber::vulkan::Sampler vulkan_sampler_;
 };
 
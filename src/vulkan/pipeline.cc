@@ -15,7 +15,9 @@
 #include "src/vulkan/pipeline.h"
 
 #include <algorithm>
+#include <cstring>
 #include <limits>
+#include <string>
 #include <utility>
 
 #include "src/command.h"
@@ -34,6 +36,70 @@ namespace {
 
 const char* kDefaultEntryPointName = "main";
 
+bool IsDynamicDescriptorType(VkDescriptorType type) {
+  return type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC ||
+         type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+}
+
+// Appends the infos of |write| to |data| and returns the template entry which
+// reads them from there.
+VkDescriptorUpdateTemplateEntry AppendTemplateData(
+    const VkWriteDescriptorSet& write,
+    std::vector<uint8_t>* data) {
+  const void* infos = nullptr;
+  size_t stride = 0;
+  switch (write.descriptorType) {
+    case VK_DESCRIPTOR_TYPE_SAMPLER:
+    case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+    case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+    case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+      infos = write.pImageInfo;
+      stride = sizeof(VkDescriptorImageInfo);
+      break;
+    case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+    case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+      infos = write.pTexelBufferView;
+      stride = sizeof(VkBufferView);
+      break;
+    default:
+      infos = write.pBufferInfo;
+      stride = sizeof(VkDescriptorBufferInfo);
+      break;
+  }
+
+  VkDescriptorUpdateTemplateEntry entry = VkDescriptorUpdateTemplateEntry();
+  entry.dstBinding = write.dstBinding;
+  entry.dstArrayElement = write.dstArrayElement;
+  entry.descriptorCount = write.descriptorCount;
+  entry.descriptorType = write.descriptorType;
+  entry.offset = data->size();
+  entry.stride = stride;
+
+  const size_t size = stride * write.descriptorCount;
+  data->resize(data->size() + size);
+  if (size > 0)
+    std::memcpy(data->data() + entry.offset, infos, size);
+  return entry;
+}
+
+bool AreTemplateEntriesEqual(
+    const std::vector<VkDescriptorUpdateTemplateEntry>& a,
+    const std::vector<VkDescriptorUpdateTemplateEntry>& b) {
+  if (a.size() != b.size())
+    return false;
+
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i].dstBinding != b[i].dstBinding ||
+        a[i].dstArrayElement != b[i].dstArrayElement ||
+        a[i].descriptorCount != b[i].descriptorCount ||
+        a[i].descriptorType != b[i].descriptorType ||
+        a[i].offset != b[i].offset || a[i].stride != b[i].stride) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 Pipeline::Pipeline(
@@ -50,20 +116,18 @@ Pipeline::~Pipeline() {
   // Command must be reset before we destroy descriptors or we get a validation
   // error.
   command_ = nullptr;
+  transfer_command_ = nullptr;
 
   for (auto& info : descriptor_set_info_) {
+    if (info.update_template != VK_NULL_HANDLE) {
+      device_->GetPtrs()->vkDestroyDescriptorUpdateTemplate(
+          device_->GetVkDevice(), info.update_template, nullptr);
+    }
     if (info.layout != VK_NULL_HANDLE) {
       device_->GetPtrs()->vkDestroyDescriptorSetLayout(device_->GetVkDevice(),
                                                        info.layout, nullptr);
     }
 
-    if (info.empty)
-      continue;
-
-    if (info.pool != VK_NULL_HANDLE) {
-      device_->GetPtrs()->vkDestroyDescriptorPool(device_->GetVkDevice(),
-                                                  info.pool, nullptr);
-    }
   }
 }
 
@@ -75,48 +139,98 @@ ComputePipeline* Pipeline::AsCompute() {
   return static_cast<ComputePipeline*>(this);
 }
 
-Result Pipeline::Initialize(CommandPool* pool) {
+Result Pipeline::Initialize(CommandPool* pool,
+                            DescriptorPool* descriptor_pool,
+                            SamplerCache* sampler_cache) {
   push_constant_ = MakeUnique<PushConstant>(device_);
+  descriptor_pool_ = descriptor_pool;
+  sampler_cache_ = sampler_cache;
 
-  command_ = MakeUnique<CommandBuffer>(device_, pool);
+  command_ = MakeUnique<CommandBuffer>(device_, pool, fence_timeout_ms_);
   return command_->Initialize();
 }
 
-Result Pipeline::CreateDescriptorSetLayouts() {
-  for (auto& info : descriptor_set_info_) {
-    VkDescriptorSetLayoutCreateInfo desc_info =
-        VkDescriptorSetLayoutCreateInfo();
-    desc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+Result Pipeline::InitializeTransferCommandBuffer(CommandPool* transfer_pool) {
+  transfer_command_ =
+      MakeUnique<CommandBuffer>(device_, transfer_pool, fence_timeout_ms_);
+  return transfer_command_->Initialize();
+}
 
-    // If there are no descriptors for this descriptor set we only
-    // need to create its layout and there will be no bindings.
-    std::vector<VkDescriptorSetLayoutBinding> bindings;
-    for (auto& desc : info.descriptors) {
-      bindings.emplace_back();
-      bindings.back().binding = desc->GetBinding();
-      bindings.back().descriptorType = desc->GetVkDescriptorType();
-      bindings.back().descriptorCount = desc->GetDescriptorCount();
-      bindings.back().stageFlags = VK_SHADER_STAGE_ALL;
-    }
-    desc_info.bindingCount = static_cast<uint32_t>(bindings.size());
-    desc_info.pBindings = bindings.data();
+size_t Pipeline::FindPushDescriptorSet() const {
+  if (!device_->SupportsPushDescriptors())
+    return descriptor_set_info_.size();
+
+  // A push descriptor set can not hold dynamic descriptors, and a layout can
+  // only have one push descriptor set.
+  for (size_t i = 0; i < descriptor_set_info_.size(); ++i) {
+    const auto& info = descriptor_set_info_[i];
+    if (info.empty)
+      continue;
 
-    if (device_->GetPtrs()->vkCreateDescriptorSetLayout(
-            device_->GetVkDevice(), &desc_info, nullptr, &info.layout) !=
-        VK_SUCCESS) {
-      return Result("Vulkan::Calling vkCreateDescriptorSetLayout Fail");
+    uint32_t count = 0;
+    bool has_dynamic = false;
+    for (const auto& desc : info.descriptors) {
+      count += desc->GetDescriptorCount();
+      has_dynamic |= IsDynamicDescriptorType(desc->GetVkDescriptorType());
     }
+    if (!has_dynamic && count <= device_->GetMaxPushDescriptors())
+      return i;
+  }
+  return descriptor_set_info_.size();
+}
+
+Result Pipeline::CreateDescriptorSetLayouts() {
+  const size_t push_set = FindPushDescriptorSet();
+  for (size_t i = 0; i < descriptor_set_info_.size(); ++i) {
+    auto& info = descriptor_set_info_[i];
+    info.push = i == push_set;
+    Result r = CreateVkDescriptorSetLayout(info, info.push, &info.layout);
+    if (!r.IsSuccess())
+      return r;
   }
 
   return {};
 }
 
-Result Pipeline::CreateDescriptorPools() {
+Result Pipeline::CreateVkDescriptorSetLayout(const DescriptorSetInfo& info,
+                                             bool push,
+                                             VkDescriptorSetLayout* layout) {
+  VkDescriptorSetLayoutCreateInfo desc_info = VkDescriptorSetLayoutCreateInfo();
+  desc_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+  if (push)
+    desc_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+
+  // If there are no descriptors for this descriptor set we only
+  // need to create its layout and there will be no bindings.
+  std::vector<VkDescriptorSetLayoutBinding> bindings;
+  for (auto& desc : info.descriptors) {
+    bindings.emplace_back();
+    bindings.back().binding = desc->GetBinding();
+    bindings.back().descriptorType = desc->GetVkDescriptorType();
+    bindings.back().descriptorCount = desc->GetDescriptorCount();
+    bindings.back().stageFlags = VK_SHADER_STAGE_ALL;
+  }
+  desc_info.bindingCount = static_cast<uint32_t>(bindings.size());
+  desc_info.pBindings = bindings.data();
+
+  if (device_->GetPtrs()->vkCreateDescriptorSetLayout(
+          device_->GetVkDevice(), &desc_info, nullptr, layout) != VK_SUCCESS) {
+    return Result("Vulkan::Calling vkCreateDescriptorSetLayout Fail");
+  }
+
+  return {};
+}
+
+Result Pipeline::CreateDescriptorSets() {
+  // All sets of the pipeline are allocated with a single call. The push
+  // descriptor set is not allocated.
+  std::vector<VkDescriptorSetLayout> layouts;
+  std::vector<VkDescriptorPoolSize> pool_sizes;
   for (auto& info : descriptor_set_info_) {
-    if (info.empty)
+    if (info.empty || info.push)
       continue;
 
-    std::vector<VkDescriptorPoolSize> pool_sizes;
+    layouts.push_back(info.layout);
     for (auto& desc : info.descriptors) {
       VkDescriptorType type = desc->GetVkDescriptorType();
       auto it = find_if(pool_sizes.begin(), pool_sizes.end(),
@@ -132,43 +246,42 @@ Result Pipeline::CreateDescriptorPools() {
       pool_sizes.back().type = type;
       pool_sizes.back().descriptorCount = desc->GetDescriptorCount();
     }
+  }
 
-    VkDescriptorPoolCreateInfo pool_info = VkDescriptorPoolCreateInfo();
-    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    pool_info.maxSets = 1;
-    pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
-    pool_info.pPoolSizes = pool_sizes.data();
+  std::vector<VkDescriptorSet> sets;
+  Result r =
+      descriptor_pool_->AllocateDescriptorSets(layouts, pool_sizes, &sets);
+  if (!r.IsSuccess())
+    return r;
 
-    if (device_->GetPtrs()->vkCreateDescriptorPool(device_->GetVkDevice(),
-                                                   &pool_info, nullptr,
-                                                   &info.pool) != VK_SUCCESS) {
-      return Result("Vulkan::Calling vkCreateDescriptorPool Fail");
-    }
+  size_t next = 0;
+  for (auto& info : descriptor_set_info_) {
+    if (!info.empty && !info.push)
+      info.vk_desc_set = sets[next++];
   }
 
   return {};
 }
 
-Result Pipeline::CreateDescriptorSets() {
-  for (size_t i = 0; i < descriptor_set_info_.size(); ++i) {
-    if (descriptor_set_info_[i].empty)
-      continue;
+void Pipeline::ComputeDynamicOffsets() {
+  for (auto& info : descriptor_set_info_) {
+    // Sort descriptors by binding number to get correct order of dynamic
+    // offsets.
+    std::vector<Descriptor*> sorted;
+    for (const auto& desc : info.descriptors)
+      sorted.push_back(desc.get());
 
-    VkDescriptorSetAllocateInfo desc_set_info = VkDescriptorSetAllocateInfo();
-    desc_set_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    desc_set_info.descriptorPool = descriptor_set_info_[i].pool;
-    desc_set_info.descriptorSetCount = 1;
-    desc_set_info.pSetLayouts = &descriptor_set_info_[i].layout;
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Descriptor* a, const Descriptor* b) {
+                return a->GetBinding() < b->GetBinding();
+              });
 
-    VkDescriptorSet desc_set = VK_NULL_HANDLE;
-    if (device_->GetPtrs()->vkAllocateDescriptorSets(
-            device_->GetVkDevice(), &desc_set_info, &desc_set) != VK_SUCCESS) {
-      return Result("Vulkan::Calling vkAllocateDescriptorSets Fail");
+    info.dynamic_offsets.clear();
+    for (auto* desc : sorted) {
+      for (auto offset : desc->GetDynamicOffsets())
+        info.dynamic_offsets.push_back(offset);
     }
-    descriptor_set_info_[i].vk_desc_set = desc_set;
   }
-
-  return {};
 }
 
 Result Pipeline::CreateVkPipelineLayout(VkPipelineLayout* pipeline_layout) {
@@ -180,15 +293,61 @@ Result Pipeline::CreateVkPipelineLayout(VkPipelineLayout* pipeline_layout) {
   for (const auto& desc_set : descriptor_set_info_)
     descriptor_set_layouts.push_back(desc_set.layout);
 
+  return CreateVkPipelineLayoutFromSetLayouts(descriptor_set_layouts,
+                                              pipeline_layout);
+}
+
+VkPushConstantRange Pipeline::GetVkPushConstantRange() const {
+  return push_constant_->GetVkPushConstantRange();
+}
+
+Result Pipeline::CreateTransientVkPipelineLayout(
+    std::vector<VkDescriptorSetLayout>* set_layouts,
+    VkPipelineLayout* pipeline_layout) {
+  *pipeline_layout = VK_NULL_HANDLE;
+  set_layouts->clear();
+
+  // The same set is chosen as by `CreateDescriptorSetLayouts`, without
+  // storing it, so the layouts are compatible with the descriptor sets.
+  const size_t push_set = FindPushDescriptorSet();
+  for (size_t i = 0; i < descriptor_set_info_.size(); ++i) {
+    set_layouts->push_back(VK_NULL_HANDLE);
+    Result r = CreateVkDescriptorSetLayout(descriptor_set_info_[i],
+                                           i == push_set,
+                                           &set_layouts->back());
+    if (!r.IsSuccess())
+      return r;
+  }
+
+  return CreateVkPipelineLayoutFromSetLayouts(*set_layouts, pipeline_layout);
+}
+
+void Pipeline::DestroyTransientVkPipelineLayout(
+    const std::vector<VkDescriptorSetLayout>& set_layouts,
+    VkPipelineLayout pipeline_layout) {
+  if (pipeline_layout != VK_NULL_HANDLE) {
+    device_->GetPtrs()->vkDestroyPipelineLayout(device_->GetVkDevice(),
+                                                pipeline_layout, nullptr);
+  }
+  for (auto layout : set_layouts) {
+    if (layout != VK_NULL_HANDLE) {
+      device_->GetPtrs()->vkDestroyDescriptorSetLayout(device_->GetVkDevice(),
+                                                       layout, nullptr);
+    }
+  }
+}
+
+Result Pipeline::CreateVkPipelineLayoutFromSetLayouts(
+    const std::vector<VkDescriptorSetLayout>& set_layouts,
+    VkPipelineLayout* pipeline_layout) {
   VkPipelineLayoutCreateInfo pipeline_layout_info =
       VkPipelineLayoutCreateInfo();
   pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
   pipeline_layout_info.setLayoutCount =
-      static_cast<uint32_t>(descriptor_set_layouts.size());
-  pipeline_layout_info.pSetLayouts = descriptor_set_layouts.data();
+      static_cast<uint32_t>(set_layouts.size());
+  pipeline_layout_info.pSetLayouts = set_layouts.data();
 
-  VkPushConstantRange push_const_range =
-      push_constant_->GetVkPushConstantRange();
+  VkPushConstantRange push_const_range = GetVkPushConstantRange();
   if (push_const_range.size > 0) {
     pipeline_layout_info.pushConstantRangeCount = 1U;
     pipeline_layout_info.pPushConstantRanges = &push_const_range;
@@ -211,23 +370,101 @@ Result Pipeline::CreateVkDescriptorRelatedObjectsIfNeeded() {
   if (!r.IsSuccess())
     return r;
 
-  r = CreateDescriptorPools();
-  if (!r.IsSuccess())
-    return r;
-
   r = CreateDescriptorSets();
   if (!r.IsSuccess())
     return r;
 
+  ComputeDynamicOffsets();
+
   descriptor_related_objects_already_created_ = true;
   return {};
 }
 
-void Pipeline::UpdateDescriptorSetsIfNeeded() {
+Result Pipeline::UpdateDescriptorSetsIfNeeded() {
+  // Without update templates, the writes of every descriptor are collected
+  // so the sets are updated with a single vkUpdateDescriptorSets call.
+  std::vector<VkWriteDescriptorSet> writes;
   for (auto& info : descriptor_set_info_) {
+    // The push descriptor set is written when it is bound.
+    if (info.empty || info.push)
+      continue;
+
+    if (device_->SupportsDescriptorUpdateTemplates()) {
+      Result r = UpdateDescriptorSetWithTemplateIfNeeded(&info);
+      if (!r.IsSuccess())
+        return r;
+      continue;
+    }
+
     for (auto& desc : info.descriptors)
-      desc->UpdateDescriptorSetIfNeeded(info.vk_desc_set);
+      desc->AddDescriptorSetWriteIfNeeded(info.vk_desc_set, &writes);
+  }
+
+  if (writes.empty())
+    return {};
+
+  device_->GetPtrs()->vkUpdateDescriptorSets(
+      device_->GetVkDevice(), static_cast<uint32_t>(writes.size()),
+      writes.data(), 0, nullptr);
+  return {};
+}
+
+Result Pipeline::UpdateDescriptorSetWithTemplateIfNeeded(
+    DescriptorSetInfo* info) {
+  std::vector<VkWriteDescriptorSet> writes;
+  for (auto& desc : info->descriptors)
+    desc->AddDescriptorSetWriteIfNeeded(info->vk_desc_set, &writes);
+
+  if (writes.empty())
+    return {};
+
+  // The template writes the whole set, so that it does not change when only
+  // some of the descriptors are out of date.
+  if (writes.size() != info->descriptors.size()) {
+    writes.clear();
+    for (auto& desc : info->descriptors) {
+      desc->SetDescriptorSetUpdateNeeded();
+      desc->AddDescriptorSetWriteIfNeeded(info->vk_desc_set, &writes);
+    }
+  }
+
+  template_data_.clear();
+  std::vector<VkDescriptorUpdateTemplateEntry> entries;
+  for (const auto& write : writes)
+    entries.push_back(AppendTemplateData(write, &template_data_));
+
+  if (info->update_template == VK_NULL_HANDLE ||
+      !AreTemplateEntriesEqual(entries, info->template_entries)) {
+    if (info->update_template != VK_NULL_HANDLE) {
+      device_->GetPtrs()->vkDestroyDescriptorUpdateTemplate(
+          device_->GetVkDevice(), info->update_template, nullptr);
+      info->update_template = VK_NULL_HANDLE;
+    }
+
+    VkDescriptorUpdateTemplateCreateInfo template_info =
+        VkDescriptorUpdateTemplateCreateInfo();
+    template_info.sType =
+        VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+    template_info.descriptorUpdateEntryCount =
+        static_cast<uint32_t>(entries.size());
+    template_info.pDescriptorUpdateEntries = entries.data();
+    template_info.templateType =
+        VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+    template_info.descriptorSetLayout = info->layout;
+
+    if (device_->GetPtrs()->vkCreateDescriptorUpdateTemplate(
+            device_->GetVkDevice(), &template_info, nullptr,
+            &info->update_template) != VK_SUCCESS) {
+      info->update_template = VK_NULL_HANDLE;
+      return Result("Vulkan::Calling vkCreateDescriptorUpdateTemplate Fail");
+    }
+    info->template_entries = entries;
   }
+
+  device_->GetPtrs()->vkUpdateDescriptorSetWithTemplate(
+      device_->GetVkDevice(), info->vk_desc_set, info->update_template,
+      template_data_.data());
+  return {};
 }
 
 Result Pipeline::RecordPushConstant(const VkPipelineLayout& pipeline_layout) {
@@ -330,8 +567,9 @@ Result Pipeline::AddBufferDescriptor(const BufferCommand* cmd) {
   if (desc == nullptr) {
     if (is_image) {
       auto image_desc = MakeUnique<ImageDescriptor>(
-          cmd->GetBuffer(), desc_type, device_, cmd->GetBaseMipLevel(),
-          cmd->GetDescriptorSet(), cmd->GetBinding(), this);
+          cmd->GetBuffer(), desc_type, device_, sampler_cache_,
+          cmd->GetBaseMipLevel(), cmd->GetDescriptorSet(), cmd->GetBinding(),
+          this);
       if (cmd->IsCombinedImageSampler())
         image_desc->SetAmberSampler(cmd->GetSampler());
 
@@ -394,7 +632,7 @@ Result Pipeline::AddSamplerDescriptor(const SamplerCommand* cmd) {
 
   if (desc == nullptr) {
     auto sampler_desc = MakeUnique<SamplerDescriptor>(
-        cmd->GetSampler(), DescriptorType::kSampler, device_,
+        cmd->GetSampler(), DescriptorType::kSampler, device_, sampler_cache_,
         cmd->GetDescriptorSet(), cmd->GetBinding());
     descriptors.push_back(std::move(sampler_desc));
   } else {
@@ -410,48 +648,43 @@ Result Pipeline::AddSamplerDescriptor(const SamplerCommand* cmd) {
 }
 
 Result Pipeline::SendDescriptorDataToDeviceIfNeeded() {
-  {
-    CommandBufferGuard guard(GetCommandBuffer());
-    if (!guard.IsRecording())
-      return guard.GetResult();
-
-    for (auto& info : descriptor_set_info_) {
-      for (auto& desc : info.descriptors) {
-        Result r = desc->CreateResourceIfNeeded();
-        if (!r.IsSuccess())
-          return r;
-      }
-    }
-
-    // Initialize transfer buffers / images.
-    for (auto buffer : descriptor_buffers_) {
-      if (descriptor_transfer_resources_.count(buffer) == 0) {
-        return Result(
-            "Vulkan: Pipeline::SendDescriptorDataToDeviceIfNeeded() "
-            "descriptor's transfer resource is not found");
-      }
-      Result r = descriptor_transfer_resources_[buffer]->Initialize();
+  // The transfer resources of the previous command were released by
+  // `ReadbackDescriptorsToHostDataQueue` after waiting for it, so the ones
+  // created here are not used by the device yet and the host may write them
+  // directly. Recording only waits for the command buffer it reuses.
+  for (auto& info : descriptor_set_info_) {
+    for (auto& desc : info.descriptors) {
+      Result r = desc->CreateResourceIfNeeded();
       if (!r.IsSuccess())
-         return r;
+        return r;
     }
+  }
 
-    // Note that if a buffer for a descriptor is host accessible and
-    // does not need to record a command to copy data to device, it
-    // directly writes data to the buffer. The direct write must be
-    // done after resizing backed buffer i.e., copying data to the new
-    // buffer from the old one. Thus, we must submit commands here to
-    // guarantee this.
-    Result r = guard.Submit(GetFenceTimeout());
+  // Initialize transfer buffers / images.
+  for (auto buffer : descriptor_buffers_) {
+    if (descriptor_transfer_resources_.count(buffer) == 0) {
+      return Result(
+          "Vulkan: Pipeline::SendDescriptorDataToDeviceIfNeeded() "
+          "descriptor's transfer resource is not found");
+    }
+    Result r = descriptor_transfer_resources_[buffer]->Initialize();
     if (!r.IsSuccess())
       return r;
   }
 
+  Result r = SendStagedDescriptorDataOnTransferQueue();
+  if (!r.IsSuccess())
+    return r;
+
   CommandBufferGuard guard(GetCommandBuffer());
   if (!guard.IsRecording())
     return guard.GetResult();
 
   // Copy descriptor data to transfer resources.
   for (auto& buffer : descriptor_buffers_) {
+    if (GetTransferQueueBuffer(descriptor_transfer_resources_[buffer].get()))
+      continue;
+
     if (auto transfer_buffer =
             descriptor_transfer_resources_[buffer]->AsTransferBuffer()) {
       BufferBackedDescriptor::RecordCopyBufferDataToTransferResourceIfNeeded(
@@ -473,47 +706,142 @@ Result Pipeline::SendDescriptorDataToDeviceIfNeeded() {
           "this should be unreachable");
     }
   }
-  return guard.Submit(GetFenceTimeout());
+  // The upload is not waited for. Later submissions of this pipeline are
+  // ordered after it by the barriers above, so the host can prepare them
+  // while the copy runs and only waits when it reads the results.
+  return guard.SubmitNoWait();
+}
+
+TransferBuffer* Pipeline::GetTransferQueueBuffer(Resource* resource) const {
+  if (!transfer_command_)
+    return nullptr;
+
+  TransferBuffer* transfer_buffer = resource->AsTransferBuffer();
+  if (!transfer_buffer || !transfer_buffer->IsStaged())
+    return nullptr;
+  return transfer_buffer;
+}
+
+Result Pipeline::SendStagedDescriptorDataOnTransferQueue() {
+  std::vector<std::pair<Buffer*, TransferBuffer*>> staged;
+  for (auto& buffer : descriptor_buffers_) {
+    if (auto transfer_buffer = GetTransferQueueBuffer(
+            descriptor_transfer_resources_[buffer].get())) {
+      staged.emplace_back(buffer, transfer_buffer);
+    }
+  }
+  if (staged.empty())
+    return {};
+
+  CommandBufferGuard guard(transfer_command_.get());
+  if (!guard.IsRecording())
+    return guard.GetResult();
+
+  for (auto& entry : staged) {
+    entry.second->UpdateMemoryWithRawData(*entry.first->ValuePtr());
+    // Read-only buffers are not copied back, so their data is kept. See
+    // BufferBackedDescriptor::RecordCopyBufferDataToTransferResourceIfNeeded.
+    if (!entry.second->IsReadOnly())
+      entry.first->ValuePtr()->clear();
+
+    entry.second->CopyToDeviceOnTransferQueue(transfer_command_.get());
+  }
+
+  Result r = guard.SubmitNoWait();
+  if (!r.IsSuccess())
+    return r;
+
+  GetCommandBuffer()->WaitForOnDevice(*transfer_command_);
+  return {};
+}
+
+Result Pipeline::RecordIndirectBufferUpload(Buffer* buffer,
+                                            uint32_t offset,
+                                            uint32_t params_size,
+                                            VkBuffer* vk_buffer) {
+  // When the buffer is also bound to a descriptor its host copy has already
+  // been sent to the device and a shader may have written the parameters
+  // since, so they are copied from the device buffer of the descriptor.
+  const TransferBuffer* descriptor_buffer = nullptr;
+  auto it = descriptor_transfer_resources_.find(buffer);
+  if (it != descriptor_transfer_resources_.end())
+    descriptor_buffer = it->second->AsTransferBuffer();
+
+  const uint64_t size_in_bytes = descriptor_buffer
+                                     ? descriptor_buffer->GetSizeInBytes()
+                                     : buffer->ValuePtr()->size();
+  if (static_cast<uint64_t>(offset) + params_size > size_in_bytes) {
+    return Result("Vulkan: indirect parameters at offset " +
+                  std::to_string(offset) + " exceed the size of buffer " +
+                  buffer->GetName());
+  }
+
+  auto& indirect = indirect_buffers_[buffer];
+  auto& transfer_buffer = indirect.buffer;
+  if (!transfer_buffer || transfer_buffer->GetSizeInBytes() != size_in_bytes) {
+    transfer_buffer =
+        MakeUnique<TransferBuffer>(device_, size_in_bytes, nullptr);
+    transfer_buffer->SetMemoryPlacement(MemoryPlacement::kDeviceLocal);
+    Result r = transfer_buffer->AddUsageFlags(
+        VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    if (!r.IsSuccess())
+      return r;
+
+    r = transfer_buffer->Initialize();
+    if (!r.IsSuccess())
+      return r;
+    indirect.uploaded_data.clear();
+  }
+
+  if (descriptor_buffer) {
+    transfer_buffer->CopyFromDevice(GetCommandBuffer(), descriptor_buffer);
+    indirect.uploaded_data.clear();
+  } else if (indirect.uploaded_data != *buffer->ValuePtr()) {
+    transfer_buffer->UpdateMemoryWithRawData(*buffer->ValuePtr());
+    transfer_buffer->CopyToDevice(GetCommandBuffer());
+    indirect.uploaded_data = *buffer->ValuePtr();
+  }
+
+  *vk_buffer = transfer_buffer->GetVkBuffer();
+  return {};
 }
 
 void Pipeline::BindVkDescriptorSets(const VkPipelineLayout& pipeline_layout) {
+  const VkPipelineBindPoint bind_point = IsGraphics()
+                                             ? VK_PIPELINE_BIND_POINT_GRAPHICS
+                                             : VK_PIPELINE_BIND_POINT_COMPUTE;
   for (size_t i = 0; i < descriptor_set_info_.size(); ++i) {
     if (descriptor_set_info_[i].empty)
       continue;
 
-    // Sort descriptors by binding number to get correct order of dynamic
-    // offsets.
-    typedef std::pair<uint32_t, std::vector<uint32_t>> binding_offsets_pair;
-    std::vector<binding_offsets_pair> binding_offsets;
-    for (const auto& desc : descriptor_set_info_[i].descriptors) {
-      binding_offsets.push_back(
-          {desc->GetBinding(), desc->GetDynamicOffsets()});
-    }
-
-    std::sort(std::begin(binding_offsets), std::end(binding_offsets),
-              [](const binding_offsets_pair& a, const binding_offsets_pair& b) {
-                return a.first < b.first;
-              });
-
-    // Add the sorted dynamic offsets.
-    std::vector<uint32_t> dynamic_offsets;
-    for (const auto& binding_offset : binding_offsets) {
-      for (auto offset : binding_offset.second) {
-        dynamic_offsets.push_back(offset);
+    // Push descriptors are part of the command buffer, so all of them are
+    // written every time the set is bound.
+    if (descriptor_set_info_[i].push) {
+      std::vector<VkWriteDescriptorSet> writes;
+      for (auto& desc : descriptor_set_info_[i].descriptors) {
+        desc->SetDescriptorSetUpdateNeeded();
+        desc->AddDescriptorSetWriteIfNeeded(VK_NULL_HANDLE, &writes);
       }
+      device_->GetPtrs()->vkCmdPushDescriptorSetKHR(
+          command_->GetVkCommandBuffer(), bind_point, pipeline_layout,
+          static_cast<uint32_t>(i), static_cast<uint32_t>(writes.size()),
+          writes.data());
+      continue;
     }
 
+    const auto& dynamic_offsets = descriptor_set_info_[i].dynamic_offsets;
     device_->GetPtrs()->vkCmdBindDescriptorSets(
-        command_->GetVkCommandBuffer(),
-        IsGraphics() ? VK_PIPELINE_BIND_POINT_GRAPHICS
-                     : VK_PIPELINE_BIND_POINT_COMPUTE,
-        pipeline_layout, static_cast<uint32_t>(i), 1,
-        &descriptor_set_info_[i].vk_desc_set,
+        command_->GetVkCommandBuffer(), bind_point, pipeline_layout,
+        static_cast<uint32_t>(i), 1, &descriptor_set_info_[i].vk_desc_set,
         static_cast<uint32_t>(dynamic_offsets.size()), dynamic_offsets.data());
   }
 }
 
 Result Pipeline::ReadbackDescriptorsToHostDataQueue() {
+  // Staged buffers written by the device are copied back on the transfer
+  // queue, once the main queue is done with them.
+  std::vector<TransferBuffer*> staged;
+
   // Record required commands to copy the data to a host visible buffer.
   {
     CommandBufferGuard guard(GetCommandBuffer());
@@ -526,7 +854,11 @@ Result Pipeline::ReadbackDescriptorsToHostDataQueue() {
             "Vulkan: Pipeline::ReadbackDescriptorsToHostDataQueue() "
             "descriptor's transfer resource is not found");
       }
-      if (auto transfer_buffer =
+      if (auto staged_buffer = GetTransferQueueBuffer(
+              descriptor_transfer_resources_[buffer].get())) {
+        if (!staged_buffer->IsReadOnly())
+          staged.push_back(staged_buffer);
+      } else if (auto transfer_buffer =
               descriptor_transfer_resources_[buffer]->AsTransferBuffer()) {
         Result r = BufferBackedDescriptor::RecordCopyTransferResourceToHost(
             GetCommandBuffer(), transfer_buffer);
@@ -548,15 +880,37 @@ Result Pipeline::ReadbackDescriptorsToHostDataQueue() {
       }
     }
 
+    Result r = guard.SubmitNoWait();
+    if (!r.IsSuccess())
+      return r;
+  }
+
+  if (!staged.empty()) {
+    transfer_command_->WaitForOnDevice(*GetCommandBuffer());
+
+    CommandBufferGuard guard(transfer_command_.get());
+    if (!guard.IsRecording())
+      return guard.GetResult();
+
+    for (auto transfer_buffer : staged)
+      transfer_buffer->CopyToHostOnTransferQueue(transfer_command_.get());
+
     Result r = guard.Submit(GetFenceTimeout());
     if (!r.IsSuccess())
       return r;
   }
 
+  // The results are read on the host below, so the commands using them must
+  // be done. This is also the only wait for the draw or dispatch submitted
+  // before the readback.
+  Result r = GetCommandBuffer()->WaitAndReset(GetFenceTimeout());
+  if (!r.IsSuccess())
+    return r;
+
   // Move data from transfer buffers to output buffers.
   for (auto& buffer : descriptor_buffers_) {
     auto& transfer_resource = descriptor_transfer_resources_[buffer];
-    Result r = BufferBackedDescriptor::MoveTransferResourceToBufferOutput(
+    r = BufferBackedDescriptor::MoveTransferResourceToBufferOutput(
         transfer_resource.get(), buffer);
     if (!r.IsSuccess())
       return r;
@@ -26,8 +26,11 @@
 #include "src/engine.h"
 #include "src/vulkan/buffer_backed_descriptor.h"
 #include "src/vulkan/command_buffer.h"
+#include "src/vulkan/descriptor_pool.h"
+#include "src/vulkan/sampler_cache.h"
 #include "src/vulkan/push_constant.h"
 #include "src/vulkan/resource.h"
+#include "src/vulkan/transfer_buffer.h"
 
 namespace amber {
 
@@ -73,6 +76,18 @@ class Pipeline {
   CommandBuffer* GetCommandBuffer() const { return command_.get(); }
   Device* GetDevice() const { return device_; }
 
+  /// Sets where the memory of buffers bound to descriptors is placed. Must be
+  /// called before descriptors are added.
+  void SetMemoryPlacement(MemoryPlacement placement) {
+    memory_placement_ = placement;
+  }
+  MemoryPlacement GetMemoryPlacement() const { return memory_placement_; }
+
+  /// Creates the command buffer used to copy staged descriptor buffers on the
+  /// transfer queue of |transfer_pool|, which must outlive the pipeline.
+  /// Without it the copies are recorded on the main command buffer.
+  Result InitializeTransferCommandBuffer(CommandPool* transfer_pool);
+
  protected:
   Pipeline(
       PipelineType type,
@@ -80,20 +95,37 @@ class Pipeline {
       uint32_t fence_timeout_ms,
       const std::vector<VkPipelineShaderStageCreateInfo>& shader_stage_info);
 
-  /// Initializes the pipeline.
-  Result Initialize(CommandPool* pool);
+  /// Initializes the pipeline. Descriptor sets are allocated from
+  /// |descriptor_pool| and samplers are taken from |sampler_cache|. Both must
+  /// outlive the pipeline.
+  Result Initialize(CommandPool* pool,
+                    DescriptorPool* descriptor_pool,
+                    SamplerCache* sampler_cache);
 
   Result GetDescriptorSlot(uint32_t desc_set,
                            uint32_t binding,
                            Descriptor** desc);
-  void UpdateDescriptorSetsIfNeeded();
+  Result UpdateDescriptorSetsIfNeeded();
 
   Result SendDescriptorDataToDeviceIfNeeded();
+  /// Binds the descriptor sets, and records the writes of the push
+  /// descriptor set if there is one.
   void BindVkDescriptorSets(const VkPipelineLayout& pipeline_layout);
 
   /// Records a Vulkan command for push contant.
   Result RecordPushConstant(const VkPipelineLayout& pipeline_layout);
 
+  /// Returns in |vk_buffer| a device local buffer holding the contents of
+  /// |buffer|, which can be used as the parameter source of an indirect
+  /// dispatch or draw, and records the barrier making it visible to indirect
+  /// command reads. The host data is only uploaded when it changed since the
+  /// last upload. |params_size| bytes at |offset| must fit in |buffer|. Must
+  /// be called outside a render pass.
+  Result RecordIndirectBufferUpload(Buffer* buffer,
+                                    uint32_t offset,
+                                    uint32_t params_size,
+                                    VkBuffer* vk_buffer);
+
   const std::vector<VkPipelineShaderStageCreateInfo>& GetVkShaderStageInfo()
       const {
     return shader_stage_info_;
@@ -102,7 +134,23 @@ class Pipeline {
   const char* GetEntryPointName(VkShaderStageFlagBits stage) const;
   uint32_t GetFenceTimeout() const { return fence_timeout_ms_; }
 
+  /// Creates Vulkan descriptor related objects.
+  Result CreateVkDescriptorRelatedObjectsIfNeeded();
   Result CreateVkPipelineLayout(VkPipelineLayout* pipeline_layout);
+  /// Returns the push constant range of the layouts created for the current
+  /// push constants.
+  VkPushConstantRange GetVkPushConstantRange() const;
+  /// Creates a layout matching the current descriptors and push constants
+  /// without creating the descriptor sets, so the pipeline itself is not
+  /// changed. The layout and the descriptor set layouts stored in
+  /// |set_layouts| are released with DestroyTransientVkPipelineLayout, even
+  /// if creating them failed.
+  Result CreateTransientVkPipelineLayout(
+      std::vector<VkDescriptorSetLayout>* set_layouts,
+      VkPipelineLayout* pipeline_layout);
+  void DestroyTransientVkPipelineLayout(
+      const std::vector<VkDescriptorSetLayout>& set_layouts,
+      VkPipelineLayout pipeline_layout);
 
   Device* device_ = nullptr;
   std::unique_ptr<CommandBuffer> command_;
@@ -111,19 +159,45 @@ class Pipeline {
   struct DescriptorSetInfo {
     bool empty = true;
     VkDescriptorSetLayout layout = VK_NULL_HANDLE;
-    VkDescriptorPool pool = VK_NULL_HANDLE;
     VkDescriptorSet vk_desc_set = VK_NULL_HANDLE;
     std::vector<std::unique_ptr<Descriptor>> descriptors;
+    /// Dynamic offsets of the descriptors, ordered by binding.
+    std::vector<uint32_t> dynamic_offsets;
+    /// True if the set is written with vkCmdPushDescriptorSetKHR when it is
+    /// bound, instead of being allocated from the pool.
+    bool push = false;
+    /// Template writing every descriptor of the set, and the entries it was
+    /// created with.
+    VkDescriptorUpdateTemplate update_template = VK_NULL_HANDLE;
+    std::vector<VkDescriptorUpdateTemplateEntry> template_entries;
   };
 
-  /// Creates Vulkan descriptor related objects.
-  Result CreateVkDescriptorRelatedObjectsIfNeeded();
+  /// Returns the index of the first set which can hold push descriptors, or
+  /// the number of sets if there is none or the device does not support
+  /// them.
+  size_t FindPushDescriptorSet() const;
   Result CreateDescriptorSetLayouts();
-  Result CreateDescriptorPools();
+  /// Creates the layout of |info|, for push descriptors if |push| is true.
+  Result CreateVkDescriptorSetLayout(const DescriptorSetInfo& info,
+                                     bool push,
+                                     VkDescriptorSetLayout* layout);
+  Result CreateVkPipelineLayoutFromSetLayouts(
+      const std::vector<VkDescriptorSetLayout>& set_layouts,
+      VkPipelineLayout* pipeline_layout);
   Result CreateDescriptorSets();
+  /// Writes every descriptor of |info| with its update template, if any of
+  /// them is out of date.
+  Result UpdateDescriptorSetWithTemplateIfNeeded(DescriptorSetInfo* info);
+  void ComputeDynamicOffsets();
   /// Adds a buffer used by a descriptor. The added buffers are be stored in
   /// |descriptor_buffers_| vector in the order they are added.
   Result AddDescriptorBuffer(Buffer* amber_buffer);
+  /// Returns |resource| as a transfer buffer if it is copied to and from its
+  /// staging buffer on the transfer queue, otherwise nullptr.
+  TransferBuffer* GetTransferQueueBuffer(Resource* resource) const;
+  /// Uploads the staged descriptor buffers on the transfer queue. The next
+  /// submission of the main command buffer waits for the upload.
+  Result SendStagedDescriptorDataOnTransferQueue();
 
   PipelineType pipeline_type_;
   std::vector<DescriptorSetInfo> descriptor_set_info_;
@@ -132,8 +206,20 @@ class Pipeline {
       descriptor_transfer_resources_;
   /// Buffers used by descriptors (buffer descriptors and image descriptors).
   std::vector<Buffer*> descriptor_buffers_;
+  /// Device copy of a buffer used as indirect dispatch or draw parameters.
+  struct IndirectBuffer {
+    std::unique_ptr<TransferBuffer> buffer;
+    /// Host data last uploaded to |buffer|. Empty if |buffer| was last
+    /// copied from a descriptor buffer on the device.
+    std::vector<uint8_t> uploaded_data;
+  };
+  std::unordered_map<Buffer*, IndirectBuffer> indirect_buffers_;
+  /// Descriptor infos passed to vkUpdateDescriptorSetWithTemplate, reused
+  /// between updates.
+  std::vector<uint8_t> template_data_;
 
   uint32_t fence_timeout_ms_ = 1000;
+  MemoryPlacement memory_placement_ = MemoryPlacement::kHostVisible;
   bool descriptor_related_objects_already_created_ = false;
   std::unordered_map<VkShaderStageFlagBits,
                      std::string,
@@ -141,6 +227,9 @@ class Pipeline {
       entry_points_;
 
   std::unique_ptr<PushConstant> push_constant_;
+  std::unique_ptr<CommandBuffer> transfer_command_;
+  DescriptorPool* descriptor_pool_ = nullptr;
+  SamplerCache* sampler_cache_ = nullptr;
 };
 
 }  // namespace vulkan
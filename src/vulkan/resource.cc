@@ -47,20 +47,30 @@ VkMemoryBarrier kMemoryBarrierForAll = {
 
 }  // namespace
 
-Resource::Resource(Device* device, uint32_t size_in_bytes)
+Resource::Resource(Device* device, uint64_t size_in_bytes)
     : device_(device), size_in_bytes_(size_in_bytes) {}
 
 Resource::~Resource() = default;
 
-Result Resource::CreateVkBuffer(VkBuffer* buffer, VkBufferUsageFlags usage) {
+Result Resource::CreateVkBuffer(VkBuffer* buffer,
+                                VkBufferUsageFlags usage,
+                                bool shared_with_transfer_queue) {
   if (!buffer)
     return Result("Vulkan::Given VkBuffer pointer is nullptr");
 
+  const uint32_t queue_family_indices[] = {
+      device_->GetQueueFamilyIndex(), device_->GetTransferQueueFamilyIndex()};
+
   VkBufferCreateInfo buffer_info = VkBufferCreateInfo();
   buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
   buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
   buffer_info.size = size_in_bytes_;
   buffer_info.usage = usage;
+  if (shared_with_transfer_queue) {
+    buffer_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+    buffer_info.queueFamilyIndexCount = 2;
+    buffer_info.pQueueFamilyIndices = queue_family_indices;
+  }
 
   if (device_->GetPtrs()->vkCreateBuffer(device_->GetVkDevice(), &buffer_info,
                                          nullptr, buffer) != VK_SUCCESS) {
@@ -167,8 +177,9 @@ void Resource::UnMapMemory(VkDeviceMemory memory) {
 }
 
 void Resource::UpdateMemoryWithRawData(const std::vector<uint8_t>& raw_data) {
-  size_t effective_size =
-      raw_data.size() > GetSizeInBytes() ? GetSizeInBytes() : raw_data.size();
+  size_t effective_size = raw_data.size() > GetSizeInBytes()
+                              ? static_cast<size_t>(GetSizeInBytes())
+                              : raw_data.size();
   std::memcpy(HostAccessibleMemoryPtr(), raw_data.data(), effective_size);
 }
 
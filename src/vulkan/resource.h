@@ -44,7 +44,7 @@ class Resource {
 
   void* HostAccessibleMemoryPtr() const { return memory_ptr_; }
 
-  uint32_t GetSizeInBytes() const { return size_in_bytes_; }
+  uint64_t GetSizeInBytes() const { return size_in_bytes_; }
   void UpdateMemoryWithRawData(const std::vector<uint8_t>& raw_data);
 
   bool IsReadOnly() const { return is_read_only_; }
@@ -54,8 +54,13 @@ class Resource {
   virtual TransferImage* AsTransferImage() { return nullptr; }
 
  protected:
-  Resource(Device* device, uint32_t size);
-  Result CreateVkBuffer(VkBuffer* buffer, VkBufferUsageFlags usage);
+  Resource(Device* device, uint64_t size);
+  /// Creates |buffer| with |usage|. If |shared_with_transfer_queue| is true
+  /// the buffer can be used by the main and the transfer queue of the device
+  /// without transferring its ownership.
+  Result CreateVkBuffer(VkBuffer* buffer,
+                        VkBufferUsageFlags usage,
+                        bool shared_with_transfer_queue = false);
 
   Result AllocateAndBindMemoryToVkBuffer(VkBuffer buffer,
                                          VkDeviceMemory* memory,
@@ -87,7 +92,7 @@ class Resource {
   Device* device_ = nullptr;
 
  private:
-  uint32_t size_in_bytes_ = 0;
+  uint64_t size_in_bytes_ = 0;
   void* memory_ptr_ = nullptr;
   bool is_read_only_ = false;
 };
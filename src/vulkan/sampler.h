@@ -16,14 +16,16 @@
 #define SRC_VULKAN_SAMPLER_H_
 
 #include "src/sampler.h"
-#include "src/vulkan/device.h"
+#include "src/vulkan/sampler_cache.h"
 
 namespace amber {
 namespace vulkan {
 
+/// Reference to a Vulkan sampler owned by a SamplerCache. The reference is
+/// released when the Sampler is destroyed.
 class Sampler {
  public:
-  explicit Sampler(Device* device);
+  explicit Sampler(SamplerCache* cache);
   ~Sampler();
 
   Result CreateSampler(amber::Sampler* sampler);
@@ -31,7 +33,7 @@ class Sampler {
 
  private:
   VkSampler sampler_ = VK_NULL_HANDLE;
-  Device* device_;
+  SamplerCache* cache_;
 };
 
 }  // namespace vulkan
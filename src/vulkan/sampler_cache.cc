@@ -0,0 +1,159 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "src/vulkan/sampler_cache.h"
+
+#include <cassert>
+
+#include "src/vulkan/device.h"
+
+namespace amber {
+namespace vulkan {
+namespace {
+
+VkSamplerAddressMode GetVkAddressMode(AddressMode mode) {
+  switch (mode) {
+    case AddressMode::kRepeat:
+      return VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    case AddressMode::kMirroredRepeat:
+      return VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+    case AddressMode::kClampToEdge:
+      return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    case AddressMode::kClampToBorder:
+      return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+    default:
+      assert(mode == AddressMode::kMirrorClampToEdge);
+      return VK_SAMPLER_ADDRESS_MODE_MIRROR_CLAMP_TO_EDGE;
+  }
+}
+
+VkBorderColor GetVkBorderColor(BorderColor color) {
+  switch (color) {
+    case BorderColor::kFloatTransparentBlack:
+      return VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+    case BorderColor::kIntTransparentBlack:
+      return VK_BORDER_COLOR_INT_TRANSPARENT_BLACK;
+    case BorderColor::kFloatOpaqueBlack:
+      return VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+    case BorderColor::kIntOpaqueBlack:
+      return VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    case BorderColor::kFloatOpaqueWhite:
+      return VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+    default:
+      assert(color == BorderColor::kIntOpaqueWhite);
+      return VK_BORDER_COLOR_INT_OPAQUE_WHITE;
+  }
+}
+
+VkCompareOp ToVkCompareOp(CompareOp op) {
+  switch (op) {
+    case CompareOp::kNever:
+      return VK_COMPARE_OP_NEVER;
+    case CompareOp::kLess:
+      return VK_COMPARE_OP_LESS;
+    case CompareOp::kEqual:
+      return VK_COMPARE_OP_EQUAL;
+    case CompareOp::kLessOrEqual:
+      return VK_COMPARE_OP_LESS_OR_EQUAL;
+    case CompareOp::kGreater:
+      return VK_COMPARE_OP_GREATER;
+    case CompareOp::kNotEqual:
+      return VK_COMPARE_OP_NOT_EQUAL;
+    case CompareOp::kGreaterOrEqual:
+      return VK_COMPARE_OP_GREATER_OR_EQUAL;
+    case CompareOp::kAlways:
+      return VK_COMPARE_OP_ALWAYS;
+    case CompareOp::kUnknown:
+      break;
+  }
+  assert(false && "Vulkan::Unknown CompareOp");
+  return VK_COMPARE_OP_NEVER;
+}
+
+}  // namespace
+
+SamplerCache::SamplerCache(Device* device) : device_(device) {}
+
+SamplerCache::~SamplerCache() {
+  for (const auto& entry : samplers_) {
+    device_->GetPtrs()->vkDestroySampler(device_->GetVkDevice(),
+                                         entry.second.sampler, nullptr);
+  }
+}
+
+Result SamplerCache::AcquireSampler(const amber::Sampler* sampler,
+                                    VkSampler* vk_sampler) {
+  VkSamplerCreateInfo sampler_info = VkSamplerCreateInfo();
+  sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+  sampler_info.magFilter = sampler->GetMagFilter() == FilterType::kLinear
+                               ? VK_FILTER_LINEAR
+                               : VK_FILTER_NEAREST;
+  sampler_info.minFilter = sampler->GetMinFilter() == FilterType::kLinear
+                               ? VK_FILTER_LINEAR
+                               : VK_FILTER_NEAREST;
+  sampler_info.mipmapMode = sampler->GetMipmapMode() == FilterType::kLinear
+                                ? VK_SAMPLER_MIPMAP_MODE_LINEAR
+                                : VK_SAMPLER_MIPMAP_MODE_NEAREST;
+  sampler_info.addressModeU = GetVkAddressMode(sampler->GetAddressModeU());
+  sampler_info.addressModeV = GetVkAddressMode(sampler->GetAddressModeV());
+  sampler_info.addressModeW = GetVkAddressMode(sampler->GetAddressModeW());
+  sampler_info.borderColor = GetVkBorderColor(sampler->GetBorderColor());
+  sampler_info.minLod = sampler->GetMinLOD();
+  sampler_info.maxLod = sampler->GetMaxLOD();
+  sampler_info.unnormalizedCoordinates =
+      (sampler->GetNormalizedCoords() ? VK_FALSE : VK_TRUE);
+  sampler_info.compareEnable =
+      (sampler->GetCompareEnable() ? VK_TRUE : VK_FALSE);
+  sampler_info.compareOp = ToVkCompareOp(sampler->GetCompareOp());
+
+  Key key(sampler_info.magFilter, sampler_info.minFilter,
+          sampler_info.mipmapMode, sampler_info.addressModeU,
+          sampler_info.addressModeV, sampler_info.addressModeW,
+          sampler_info.borderColor, sampler_info.minLod, sampler_info.maxLod,
+          sampler_info.unnormalizedCoordinates, sampler_info.compareEnable,
+          sampler_info.compareOp);
+
+  auto it = samplers_.find(key);
+  if (it == samplers_.end()) {
+    Entry entry;
+    if (device_->GetPtrs()->vkCreateSampler(device_->GetVkDevice(),
+                                            &sampler_info, nullptr,
+                                            &entry.sampler) != VK_SUCCESS) {
+      return Result("Vulkan::Calling vkCreateSampler Fail");
+    }
+    it = samplers_.insert(std::make_pair(key, entry)).first;
+  }
+
+  ++it->second.ref_count;
+  *vk_sampler = it->second.sampler;
+  return {};
+}
+
+void SamplerCache::ReleaseSampler(VkSampler vk_sampler) {
+  for (auto it = samplers_.begin(); it != samplers_.end(); ++it) {
+    if (it->second.sampler != vk_sampler)
+      continue;
+
+    assert(it->second.ref_count > 0);
+    if (--it->second.ref_count == 0) {
+      device_->GetPtrs()->vkDestroySampler(device_->GetVkDevice(), vk_sampler,
+                                           nullptr);
+      samplers_.erase(it);
+    }
+    return;
+  }
+}
+
+}  // namespace vulkan
+}  // namespace amber
@@ -0,0 +1,78 @@
+// Copyright 2021 The Amber Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_VULKAN_SAMPLER_CACHE_H_
+#define SRC_VULKAN_SAMPLER_CACHE_H_
+
+#include <map>
+#include <tuple>
+
+#include "amber/result.h"
+#include "amber/vulkan_header.h"
+#include "src/sampler.h"
+
+namespace amber {
+namespace vulkan {
+
+class Device;
+
+/// Engine wide cache of Vulkan samplers. Samplers with the same filter,
+/// address, border, LOD and compare state are created once and shared by
+/// every descriptor using them. Each sampler is reference counted and
+/// destroyed when its last user releases it.
+class SamplerCache {
+ public:
+  explicit SamplerCache(Device* device);
+  ~SamplerCache();
+
+  /// Stores in |vk_sampler| a sampler matching the state of |sampler|,
+  /// creating it if needed, and adds a reference to it.
+  Result AcquireSampler(const amber::Sampler* sampler, VkSampler* vk_sampler);
+  /// Drops a reference to |vk_sampler|, which must have been returned by
+  /// AcquireSampler. The sampler is destroyed with its last reference.
+  void ReleaseSampler(VkSampler vk_sampler);
+
+  /// Returns the number of live Vulkan samplers.
+  size_t GetSamplerCount() const { return samplers_.size(); }
+
+ private:
+  // magFilter, minFilter, mipmapMode, addressModeU, addressModeV,
+  // addressModeW, borderColor, minLod, maxLod, unnormalizedCoordinates,
+  // compareEnable and compareOp of VkSamplerCreateInfo.
+  using Key = std::tuple<VkFilter,
+                         VkFilter,
+                         VkSamplerMipmapMode,
+                         VkSamplerAddressMode,
+                         VkSamplerAddressMode,
+                         VkSamplerAddressMode,
+                         VkBorderColor,
+                         float,
+                         float,
+                         VkBool32,
+                         VkBool32,
+                         VkCompareOp>;
+
+  struct Entry {
+    VkSampler sampler = VK_NULL_HANDLE;
+    uint32_t ref_count = 0;
+  };
+
+  Device* device_ = nullptr;
+  std::map<Key, Entry> samplers_;
+};
+
+}  // namespace vulkan
+}  // namespace amber
+
+#endif  // SRC_VULKAN_SAMPLER_CACHE_H_
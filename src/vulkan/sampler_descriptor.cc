@@ -23,9 +23,11 @@ namespace vulkan {
 SamplerDescriptor::SamplerDescriptor(amber::Sampler* sampler,
                                      DescriptorType type,
                                      Device* device,
+                                     SamplerCache* sampler_cache,
                                      uint32_t desc_set,
                                      uint32_t binding)
-    : Descriptor(type, device, desc_set, binding) {
+    : Descriptor(type, device, desc_set, binding),
+      sampler_cache_(sampler_cache) {
   AddAmberSampler(sampler);
 }
 
@@ -34,7 +36,7 @@ SamplerDescriptor::~SamplerDescriptor() = default;
 Result SamplerDescriptor::CreateResourceIfNeeded() {
   vulkan_samplers_.reserve(amber_samplers_.size());
   for (const auto& sampler : amber_samplers_) {
-    vulkan_samplers_.emplace_back(MakeUnique<Sampler>(device_));
+    vulkan_samplers_.emplace_back(MakeUnique<Sampler>(sampler_cache_));
     Result r = vulkan_samplers_.back()->CreateSampler(sampler);
     if (!r.IsSuccess())
       return r;
@@ -43,14 +45,15 @@ Result SamplerDescriptor::CreateResourceIfNeeded() {
   return {};
 }
 
-void SamplerDescriptor::UpdateDescriptorSetIfNeeded(
-    VkDescriptorSet descriptor_set) {
-  std::vector<VkDescriptorImageInfo> image_infos;
+void SamplerDescriptor::AddDescriptorSetWriteIfNeeded(
+    VkDescriptorSet descriptor_set,
+    std::vector<VkWriteDescriptorSet>* writes) {
+  image_infos_.clear();
 
   for (auto& sampler : vulkan_samplers_) {
     VkDescriptorImageInfo image_info = {sampler->GetVkSampler(), VK_NULL_HANDLE,
                                         VK_IMAGE_LAYOUT_GENERAL};
-    image_infos.push_back(image_info);
+    image_infos_.push_back(image_info);
   }
 
   VkWriteDescriptorSet write = VkWriteDescriptorSet();
@@ -58,12 +61,10 @@ void SamplerDescriptor::UpdateDescriptorSetIfNeeded(
   write.dstSet = descriptor_set;
   write.dstBinding = binding_;
   write.dstArrayElement = 0;
-  write.descriptorCount = static_cast<uint32_t>(image_infos.size());
+  write.descriptorCount = static_cast<uint32_t>(image_infos_.size());
   write.descriptorType = GetVkDescriptorType();
-  write.pImageInfo = image_infos.data();
-
-  device_->GetPtrs()->vkUpdateDescriptorSets(device_->GetVkDevice(), 1, &write,
-                                             0, nullptr);
+  write.pImageInfo = image_infos_.data();
+  writes->push_back(write);
 }
 
 }  // namespace vulkan
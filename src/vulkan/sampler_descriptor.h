@@ -30,11 +30,14 @@ class SamplerDescriptor : public Descriptor {
   SamplerDescriptor(amber::Sampler* sampler,
                     DescriptorType type,
                     Device* device,
+                    SamplerCache* sampler_cache,
                     uint32_t desc_set,
                     uint32_t binding);
   ~SamplerDescriptor() override;
 
-  void UpdateDescriptorSetIfNeeded(VkDescriptorSet descriptor_set) override;
+  void AddDescriptorSetWriteIfNeeded(
+      VkDescriptorSet descriptor_set,
+      std::vector<VkWriteDescriptorSet>* writes) override;
   Result CreateResourceIfNeeded() override;
   void AddAmberSampler(amber::Sampler* sampler) {
     amber_samplers_.push_back(sampler);
@@ -45,8 +48,10 @@ class SamplerDescriptor : public Descriptor {
   SamplerDescriptor* AsSamplerDescriptor() override { return this; }
 
  private:
+  SamplerCache* sampler_cache_;
   std::vector<amber::Sampler*> amber_samplers_;
   std::vector<std::unique_ptr<amber::vulkan::Sampler>> vulkan_samplers_;
+  std::vector<VkDescriptorImageInfo> image_infos_;
 };
 
 }  // namespace vulkan
@@ -14,6 +14,8 @@
 
 #include "src/vulkan/transfer_buffer.h"
 
+#include <limits>
+
 #include "src/vulkan/command_buffer.h"
 #include "src/vulkan/device.h"
 
@@ -21,7 +23,7 @@ namespace amber {
 namespace vulkan {
 
 TransferBuffer::TransferBuffer(Device* device,
-                               uint32_t size_in_bytes,
+                               uint64_t size_in_bytes,
                                Format* format)
     : Resource(device, size_in_bytes) {
   if (format)
@@ -33,8 +35,18 @@ TransferBuffer::~TransferBuffer() {
     device_->GetPtrs()->vkDestroyBufferView(device_->GetVkDevice(), view_,
                                             nullptr);
 
+    if (staging_memory_ != VK_NULL_HANDLE) {
+      UnMapMemory(staging_memory_);
+      device_->GetPtrs()->vkFreeMemory(device_->GetVkDevice(), staging_memory_,
+                                       nullptr);
+    }
+
+    device_->GetPtrs()->vkDestroyBuffer(device_->GetVkDevice(),
+                                        staging_buffer_, nullptr);
+
     if (memory_ != VK_NULL_HANDLE) {
-      UnMapMemory(memory_);
+      if (staging_buffer_ == VK_NULL_HANDLE)
+        UnMapMemory(memory_);
       device_->GetPtrs()->vkFreeMemory(device_->GetVkDevice(), memory_,
                                        nullptr);
     }
@@ -51,15 +63,20 @@ Result TransferBuffer::Initialize() {
         "initialized.");
   }
 
-  Result r = CreateVkBuffer(&buffer_, usage_flags_);
+  if (placement_ == MemoryPlacement::kDeviceLocal) {
+    usage_flags_ |=
+        VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+  }
+
+  Result r =
+      CreateVkBuffer(&buffer_, usage_flags_, IsSharedWithTransferQueue());
   if (!r.IsSuccess())
     return r;
 
-  uint32_t memory_type_index = 0;
-  r = AllocateAndBindMemoryToVkBuffer(buffer_, &memory_,
-                                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-                                          VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                                      true, &memory_type_index);
+  if (placement_ == MemoryPlacement::kDeviceLocal)
+    r = AllocateDeviceLocalMemory();
+  else
+    r = AllocateHostVisibleMemory();
   if (!r.IsSuccess())
     return r;
 
@@ -80,6 +97,19 @@ Result TransferBuffer::Initialize() {
     }
   }
 
+  return {};
+}
+
+Result TransferBuffer::AllocateHostVisibleMemory() {
+  uint32_t memory_type_index = 0;
+  Result r = AllocateAndBindMemoryToVkBuffer(
+      buffer_, &memory_,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+          VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+      true, &memory_type_index);
+  if (!r.IsSuccess())
+    return r;
+
   if (!device_->IsMemoryHostAccessible(memory_type_index) ||
       !device_->IsMemoryHostCoherent(memory_type_index)) {
     return Result(
@@ -90,16 +120,129 @@ Result TransferBuffer::Initialize() {
   return MapMemory(memory_);
 }
 
+Result TransferBuffer::AllocateDeviceLocalMemory() {
+  VkMemoryRequirements requirement;
+  device_->GetPtrs()->vkGetBufferMemoryRequirements(device_->GetVkDevice(),
+                                                    buffer_, &requirement);
+
+  // Device local memory which the host can map needs no staging copies. The
+  // heap of such memory is often small, so a failed allocation falls back
+  // to staging.
+  uint32_t memory_type_index = ChooseMemory(
+      requirement.memoryTypeBits,
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT |
+          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+          VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+      true);
+  if (memory_type_index != std::numeric_limits<uint32_t>::max()) {
+    if (AllocateMemory(&memory_, requirement.size, memory_type_index)
+            .IsSuccess()) {
+      Result r = BindMemory();
+      if (!r.IsSuccess())
+        return r;
+      return MapMemory(memory_);
+    }
+    memory_ = VK_NULL_HANDLE;
+  }
+
+  memory_type_index = ChooseMemory(requirement.memoryTypeBits,
+                                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false);
+  Result r = AllocateMemory(&memory_, requirement.size, memory_type_index);
+  if (!r.IsSuccess()) {
+    memory_ = VK_NULL_HANDLE;
+    return r;
+  }
+
+  r = BindMemory();
+  if (!r.IsSuccess())
+    return r;
+
+  return CreateStagingBuffer();
+}
+
+bool TransferBuffer::IsSharedWithTransferQueue() const {
+  return placement_ == MemoryPlacement::kDeviceLocal &&
+         device_->HasTransferQueue();
+}
+
+Result TransferBuffer::BindMemory() {
+  if (device_->GetPtrs()->vkBindBufferMemory(device_->GetVkDevice(), buffer_,
+                                             memory_, 0) != VK_SUCCESS) {
+    return Result("Vulkan::Calling vkBindBufferMemory Fail");
+  }
+  return {};
+}
+
+Result TransferBuffer::CreateStagingBuffer() {
+  Result r = CreateVkBuffer(
+      &staging_buffer_,
+      VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+      IsSharedWithTransferQueue());
+  if (!r.IsSuccess())
+    return r;
+
+  uint32_t memory_type_index = 0;
+  r = AllocateAndBindMemoryToVkBuffer(staging_buffer_, &staging_memory_,
+                                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                          VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                                      true, &memory_type_index);
+  if (!r.IsSuccess())
+    return r;
+
+  return MapMemory(staging_memory_);
+}
+
+void TransferBuffer::RecordCopy(CommandBuffer* command_buffer,
+                                VkBuffer src,
+                                VkBuffer dst) {
+  VkBufferCopy region = VkBufferCopy();
+  region.srcOffset = 0;
+  region.dstOffset = 0;
+  region.size = GetSizeInBytes();
+  device_->GetPtrs()->vkCmdCopyBuffer(command_buffer->GetVkCommandBuffer(),
+                                      src, dst, 1, &region);
+}
+
 void TransferBuffer::CopyToDevice(CommandBuffer* command_buffer) {
-  // This is redundant because this buffer is always host visible
-  // and coherent and vkQueueSubmit will make writes from host
-  // available (See chapter 6.9. "Host Write Ordering Guarantees" in
-  // Vulkan spec), but we prefer to keep it to simplify our own code.
+  // When the buffer is host visible and coherent this barrier is redundant,
+  // because vkQueueSubmit will make writes from host available (See chapter
+  // 6.9. "Host Write Ordering Guarantees" in Vulkan spec), but we prefer to
+  // keep it to simplify our own code. With a staging buffer it also orders
+  // the copy after earlier device accesses.
+  MemoryBarrier(command_buffer);
+  if (!IsStaged())
+    return;
+
+  RecordCopy(command_buffer, staging_buffer_, buffer_);
   MemoryBarrier(command_buffer);
 }
 
 void TransferBuffer::CopyToHost(CommandBuffer* command_buffer) {
   MemoryBarrier(command_buffer);
+  if (!IsStaged())
+    return;
+
+  RecordCopy(command_buffer, buffer_, staging_buffer_);
+  MemoryBarrier(command_buffer);
+}
+
+void TransferBuffer::CopyFromDevice(CommandBuffer* command_buffer,
+                                    const TransferBuffer* src) {
+  MemoryBarrier(command_buffer);
+  RecordCopy(command_buffer, src->buffer_, buffer_);
+  MemoryBarrier(command_buffer);
+}
+
+void TransferBuffer::CopyToDeviceOnTransferQueue(
+    CommandBuffer* command_buffer) {
+  // Host writes are made available by vkQueueSubmit, and the waiting
+  // submission on the main queue orders its accesses after the copy.
+  RecordCopy(command_buffer, staging_buffer_, buffer_);
+}
+
+void TransferBuffer::CopyToHostOnTransferQueue(CommandBuffer* command_buffer) {
+  RecordCopy(command_buffer, buffer_, staging_buffer_);
+  MemoryBarrier(command_buffer);
 }
 
 }  // namespace vulkan
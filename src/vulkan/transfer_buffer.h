@@ -17,6 +17,7 @@
 
 #include <vector>
 
+#include "amber/recipe.h"
 #include "amber/result.h"
 #include "amber/vulkan_header.h"
 #include "src/format.h"
@@ -29,9 +30,17 @@ class CommandBuffer;
 class Device;
 
 /// Wrapper around a Vulkan VkBuffer object.
+///
+/// By default the buffer lives in host visible memory which the host reads
+/// and writes in place. With MemoryPlacement::kDeviceLocal the buffer lives
+/// in device local memory. If the host can map that memory, it is still
+/// accessed in place. Otherwise the host accesses a staging buffer, and
+/// CopyToDevice() and CopyToHost() record the copies between the two. If the
+/// device has a transfer queue, these copies can be recorded for it with
+/// CopyToDeviceOnTransferQueue() and CopyToHostOnTransferQueue() instead.
 class TransferBuffer : public Resource {
  public:
-  TransferBuffer(Device* device, uint32_t size_in_bytes, Format* format);
+  TransferBuffer(Device* device, uint64_t size_in_bytes, Format* format);
   ~TransferBuffer() override;
 
   TransferBuffer* AsTransferBuffer() override { return this; }
@@ -44,6 +53,12 @@ class TransferBuffer : public Resource {
     usage_flags_ |= flags;
     return {};
   }
+  /// Sets where the buffer memory is placed. Must be called before
+  /// Initialize().
+  void SetMemoryPlacement(MemoryPlacement placement) { placement_ = placement; }
+  /// Returns true if the host accesses the buffer through a staging buffer.
+  bool IsStaged() const { return staging_buffer_ != VK_NULL_HANDLE; }
+
   Result Initialize() override;
   const VkBufferView* GetVkBufferView() const { return &view_; }
 
@@ -55,11 +70,36 @@ class TransferBuffer : public Resource {
   /// Records a command on |command_buffer| to copy the buffer contents from the
   /// device to the host.
   void CopyToHost(CommandBuffer* command_buffer) override;
+  /// Records a command on |command_buffer| to copy the device contents of
+  /// |src|, which must be at least as large, into the device buffer. The
+  /// copy is ordered after earlier device accesses and before later ones.
+  void CopyFromDevice(CommandBuffer* command_buffer, const TransferBuffer* src);
+
+  /// Records the copy from the staging buffer to the device local buffer on
+  /// |command_buffer| of the transfer queue. The submission using the buffer
+  /// must wait for it with CommandBuffer::WaitForOnDevice(). Only valid if
+  /// IsStaged().
+  void CopyToDeviceOnTransferQueue(CommandBuffer* command_buffer);
+  /// Records the copy from the device local buffer to the staging buffer on
+  /// |command_buffer| of the transfer queue, which must wait for the
+  /// submission writing the buffer. Only valid if IsStaged().
+  void CopyToHostOnTransferQueue(CommandBuffer* command_buffer);
 
  private:
+  Result AllocateHostVisibleMemory();
+  Result AllocateDeviceLocalMemory();
+  Result BindMemory();
+  Result CreateStagingBuffer();
+  /// Returns true if the buffers are used by the main and the transfer queue.
+  bool IsSharedWithTransferQueue() const;
+  void RecordCopy(CommandBuffer* command_buffer, VkBuffer src, VkBuffer dst);
+
+  MemoryPlacement placement_ = MemoryPlacement::kHostVisible;
   VkBufferUsageFlags usage_flags_ = 0;
   VkBuffer buffer_ = VK_NULL_HANDLE;
   VkDeviceMemory memory_ = VK_NULL_HANDLE;
+  VkBuffer staging_buffer_ = VK_NULL_HANDLE;
+  VkDeviceMemory staging_memory_ = VK_NULL_HANDLE;
   VkBufferView view_ = VK_NULL_HANDLE;
   VkFormat format_ = VK_FORMAT_UNDEFINED;
 };
@@ -80,7 +80,7 @@ TransferImage::TransferImage(Device* device,
                              uint32_t samples)
     : Resource(
           device,
-          x * y * z *
+          static_cast<uint64_t>(x) * y * z *
               (format.SizeInBytes() +
                // D24_UNORM_S8_UINT requires 32bit component for depth when
                // performing buffer copies. Reserve extra room to handle that.
@@ -88,6 +88,7 @@ TransferImage::TransferImage(Device* device,
                                                                          : 0))),
       image_info_(kDefaultImageInfo),
       aspect_(aspect),
+      texel_size_(format.SizeInBytes()),
       mip_levels_(mip_levels),
       base_mip_level_(base_mip_level),
       used_mip_levels_(used_mip_levels),
@@ -155,10 +156,12 @@ Result TransferImage::Initialize() {
   // For images, we always make a secondary buffer. When the tiling of an image
   // is optimal, read/write data from CPU does not show correct values. We need
   // a secondary buffer to convert the GPU-optimal data to CPU-readable data
-  // and vice versa.
-  r = CreateVkBuffer(
-      &host_accessible_buffer_,
-      VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+  // and vice versa. The buffer can also be bound as a storage buffer so
+  // probes can read it on the device.
+  r = CreateVkBuffer(&host_accessible_buffer_,
+                     VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                         VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
   if (!r.IsSuccess())
     return r;
 
@@ -228,7 +231,8 @@ VkBufferImageCopy TransferImage::CreateBufferImageCopy(
   if (aspect == VK_IMAGE_ASPECT_STENCIL_BIT) {
     // Store stencil data at the end of the buffer after depth data.
     copy_region.bufferOffset =
-        GetSizeInBytes() - image_info_.extent.width * image_info_.extent.height;
+        GetSizeInBytes() - static_cast<VkDeviceSize>(image_info_.extent.width) *
+                               image_info_.extent.height;
   } else {
     copy_region.bufferOffset = 0;
   }
@@ -277,6 +281,38 @@ void TransferImage::CopyToHost(CommandBuffer* command_buffer) {
   MemoryBarrier(command_buffer);
 }
 
+void TransferImage::CopyRegionsToHost(CommandBuffer* command_buffer,
+                                      const std::vector<VkRect2D>& regions) {
+  // Copy operations don't support multisample images.
+  if (samples_ > 1 || regions.empty())
+    return;
+
+  std::vector<VkBufferImageCopy> copy_regions;
+  for (const auto& region : regions) {
+    VkBufferImageCopy copy_region =
+        CreateBufferImageCopy(VK_IMAGE_ASPECT_COLOR_BIT, base_mip_level_);
+    // Rows keep the stride of the whole image so each texel lands at the
+    // same offset as with a full copy.
+    copy_region.bufferOffset =
+        (static_cast<VkDeviceSize>(region.offset.y) *
+             image_info_.extent.width +
+         static_cast<VkDeviceSize>(region.offset.x)) *
+        texel_size_;
+    copy_region.bufferRowLength = image_info_.extent.width;
+    copy_region.bufferImageHeight = image_info_.extent.height;
+    copy_region.imageOffset = {region.offset.x, region.offset.y, 0};
+    copy_region.imageExtent = {region.extent.width, region.extent.height, 1};
+    copy_regions.push_back(copy_region);
+  }
+
+  device_->GetPtrs()->vkCmdCopyImageToBuffer(
+      command_buffer->GetVkCommandBuffer(), image_,
+      VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, host_accessible_buffer_,
+      static_cast<uint32_t>(copy_regions.size()), copy_regions.data());
+
+  MemoryBarrier(command_buffer);
+}
+
 void TransferImage::CopyToDevice(CommandBuffer* command_buffer) {
   // Copy operations don't support multisample images.
   if (samples_ > 1)
@@ -46,6 +46,9 @@ class TransferImage : public Resource {
   TransferImage* AsTransferImage() override { return this; }
   Result Initialize() override;
   VkImageView GetVkImageView() const { return view_; }
+  /// Returns the host accessible buffer holding the image contents after
+  /// CopyToHost.
+  VkBuffer GetHostAccessibleBuffer() const { return host_accessible_buffer_; }
 
   void ImageBarrier(CommandBuffer* command_buffer,
                     VkImageLayout to_layout,
@@ -57,6 +60,11 @@ class TransferImage : public Resource {
   /// Records a command on |command_buffer| to copy the buffer contents from the
   /// device to the host.
   void CopyToHost(CommandBuffer* command_buffer) override;
+  /// Records a command on |command_buffer| to copy only |regions| of the
+  /// first mip level of a color image to the host. Each region lands where
+  /// CopyToHost would put it.
+  void CopyRegionsToHost(CommandBuffer* command_buffer,
+                         const std::vector<VkRect2D>& regions);
 
  private:
   Result CreateVkImageView(VkImageAspectFlags aspect);
@@ -85,6 +93,7 @@ class TransferImage : public Resource {
   VkImageLayout layout_ = VK_IMAGE_LAYOUT_UNDEFINED;
   VkPipelineStageFlags stage_ = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
 
+  uint32_t texel_size_;
   uint32_t mip_levels_;
   uint32_t base_mip_level_;
   uint32_t used_mip_levels_;
@@ -82,7 +82,7 @@ Result VertexBuffer::SendVertexData(CommandBuffer* command) {
     }
 
     // Create a new transfer buffer to hold vertex data.
-    uint32_t bytes = buf->GetSizeInBytes();
+    const auto bytes = static_cast<size_t>(buf->GetSizeInBytes());
     transfer_buffers_.push_back(
         MakeUnique<TransferBuffer>(device_, bytes, nullptr));
     Result r = transfer_buffers_.back()->AddUsageFlags(
@@ -139,7 +139,7 @@ class VertexBufferTest : public testing::Test {
       : device_(MakeUnique<DummyDevice>()),
         commandPool_(MakeUnique<CommandPool>(device_.get())),
         commandBuffer_(
-            MakeUnique<CommandBuffer>(device_.get(), commandPool_.get())),
+            MakeUnique<CommandBuffer>(device_.get(), commandPool_.get(), 0)),
         vertex_buffer_(MakeUnique<VertexBuffer>(device_.get())) {
     commandBuffer_->Initialize();
   }
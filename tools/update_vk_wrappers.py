@@ -67,7 +67,26 @@ def read_vk(file):
   return methods
 
 
-def gen_wrappers(methods, xml):
+def indent(text):
+  return ''.join('  ' + line if line.strip() else line
+                 for line in text.splitlines(True))
+
+
+# Loads the pointer of an optional core method, falling back to its KHR alias.
+# Extension methods have no alias to fall back to. The rest of the wrapper is
+# only run if a pointer was found, otherwise the member stays empty.
+OPTIONAL_LOOKUP = R'''  if (!ptr) {
+    ptr = reinterpret_cast<PFN_${method}>(getInstanceProcAddr(instance_, "${method}KHR"));
+  }
+'''
+
+REQUIRED_LOOKUP = R'''  if (!ptr) {
+    return Result("Vulkan: Unable to load ${method} pointer");
+  }
+'''
+
+
+def gen_wrappers(methods, xml, optional):
   content = ""
   for method in methods:
     data = xml[method]
@@ -89,19 +108,23 @@ def gen_wrappers(methods, xml):
       return_variable = 'ret'
       call_prefix = return_type + ' ' + return_variable + ' = '
 
-    template = Template(R'''{
-  PFN_${method} ptr = reinterpret_cast<PFN_${method}>(getInstanceProcAddr(instance_, "${method}"));
-  if (!ptr) {
-    return Result("Vulkan: Unable to load ${method} pointer");
-  }
+    body = R'''CallStats::Entry* stats =
+      call_stats_ ? call_stats_->AddEntry("${method}") : nullptr;
   if (delegate && delegate->LogGraphicsCalls()) {
-    ptrs_.${method} = [ptr, delegate](${signature}) -> ${return_type} {
+    ptrs_.${method} = [ptr, delegate, stats](${signature}) -> ${return_type} {
       delegate->Log("${method}");
+      uint64_t stats_start = 0;
+      if (stats) {
+        stats_start = CallStats::NowNs();
+      }
       uint64_t timestamp_start = 0;
       if (delegate->LogGraphicsCallsTime()) {
         timestamp_start = delegate->GetTimestampNs();
       }
       ${call_prefix}ptr(${arguments});
+      if (stats) {
+        CallStats::Record(stats, CallStats::NowNs() - stats_start);
+      }
       if (delegate->LogGraphicsCallsTime()) {
         uint64_t timestamp_end = delegate->GetTimestampNs();
         uint64_t duration = timestamp_end - timestamp_start;
@@ -116,14 +139,33 @@ def gen_wrappers(methods, xml):
       }
       return ${return_variable};
     };
+  } else if (stats) {
+    // Only the counters are updated, nothing is formatted or logged per call.
+    // The steady clock is used since the delegate may not be thread safe and
+    // the precompile workers call these wrappers too.
+    ptrs_.${method} = [ptr, stats](${signature}) -> ${return_type} {
+      uint64_t timestamp_start = CallStats::NowNs();
+      ${call_prefix}ptr(${arguments});
+      CallStats::Record(stats, CallStats::NowNs() - timestamp_start);
+      return ${return_variable};
+    };
   } else {
     ptrs_.${method} = [ptr](${signature}) -> ${return_type} {
       ${call_prefix}ptr(${arguments});
       return ${return_variable};
     };
   }
-}
-''')
+'''
+    body = '  ' + body
+    if optional:
+      lookup = '' if method.endswith('KHR') else OPTIONAL_LOOKUP
+      body = lookup + '  if (ptr) {\n' + indent(body) + '  }\n'
+    else:
+      body = REQUIRED_LOOKUP + body
+
+    template = Template(R'''{
+  PFN_${method} ptr = reinterpret_cast<PFN_${method}>(getInstanceProcAddr(instance_, "${method}"));
+''' + body + '}\n')
 
     content += template.substitute(method=method,
                                    signature=signature,
@@ -154,17 +196,31 @@ def gen_headers(methods, xml):
   return content
 
 
-def gen_direct(methods):
+def gen_direct(methods, optional):
   content = "";
 
-  template = Template(R'''
+  extension_template = Template(R'''
+ptrs_.${method} = reinterpret_cast<PFN_${method}>(getInstanceProcAddr(instance_, "${method}"));
+''')
+
+  if optional:
+    template = Template(R'''
+if (!(ptrs_.${method} = reinterpret_cast<PFN_${method}>(getInstanceProcAddr(instance_, "${method}")))) {
+  ptrs_.${method} = reinterpret_cast<PFN_${method}>(getInstanceProcAddr(instance_, "${method}KHR"));
+}
+''')
+  else:
+    template = Template(R'''
 if (!(ptrs_.${method} = reinterpret_cast<PFN_${method}>(getInstanceProcAddr(instance_, "${method}")))) {
   return Result("Vulkan: Unable to load ${method} pointer");
 }
 ''')
 
   for method in methods:
-    content += template.substitute(method=method)
+    if optional and method.endswith('KHR'):
+      content += extension_template.substitute(method=method)
+    else:
+      content += template.substitute(method=method)
 
   return content
 
@@ -177,6 +233,16 @@ def gen_direct_headers(methods):
   return content
 
 
+# Unchanged files are not written again, so they do not trigger a rebuild.
+def write_if_changed(path, content):
+  if os.path.isfile(path):
+    with open(path, 'r') as f:
+      if content == f.read():
+        return
+  with open(path, 'w') as f:
+    f.write(content)
+
+
 def main():
   if len(sys.argv) != 3:
     print('usage: {} <outdir> <src_dir>'.format(
@@ -186,9 +252,12 @@ def main():
   outdir = sys.argv[1]
   srcdir = sys.argv[2]
 
-  vulkan_versions = ("1-0", "1-1")
+  # Methods of the optional list may be missing, in which case their member
+  # is left empty.
+  vulkan_versions = ("1-0", "1-1", "optional")
 
   for vulkan_version in vulkan_versions:
+    optional = vulkan_version == "optional"
 
     vkfile = os.path.join(srcdir, 'third_party', 'vulkan-headers', 'registry', 'vk.xml')
     incfile = os.path.join(srcdir, 'src', 'vulkan', 'vk-funcs-%s.inc' % vulkan_version)
@@ -199,27 +268,17 @@ def main():
     header_content = ''
     if os.path.isfile(vkfile):
       vk_data = read_vk(vkfile)
-      wrapper_content = gen_wrappers(data, vk_data)
+      wrapper_content = gen_wrappers(data, vk_data, optional)
       header_content = gen_headers(data, vk_data)
     else:
-      wrapper_content = gen_direct(data)
+      wrapper_content = gen_direct(data, optional)
       header_content = gen_direct_headers(data)
 
     outfile = os.path.join(outdir, 'vk-wrappers-%s.inc' % vulkan_version)
-    if os.path.isfile(outfile):
-      with open(outfile, 'r') as f:
-        if wrapper_content == f.read():
-          return
-    with open(outfile, 'w') as f:
-      f.write(wrapper_content)
+    write_if_changed(outfile, wrapper_content)
 
     hdrfile = os.path.join(outdir, 'vk-wrappers-%s.h' % vulkan_version)
-    if os.path.isfile(hdrfile):
-      with open(hdrfile, 'r') as f:
-        if header_content == f.read():
-          return
-    with open(hdrfile, 'w') as f:
-      f.write(header_content)
+    write_if_changed(hdrfile, header_content)
 
 
 if __name__ == '__main__':